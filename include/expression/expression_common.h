@@ -526,4 +526,18 @@ namespace expression
 	std::unordered_map<identifier, number> makeDefaultVariables() noexcept;
 
 	std::unordered_map<identifier, std::unique_ptr<IFunctionHolder>> makeDefaultFunctions() noexcept;
+
+	/// <summary>
+	/// Function returning uniformly distributed random numbers in [0,1).
+	/// </summary>
+	typedef std::function<number()> RandomSource;
+
+	/// <summary>
+	/// Sets the source of the random numbers returned by the default function rand() (see makeDefaultFunctions()) when evaluated on the calling thread, and returns the previous source.
+	/// Simulations set this to their own random number stream while running, such that expressions using rand() are reproducible given the seed of the simulation.
+	/// If no source is set (nullptr), rand() uses a randomly seeded generator local to the calling thread.
+	/// </summary>
+	/// <param name="source">Source of random numbers, or nullptr.</param>
+	/// <returns>Previous source of random numbers.</returns>
+	RandomSource setRandomSource(RandomSource source) noexcept;
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <exception>
+#include <utility>
+namespace stochsim
+{
+	/// <summary>
+	/// Serializes the runtime state of a simulation into a compact binary checkpoint (see SimulationInstance::SaveCheckpoint()). Values are stored in their native binary representation, such that
+	/// a checkpoint can only be restored on a machine with the same endianness and type sizes, but restoring is a plain memory copy and restores all floating point values bit-exactly.
+	/// </summary>
+	class CheckpointWriter
+	{
+	public:
+		/// <summary>
+		/// Appends a single value, which must be trivially copyable.
+		/// </summary>
+		/// <param name="value">Value to append.</param>
+		template<typename T> inline void Write(const T& value)
+		{
+			WriteArray(&value, 1);
+		}
+		/// <summary>
+		/// Appends an array of values, which must be trivially copyable. The number of values is not stored, and must be known when reading the array.
+		/// </summary>
+		/// <param name="values">Values to append.</param>
+		/// <param name="num">Number of values.</param>
+		template<typename T> inline void WriteArray(const T* values, size_t num)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written to a checkpoint.");
+			const size_t oldSize = data_.size();
+			data_.resize(oldSize + num * sizeof(T));
+			if (num > 0)
+				std::memcpy(data_.data() + oldSize, values, num * sizeof(T));
+		}
+		/// <summary>
+		/// Appends a string, preceded by its length.
+		/// </summary>
+		/// <param name="value">String to append.</param>
+		inline void WriteString(const std::string& value)
+		{
+			Write<std::uint64_t>(value.size());
+			WriteArray(value.data(), value.size());
+		}
+		/// <summary>
+		/// Returns the binary checkpoint written so far.
+		/// </summary>
+		/// <returns>Binary checkpoint.</returns>
+		inline const std::vector<char>& GetData() const noexcept
+		{
+			return data_;
+		}
+		/// <summary>
+		/// Moves the binary checkpoint written so far out of the writer, leaving the writer empty.
+		/// </summary>
+		/// <returns>Binary checkpoint.</returns>
+		inline std::vector<char> Release() noexcept
+		{
+			std::vector<char> data;
+			data.swap(data_);
+			return data;
+		}
+	private:
+		std::vector<char> data_;
+	};
+
+	/// <summary>
+	/// Reads the values of a binary checkpoint in the order they were written by a CheckpointWriter. Throws an exception if the checkpoint ends before all values are read.
+	/// </summary>
+	class CheckpointReader
+	{
+	public:
+		CheckpointReader(std::vector<char> data) : data_(std::move(data)), position_(0)
+		{
+		}
+		/// <summary>
+		/// Reads a single value.
+		/// </summary>
+		/// <returns>Value read.</returns>
+		template<typename T> inline T Read()
+		{
+			T value;
+			ReadArray(&value, 1);
+			return value;
+		}
+		/// <summary>
+		/// Reads an array of values.
+		/// </summary>
+		/// <param name="values">Array receiving the values.</param>
+		/// <param name="num">Number of values.</param>
+		template<typename T> inline void ReadArray(T* values, size_t num)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read from a checkpoint.");
+			if (num > (data_.size() - position_) / sizeof(T))
+				throw std::exception("Checkpoint is truncated or corrupt.");
+			if (num > 0)
+				std::memcpy(values, data_.data() + position_, num * sizeof(T));
+			position_ += num * sizeof(T);
+		}
+		/// <summary>
+		/// Reads a string written by CheckpointWriter::WriteString().
+		/// </summary>
+		/// <returns>String read.</returns>
+		inline std::string ReadString()
+		{
+			const std::uint64_t length = Read<std::uint64_t>();
+			if (length > data_.size() - position_)
+				throw std::exception("Checkpoint is truncated or corrupt.");
+			std::string value(data_.data() + position_, static_cast<size_t>(length));
+			position_ += static_cast<size_t>(length);
+			return value;
+		}
+		/// <summary>
+		/// Returns true if all values of the checkpoint were read.
+		/// </summary>
+		/// <returns>True if at end of checkpoint.</returns>
+		inline bool AtEnd() const noexcept
+		{
+			return position_ == data_.size();
+		}
+	private:
+		std::vector<char> data_;
+		size_t position_;
+	};
+
+	/// <summary>
+	/// Writes a binary checkpoint to the given file. The checkpoint is first written to a temporary file, which then replaces the given file, such that the file always contains a complete checkpoint,
+	/// even if the program is terminated while writing.
+	/// </summary>
+	/// <param name="fileName">Name of the checkpoint file.</param>
+	/// <param name="data">Binary checkpoint.</param>
+	void WriteCheckpointFile(const std::string& fileName, const std::vector<char>& data);
+	/// <summary>
+	/// Reads a binary checkpoint from the given file.
+	/// </summary>
+	/// <param name="fileName">Name of the checkpoint file.</param>
+	/// <returns>Binary checkpoint.</returns>
+	std::vector<char> ReadCheckpointFile(const std::string& fileName);
+	/// <summary>
+	/// Truncates the given file to the given size. Used by loggers to discard everything they wrote after a checkpoint when the checkpoint is restored.
+	/// </summary>
+	/// <param name="fileName">Name of the file.</param>
+	/// <param name="size">New size of the file, in bytes.</param>
+	void TruncateFile(const std::string& fileName, std::uint64_t size);
+}
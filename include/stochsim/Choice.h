@@ -42,20 +42,12 @@ namespace stochsim
 					propertyExpressions_[i].SetExpression(std::move(propertyExpressions[i]));
 				}
 			}
-			inline void Initialize(ISimInfo& simInfo)
+			inline void Compile(IModelCompiler& compiler)
 			{
 				for (auto& propertyExpression : propertyExpressions_)
 				{
 					if (propertyExpression)
-						propertyExpression.Initialize(simInfo);
-				}
-			}
-			inline void Uninitialize(ISimInfo& simInfo)
-			{
-				for (auto& propertyExpression : propertyExpressions_)
-				{
-					if (propertyExpression)
-						propertyExpression.Uninitialize(simInfo);
+						propertyExpression.Compile(compiler);
 				}
 			}
 			inline Molecule operator() (ISimInfo& simInfo, const std::vector<Variable>& variables = {}) const
@@ -144,7 +136,7 @@ namespace stochsim
 				}
 			}
 		}
-		virtual const Molecule& Peak(ISimInfo& simInfo) const override
+		virtual Molecule Peak(ISimInfo& simInfo) const override
 		{
 			throw std::exception("Choices must only be used as products of a reaction, not as reactants (i.e. Peak must not be called).");
 		}
@@ -156,31 +148,26 @@ namespace stochsim
 		{
 			throw std::exception("Choices must only be used as products of a reaction, not as transformees (i.e. Transform must not be called).");
 		}
-		virtual void Initialize(ISimInfo& simInfo) override
+		virtual void Compile(IModelCompiler& compiler) override
 		{
 			for (auto& product : elementsIfTrue_)
 			{
-				product.Initialize(simInfo);
+				product.Compile(compiler);
 			}
 			for (auto& product : elementsIfFalse_)
 			{
-				product.Initialize(simInfo);
+				product.Compile(compiler);
 			}
 			if (choiceEquation_)
-				choiceEquation_.Initialize(simInfo);
+				choiceEquation_.Compile(compiler);
+		}
+		virtual void Initialize(ISimInfo& simInfo) override
+		{
+			// do nothing. Choices do not have a state on their own.
 		}
 		virtual void Uninitialize(ISimInfo& simInfo) override
 		{
-			if (choiceEquation_)
-				choiceEquation_.Uninitialize(simInfo);
-			for (auto& product : elementsIfTrue_)
-			{
-				product.Uninitialize(simInfo);
-			}
-			for (auto& product : elementsIfFalse_)
-			{
-				product.Uninitialize(simInfo);
-			}
+			// do nothing.
 		}
 		virtual std::string GetName() const noexcept override
 		{
@@ -0,0 +1,115 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include "stochsim_common.h"
+namespace stochsim
+{
+	// Forward declarations.
+	class DependencyGraph;
+	class MassActionKernel;
+	class StopCondition;
+
+	/// <summary>
+	/// Immutable representation of a model, i.e. of the states and reactions of a simulation, created by Simulation::Compile().
+	/// When compiled, all states and reactions move the data which changes during a simulation run (e.g. molecular numbers) into instance data, and all expressions are bound to the states of the model.
+	/// The compiled model itself is then never modified while simulating, such that it can be shared by any number of simulation instances (see SimulationInstance), including instances running concurrently
+	/// on different threads. Each instance only holds its own copy of the instance data, its random number generator and its loggers.
+	/// The states and reactions of a compiled model must not be modified, and must not be compiled again (e.g. by running the simulation they were created with), while any instance of the compiled model is running.
+	/// </summary>
+	class CompiledModel
+	{
+	public:
+		/// <summary>
+		/// Compiles the model consisting of the given states and reactions.
+		/// </summary>
+		/// <param name="states">States of the model.</param>
+		/// <param name="propensityReactions">Propensity reactions of the model.</param>
+		/// <param name="eventReactions">Event reactions of the model.</param>
+		/// <param name="stopConditions">Conditions ending a simulation of the model early (see StopCondition).</param>
+		/// <param name="vectorized">True if the propensities of mass action reactions should be computed with SIMD instructions, if supported by the CPU (see Simulation::SetVectorized()).</param>
+		CompiledModel(std::vector<std::shared_ptr<IState>> states, std::vector<std::shared_ptr<IPropensityReaction>> propensityReactions, std::vector<std::shared_ptr<IEventReaction>> eventReactions, std::vector<std::shared_ptr<StopCondition>> stopConditions = {}, bool vectorized = true);
+		virtual ~CompiledModel();
+		/// <summary>
+		/// Returns all states of the model.
+		/// </summary>
+		/// <returns>States of the model.</returns>
+		inline const std::vector<std::shared_ptr<IState>>& GetStates() const noexcept
+		{
+			return states_;
+		}
+		/// <summary>
+		/// Returns all propensity reactions of the model.
+		/// </summary>
+		/// <returns>Propensity reactions of the model.</returns>
+		inline const std::vector<std::shared_ptr<IPropensityReaction>>& GetPropensityReactions() const noexcept
+		{
+			return propensityReactions_;
+		}
+		/// <summary>
+		/// Returns all event reactions of the model.
+		/// </summary>
+		/// <returns>Event reactions of the model.</returns>
+		inline const std::vector<std::shared_ptr<IEventReaction>>& GetEventReactions() const noexcept
+		{
+			return eventReactions_;
+		}
+		/// <summary>
+		/// Returns all stop conditions of the model.
+		/// </summary>
+		/// <returns>Stop conditions of the model.</returns>
+		inline const std::vector<std::shared_ptr<StopCondition>>& GetStopConditions() const noexcept
+		{
+			return stopConditions_;
+		}
+		/// <summary>
+		/// Creates a new copy of the initial instance data requested by the states and reactions of the model, indexed by slot.
+		/// </summary>
+		/// <returns>Instance data for a new simulation instance.</returns>
+		std::vector<std::unique_ptr<IInstanceData>> CreateInstanceData() const;
+		/// <summary>
+		/// Returns the dependency graph of the reactions of the model.
+		/// </summary>
+		/// <returns>Dependency graph.</returns>
+		inline const DependencyGraph& GetDependencyGraph() const noexcept
+		{
+			return *dependencyGraph_;
+		}
+		/// <summary>
+		/// Returns the kernel computing the propensities of the propensity reactions of the model.
+		/// </summary>
+		/// <returns>Mass action kernel.</returns>
+		inline const MassActionKernel& GetMassActionKernel() const noexcept
+		{
+			return *massActionKernel_;
+		}
+		/// <summary>
+		/// Returns the number of slots in the flat array of molecular numbers requested by the states of the model (see IModelCompiler::AddMolecularNumber()).
+		/// </summary>
+		/// <returns>Number of molecular number slots.</returns>
+		inline size_t NumMolecularNumbers() const noexcept
+		{
+			return numMolecularNumbers_;
+		}
+		/// <summary>
+		/// Checks that all implementations of the kernel computing the propensities of mass action reactions which are supported by the CPU (scalar, AVX2 and AVX-512) compute propensities
+		/// which are bit-for-bit identical to PropensityReaction::ComputeRate(), for stochiometries between one and three and for molecular numbers both above and below the stochiometries.
+		/// Throws an exception describing the first difference.
+		/// </summary>
+		/// <returns>Names of the tested instruction sets.</returns>
+		static std::vector<std::string> TestMassActionKernel();
+	private:
+		// Make this object be non-copyable
+		CompiledModel(const CompiledModel&) = delete;
+		CompiledModel& operator=(const CompiledModel&) = delete;
+
+		const std::vector<std::shared_ptr<IState>> states_;
+		const std::vector<std::shared_ptr<IPropensityReaction>> propensityReactions_;
+		const std::vector<std::shared_ptr<IEventReaction>> eventReactions_;
+		const std::vector<std::shared_ptr<StopCondition>> stopConditions_;
+		std::vector<std::unique_ptr<IInstanceData>> initialData_;
+		size_t numMolecularNumbers_;
+		std::unique_ptr<DependencyGraph> dependencyGraph_;
+		std::unique_ptr<MassActionKernel> massActionKernel_;
+	};
+}
@@ -1,35 +1,36 @@
 #pragma once
 #include <vector>
+#include <deque>
 #include <list>
 #include <string>
 #include <memory>
 #include <functional>
 #include <cassert>
+#include <sstream>
+#include <cmath>
 #include "stochsim_common.h"
-#include "CircularBuffer.h"
+#include "Checkpoint.h"
+#include "ExpressionHolder.h"
+#include "expression_common.h"
 namespace stochsim
 {	
 	/// <summary>
 	/// A state representing the concentration of a species, where, however, each molecule has its own identiy/properties. That is, the molecules can be distinguished, which means that this
 	/// class represents something like a meta-state.
+	/// The molecules are stored densely as a structure of arrays, with one array for each property, such that a uniformly random molecule can be drawn and removed in constant time by moving the last molecule into its place,
+	/// and such that scanning a single property of all molecules (see GetPropertyValues()) is cache friendly. Only the properties actually used by the model are stored (see SetNumProperties()). Additionally, the molecules
+	/// are linked in the order of their creation, such that the oldest molecule, e.g. the next one to fire for a DelayReaction, can be accessed in constant time, too.
+	/// Reactions whose propensity depends on the properties of the individual molecules can register weights (see AddWeight()). For every weight, the state keeps a sum tree of the weights of all molecules,
+	/// such that the total weight can be read in constant time, and a molecule can be drawn with a probability proportional to its weight in O(log N).
 	/// </summary>
 	class ComposedState:
 		public IState
 	{
 	private:
-		struct MoleculeHolder
-		{
-			Molecule molecule;
-			/// <summary>
-			/// The simulation time when the molecule was created.
-			/// </summary>
-			double creationTime;
-			/// <summary>
-			/// True if the molecule is already deleted. Keeping this variable is necessary due to implementation details.
-			/// Molecules which are returned must always have invalidated=false.
-			/// </summary>
-			bool invalidated;
-		};
+		/// <summary>
+		/// Index indicating that a molecule has no older or newer neighbor.
+		/// </summary>
+		static constexpr size_t none = static_cast<size_t>(-1);
 	public:
 		/// <summary>
 		/// Constructor.
@@ -37,33 +38,38 @@ namespace stochsim
 		/// <param name="name">Name of the state.</param>
 		/// <param name="initialCondition">Initial number of molecules which are there when the simulation starts.</param>
 		/// <param name="initialCapacity">Initial maximum amount of molecules which are expected to be hold by this state. If the number of molecules increases over the maximum, the maximum is doubled which requires reallocation of space.</param>
-		/// <param name="initializer">Function which initilize the properties of a molecule whenever a new molecule of the species represented by this state is produced.</param>
-		/// <param name="modifier">Function which modifies the properties of a molecule whenever a molecule of the species represented by this state is modified, i.e.
-		/// when State::Modify is called on this state and a given molecule represented by this state was chosen to be modified.</param>
-		ComposedState(std::string name, size_t initialCondition, size_t initialCapacity = 1000) : name_(name), size_(0), initialCondition_(initialCondition), buffer_(initialCapacity>initialCondition ? initialCapacity : initialCondition)
+		/// <param name="numProperties">Number of properties stored for each molecule (see SetNumProperties()).</param>
+		ComposedState(std::string name, size_t initialCondition, size_t initialCapacity = 1000, size_t numProperties = Molecule::size_) : dataSlot_(0), numSlot_(0), name_(name), initialCondition_(initialCondition), initialCapacity_(initialCapacity), numProperties_(0)
 		{
+			SetNumProperties(numProperties);
 		}
 
+		virtual void Compile(IModelCompiler& compiler) override
+		{
+			// Weights are registered again by the reactions when they are compiled.
+			weights_.clear();
+			dataSlot_ = compiler.AddInstanceData(std::make_unique<InstanceData>(initialCapacity_ > initialCondition_ ? initialCapacity_ : initialCondition_, numProperties_));
+			numSlot_ = compiler.AddMolecularNumber(*this);
+		}
 		virtual void Initialize(ISimInfo& simInfo) override
 		{
-			buffer_.Clear();
-			size_ = GetInitialCondition();
-			for (size_t i = 0; i < size_; i++)
+			InstanceData& data = this->data(simInfo);
+			data.Clear();
+			num(simInfo) = GetInitialCondition();
+			for (size_t i = 0; i < GetInitialCondition(); i++)
 			{
-				MoleculeHolder& holder = buffer_.PushTail();
-				holder.molecule.Reset();
-				holder.creationTime = simInfo.GetSimTime();
-				holder.invalidated = false;
+				data.PushNewest(defaultMolecule, simInfo.GetSimTime());
 			}
 		}
 		virtual void Uninitialize(ISimInfo& simInfo) override
 		{
-			buffer_.Clear();
-			size_ = 0;
+			InstanceData& data = this->data(simInfo);
+			data.Clear();
+			num(simInfo) = 0;
 		}
 		virtual inline size_t Num(ISimInfo& simInfo) const override
 		{
-			return size_;
+			return num(simInfo);
 		}
 		virtual inline void AddDecreaseListener(StateListener stateListener) override
 		{
@@ -84,73 +90,141 @@ namespace stochsim
 				}
 			}
 
-			MoleculeHolder& holder = buffer_.PushTail();
-			holder.molecule = molecule;
-			holder.creationTime = simInfo.GetSimTime();
-			holder.invalidated = false;
-			size_ ++;
+			InstanceData& data = this->data(simInfo);
+			const size_t index = data.PushNewest(molecule, simInfo.GetSimTime());
+			if (data.weightsValid_)
+			{
+				for (size_t w = 0; w < weights_.size(); w++)
+				{
+					data.weightTrees_[w].PushBack(weight(simInfo, w, index));
+				}
+			}
+			num(simInfo)++;
 		}
 
 		virtual Molecule Remove(ISimInfo& simInfo, const Variables& variables = {}) override
 		{
-			size_t idx = randomBufferIndex(simInfo);
-			if (idx == 0)
-			{
-				return RemoveFirst(simInfo, variables);
-			}
-			else
+			return remove(simInfo, randomIndex(simInfo));
+		}
+
+		Molecule RemoveFirst(ISimInfo& simInfo, const Variables& variables = {})
+		{
+			return remove(simInfo, data(simInfo).oldest_);
+		}
+		/// <summary>
+		/// Returns the creation time of the first, that is, oldest molecule. Behavior undefined if size is zero.
+		/// </summary>
+		/// <returns>Creation time of oldest element</returns>
+		inline double PeakFirstCreationTime(ISimInfo& simInfo) const
+		{
+			InstanceData& data = this->data(simInfo);
+			return data.creationTimes_[data.oldest_];
+		}
+		virtual Molecule Peak(ISimInfo& simInfo) const override
+		{
+			return data(simInfo).GetMolecule(randomIndex(simInfo));
+		}
+		/// <summary>
+		/// Returns a uniformly random molecule which can be transformed. Since the properties are not stored together, the returned molecule is a copy, which is written back when CommitTransform() is called.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <returns>Molecule which can be transformed.</returns>
+		virtual inline Molecule& Transform(ISimInfo& simInfo, const Variables& variables = {}) override
+		{
+			return transform(simInfo, randomIndex(simInfo));
+		}
+		virtual void CommitTransform(ISimInfo& simInfo) override
+		{
+			InstanceData& data = this->data(simInfo);
+			for (size_t k = 0; k < data.transformedIndices_.size(); k++)
 			{
-				MoleculeHolder& holder = buffer_[idx];
-				if (!removeListeners_.empty())
+				const size_t index = data.transformedIndices_[k];
+				data.SetProperties(index, data.transformedMolecules_[k]);
+				if (data.weightsValid_)
 				{
-					double time = simInfo.GetSimTime();
-					for (auto& removeListener : removeListeners_)
+					for (size_t w = 0; w < weights_.size(); w++)
 					{
-						removeListener(holder.molecule, time);
+						data.weightTrees_[w].Update(index, weight(simInfo, w, index));
 					}
 				}
-				holder.invalidated = true;
-				size_--;
-				return holder.molecule;
 			}
+			data.transformedIndices_.clear();
+			data.transformedMolecules_.clear();
 		}
 
-		Molecule RemoveFirst(ISimInfo& simInfo, const Variables& variables = {})
+		/// <summary>
+		/// Registers a weight, i.e. an expression assigning every molecule a non-negative weight based on its properties. Typically called by a reaction whose propensity is proportional to the sum of the
+		/// weights of all molecules, instead of to their number, when the reaction is compiled. Must be called after the state was compiled. Registering the same weight twice returns the same index.
+		/// The weight can only reference the properties of the molecule via the given property names, but neither states nor the simulation time or random numbers.
+		/// </summary>
+		/// <param name="compiler">Model compiler.</param>
+		/// <param name="weight">Expression determining the weight of a molecule.</param>
+		/// <param name="propertyNames">Names under which the properties of a molecule are referenced by the expression.</param>
+		/// <returns>Index of the weight, to be passed to WeightSum(), RemoveWeighted(), PeakWeighted() and TransformWeighted().</returns>
+		size_t AddWeight(IModelCompiler& compiler, std::unique_ptr<expression::IExpression> weight, Molecule::PropertyNames propertyNames)
 		{
-			Molecule molecule = buffer_[0].molecule;
-			if (!removeListeners_.empty())
+			if (!weight)
+				throw std::exception("Weight not set.");
+			const std::string cmdl = weight->ToCmdl();
+			for (size_t w = 0; w < weights_.size(); w++)
 			{
-				double time = simInfo.GetSimTime();
-				for (auto& removeListener : removeListeners_)
-				{
-					removeListener(molecule, time);
-				}
+				if (weights_[w].cmdl == cmdl && weights_[w].propertyNames == propertyNames)
+					return w;
 			}
-			// First element guaranteed to be valid.
-			buffer_.PopTop();
-			size_--;
-			// Remove new first element if it happens to be invalid to guarantee that first element is always valid.
-			while (buffer_.Size() > 0 && buffer_[0].invalidated)
+			Weight newWeight;
+			newWeight.cmdl = cmdl;
+			newWeight.propertyNames = std::move(propertyNames);
+			newWeight.expression.SetExpression(std::move(weight));
+			newWeight.expression.Compile(compiler);
+			if (!newWeight.expression.GetBoundStates().empty() || newWeight.expression.IsTimeDependent() || newWeight.expression.IsRandom())
 			{
-				buffer_.PopTop();
+				std::stringstream errorMessage;
+				errorMessage << "Weight " << cmdl << " of state " << name_ << " must only depend on the properties of the molecules, but not on states, the simulation time or random numbers.";
+				throw std::exception(errorMessage.str().c_str());
 			}
-			return molecule;
+			weights_.push_back(std::move(newWeight));
+			return weights_.size() - 1;
 		}
 		/// <summary>
-		/// Returns the creation time of the first, that is, oldest molecule. Behavior undefined if size is zero.
+		/// Returns the sum of the given weight over all molecules. Runs in O(1), except after the state was (re-)initialized, in which case the weights of all molecules are computed first.
 		/// </summary>
-		/// <returns>Creation time of oldest element</returns>
-		inline double PeakFirstCreationTime(ISimInfo& simInfo) const
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="weightIndex">Index of the weight, as returned by AddWeight().</param>
+		/// <returns>Total weight of all molecules.</returns>
+		double WeightSum(ISimInfo& simInfo, size_t weightIndex) const
 		{
-			return buffer_[0].creationTime;
+			return weightTrees(simInfo)[weightIndex].Total();
 		}
-		virtual const Molecule& Peak(ISimInfo& simInfo) const
+		/// <summary>
+		/// Removes a molecule drawn with a probability proportional to the given weight. Behavior undefined if the total weight is not positive.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="weightIndex">Index of the weight, as returned by AddWeight().</param>
+		/// <returns>Removed molecule.</returns>
+		Molecule RemoveWeighted(ISimInfo& simInfo, size_t weightIndex)
 		{
-			return buffer_[randomBufferIndex(simInfo)].molecule;
+			return remove(simInfo, weightedIndex(simInfo, weightIndex));
 		}
-		virtual inline Molecule& Transform(ISimInfo& simInfo, const Variables& variables = {}) override
+		/// <summary>
+		/// Returns a molecule drawn with a probability proportional to the given weight, without removing it. Behavior undefined if the total weight is not positive.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="weightIndex">Index of the weight, as returned by AddWeight().</param>
+		/// <returns>Drawn molecule.</returns>
+		Molecule PeakWeighted(ISimInfo& simInfo, size_t weightIndex) const
+		{
+			return data(simInfo).GetMolecule(weightedIndex(simInfo, weightIndex));
+		}
+		/// <summary>
+		/// Returns a molecule drawn with a probability proportional to the given weight, which can be transformed. As for Transform(), the molecule is written back when CommitTransform() is called.
+		/// Behavior undefined if the total weight is not positive.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="weightIndex">Index of the weight, as returned by AddWeight().</param>
+		/// <returns>Molecule which can be transformed.</returns>
+		Molecule& TransformWeighted(ISimInfo& simInfo, size_t weightIndex)
 		{
-			return buffer_[randomBufferIndex(simInfo)].molecule;
+			return transform(simInfo, weightedIndex(simInfo, weightIndex));
 		}
 
 		virtual std::string GetName() const noexcept override
@@ -173,39 +247,468 @@ namespace stochsim
 		{
 			initialCondition_ = initialCondition;
 		}
+		/// <summary>
+		/// Returns the number of properties stored for each molecule.
+		/// </summary>
+		/// <returns>Number of stored properties.</returns>
+		size_t GetNumProperties() const noexcept
+		{
+			return numProperties_;
+		}
+		/// <summary>
+		/// Sets the number of properties stored for each molecule, which must not exceed Molecule::size_. Only the first numProperties properties of a molecule are stored, all others are dropped
+		/// when a molecule is added, and are zero when a molecule is read. Must be set before the model is compiled.
+		/// </summary>
+		/// <param name="numProperties">Number of stored properties.</param>
+		void SetNumProperties(size_t numProperties)
+		{
+			if (numProperties > Molecule::size_)
+			{
+				std::stringstream errorMessage;
+				errorMessage << "State " << name_ << " cannot store " << numProperties << " properties per molecule, since molecules have at most " << Molecule::size_ << " properties (see STOCHSIM_MAX_PROPERTIES).";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			numProperties_ = numProperties;
+		}
+		/// <summary>
+		/// Returns the values of the given property of all molecules, in no particular order. The returned array is only valid until the state is changed the next time.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="property">Index of the property, which must be smaller than GetNumProperties().</param>
+		/// <returns>Values of the property of all molecules.</returns>
+		const std::vector<double>& GetPropertyValues(ISimInfo& simInfo, size_t property) const
+		{
+			if (property >= numProperties_)
+			{
+				std::stringstream errorMessage;
+				errorMessage << "State " << name_ << " only stores " << numProperties_ << " properties per molecule, and property " << property << " is thus not available.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			return data(simInfo).properties_[property];
+		}
 	private:
 		/// <summary>
-		/// Returns a (uniform) random index in the buffer. Since the buffer might contain already invalidated elements,
-		/// the random index might be drawn from a broader range.
+		/// Complete binary tree whose leaves are the weights of the molecules, and whose inner nodes store the sum of their two children. Appending, removing the last leaf, changing a single weight, and
+		/// finding the molecule corresponding to a given fraction of the total weight all run in O(log N). Since every inner node is recomputed from its children, no rounding errors accumulate over time.
 		/// </summary>
-		/// <returns>A uniform random index to a valid buffer element.</returns>
-		inline size_t randomBufferIndex(ISimInfo& simInfo) const
+		class SumTree
 		{
-			size_t idx;
-			// try three times to draw a valid random number. If this fails, clean up the buffer.
-			for (int trial = 0; trial < 3; trial++)
+		public:
+			SumTree() : numLeaves_(0), firstLeaf_(1), nodes_(2, 0)
+			{
+			}
+			inline size_t Size() const noexcept
+			{
+				return numLeaves_;
+			}
+			inline double Total() const noexcept
+			{
+				return nodes_[1];
+			}
+			inline double Get(size_t index) const
+			{
+				return nodes_[firstLeaf_ + index];
+			}
+			void Update(size_t index, double weight)
+			{
+				size_t node = firstLeaf_ + index;
+				nodes_[node] = weight;
+				for (node /= 2; node > 0; node /= 2)
+				{
+					nodes_[node] = nodes_[2 * node] + nodes_[2 * node + 1];
+				}
+			}
+			/// <summary>
+			/// Appends a leaf. If the tree is full, its capacity is doubled, which takes O(N).
+			/// </summary>
+			void PushBack(double weight)
+			{
+				if (numLeaves_ == firstLeaf_)
+				{
+					// The old tree becomes the left subtree of the new root. Since the leaves of a subtree keep their relative positions, all sums stay the same.
+					std::vector<double> nodes(4 * firstLeaf_, 0);
+					for (size_t levelStart = 1; levelStart <= firstLeaf_; levelStart *= 2)
+					{
+						std::copy(nodes_.begin() + levelStart, nodes_.begin() + 2 * levelStart, nodes.begin() + 2 * levelStart);
+					}
+					nodes[1] = nodes[2];
+					nodes_.swap(nodes);
+					firstLeaf_ *= 2;
+				}
+				numLeaves_++;
+				Update(numLeaves_ - 1, weight);
+			}
+			void PopBack()
+			{
+				Update(numLeaves_ - 1, 0);
+				numLeaves_--;
+			}
+			/// <summary>
+			/// Returns the index i for which w_0 + ... + w_(i-1) &lt;= target &lt; w_0 + ... + w_i. Molecules with zero weight are never returned, also not when rounding errors occur.
+			/// Behavior undefined if Total() is not positive.
+			/// </summary>
+			size_t Find(double target) const
 			{
-				idx = simInfo.Rand(0, buffer_.Size() - 1);
-				if (!buffer_[idx].invalidated)
-					return idx;
+				size_t node = 1;
+				while (node < firstLeaf_)
+				{
+					const double left = nodes_[2 * node];
+					const double right = nodes_[2 * node + 1];
+					if ((target < left || right <= 0) && left > 0)
+					{
+						node = 2 * node;
+					}
+					else
+					{
+						target -= left;
+						node = 2 * node + 1;
+					}
+				}
+				return node - firstLeaf_;
 			}
-			// Remove all invalidated molecules.
-			// first, sort buffer by creation time, however, with all invalidated molecules coming first.
-			buffer_.Sort([](const MoleculeHolder& a, const MoleculeHolder& b) -> bool
+		private:
+			size_t numLeaves_;
+			// Index of the first leaf. The root is stored at index 1, and the children of node n at 2n and 2n+1.
+			size_t firstLeaf_;
+			std::vector<double> nodes_;
+		};
+		/// <summary>
+		/// Weight registered by a reaction (see AddWeight()).
+		/// </summary>
+		struct Weight
+		{
+			ExpressionHolder expression;
+			Molecule::PropertyNames propertyNames;
+			// Textual representation of the expression, to identify weights registered twice.
+			std::string cmdl;
+		};
+		/// <summary>
+		/// Data of the state changing during a simulation run.
+		/// </summary>
+		struct InstanceData : public IInstanceData
+		{
+			InstanceData(size_t initialCapacity, size_t numProperties) : properties_(numProperties), oldest_(none), newest_(none), weightsValid_(false)
 			{
-				return !b.invalidated && (a.invalidated || a.creationTime < b.creationTime);
-			});
-			// remove all invalidated elements, which are now at the front.
-			buffer_.PopTop(buffer_.Size() - size_);
-			// return just a uniformly sampled index. Since all elements are now valid, this index is valid, too.
-			return simInfo.Rand(0, buffer_.Size() - 1);
+				for (auto& values : properties_)
+				{
+					values.reserve(initialCapacity);
+				}
+				creationTimes_.reserve(initialCapacity);
+				older_.reserve(initialCapacity);
+				newer_.reserve(initialCapacity);
+			}
+			virtual std::unique_ptr<IInstanceData> Clone() const override
+			{
+				return std::make_unique<InstanceData>(*this);
+			}
+			virtual void Save(CheckpointWriter& checkpoint) const override
+			{
+				// The molecules are saved in the order of the arrays, such that the same molecules are drawn randomly after the checkpoint is restored.
+				const size_t size = Size();
+				checkpoint.Write<std::uint64_t>(properties_.size());
+				checkpoint.Write<std::uint64_t>(size);
+				checkpoint.Write<std::uint64_t>(oldest_);
+				checkpoint.Write<std::uint64_t>(newest_);
+				for (const auto& values : properties_)
+				{
+					checkpoint.WriteArray(values.data(), size);
+				}
+				checkpoint.WriteArray(creationTimes_.data(), size);
+				for (size_t index = 0; index < size; index++)
+				{
+					checkpoint.Write<std::uint64_t>(older_[index]);
+					checkpoint.Write<std::uint64_t>(newer_[index]);
+				}
+			}
+			virtual void Load(CheckpointReader& checkpoint) override
+			{
+				// The weights are not stored, but recomputed when they are needed next.
+				InvalidateWeights();
+				transformedIndices_.clear();
+				transformedMolecules_.clear();
+				if (checkpoint.Read<std::uint64_t>() != properties_.size())
+					throw std::exception("Checkpoint stores a different number of properties per molecule than the state.");
+				const size_t size = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				oldest_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				newest_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				for (auto& values : properties_)
+				{
+					values.resize(size);
+					checkpoint.ReadArray(values.data(), size);
+				}
+				creationTimes_.resize(size);
+				checkpoint.ReadArray(creationTimes_.data(), size);
+				older_.resize(size);
+				newer_.resize(size);
+				for (size_t index = 0; index < size; index++)
+				{
+					older_[index] = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+					newer_[index] = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				}
+			}
+			void Clear() noexcept
+			{
+				for (auto& values : properties_)
+				{
+					values.clear();
+				}
+				creationTimes_.clear();
+				older_.clear();
+				newer_.clear();
+				oldest_ = none;
+				newest_ = none;
+				transformedIndices_.clear();
+				transformedMolecules_.clear();
+				InvalidateWeights();
+			}
+			void InvalidateWeights() noexcept
+			{
+				weightsValid_ = false;
+				weightTrees_.clear();
+			}
+			inline size_t Size() const noexcept
+			{
+				return creationTimes_.size();
+			}
+			/// <summary>
+			/// Returns the molecule with the given index, with all properties which are not stored set to zero.
+			/// </summary>
+			Molecule GetMolecule(size_t index) const
+			{
+				Molecule molecule;
+				for (size_t p = 0; p < properties_.size(); p++)
+				{
+					molecule[p] = properties_[p][index];
+				}
+				return molecule;
+			}
+			/// <summary>
+			/// Sets the stored properties of the molecule with the given index.
+			/// </summary>
+			void SetProperties(size_t index, const Molecule& molecule)
+			{
+				for (size_t p = 0; p < properties_.size(); p++)
+				{
+					properties_[p][index] = molecule[p];
+				}
+			}
+			/// <summary>
+			/// Appends a new molecule to the arrays and links it as the newest molecule. Amortized constant time.
+			/// </summary>
+			/// <param name="molecule">Molecule whose properties are stored.</param>
+			/// <param name="creationTime">The simulation time when the molecule was created.</param>
+			/// <returns>Index of the new molecule.</returns>
+			size_t PushNewest(const Molecule& molecule, double creationTime)
+			{
+				// Molecules must not be added or removed while transformed molecules are pending (see CommitTransform()).
+				assert(transformedIndices_.empty());
+				const size_t index = Size();
+				for (size_t p = 0; p < properties_.size(); p++)
+				{
+					properties_[p].push_back(molecule[p]);
+				}
+				creationTimes_.push_back(creationTime);
+				older_.push_back(newest_);
+				newer_.push_back(none);
+				if (newest_ != none)
+					newer_[newest_] = index;
+				else
+					oldest_ = index;
+				newest_ = index;
+				return index;
+			}
+			/// <summary>
+			/// Removes the molecule with the given index in constant time, by unlinking it and moving the last molecule of the arrays into its place.
+			/// </summary>
+			/// <param name="index">Index of the molecule.</param>
+			void Erase(size_t index)
+			{
+				assert(transformedIndices_.empty());
+				unlink(index);
+				const size_t last = Size() - 1;
+				if (index != last)
+				{
+					for (auto& values : properties_)
+					{
+						values[index] = values[last];
+					}
+					creationTimes_[index] = creationTimes_[last];
+					older_[index] = older_[last];
+					newer_[index] = newer_[last];
+					relink(index);
+				}
+				for (auto& values : properties_)
+				{
+					values.pop_back();
+				}
+				creationTimes_.pop_back();
+				older_.pop_back();
+				newer_.pop_back();
+				if (weightsValid_)
+				{
+					for (SumTree& tree : weightTrees_)
+					{
+						tree.Update(index, tree.Get(last));
+						tree.PopBack();
+					}
+				}
+			}
+			// One array for every stored property, holding the values of all molecules in no particular order.
+			std::vector<std::vector<double>> properties_;
+			// The simulation times when the molecules were created.
+			std::vector<double> creationTimes_;
+			// Indices of the next older and the next newer molecule, or none if this is the oldest, respectively newest, molecule.
+			std::vector<size_t> older_;
+			std::vector<size_t> newer_;
+			// Indices of the oldest and the newest molecule, or none if there are no molecules.
+			size_t oldest_;
+			size_t newest_;
+			// One sum tree for every weight, with the leaves in the order of the molecules. Only maintained after the weights were first needed.
+			bool weightsValid_;
+			std::vector<SumTree> weightTrees_;
+			// Molecules returned for transformation since the last commit, and their indices. A deque is used such that the returned references stay valid when further molecules are returned.
+			std::vector<size_t> transformedIndices_;
+			std::deque<Molecule> transformedMolecules_;
+		private:
+			void unlink(size_t index) noexcept
+			{
+				const size_t older = older_[index];
+				const size_t newer = newer_[index];
+				if (older != none)
+					newer_[older] = newer;
+				else
+					oldest_ = newer;
+				if (newer != none)
+					older_[newer] = older;
+				else
+					newest_ = older;
+			}
+			// Updates the links pointing to a molecule which was moved to the given index.
+			void relink(size_t index) noexcept
+			{
+				const size_t older = older_[index];
+				const size_t newer = newer_[index];
+				if (older != none)
+					newer_[older] = index;
+				else
+					oldest_ = index;
+				if (newer != none)
+					older_[newer] = index;
+				else
+					newest_ = index;
+			}
+		};
+		inline InstanceData& data(ISimInfo& simInfo) const
+		{
+			return static_cast<InstanceData&>(simInfo.GetInstanceData(dataSlot_));
+		}
+		inline size_t& num(ISimInfo& simInfo) const
+		{
+			return simInfo.GetMolecularNumbers()[numSlot_];
+		}
+
+		/// <summary>
+		/// Returns a uniformly random index of a molecule. Behavior undefined if there are no molecules.
+		/// </summary>
+		/// <returns>A uniform random index to a molecule.</returns>
+		inline size_t randomIndex(ISimInfo& simInfo) const
+		{
+			return simInfo.Rand(0, data(simInfo).Size() - 1);
+		}
+		/// <summary>
+		/// Returns the index of a molecule drawn with a probability proportional to the given weight. Behavior undefined if the total weight is not positive.
+		/// </summary>
+		inline size_t weightedIndex(ISimInfo& simInfo, size_t weightIndex) const
+		{
+			const SumTree& tree = weightTrees(simInfo)[weightIndex];
+			return tree.Find(simInfo.Rand() * tree.Total());
+		}
+		/// <summary>
+		/// Evaluates the given weight for the molecule with the given index.
+		/// </summary>
+		double weight(ISimInfo& simInfo, size_t weightIndex, size_t index) const
+		{
+			const Weight& definition = weights_[weightIndex];
+			const InstanceData& data = this->data(simInfo);
+			Variables variables;
+			for (size_t p = 0; p < Molecule::size_; p++)
+			{
+				if (!definition.propertyNames[p].empty())
+					variables.push_back(Variable(definition.propertyNames[p], p < numProperties_ ? data.properties_[p][index] : 0.0));
+			}
+			const double value = definition.expression(simInfo, variables);
+			if (!(value >= 0) || std::isinf(value))
+			{
+				std::stringstream errorMessage;
+				errorMessage << "Weight " << definition.cmdl << " of state " << name_ << " evaluated to " << value << ", but weights must be non-negative and finite.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			return value;
+		}
+		/// <summary>
+		/// Returns the sum trees of all weights. Builds the trees in O(N) if they are not maintained yet.
+		/// </summary>
+		std::vector<SumTree>& weightTrees(ISimInfo& simInfo) const
+		{
+			InstanceData& data = this->data(simInfo);
+			if (!data.weightsValid_)
+			{
+				data.weightTrees_.assign(weights_.size(), SumTree());
+				for (size_t w = 0; w < weights_.size(); w++)
+				{
+					for (size_t index = 0; index < data.Size(); index++)
+					{
+						data.weightTrees_[w].PushBack(weight(simInfo, w, index));
+					}
+				}
+				data.weightsValid_ = true;
+			}
+			return data.weightTrees_;
+		}
+		/// <summary>
+		/// Returns a copy of the molecule with the given index for transformation, which is written back by CommitTransform(). If the molecule was already returned since the last commit, the same copy is returned,
+		/// such that all transformations apply.
+		/// </summary>
+		Molecule& transform(ISimInfo& simInfo, size_t index)
+		{
+			InstanceData& data = this->data(simInfo);
+			for (size_t k = 0; k < data.transformedIndices_.size(); k++)
+			{
+				if (data.transformedIndices_[k] == index)
+					return data.transformedMolecules_[k];
+			}
+			data.transformedIndices_.push_back(index);
+			data.transformedMolecules_.push_back(data.GetMolecule(index));
+			return data.transformedMolecules_.back();
+		}
+		/// <summary>
+		/// Removes the molecule with the given index, and notifies the remove listeners.
+		/// </summary>
+		Molecule remove(ISimInfo& simInfo, size_t index)
+		{
+			InstanceData& data = this->data(simInfo);
+			Molecule molecule = data.GetMolecule(index);
+			if (!removeListeners_.empty())
+			{
+				double time = simInfo.GetSimTime();
+				for (auto& removeListener : removeListeners_)
+				{
+					removeListener(molecule, time);
+				}
+			}
+			data.Erase(index);
+			num(simInfo)--;
+			return molecule;
 		}
 
-		mutable CircularBuffer<MoleculeHolder> buffer_;
+		size_t dataSlot_;
+		size_t numSlot_;
 		std::list<StateListener> removeListeners_;
 		std::list<StateListener> addListeners_;
+		std::vector<Weight> weights_;
 		const std::string name_;
 		size_t initialCondition_;
-		size_t size_;
+		size_t initialCapacity_;
+		size_t numProperties_;
 	};
 }
@@ -44,20 +44,12 @@ namespace stochsim
 					propertyExpressions_[i].SetExpression(std::move(propertyExpressions[i]));
 				}
 			}
-			inline void Initialize(ISimInfo& simInfo)
-			{
-				for (auto& propertyExpression : propertyExpressions_)
-				{
-					if (propertyExpression)
-						propertyExpression.Initialize(simInfo);
-				}
-			}
-			inline void Uninitialize(ISimInfo& simInfo)
+			inline void Compile(IModelCompiler& compiler)
 			{
 				for (auto& propertyExpression : propertyExpressions_)
 				{
 					if (propertyExpression)
-						propertyExpression.Uninitialize(simInfo);
+						propertyExpression.Compile(compiler);
 				}
 			}
 			inline Molecule operator() (ISimInfo& simInfo, const std::vector<Variable>& variables = {}) const
@@ -104,19 +96,20 @@ namespace stochsim
 		{
 			return name_;
 		}
-		virtual void Initialize(ISimInfo& simInfo) override
+		virtual void Compile(IModelCompiler& compiler) override
 		{
 			for (auto& product : products_)
 			{
-				product.Initialize(simInfo);
+				product.Compile(compiler);
 			}
 		}
+		virtual void Initialize(ISimInfo& simInfo) override
+		{
+			reactant_.Initialize(simInfo);
+		}
 		virtual void Uninitialize(ISimInfo& simInfo) override
 		{
-			for (auto& product : products_)
-			{
-				product.Uninitialize(simInfo);
-			}
+			reactant_.Uninitialize(simInfo);
 		}
 
 		/// <summary>
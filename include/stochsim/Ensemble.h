@@ -0,0 +1,120 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <functional>
+#include "stochsim_common.h"
+#include "Simulation.h"
+#include "SimulationInstance.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Runs many independent replicates of the same model in parallel on a pool of threads.
+	/// All replicates share the same compiled model (see Simulation::Compile()), and every replicate is simulated by its own SimulationInstance holding only the molecular numbers and other data changing during the run.
+	/// Every replicate gets its own random number stream, whose seed only depends on the seed of the ensemble and the index of the replicate, such that the results are reproducible and do not depend on the number of threads.
+	/// The molecular numbers of all states are recorded for every replicate at every log period (see SimulationInstance::SetLogPeriod).
+	/// </summary>
+	class Ensemble
+	{
+	public:
+		/// <summary>
+		/// Function setting up the simulation instance of the replicate with the given index, e.g. its algorithm, log period and loggers.
+		/// Called concurrently from different threads, and must thus not modify any shared data. Loggers writing to the disk should use a different base folder for every replicate.
+		/// </summary>
+		typedef std::function<void(SimulationInstance& instance, size_t replicate)> InstanceSetup;
+		/// <summary>
+		/// Molecular numbers of all states of one replicate, sampled at the log times of the replicate.
+		/// </summary>
+		struct Result
+		{
+			/// <summary>
+			/// Simulation times when the molecular numbers were recorded.
+			/// </summary>
+			std::vector<double> times_;
+			/// <summary>
+			/// Molecular numbers of all states (in the order of GetStateNames()) for every simulation time in times_.
+			/// </summary>
+			std::vector<std::vector<size_t>> numbers_;
+			/// <summary>
+			/// Reason why the replicate ended early (see SimulationInstance::GetStopReason()), or an empty string if the replicate ran until the end. The last entry of times_ is the time when the replicate stopped.
+			/// </summary>
+			std::string stopReason_;
+		};
+
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="model">Compiled model simulated by all replicates.</param>
+		/// <param name="instanceSetup">Function setting up the simulation instance of every replicate, or nullptr if the default settings should be used.</param>
+		explicit Ensemble(std::shared_ptr<const CompiledModel> model, InstanceSetup instanceSetup = nullptr);
+		virtual ~Ensemble();
+		/// <summary>
+		/// Runs the given number of replicates for maxTime time units each. Blocks until all replicates finished. Results of previous runs are discarded.
+		/// If any replicate throws an exception, the remaining replicates are not started anymore, and the exception is rethrown after all running replicates finished.
+		/// </summary>
+		/// <param name="numReplicates">Number of replicates to run.</param>
+		/// <param name="maxTime">Simulation time when every replicate should stop.</param>
+		virtual void Run(size_t numReplicates, double maxTime);
+		/// <summary>
+		/// Branches the given number of replicates off the state stored in a checkpoint (see SimulationInstance::CreateCheckpoint() and Simulation::CreateCheckpoint()), and runs them until maxTime in parallel.
+		/// Every replicate starts from the same molecular numbers and molecules of composed states, but with its own random number stream (see GetReplicateSeed()), such that the replicates continue independently.
+		/// This avoids re-simulating the common history of all replicates, e.g. until a rare state is reached. The results of every replicate start at the simulation time of the checkpoint.
+		/// Blocks until all replicates finished. Results of previous runs are discarded. Exceptions are handled as in Run().
+		/// </summary>
+		/// <param name="checkpoint">Binary checkpoint saved by a simulation of the model of the ensemble.</param>
+		/// <param name="numReplicates">Number of replicates to branch off.</param>
+		/// <param name="maxTime">Simulation time when every replicate should stop.</param>
+		virtual void Fork(const std::vector<char>& checkpoint, size_t numReplicates, double maxTime);
+		/// <summary>
+		/// Sets the number of threads running replicates in parallel. Set to zero to use one thread per hardware thread. Default = 0.
+		/// </summary>
+		/// <param name="numThreads">Number of threads.</param>
+		virtual void SetNumThreads(size_t numThreads);
+		/// <summary>
+		/// Returns the number of threads running replicates in parallel. Zero indicates one thread per hardware thread. Default = 0.
+		/// </summary>
+		/// <returns>Number of threads.</returns>
+		virtual size_t GetNumThreads() const;
+		/// <summary>
+		/// Sets the seed of the ensemble, from which the seeds of all replicates are derived. Running the ensemble twice with the same seed produces identical results. By default, the seed is chosen randomly
+		/// when the ensemble is constructed.
+		/// </summary>
+		/// <param name="seed">Seed of the ensemble.</param>
+		virtual void SetSeed(unsigned long long seed);
+		/// <summary>
+		/// Returns the seed of the ensemble, from which the seeds of all replicates are derived.
+		/// </summary>
+		/// <returns>Seed of the ensemble.</returns>
+		virtual unsigned long long GetSeed() const;
+		/// <summary>
+		/// Returns the seed of the random number generator of the replicate with the given index. Setting this seed for a single simulation of the model (see Simulation::SetSeed) reproduces the replicate.
+		/// </summary>
+		/// <param name="replicate">Index of replicate.</param>
+		/// <returns>Seed of replicate.</returns>
+		virtual unsigned long long GetReplicateSeed(size_t replicate) const;
+		/// <summary>
+		/// Returns the number of replicates of the last run.
+		/// </summary>
+		/// <returns>Number of replicates.</returns>
+		virtual size_t NumReplicates() const;
+		/// <summary>
+		/// Returns the names of all states of the model, in the order in which their molecular numbers are stored in the results.
+		/// </summary>
+		/// <returns>Names of states.</returns>
+		virtual const std::vector<std::string>& GetStateNames() const;
+		/// <summary>
+		/// Returns the molecular numbers of all states of the given replicate recorded during the last run.
+		/// </summary>
+		/// <param name="replicate">Index of replicate, between 0 and NumReplicates()-1.</param>
+		/// <returns>Results of replicate.</returns>
+		virtual const Result& GetResult(size_t replicate) const;
+
+	private:
+		// Make this object be non-copyable
+		Ensemble(const Ensemble&) = delete;
+		Ensemble& operator=(const Ensemble&) = delete;
+
+		class Impl;
+		Impl* const impl_;
+	};
+}
@@ -6,26 +6,43 @@
 #include "expression_common.h"
 #include <map>
 #include <unordered_map>
+#include <sstream>
 namespace stochsim
 {
 	/// <summary>
-	/// Holds a mathematical expression, binds free variables upon initialization, and allows to evaluate the expression.
+	/// Holds a mathematical expression, binds free variables when the model is compiled, and allows to evaluate the expression.
+	/// The bound expression does not refer to a specific simulation instance. Instead, the simulation context and the values of the temporary variables passed to an evaluation are looked up
+	/// in a thread local evaluation context, such that one bound expression can be evaluated concurrently by several simulation instances running on different threads.
 	/// </summary>
 	class ExpressionHolder
 	{
 	private:
-		typedef std::unordered_map<expression::identifier, std::unique_ptr<expression::number>> TemporaryVariables;
+		/// <summary>
+		/// Context of the evaluation currently running on this thread.
+		/// </summary>
+		struct EvaluationContext
+		{
+			ISimInfo* simInfo_ = nullptr;
+			std::vector<expression::number> values_;
+			std::vector<char> defined_;
+		};
+		static EvaluationContext& evaluationContext() noexcept
+		{
+			static thread_local EvaluationContext context;
+			return context;
+		}
 	public:
 		/// <summary>
 		/// Constructor.
 		/// </summary>
-		ExpressionHolder() noexcept : temporaryVariables_(10)
+		ExpressionHolder() noexcept : timeDependent_(false), random_(false)
 		{
 		}
 
 		void SetExpression(std::unique_ptr<expression::IExpression> expression) noexcept
 		{
 			expression_ = std::move(expression);
+			boundExpession_ = nullptr;
 		}
 		const expression::IExpression* GetExpression() const noexcept
 		{
@@ -54,62 +71,100 @@ namespace stochsim
 		{
 			if (!operator bool())
 				throw std::exception("Expression not set.");
+			if (!boundExpession_)
+				throw std::exception("Expression not compiled.");
 
-			// Set temporary variables
-			bool rebind = false;
-			for (auto& variable : variables)
+			// Set temporary variables. If a variable is defined several times, the last definition wins.
+			EvaluationContext& context = evaluationContext();
+			context.simInfo_ = &simInfo;
+			if (context.values_.size() < temporaryVariables_.size())
 			{
-				auto& valuePtr = temporaryVariables_[static_cast<expression::identifier>(variable.first)];
-				if (!valuePtr)
-				{
-					valuePtr = std::make_unique<expression::number>(static_cast<expression::number>(variable.second));
-					rebind = true;
-				}
-				else
+				context.values_.resize(temporaryVariables_.size());
+				context.defined_.resize(temporaryVariables_.size());
+			}
+			for (size_t i = 0; i < temporaryVariables_.size(); i++)
+			{
+				context.defined_[i] = false;
+				for (auto variable = variables.rbegin(); variable != variables.rend(); ++variable)
 				{
-					*valuePtr = static_cast<expression::number>(variable.second);
+					if (variable->first == temporaryVariables_[i])
+					{
+						context.values_[i] = static_cast<expression::number>(variable->second);
+						context.defined_[i] = true;
+						break;
+					}
 				}
 			}
-			if (rebind)
-				rebindTemporaryVariables();
-
 
 			return boundExpession_->Eval();
 		}
 
-		void Initialize(ISimInfo& simInfo)
+		/// <summary>
+		/// Returns all states whose molecular numbers are referenced by the expression. Only valid after compilation.
+		/// </summary>
+		/// <returns>States referenced by the expression.</returns>
+		const std::vector<std::shared_ptr<IState>>& GetBoundStates() const noexcept
+		{
+			return boundStates_;
+		}
+		/// <summary>
+		/// Returns true if the expression references the simulation time. Only valid after compilation.
+		/// </summary>
+		/// <returns>True if expression depends on the simulation time.</returns>
+		bool IsTimeDependent() const noexcept
+		{
+			return timeDependent_;
+		}
+		/// <summary>
+		/// Returns true if the expression references random numbers (rand()). Only valid after compilation.
+		/// </summary>
+		/// <returns>True if expression depends on random numbers.</returns>
+		bool IsRandom() const noexcept
+		{
+			return random_;
+		}
+
+		/// <summary>
+		/// Binds all free variables of the expression to the states of the model, the simulation time, or default variables. All remaining variables are treated as temporary variables, whose values
+		/// are passed when evaluating the expression.
+		/// </summary>
+		/// <param name="compiler">Model compiler.</param>
+		void Compile(IModelCompiler& compiler)
 		{
 			if (!operator bool())
 				throw std::exception("Expression not set.");
 			temporaryVariables_.clear();
+			boundStates_.clear();
+			timeDependent_ = false;
+			random_ = false;
 			boundExpession_ = expression_->Clone();
-			bindVariables(simInfo);
+			bindVariables(compiler);
 			boundExpession_ = boundExpession_->Simplify();
 		}
-		void Uninitialize(ISimInfo& simInfo)
-		{
-			boundExpession_ = nullptr;
-			temporaryVariables_.clear();
-		}
 	private:
 		std::unique_ptr<expression::IExpression> boundExpession_;
 		std::unique_ptr<expression::IExpression> expression_;
-		mutable TemporaryVariables temporaryVariables_;
+		std::vector<expression::identifier> temporaryVariables_;
+		std::vector<std::shared_ptr<IState>> boundStates_;
+		bool timeDependent_;
+		bool random_;
 
-		void bindVariables(ISimInfo& simInfo)
+		void bindVariables(IModelCompiler& compiler)
 		{
 			auto defaultFunctions = expression::makeDefaultFunctions();
 			auto defaultVariables = expression::makeDefaultVariables();
-			expression::BindingRegister bindings = [this, &defaultFunctions, &defaultVariables, &simInfo](const expression::identifier name)->std::unique_ptr<expression::IFunctionHolder>
+			auto states = compiler.GetStates();
+			expression::BindingRegister bindings = [this, &defaultFunctions, &defaultVariables, &states](const expression::identifier name)->std::unique_ptr<expression::IFunctionHolder>
 			{
 				std::string stdName(name);
 				if (name[name.size() - 1] == ')' && name[name.size() - 2] == '(')
 				{
 					if (stdName == "rand()")
 					{
-						std::function<expression::number()> holder = [&simInfo]() -> expression::number
+						random_ = true;
+						std::function<expression::number()> holder = []() -> expression::number
 						{
-							return static_cast<expression::number>(simInfo.Rand());
+							return static_cast<expression::number>(evaluationContext().simInfo_->Rand());
 						};
 						return expression::makeFunctionHolder(holder, true);
 					}
@@ -120,32 +175,25 @@ namespace stochsim
 				}
 				else
 				{
-					auto search = temporaryVariables_.find(name);
-					if (search != temporaryVariables_.end())
-					{
-						auto valuePointer = search->second.get();
-						std::function<expression::number()> holder = [valuePointer]() -> expression::number
-						{
-							return *valuePointer;
-						};
-						return expression::makeFunctionHolder(holder, true);
-					}
-					for (auto& state : simInfo.GetStates())
+					for (auto& state : states)
 					{
 						if (state->GetName() == name)
 						{
-							std::function<expression::number()> holder = [state, &simInfo]() -> expression::number
+							boundStates_.push_back(state);
+							IState* statePointer = state.get();
+							std::function<expression::number()> holder = [statePointer]() -> expression::number
 							{
-								return static_cast<expression::number>(state->Num(simInfo));
+								return static_cast<expression::number>(statePointer->Num(*evaluationContext().simInfo_));
 							};
 							return expression::makeFunctionHolder(holder, true);
 						}
 					}
 					if (stdName == "time")
 					{
-						std::function<expression::number()> holder = [&simInfo]() -> expression::number
+						timeDependent_ = true;
+						std::function<expression::number()> holder = []() -> expression::number
 						{
-							return static_cast<expression::number>(simInfo.GetSimTime());
+							return static_cast<expression::number>(evaluationContext().simInfo_->GetSimTime());
 						};
 						return expression::makeFunctionHolder(holder, true);
 					}
@@ -157,22 +205,29 @@ namespace stochsim
 						std::function<expression::number()> binding = [value]()->expression::number {return value; };
 						return expression::makeFunctionHolder(binding, false);
 					}
-				}
-				return nullptr;
-			};
-			boundExpession_->Bind(bindings);
-		}
-		void rebindTemporaryVariables() const
-		{
-			expression::BindingRegister bindings = [this](const expression::identifier name) -> std::unique_ptr<expression::IFunctionHolder>
-			{
-				auto search = temporaryVariables_.find(name);
-				if (search != temporaryVariables_.end())
-				{
-					auto valuePointer = search->second.get();
-					std::function<expression::number()> holder = [valuePointer]() -> expression::number
+
+					// Temporary variable, e.g. a property of a reactant, whose value is passed when evaluating the expression.
+					size_t index = temporaryVariables_.size();
+					for (size_t i = 0; i < temporaryVariables_.size(); i++)
 					{
-						return *valuePointer;
+						if (temporaryVariables_[i] == name)
+						{
+							index = i;
+							break;
+						}
+					}
+					if (index == temporaryVariables_.size())
+						temporaryVariables_.push_back(name);
+					std::function<expression::number()> holder = [index, stdName]() -> expression::number
+					{
+						const EvaluationContext& context = evaluationContext();
+						if (!context.defined_[index])
+						{
+							std::stringstream errorMessage;
+							errorMessage << "Expression contains unbound variable with name \"" << stdName << "\".";
+							throw std::exception(errorMessage.str().c_str());
+						}
+						return context.values_[index];
 					};
 					return expression::makeFunctionHolder(holder, true);
 				}
@@ -182,4 +237,3 @@ namespace stochsim
 		}
 	};
 }
-
@@ -9,6 +9,7 @@
 #include "ExpressionHolder.h"
 #include "expression_common.h"
 #include "ExpressionParser.h"
+#include "ComposedState.h"
 namespace stochsim
 {
 	/// <summary>
@@ -16,17 +17,55 @@ namespace stochsim
 	/// When the reaction fires, for most reactant/products the absolute numbers are increased/decreased accoding to their stochiometries.
 	/// However, when a reactant is flagged (its modifier is true), its concentration is not decreased when the reaction fires, which allows to implement e.g. enzymes catalyzing a reaction.
 	/// In contrary, when a product is flagged (its modifier is true), its concentration is also not increased when the reaction is fired, but instead the modify function is called on the respective state.
+	/// A reactant, modifier or transformee which is a ComposedState can be weighted (see SetWeight()). Then, its number in the propensity is replaced by the sum of the weights of all its molecules, and
+	/// the molecule taking part in the reaction is drawn with a probability proportional to its weight.
 	/// </summary>
 	class PropensityReaction :
 		public IPropensityReaction
 	{
 	private:
+		/// <summary>
+		/// Weight of the molecules of a reactant, modifier or transformee (see SetWeight()).
+		/// </summary>
+		class Weight
+		{
+		public:
+			std::unique_ptr<expression::IExpression> expression_;
+			// The weighted state and the index of the weight in this state. Only valid after compilation.
+			ComposedState* state_;
+			size_t index_;
+			Weight() noexcept : state_(nullptr), index_(0)
+			{
+			}
+			explicit operator bool() const noexcept
+			{
+				return expression_.operator bool();
+			}
+			void Compile(IModelCompiler& compiler, const std::shared_ptr<IState>& state, Stochiometry stochiometry, const Molecule::PropertyNames& propertyNames, const std::string& reactionName)
+			{
+				state_ = dynamic_cast<ComposedState*>(state.get());
+				if (!state_)
+				{
+					std::stringstream errorMessage;
+					errorMessage << "The weighted species " << state->GetName() << " in reaction " << reactionName << " is not a composed state.";
+					throw std::exception(errorMessage.str().c_str());
+				}
+				if (stochiometry != 1)
+				{
+					std::stringstream errorMessage;
+					errorMessage << "The weighted species " << state->GetName() << " in reaction " << reactionName << " must have a stochiometry of one.";
+					throw std::exception(errorMessage.str().c_str());
+				}
+				index_ = state_->AddWeight(compiler, expression_->Clone(), propertyNames);
+			}
+		};
 		class Reactant
 		{
 		public:
 			Stochiometry stochiometry_;
 			const std::shared_ptr<IState> state_;
 			const Molecule::PropertyNames propertyNames_;
+			Weight weight_;
 			Reactant(std::shared_ptr<IState> state, Stochiometry stochiometry, Molecule::PropertyNames propertyNames) noexcept : stochiometry_(stochiometry), state_(std::move(state)), propertyNames_(std::move(propertyNames))
 			{
 			}
@@ -45,6 +84,7 @@ namespace stochsim
 			Stochiometry stochiometry_;
 			const std::shared_ptr<IState> state_;
 			const Molecule::PropertyNames propertyNames_;
+			Weight weight_;
 			Modifier(std::shared_ptr<IState> state, Stochiometry stochiometry, Molecule::PropertyNames propertyNames) noexcept : stochiometry_(stochiometry), state_(std::move(state)), propertyNames_(std::move(propertyNames))
 			{
 			}
@@ -70,20 +110,12 @@ namespace stochsim
 					propertyExpressions_[i].SetExpression(std::move(propertyExpressions[i]));
 				}
 			}
-			inline void Initialize(ISimInfo& simInfo)
-			{
-				for (auto& propertyExpression : propertyExpressions_)
-				{
-					if (propertyExpression)
-						propertyExpression.Initialize(simInfo);
-				}
-			}
-			inline void Uninitialize(ISimInfo& simInfo)
+			inline void Compile(IModelCompiler& compiler)
 			{
 				for (auto& propertyExpression : propertyExpressions_)
 				{
 					if (propertyExpression)
-						propertyExpression.Uninitialize(simInfo);
+						propertyExpression.Compile(compiler);
 				}
 			}
 			inline Molecule operator() (ISimInfo& simInfo, const std::vector<Variable>& variables = {}) const
@@ -104,6 +136,7 @@ namespace stochsim
 			const std::shared_ptr<IState> state_;
 			std::array<ExpressionHolder, Molecule::size_> propertyExpressions_;
 			const Molecule::PropertyNames propertyNames_;
+			Weight weight_;
 			Transformee(std::shared_ptr<IState> state, Stochiometry stochiometry, Molecule::PropertyExpressions propertyExpressions, Molecule::PropertyNames propertyNames) noexcept : stochiometry_(stochiometry), state_(std::move(state)), propertyNames_(std::move(propertyNames))
 			{
 				for (size_t i = 0; i < Molecule::size_; i++)
@@ -111,20 +144,12 @@ namespace stochsim
 					propertyExpressions_[i].SetExpression(std::move(propertyExpressions[i]));
 				}
 			}
-			inline void Initialize(ISimInfo& simInfo)
+			inline void Compile(IModelCompiler& compiler)
 			{
 				for (auto& propertyExpression : propertyExpressions_)
 				{
 					if (propertyExpression)
-						propertyExpression.Initialize(simInfo);
-				}
-			}
-			inline void Uninitialize(ISimInfo& simInfo)
-			{
-				for (auto& propertyExpression : propertyExpressions_)
-				{
-					if (propertyExpression)
-						propertyExpression.Uninitialize(simInfo);
+						propertyExpression.Compile(compiler);
 				}
 			}
 			inline Molecule& operator() (Molecule& molecule, ISimInfo& simInfo, const std::vector<Variable>& variables = {}) const
@@ -364,7 +389,7 @@ namespace stochsim
 			{
 				for (size_t i = 0; i < reactant.stochiometry_; i++)
 				{
-					Molecule molecule = reactant.state_->Remove(simInfo);
+					Molecule molecule = reactant.weight_ ? reactant.weight_.state_->RemoveWeighted(simInfo, reactant.weight_.index_) : reactant.state_->Remove(simInfo);
 					for (size_t p = 0; p < molecule.Size(); p++)
 					{
 						if (!reactant.propertyNames_[p].empty())
@@ -382,7 +407,7 @@ namespace stochsim
 			{
 				for (size_t i = 0; i < modifier.stochiometry_; i++)
 				{
-					const Molecule& molecule = modifier.state_->Peak(simInfo);
+					const Molecule molecule = modifier.weight_ ? modifier.weight_.state_->PeakWeighted(simInfo, modifier.weight_.index_) : modifier.state_->Peak(simInfo);
 					for (size_t p = 0; p < molecule.Size(); p++)
 					{
 						if (!modifier.propertyNames_[p].empty())
@@ -400,7 +425,7 @@ namespace stochsim
 				std::vector<Molecule*> molecules;
 				for (size_t i = 0; i < transformee.stochiometry_; i++)
 				{
-					molecules.push_back(&transformee.state_->Transform(simInfo));
+					molecules.push_back(transformee.weight_ ? &transformee.weight_.state_->TransformWeighted(simInfo, transformee.weight_.index_) : &transformee.state_->Transform(simInfo));
 					for (size_t p = 0; p < molecules[i]->Size(); p++)
 					{
 						if (!transformee.propertyNames_[p].empty())
@@ -441,6 +466,7 @@ namespace stochsim
 						}
 					}
 				}
+				transformee.state_->CommitTransform(simInfo);
 			}
 			for (auto& product : products_)
 			{
@@ -477,6 +503,11 @@ namespace stochsim
 				double rate = rateConstant_;
 				for (const auto& reactant : reactants_)
 				{
+					if (reactant.weight_)
+					{
+						rate *= reactant.weight_.state_->WeightSum(simInfo, reactant.weight_.index_);
+						continue;
+					}
 					const long stoch = reactant.stochiometry_;
 					const size_t num = reactant.state_->Num(simInfo);
 					for (size_t s = 0; s < stoch; s++)
@@ -486,6 +517,11 @@ namespace stochsim
 				}
 				for (const auto& modifier : modifiers_)
 				{
+					if (modifier.weight_)
+					{
+						rate *= modifier.weight_.state_->WeightSum(simInfo, modifier.weight_.index_);
+						continue;
+					}
 					const long stoch = modifier.stochiometry_;
 					const size_t num = modifier.state_->Num(simInfo);
 					for (size_t s = 0; s < stoch; s++)
@@ -495,6 +531,11 @@ namespace stochsim
 				}
 				for (const auto& transformee : transformees_)
 				{
+					if (transformee.weight_)
+					{
+						rate *= transformee.weight_.state_->WeightSum(simInfo, transformee.weight_.index_);
+						continue;
+					}
 					const long stoch = transformee.stochiometry_;
 					const size_t num = transformee.state_->Num(simInfo);
 					for (size_t s = 0; s < stoch; s++)
@@ -509,50 +550,63 @@ namespace stochsim
 		{
 			return name_;
 		}
-		virtual void Initialize(ISimInfo& simInfo) override
+		virtual void Compile(IModelCompiler& compiler) override
 		{
 			if (customRate_)
 			{
-				customRate_.Initialize(simInfo);
+				customRate_.Compile(compiler);
 			}
-
-			for (auto& reactant : reactants_)
+			if (customRate_ && HasWeights())
 			{
-				reactant.Initialize(simInfo);
+				std::stringstream errorMessage;
+				errorMessage << "Reaction " << name_ << " has a custom rate equation, and weighted species. Weights can only be used together with mass action kinetics.";
+				throw std::exception(errorMessage.str().c_str());
 			}
-			for (auto& product : products_)
+			for (auto& reactant : reactants_)
 			{
-				product.Initialize(simInfo);
+				if (reactant.weight_)
+					reactant.weight_.Compile(compiler, reactant.state_, reactant.stochiometry_, reactant.propertyNames_, name_);
 			}
 			for (auto& modifier : modifiers_)
 			{
-				modifier.Initialize(simInfo);
+				if (modifier.weight_)
+					modifier.weight_.Compile(compiler, modifier.state_, modifier.stochiometry_, modifier.propertyNames_, name_);
 			}
 			for (auto& transformee : transformees_)
 			{
-				transformee.Initialize(simInfo);
+				if (transformee.weight_)
+					transformee.weight_.Compile(compiler, transformee.state_, transformee.stochiometry_, transformee.propertyNames_, name_);
+			}
+			for (auto& product : products_)
+			{
+				product.Compile(compiler);
+			}
+			for (auto& transformee : transformees_)
+			{
+				transformee.Compile(compiler);
 			}
 		}
-		virtual void Uninitialize(ISimInfo& simInfo) override
+		virtual void Initialize(ISimInfo& simInfo) override
 		{
 			for (auto& reactant : reactants_)
 			{
-				reactant.Uninitialize(simInfo);
+				reactant.Initialize(simInfo);
 			}
-			for (auto& product : products_)
+			for (auto& modifier : modifiers_)
 			{
-				product.Uninitialize(simInfo);
+				modifier.Initialize(simInfo);
 			}
-			for (auto& modifier : modifiers_)
+		}
+		virtual void Uninitialize(ISimInfo& simInfo) override
+		{
+			for (auto& reactant : reactants_)
 			{
-				modifier.Uninitialize(simInfo);
+				reactant.Uninitialize(simInfo);
 			}
-			for (auto& transformee : transformees_)
+			for (auto& modifier : modifiers_)
 			{
-				transformee.Uninitialize(simInfo);
+				modifier.Uninitialize(simInfo);
 			}
-
-			customRate_.Uninitialize(simInfo);
 		}
 		/// <summary>
 		/// Returns the rate constant of this reaction. If this reaction depends on a custom rate equation instead of a rate constant, returns -1.
@@ -584,6 +638,156 @@ namespace stochsim
 			return customRate_.GetExpression();
 		}
 		/// <summary>
+		/// Returns true if the propensity of this reaction is completely determined by its rate constant and the molecular numbers of its reactants, modifiers and transformees, i.e. if it neither has
+		/// a custom rate equation nor weighted species.
+		/// </summary>
+		/// <returns>True if the reaction follows mass action kinetics.</returns>
+		bool IsMassAction() const noexcept
+		{
+			return !customRate_ && !HasWeights();
+		}
+		/// <summary>
+		/// Returns true if at least one reactant, modifier or transformee of this reaction is weighted (see SetWeight()).
+		/// </summary>
+		/// <returns>True if the reaction has weighted species.</returns>
+		bool HasWeights() const noexcept
+		{
+			for (const auto& reactant : reactants_)
+			{
+				if (reactant.weight_)
+					return true;
+			}
+			for (const auto& modifier : modifiers_)
+			{
+				if (modifier.weight_)
+					return true;
+			}
+			for (const auto& transformee : transformees_)
+			{
+				if (transformee.weight_)
+					return true;
+			}
+			return false;
+		}
+		/// <summary>
+		/// Returns the states which are weighted (see SetWeight()).
+		/// </summary>
+		/// <returns>Weighted states.</returns>
+		stochsim::Collection<std::shared_ptr<IState>> GetWeightedStates() const
+		{
+			stochsim::Collection<std::shared_ptr<IState>> returnVal;
+			for (const auto& reactant : reactants_)
+			{
+				if (reactant.weight_)
+					returnVal.push_back(reactant.state_);
+			}
+			for (const auto& modifier : modifiers_)
+			{
+				if (modifier.weight_)
+					returnVal.push_back(modifier.state_);
+			}
+			for (const auto& transformee : transformees_)
+			{
+				if (transformee.weight_)
+					returnVal.push_back(transformee.state_);
+			}
+			return returnVal;
+		}
+		/// <summary>
+		/// Weights the molecules of a reactant, modifier or transformee of this reaction, which has to be a ComposedState with a stochiometry of one. Instead of being proportional to the number of molecules of the state,
+		/// the propensity of the reaction is then proportional to the sum of the weights of all molecules. When the reaction fires, the molecule taking part in the reaction is drawn with a probability proportional
+		/// to its weight. The weight can reference the properties of a molecule via the property names of the reactant, modifier or transformee, e.g. "1/(1+numModified)", and has to be non-negative.
+		/// Only valid for reactions following mass action kinetics, i.e. not having a custom rate equation. If the state is e.g. both a reactant and a modifier, the reactant is weighted.
+		/// </summary>
+		/// <param name="state">Reactant, modifier or transformee to weight.</param>
+		/// <param name="weight">Weight of a molecule.</param>
+		void SetWeight(std::shared_ptr<IState> state, std::unique_ptr<expression::IExpression> weight)
+		{
+			for (auto& reactant : reactants_)
+			{
+				if (reactant.state_ == state)
+				{
+					reactant.weight_.expression_ = std::move(weight);
+					return;
+				}
+			}
+			for (auto& modifier : modifiers_)
+			{
+				if (modifier.state_ == state)
+				{
+					modifier.weight_.expression_ = std::move(weight);
+					return;
+				}
+			}
+			for (auto& transformee : transformees_)
+			{
+				if (transformee.state_ == state)
+				{
+					transformee.weight_.expression_ = std::move(weight);
+					return;
+				}
+			}
+			std::stringstream errorMessage;
+			errorMessage << "Cannot weight species " << state->GetName() << " in reaction " << name_ << ", since it is neither a reactant, modifier nor transformee of the reaction.";
+			throw std::exception(errorMessage.str().c_str());
+		}
+		/// <summary>
+		/// Weights the molecules of a reactant, modifier or transformee of this reaction (see SetWeight(std::shared_ptr&lt;IState&gt;, std::unique_ptr&lt;expression::IExpression&gt;)).
+		/// </summary>
+		/// <param name="state">Reactant, modifier or transformee to weight.</param>
+		/// <param name="weight">Weight of a molecule, as a string which is parsed immediately.</param>
+		void SetWeight(std::shared_ptr<IState> state, std::string weight)
+		{
+			expression::ExpressionParser parser;
+			SetWeight(std::move(state), parser.Parse(weight, false, false));
+		}
+		/// <summary>
+		/// Returns all states on whose molecular numbers the rate of this reaction depends. For mass action kinetics and reactions with weighted species, these are the reactants, modifiers and transformees.
+		/// For custom rate equations, these are the states referenced by the equation, which are only known after the reaction was initialized.
+		/// </summary>
+		/// <returns>States the reaction rate depends on.</returns>
+		stochsim::Collection<std::shared_ptr<IState>> GetRateDependencies() const
+		{
+			stochsim::Collection<std::shared_ptr<IState>> returnVal;
+			if (customRate_)
+			{
+				returnVal.insert(returnVal.end(), customRate_.GetBoundStates().begin(), customRate_.GetBoundStates().end());
+				return returnVal;
+			}
+			for (const auto& reactant : reactants_)
+			{
+				returnVal.push_back(reactant.state_);
+			}
+			for (const auto& modifier : modifiers_)
+			{
+				returnVal.push_back(modifier.state_);
+			}
+			for (const auto& transformee : transformees_)
+			{
+				returnVal.push_back(transformee.state_);
+			}
+			return returnVal;
+		}
+		/// <summary>
+		/// Returns true if the rate of this reaction might change even if the molecular numbers of all states returned by GetRateDependencies() stay constant, i.e. if its custom
+		/// rate equation references the simulation time or random numbers. Only valid after the reaction was initialized.
+		/// </summary>
+		/// <returns>True if the reaction rate is time dependent.</returns>
+		bool IsRateTimeDependent() const noexcept
+		{
+			return customRate_ && (customRate_.IsTimeDependent() || customRate_.IsRandom());
+		}
+		/// <summary>
+		/// Returns true if the custom rate equation of this reaction references random numbers. Only valid after the reaction was initialized.
+		/// Reactions whose rate only depends on the simulation time and on molecular numbers are simulated exactly by integrating their propensity over time, while the rate of reactions referencing
+		/// random numbers is redrawn after every firing of any reaction, and assumed to be constant in between.
+		/// </summary>
+		/// <returns>True if the reaction rate is random.</returns>
+		bool IsRateRandom() const noexcept
+		{
+			return customRate_ && customRate_.IsRandom();
+		}
+		/// <summary>
 		/// Sets a custom rate equation for this reaction. If a custom rate equation is defined, the rate of the equation is not determined by standard mass action kinetics.
 		/// Instead, the rate is dynamically calculated by solving the mathematical formula provided as an argument. This formula can contain standard math functions like
 		/// min, sin and similar, as well as variables having the name of the reactants of this reaction, which are dynamically replaced by the molcular numbers of these reactants
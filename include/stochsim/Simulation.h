@@ -1,8 +1,14 @@
 #pragma once
 #include <memory>
+#include <vector>
 #include "stochsim_common.h"
 namespace stochsim
 {
+	// Forward declarations.
+	class CompiledModel;
+	class Ensemble;
+	class StopCondition;
+
 	/// <summary>
 	/// Main class to run simulations.
 	/// The idea is to construct a simulation by adding reactions and states to an object of this class. Once done, the simulation can be run using Simulation::run.
@@ -10,13 +16,138 @@ namespace stochsim
 	class Simulation
 	{
 	public:
+		/// <summary>
+		/// Algorithms which can be used to determine when and which propensity reaction fires next. All algorithms except tau-leaping and the hybrid method are exact, i.e. produce trajectories with the same statistics,
+		/// but they scale differently with the number of reactions in the model.
+		/// </summary>
+		enum class Algorithm
+		{
+			/// <summary>
+			/// Gillespie's direct method. Default algorithm, and the reference implementation for all other algorithms.
+			/// </summary>
+			DirectMethod,
+			/// <summary>
+			/// Gibson and Bruck's next reaction method. Every reaction keeps its own putative firing time in an indexed priority queue, and only the propensities of reactions affected by a firing
+			/// are recomputed. Typically faster than the direct method for models with many, sparsely coupled reactions.
+			/// </summary>
+			NextReactionMethod,
+			/// <summary>
+			/// Slepoy, Thompson and Plimpton's composition-rejection method. Reactions are grouped into bins of propensities differing by at most a factor of two, and the reaction firing next is
+			/// selected by rejection sampling within a bin. The costs per step are nearly independent of the number of reactions, making it the algorithm of choice for very large reaction networks.
+			/// </summary>
+			CompositionRejection,
+			/// <summary>
+			/// Cao, Gillespie and Petzold's tau-leaping method. Instead of firing one reaction at a time, the simulation leaps over time steps during which all propensities stay approximately constant,
+			/// and every reaction fires a Poisson distributed number of times. Approximate, but much faster than the exact algorithms for models with high molecular numbers. Falls back to exact steps when
+			/// leaping would not be beneficial. Event reactions still fire exactly at their scheduled times.
+			/// </summary>
+			TauLeaping,
+			/// <summary>
+			/// Hybrid stochastic-deterministic method. Fast reactions between species with high molecular numbers are integrated deterministically with an adaptive RK45 solver, while all other reactions fire
+			/// stochastically. The partitioning into fast and slow reactions is updated in every step. Approximate, but much faster than the exact algorithms for models mixing species with low
+			/// (e.g. genes) and high (e.g. proteins) molecular numbers. Event reactions still fire exactly at their scheduled times.
+			/// </summary>
+			Hybrid,
+			/// <summary>
+			/// McCollum et al.'s sorting direct method. Variant of the direct method selecting the reaction firing next by a linear search, in an order which adapts during the simulation such that frequently
+			/// firing reactions are searched first. Avoids the overhead of the sum tree of the direct method and the priority queue of the next reaction method, and is thus typically faster than both for
+			/// medium-sized models in which a few reactions dominate.
+			/// </summary>
+			SortingDirectMethod,
+			/// <summary>
+			/// Ramaswamy et al.'s partial-propensity direct method. The propensities of all mass action reactions with at most two reactants are factorized into the molecular number of the first reactant and
+			/// a partial propensity depending only on the second reactant, and grouped by the first reactant. The costs per step scale with the number of species instead of the number of reactions,
+			/// making it the algorithm of choice for networks dominated by bimolecular reactions, whose number grows quadratically with the number of species. All other reactions are simulated as by the direct method.
+			/// </summary>
+			PartialPropensityMethod,
+			/// <summary>
+			/// Cao, Gillespie and Petzold's slow-scale stochastic simulation algorithm. Fast reversible reaction pairs (e.g. E + S &lt;-&gt; ES) are detected automatically and assumed to be in partial equilibrium,
+			/// such that only the slow reactions have to be simulated, with their propensities averaged over the stationary distributions of the fast pairs. Approximate, but orders of magnitude faster than the exact
+			/// algorithms for models in which fast reversible reactions dominate. Event reactions still fire exactly at their scheduled times.
+			/// </summary>
+			SlowScale
+		};
+
 		explicit Simulation();
 		virtual ~Simulation();
 		/// <summary>
-		/// Runs the simulation for maxTime time units.
+		/// Runs the simulation for maxTime time units, or until a stop condition is met (see AddStopCondition() and GetStopReason()).
 		/// </summary>
 		/// <param name="maxTime">Simulation time when simulation should stop. Simulation starts at simulation time zero.</param>
 		virtual void Run(double maxTime);
+		/// <summary>
+		/// Advances the simulation until the given simulation time, keeping its state such that it can be advanced further by subsequent calls, e.g. to check or log the state in between.
+		/// The first call compiles the model and initializes all states, reactions and loggers, such that these costs are only paid once. Changes of the model or the settings of the simulation only take effect
+		/// after the simulation was finished (see Finish()). Run() finishes the simulation, too.
+		/// See SimulationInstance::RunUntil().
+		/// </summary>
+		/// <param name="time">Simulation time until which the simulation should run. Must not be earlier than the current simulation time.</param>
+		virtual void RunUntil(double time);
+		/// <summary>
+		/// Advances the simulation for the given duration. Same as RunUntil(GetSimTime() + duration).
+		/// </summary>
+		/// <param name="duration">Simulation time units the simulation should run.</param>
+		virtual void Continue(double duration);
+		/// <summary>
+		/// Advances the simulation by firing the given number of propensity or event reactions (see RunUntil() and SimulationInstance::Step()).
+		/// </summary>
+		/// <param name="numSteps">Number of reactions to fire.</param>
+		/// <returns>Number of reactions fired, which is smaller than numSteps if no reaction can fire anymore.</returns>
+		virtual size_t Step(size_t numSteps = 1);
+		/// <summary>
+		/// Finishes the simulation advanced by RunUntil(), Continue() or Step(), i.e. writes the final log and uninitializes all loggers. Does nothing if the simulation is not running.
+		/// </summary>
+		virtual void Finish();
+		/// <summary>
+		/// Returns true if the simulation was started by RunUntil(), Continue() or Step(), and not yet finished.
+		/// </summary>
+		/// <returns>True if simulation is running.</returns>
+		virtual bool IsRunning() const;
+		/// <summary>
+		/// Returns the current simulation time of the simulation advanced by RunUntil(), Continue() or Step(), or zero if it is not running.
+		/// </summary>
+		/// <returns>Simulation time.</returns>
+		virtual double GetSimTime() const;
+		/// <summary>
+		/// Returns the current molecular number of the given state in the simulation advanced by RunUntil(), Continue() or Step(). Throws an exception if the simulation is not running.
+		/// </summary>
+		/// <param name="state">State of the simulation.</param>
+		/// <returns>Molecular number of the state.</returns>
+		virtual size_t Num(const IState& state);
+		/// <summary>
+		/// Saves the complete runtime state of the simulation advanced by RunUntil(), Continue() or Step() to a binary checkpoint file. Throws an exception if the simulation is not running.
+		/// See SimulationInstance::SaveCheckpoint().
+		/// </summary>
+		/// <param name="fileName">Name of the checkpoint file.</param>
+		virtual void SaveCheckpoint(const std::string& fileName);
+		/// <summary>
+		/// Finishes the simulation, if running, and restores it from a checkpoint file saved by a simulation of the same model, with the same loggers. The simulation can then be advanced by RunUntil(),
+		/// Continue() or Step(). See SimulationInstance::LoadCheckpoint().
+		/// </summary>
+		/// <param name="fileName">Name of the checkpoint file.</param>
+		virtual void LoadCheckpoint(const std::string& fileName);
+		/// <summary>
+		/// Returns a binary checkpoint of the complete runtime state of the simulation advanced by RunUntil(), Continue() or Step(), e.g. to branch replicates off it with Ensemble::Fork().
+		/// Throws an exception if the simulation is not running. See SimulationInstance::CreateCheckpoint().
+		/// </summary>
+		/// <returns>Binary checkpoint.</returns>
+		virtual std::vector<char> CreateCheckpoint();
+		/// <summary>
+		/// Branches the given number of replicates off the current state of the simulation advanced by RunUntil(), Continue() or Step(), and runs them in parallel until maxTime, each with its own random number stream
+		/// (see Ensemble::Fork()). The replicates use the algorithm and log period of this simulation, and their seeds are derived from the seed of this simulation. Since all replicates would write to the same files,
+		/// the loggers of this simulation are not added to the replicates; instead, the molecular numbers of the replicates are recorded in the returned ensemble. This simulation keeps running, and can be advanced further afterwards.
+		/// Throws an exception if the simulation is not running.
+		/// </summary>
+		/// <param name="numReplicates">Number of replicates to branch off.</param>
+		/// <param name="maxTime">Simulation time when every replicate should stop.</param>
+		/// <returns>Ensemble holding the results of all replicates.</returns>
+		virtual std::unique_ptr<Ensemble> Fork(size_t numReplicates, double maxTime);
+		/// <summary>
+		/// Compiles the states and reactions of the simulation into an immutable model, which can then be simulated by any number of simulation instances (see SimulationInstance), e.g. concurrently on different threads.
+		/// The simulation itself compiles its model every time it is run. Loggers and settings like the log period or the algorithm are not part of the compiled model, but have to be set for every instance.
+		/// </summary>
+		/// <returns>Compiled model.</returns>
+		virtual std::shared_ptr<const CompiledModel> Compile() const;
 
 		/// <summary>
 		/// Creates a state of the given type and adds it to the set of states managed by this simulation. Equivalent to
@@ -55,6 +186,25 @@ namespace stochsim
 			return reaction;
 		}
 
+		/// <summary>
+		/// Creates a stop condition and adds it to the set of stop conditions of this simulation (see AddStopCondition()). Equivalent to
+		/// <code>
+		///		Simulation sim;
+		///		// ...
+		///		std::shared_ptr&lt;StopCondition&gt; stopCondition = make_shared&lt;StopCondition&gt;(arguments...);
+		///		sim.AddStopCondition(stopCondition);
+		/// </code>
+		/// Requires StopCondition.h to be included.
+		/// <returns>The created stop condition.</returns>
+		/// </summary>
+		template<class... ArgumentTypes> inline
+			std::shared_ptr<StopCondition> CreateStopCondition(ArgumentTypes&&... arguments)
+		{
+			std::shared_ptr<StopCondition> stopCondition = std::make_shared<StopCondition>(std::forward<ArgumentTypes>(arguments)...);
+			AddStopCondition(stopCondition);
+			return stopCondition;
+		}
+
 		/// <summary>
 		/// Adds a propensity reaction externally created (i.e. not with Simulation::CreateReaction) to be managed by the simulation.
 		/// Only reactions managed by the simulation will fire when the simulation runs. Also, all states belonging to the reaction must also be managed by the simulation.
@@ -68,6 +218,26 @@ namespace stochsim
 		/// <param name="reaction">Reaction to add.</param>
 		virtual void AddReaction(std::shared_ptr<IEventReaction> reaction);
 		/// <summary>
+		/// Adds a condition ending the simulation early as soon as it is met, e.g. when a species went extinct (see StopCondition).
+		/// </summary>
+		/// <param name="stopCondition">Stop condition to add.</param>
+		virtual void AddStopCondition(std::shared_ptr<StopCondition> stopCondition);
+		/// <summary>
+		/// Returns all stop conditions defined in this simulation.
+		/// </summary>
+		/// <returns>Collection of all stop conditions.</returns>
+		virtual const Collection<std::shared_ptr<StopCondition>> GetStopConditions() const;
+		/// <summary>
+		/// Returns the name of the stop condition which ended the current or last run early, the reason passed to ISimInfo::Stop() if e.g. a logger stopped it, or an empty string if the run was not stopped early (see SimulationInstance::GetStopReason()).
+		/// </summary>
+		/// <returns>Reason why the run stopped.</returns>
+		virtual std::string GetStopReason() const;
+		/// <summary>
+		/// Returns the simulation time when the current or last run was stopped early, or stochsim::inf if it was not stopped early.
+		/// </summary>
+		/// <returns>Simulation time when the simulation stopped.</returns>
+		virtual double GetStopTime() const;
+		/// <summary>
 		/// Adds a state externally created (i.e. not with Simulation::CreateState) to be managed by the simulation. Every state modified by any reaction in the simulation must also be managed by the simulation.
 		/// </summary>
 		/// <param name="reaction">State to add.</param>
@@ -150,6 +320,62 @@ namespace stochsim
 		/// <returns>True if sub-folder is created, false if results are saved directly in the base folder.</returns>
 		virtual bool IsUniqueSubfolder() const;
 		/// <summary>
+		/// Sets the algorithm used to determine when and which propensity reaction fires next. Default = Algorithm::DirectMethod.
+		/// The algorithm only takes effect when the simulation is (re-)started.
+		/// </summary>
+		/// <param name="algorithm">Algorithm to use.</param>
+		virtual void SetAlgorithm(Algorithm algorithm);
+		/// <summary>
+		/// Returns the algorithm used to determine when and which propensity reaction fires next. Default = Algorithm::DirectMethod.
+		/// </summary>
+		/// <returns>Algorithm used.</returns>
+		virtual Algorithm GetAlgorithm() const;
+		/// <summary>
+		/// Sets the seed of the random number generator. Every (re-)start of the simulation then re-seeds the generator with this seed, such that runs of the same model with the same seed produce identical trajectories.
+		/// All random numbers of a run, including those of the function rand() in custom rate and property expressions, are drawn from this generator.
+		/// By default, no seed is set, and every run is seeded randomly.
+		/// </summary>
+		/// <param name="seed">Seed of the random number generator.</param>
+		virtual void SetSeed(unsigned long long seed);
+		/// <summary>
+		/// Returns the seed of the random number generator, or the seed drawn randomly for the last run if no seed was set (see SetSeed()).
+		/// </summary>
+		/// <returns>Seed of the random number generator.</returns>
+		virtual unsigned long long GetSeed() const;
+		/// <summary>
+		/// Set to true to compute the propensities of mass action reactions with SIMD instructions (AVX-512 or AVX2, selected at runtime depending on the CPU) whenever all propensities are recomputed at once,
+		/// e.g. in every step of tau-leaping and of the hybrid method. Falls back to scalar code if the CPU supports neither instruction set. The propensities, and thus the trajectories, are bit-for-bit identical
+		/// in both cases. Default = true.
+		/// The setting only takes effect when the model is (re-)compiled.
+		/// </summary>
+		/// <param name="vectorized">True if SIMD instructions should be used if available, false to always use scalar code.</param>
+		virtual void SetVectorized(bool vectorized);
+		/// <summary>
+		/// Returns true if the propensities of mass action reactions are computed with SIMD instructions if supported by the CPU. Default = true.
+		/// </summary>
+		/// <returns>True if SIMD instructions are used if available.</returns>
+		virtual bool IsVectorized() const;
+		/// <summary>
+		/// Sets the file to which checkpoints are saved periodically while the simulation runs (see SetCheckpointPeriod() and SimulationInstance::SetCheckpointFile()). Default = "", i.e. no periodic checkpoints.
+		/// </summary>
+		/// <param name="checkpointFile">Name of the checkpoint file.</param>
+		virtual void SetCheckpointFile(std::string checkpointFile);
+		/// <summary>
+		/// Returns the file to which checkpoints are saved periodically. Default = "", i.e. no periodic checkpoints.
+		/// </summary>
+		/// <returns>Name of the checkpoint file.</returns>
+		virtual std::string GetCheckpointFile() const;
+		/// <summary>
+		/// Sets the period, in simulation time units, with which checkpoints are saved to the checkpoint file while the simulation runs. Zero disables periodic checkpoints. Default = 0.
+		/// </summary>
+		/// <param name="checkpointPeriod">Checkpoint period in simulation time units.</param>
+		virtual void SetCheckpointPeriod(double checkpointPeriod);
+		/// <summary>
+		/// Returns the period with which checkpoints are saved to the checkpoint file. Default = 0, i.e. no periodic checkpoints.
+		/// </summary>
+		/// <returns>Checkpoint period in simulation time units.</returns>
+		virtual double GetCheckpointPeriod() const;
+		/// <summary>
 		/// Creates a logger monitoring the state of the simulation and adds it to this simulation. Same as
 		/// <code>
 		/// Simulation sim;
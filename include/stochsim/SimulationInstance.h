@@ -0,0 +1,217 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "stochsim_common.h"
+#include "Simulation.h"
+#include "CompiledModel.h"
+namespace stochsim
+{
+	/// <summary>
+	/// A single run of a compiled model (see Simulation::Compile()). Holds only the data which changes while simulating, i.e. the instance data of all states and reactions (molecular numbers,
+	/// molecule buffers,...), the event queue and the random number generator, as well as its loggers. Many instances can share one compiled model, and instances of the same model can run concurrently
+	/// on different threads.
+	/// </summary>
+	class SimulationInstance
+	{
+	public:
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="model">Compiled model to simulate.</param>
+		explicit SimulationInstance(std::shared_ptr<const CompiledModel> model);
+		virtual ~SimulationInstance();
+		/// <summary>
+		/// Runs the simulation for maxTime time units, or until a stop condition of the model is met (see GetStopReason()). Finishes the simulation advanced by RunUntil(), Continue() or Step(), if any, and starts a new one.
+		/// </summary>
+		/// <param name="maxTime">Simulation time when simulation should stop. Simulation starts at simulation time zero.</param>
+		virtual void Run(double maxTime);
+		/// <summary>
+		/// Advances the simulation until the given simulation time, keeping its state such that it can be advanced further by subsequent calls. If the simulation is not yet running, it is started at simulation time zero,
+		/// which initializes all states, reactions and loggers. Loggers are only uninitialized, and write their final log, when calling Finish().
+		/// The runtime seen by the loggers (see ISimInfo::GetRunTime()) is the time passed to the call starting the simulation.
+		/// </summary>
+		/// <param name="time">Simulation time until which the simulation should run. Must not be earlier than the current simulation time.</param>
+		virtual void RunUntil(double time);
+		/// <summary>
+		/// Advances the simulation for the given duration. Same as RunUntil(GetSimTime() + duration).
+		/// </summary>
+		/// <param name="duration">Simulation time units the simulation should run.</param>
+		virtual void Continue(double duration);
+		/// <summary>
+		/// Advances the simulation by firing the given number of propensity or event reactions, starting the simulation if it is not yet running (see RunUntil()). A leap of an approximate algorithm firing several
+		/// reactions at once counts as a single step. The simulation time is set to the time of the last reaction.
+		/// </summary>
+		/// <param name="numSteps">Number of reactions to fire.</param>
+		/// <returns>Number of reactions fired, which is smaller than numSteps if no reaction can fire anymore.</returns>
+		virtual size_t Step(size_t numSteps = 1);
+		/// <summary>
+		/// Finishes the simulation advanced by RunUntil(), Continue() or Step(), i.e. writes the final log and uninitializes all loggers and states. The next call to any of these methods starts a new simulation.
+		/// Does nothing if the simulation is not running.
+		/// </summary>
+		virtual void Finish();
+		/// <summary>
+		/// Returns true if the simulation was started by RunUntil(), Continue() or Step(), and not yet finished.
+		/// </summary>
+		/// <returns>True if simulation is running.</returns>
+		virtual bool IsRunning() const;
+		/// <summary>
+		/// Returns the current simulation time.
+		/// </summary>
+		/// <returns>Simulation time.</returns>
+		virtual double GetSimTime() const;
+		/// <summary>
+		/// Returns the current molecular number of the given state of the model. Only valid while the simulation is running.
+		/// </summary>
+		/// <param name="state">State of the model.</param>
+		/// <returns>Molecular number of the state.</returns>
+		virtual size_t Num(const IState& state);
+		/// <summary>
+		/// Returns the name of the stop condition which ended the current or last simulation early (see Simulation::AddStopCondition()), the reason passed to ISimInfo::Stop() if e.g. a logger stopped it,
+		/// or an empty string if the simulation was not stopped early. Once stopped, the simulation does not advance anymore until it is finished and started again.
+		/// </summary>
+		/// <returns>Reason why the simulation stopped.</returns>
+		virtual std::string GetStopReason() const;
+		/// <summary>
+		/// Returns the simulation time when the current or last simulation was stopped early, or stochsim::inf if it was not stopped early.
+		/// </summary>
+		/// <returns>Simulation time when the simulation stopped.</returns>
+		virtual double GetStopTime() const;
+		/// <summary>
+		/// Saves the complete runtime state of the running simulation to a binary checkpoint file, i.e. the simulation time, the state of the random number generator, the molecular numbers of all states,
+		/// the molecules of all composed states with their creation times and properties, the data of all reactions (e.g. if a timer already fired), and the positions of all loggers.
+		/// The state of the algorithm and the schedulers (e.g. the putative firing times of the next reaction method, or a leap not yet fired) is saved, too, such that the restored simulation continues bit-exactly as this simulation.
+		/// Saving a checkpoint does not change the trajectory of this simulation.
+		/// Throws an exception if the simulation is not running.
+		/// </summary>
+		/// <param name="fileName">Name of the checkpoint file.</param>
+		virtual void SaveCheckpoint(const std::string& fileName);
+		/// <summary>
+		/// Finishes the simulation, if running, and restores the simulation from a checkpoint file saved by a simulation instance of the same model, with the same loggers. The simulation is then running
+		/// at the simulation time of the checkpoint, and can be advanced by RunUntil(), Continue() or Step(). Instead of being initialized, the loggers continue logging where they were when the checkpoint was saved,
+		/// discarding everything they logged afterwards. The algorithm, seed and runtime are taken from the checkpoint.
+		/// </summary>
+		/// <param name="fileName">Name of the checkpoint file.</param>
+		virtual void LoadCheckpoint(const std::string& fileName);
+		/// <summary>
+		/// Same as SaveCheckpoint(), but returns the binary checkpoint instead of writing it to a file, e.g. to branch several simulations off the current state (see StartFromCheckpoint() and Ensemble::Fork()).
+		/// Throws an exception if the simulation is not running.
+		/// </summary>
+		/// <returns>Binary checkpoint.</returns>
+		virtual std::vector<char> CreateCheckpoint();
+		/// <summary>
+		/// Finishes the simulation, if running, and starts a new simulation branching off the state stored in a checkpoint created by a simulation instance of the same model (see CreateCheckpoint()).
+		/// Only the state of the model, i.e. the simulation time and the molecular numbers and data of all states and reactions, is taken from the checkpoint. The algorithm, the seed, the loggers and the other settings
+		/// are the ones of this instance, such that branches with different seeds continue independently from the same state. The loggers are initialized at the simulation time of the checkpoint.
+		/// The simulation can then be advanced by RunUntil(), Continue() or Step().
+		/// </summary>
+		/// <param name="checkpoint">Binary checkpoint.</param>
+		/// <param name="runtime">Runtime seen by the loggers (see ISimInfo::GetRunTime()), i.e. the simulation time until which the branch is going to be advanced.</param>
+		virtual void StartFromCheckpoint(const std::vector<char>& checkpoint, double runtime);
+		/// <summary>
+		/// Sets the file to which checkpoints are saved periodically while the simulation is advanced by Run(), RunUntil() or Continue() (see SetCheckpointPeriod()). Default = "", i.e. no periodic checkpoints.
+		/// </summary>
+		/// <param name="checkpointFile">Name of the checkpoint file.</param>
+		virtual void SetCheckpointFile(std::string checkpointFile);
+		/// <summary>
+		/// Returns the file to which checkpoints are saved periodically. Default = "", i.e. no periodic checkpoints.
+		/// </summary>
+		/// <returns>Name of the checkpoint file.</returns>
+		virtual std::string GetCheckpointFile() const;
+		/// <summary>
+		/// Sets the period, in simulation time units, with which checkpoints are saved to the checkpoint file (see SetCheckpointFile()). The simulation state is serialized into memory at multiples of the period,
+		/// while the file is written in the background, such that the simulation does not wait for the disk. Zero disables periodic checkpoints. Default = 0.
+		/// </summary>
+		/// <param name="checkpointPeriod">Checkpoint period in simulation time units.</param>
+		virtual void SetCheckpointPeriod(double checkpointPeriod);
+		/// <summary>
+		/// Returns the period with which checkpoints are saved to the checkpoint file. Default = 0, i.e. no periodic checkpoints.
+		/// </summary>
+		/// <returns>Checkpoint period in simulation time units.</returns>
+		virtual double GetCheckpointPeriod() const;
+		/// <summary>
+		/// Returns the compiled model simulated by this instance.
+		/// </summary>
+		/// <returns>Compiled model.</returns>
+		virtual std::shared_ptr<const CompiledModel> GetModel() const;
+
+		/// <summary>
+		/// Adds a logger to the simulation instance monitoring the progress of a simulation and e.g. writing it to a file. This logger is called every time the simulation time exceeds the log period.
+		/// </summary>
+		/// <param name="task">Logger to add.</param>
+		virtual void AddLogger(std::shared_ptr<ILogger> logger);
+		/// <summary>
+		/// Sets the time period of logging. Default = 1.
+		/// </summary>
+		/// <param name="logPeriod">Log period in simulation time units</param>
+		virtual void SetLogPeriod(double logPeriod);
+		/// <summary>
+		/// Returns the time period of logging. Default = 1.
+		/// </summary>
+		/// <returns>Log period in simulation time units</returns>
+		virtual double GetLogPeriod() const;
+		/// <summary>
+		/// Sets the folder under which the results of the simulation should be saved (see Simulation::SetBaseFolder()).
+		/// </summary>
+		/// <param name="baseFolder">Base folder where simulation results are saved.</param>
+		virtual void SetBaseFolder(std::string baseFolder);
+		/// <summary>
+		/// Returns the folder under which the results of the simulation should be saved (see Simulation::SetBaseFolder()).
+		/// </summary>
+		/// <returns>Base folder where simulation results are saved.</returns>
+		virtual std::string GetBaseFolder() const;
+		/// <summary>
+		/// Set to true to create an additional sub-folder under the base folder with the name indicating the current date and time to prevent overwriting old simulation results.
+		/// </summary>
+		/// <param name="uniqueSubFolder">True if sub-folder should be created, false if results should be saved directly in the base folder.</param>
+		virtual void SetUniqueSubfolder(bool uniqueSubFolder);
+		/// <summary>
+		/// Returns true if an additional sub-folder under the base folder is created with the name indicating the current date and time to prevent overwriting old simulation results.
+		/// </summary>
+		/// <returns>True if sub-folder is created, false if results are saved directly in the base folder.</returns>
+		virtual bool IsUniqueSubfolder() const;
+		/// <summary>
+		/// Sets the algorithm used to determine when and which propensity reaction fires next. Default = Simulation::Algorithm::DirectMethod.
+		/// </summary>
+		/// <param name="algorithm">Algorithm to use.</param>
+		virtual void SetAlgorithm(Simulation::Algorithm algorithm);
+		/// <summary>
+		/// Returns the algorithm used to determine when and which propensity reaction fires next. Default = Simulation::Algorithm::DirectMethod.
+		/// </summary>
+		/// <returns>Algorithm used.</returns>
+		virtual Simulation::Algorithm GetAlgorithm() const;
+		/// <summary>
+		/// Sets the seed of the random number generator (see Simulation::SetSeed()).
+		/// </summary>
+		/// <param name="seed">Seed of the random number generator.</param>
+		virtual void SetSeed(unsigned long long seed);
+		/// <summary>
+		/// Returns the seed of the random number generator, or the seed drawn randomly for the last run if no seed was set.
+		/// </summary>
+		/// <returns>Seed of the random number generator.</returns>
+		virtual unsigned long long GetSeed() const;
+		/// <summary>
+		/// Creates a logger monitoring the state of the simulation instance and adds it to this instance. Same as
+		/// <code>
+		/// SimulationInstance instance(model);
+		/// //...
+		/// shared_pointer&lt;TaskClass&gt; logger = make_shared&lt;TaskClass&gt;(arguments...);
+		/// instance.AddLogger(logger);
+		/// </code>
+		/// </summary>
+		template<class TaskClass,
+			class... ArgumentTypes> inline
+			std::shared_ptr<TaskClass> CreateLogger(ArgumentTypes&&... arguments)
+		{
+			std::shared_ptr<TaskClass> logger = std::make_shared<TaskClass>(std::forward<ArgumentTypes>(arguments)...);
+			AddLogger(logger);
+			return logger;
+		}
+	private:
+		// Make this object be non-copyable
+		SimulationInstance(const SimulationInstance&) = delete;
+		SimulationInstance& operator=(const SimulationInstance&) = delete;
+
+		class Impl;
+		Impl* const impl_;
+	};
+}
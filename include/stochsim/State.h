@@ -10,12 +10,12 @@ namespace stochsim
 		public IState
 	{
 	public:
-		State(std::string name, size_t initialCondition) : num_(0), name_(name), initialCondition_(initialCondition)
+		State(std::string name, size_t initialCondition) : numSlot_(0), name_(name), initialCondition_(initialCondition)
 		{
 		}
 		virtual size_t Num(ISimInfo& simInfo) const override
 		{
-			return num_;
+			return num(simInfo);
 		}
 		virtual void Add(ISimInfo& simInfo, const Molecule& molecule = defaultMolecule, const Variables& variables = {}) override
 		{
@@ -27,7 +27,7 @@ namespace stochsim
 					addListener(molecule, time);
 				}
 			}
-			num_ ++;
+			num(simInfo)++;
 		}
 		virtual Molecule Remove(ISimInfo& simInfo, const Variables& variables = {}) override
 		{
@@ -39,26 +39,30 @@ namespace stochsim
 					removeListener(defaultMolecule, time);
 				}
 			}
-			num_ --;
+			num(simInfo)--;
 			return defaultMolecule;
 		}
 		virtual Molecule& Transform(ISimInfo& simInfo, const Variables& variables = {}) override
 		{
-			static Molecule molecule;
+			static thread_local Molecule molecule;
 			molecule.Reset();
 			return molecule;
 		}
-		virtual const Molecule& Peak(ISimInfo& simInfo) const
+		virtual Molecule Peak(ISimInfo& simInfo) const override
 		{
 			return defaultMolecule;
 		}
+		virtual void Compile(IModelCompiler& compiler) override
+		{
+			numSlot_ = compiler.AddMolecularNumber(*this);
+		}
 		virtual void Initialize(ISimInfo& simInfo) override
 		{
-			num_ = GetInitialCondition();
+			num(simInfo) = GetInitialCondition();
 		}
 		virtual void Uninitialize(ISimInfo& simInfo) override
 		{
-			num_ = 0;
+			num(simInfo) = 0;
 		}
 		virtual std::string GetName() const noexcept override
 		{
@@ -89,7 +93,12 @@ namespace stochsim
 			addListeners_.push_back(std::move(stateListener));
 		}
 	private:
-		size_t num_;
+		inline size_t& num(ISimInfo& simInfo) const
+		{
+			return simInfo.GetMolecularNumbers()[numSlot_];
+		}
+
+		size_t numSlot_;
 		const std::string name_;
 		size_t initialCondition_;
 		std::list<StateListener> removeListeners_;
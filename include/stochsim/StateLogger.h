@@ -3,6 +3,7 @@
 #include <vector>
 #include "stochsim_common.h"
 #include <fstream>
+#include "Checkpoint.h"
 namespace stochsim
 {
 	/// <summary>
@@ -110,6 +111,43 @@ namespace stochsim
 			}
 		}
 
+		virtual void SaveCheckpoint(ISimInfo& simInfo, CheckpointWriter& checkpoint) override
+		{
+			// Everything written until now is part of the checkpoint.
+			std::uint64_t size = 0;
+			if (file_)
+			{
+				file_->flush();
+				size = static_cast<std::uint64_t>(file_->tellp());
+			}
+			checkpoint.Write(size);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			const std::uint64_t size = checkpoint.Read<std::uint64_t>();
+			if (!shouldLog_)
+				return;
+			if (file_)
+			{
+				file_->close();
+				file_.reset();
+			}
+			std::string fileName = simInfo.GetSaveFolder();
+			fileName += "/";
+			fileName += fileName_;
+
+			// Discard everything logged after the checkpoint, and continue logging at the end.
+			TruncateFile(fileName, size);
+			file_ = std::make_unique<std::ofstream>();
+			file_->open(fileName, std::ios::out | std::ios::app);
+			if (!file_->is_open())
+			{
+				std::string errorMessage = "Could not open file ";
+				errorMessage += fileName;
+				throw std::exception(errorMessage.c_str());
+			}
+		}
+
 	private:
 		std::vector<std::shared_ptr<IState>> states_;
 		std::unique_ptr<std::ofstream> file_;
@@ -0,0 +1,324 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "stochsim_common.h"
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// A logger task which detects when the molecular numbers of its supplied states reached a steady state, i.e. are stationary, based on the values sampled every log period (see Simulation::SetLogPeriod()).
+	/// Stationarity is tested with a batch means test: the second half of all samples taken so far is split into batches, and the mean of the first half of these batches is compared to the mean of the second half,
+	/// taking the variance of the batch means into account. If the difference is below the threshold for all states in several consecutive tests, the simulation is considered stationary from the first sample in the window of
+	/// the last test on, and the time of this sample is reported as the burn-in time.
+	/// Since the test is repeated while the simulation runs, a single passing test would be a sequential multiple test, which accepts non-stationary transients far more often than the nominal error rate of a single test
+	/// (about 5% for the default threshold of two standard errors). The test is thus only repeated after the number of samples grew by a quarter, such that consecutive windows are shifted considerably, and has to pass
+	/// numConsecutivePasses times in a row. This reduces, but does not eliminate, false detections: trends which are slow compared to the fluctuations of the states, or transients which only start after the burn-in time, can still
+	/// be accepted as stationary.
+	/// Depending on the mode, the simulation is then stopped (see SimulationInstance::GetStopReason()), or continues while the mean and variance of all states are averaged over all samples after the burn-in time.
+	/// </summary>
+	class SteadyStateDetector :
+		public ILogger
+	{
+	public:
+		/// <summary>
+		/// What to do when a steady state was detected.
+		/// </summary>
+		enum class Mode
+		{
+			/// <summary>
+			/// Stop the simulation, with the mean and variance of all states being computed from the samples in the tested window.
+			/// </summary>
+			Stop,
+			/// <summary>
+			/// Continue the simulation until its end, and average the mean and variance of all states over all samples after the burn-in time.
+			/// </summary>
+			Average
+		};
+		/// <summary>
+		/// Stop reason reported when the detector stopped the simulation (see SimulationInstance::GetStopReason()).
+		/// </summary>
+		static constexpr const char* stopReason = "steady state";
+
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="mode">What to do when a steady state was detected.</param>
+		/// <param name="threshold">Maximal difference between the means of the two halves of the tested window, in units of its standard error, for which the states are considered stationary.</param>
+		/// <param name="minSamples">Minimal number of samples before the first test. At least four samples per batch are used.</param>
+		SteadyStateDetector(Mode mode = Mode::Stop, double threshold = 2, size_t minSamples = 100) : mode_(mode), threshold_(threshold), minSamples_(std::max(minSamples, 4 * numBatches)), detected_(false), burnInTime_(stochsim::inf), nextTest_(0), numPasses_(0), numAveraged_(0)
+		{
+		}
+		template <typename... T> SteadyStateDetector(Mode mode, double threshold, size_t minSamples, std::shared_ptr<IState> state, T... others) : SteadyStateDetector(mode, threshold, minSamples)
+		{
+			AddState(state, others...);
+		}
+		virtual bool WritesToDisk() const override
+		{
+			return false;
+		}
+		/// <summary>
+		/// Adds a state which has to be stationary. If no state is added, all states of the simulation have to be stationary.
+		/// </summary>
+		/// <param name="state">State to monitor.</param>
+		void AddState(std::shared_ptr<IState> state)
+		{
+			states_.push_back(std::move(state));
+		}
+		template <typename... T> void AddState(std::shared_ptr<IState> state, T... others)
+		{
+			AddState(state);
+			AddState(others...);
+		}
+		virtual void Initialize(ISimInfo& simInfo) override
+		{
+			resolveStates(simInfo);
+			detected_ = false;
+			burnInTime_ = stochsim::inf;
+			nextTest_ = minSamples_;
+			numPasses_ = 0;
+			times_.clear();
+			values_.assign(monitored_.size(), std::vector<size_t>());
+			sums_.assign(monitored_.size(), std::vector<double>(1, 0));
+			numAveraged_ = 0;
+			means_.assign(monitored_.size(), 0);
+			squares_.assign(monitored_.size(), 0);
+		}
+		virtual void WriteLog(ISimInfo& simInfo, double time) override
+		{
+			if (detected_)
+			{
+				if (mode_ == Mode::Average)
+				{
+					numAveraged_++;
+					for (size_t i = 0; i < monitored_.size(); i++)
+					{
+						average(i, static_cast<double>(monitored_[i]->Num(simInfo)));
+					}
+				}
+				return;
+			}
+			times_.push_back(time);
+			for (size_t i = 0; i < monitored_.size(); i++)
+			{
+				size_t value = monitored_[i]->Num(simInfo);
+				values_[i].push_back(value);
+				sums_[i].push_back(sums_[i].back() + value);
+			}
+			if (times_.size() < nextTest_)
+				return;
+			nextTest_ = times_.size() + std::max(times_.size() / 4, size_t(1));
+			size_t windowStart;
+			if (!isStationary(windowStart))
+			{
+				numPasses_ = 0;
+				return;
+			}
+			if (++numPasses_ < numConsecutivePasses)
+				return;
+			detected_ = true;
+			burnInTime_ = times_[windowStart];
+			// From now on, only the averages are needed.
+			numAveraged_ = times_.size() - windowStart;
+			for (size_t i = 0; i < monitored_.size(); i++)
+			{
+				for (size_t sample = windowStart; sample < values_[i].size(); sample++)
+				{
+					average(i, static_cast<double>(values_[i][sample]), sample - windowStart + 1);
+				}
+			}
+			times_.clear();
+			values_.assign(monitored_.size(), std::vector<size_t>());
+			sums_.assign(monitored_.size(), std::vector<double>(1, 0));
+			if (mode_ == Mode::Stop)
+				simInfo.Stop(stopReason);
+		}
+		virtual void Uninitialize(ISimInfo& simInfo) override
+		{
+		}
+		virtual void SaveCheckpoint(ISimInfo& simInfo, CheckpointWriter& checkpoint) override
+		{
+			checkpoint.Write(detected_);
+			checkpoint.Write(burnInTime_);
+			checkpoint.Write<std::uint64_t>(nextTest_);
+			checkpoint.Write<std::uint64_t>(numPasses_);
+			checkpoint.Write<std::uint64_t>(times_.size());
+			checkpoint.WriteArray(times_.data(), times_.size());
+			for (size_t i = 0; i < monitored_.size(); i++)
+			{
+				checkpoint.WriteArray(values_[i].data(), values_[i].size());
+			}
+			checkpoint.Write<std::uint64_t>(numAveraged_);
+			checkpoint.WriteArray(means_.data(), means_.size());
+			checkpoint.WriteArray(squares_.data(), squares_.size());
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			Initialize(simInfo);
+			detected_ = checkpoint.Read<bool>();
+			burnInTime_ = checkpoint.Read<double>();
+			nextTest_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			numPasses_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			times_.resize(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+			checkpoint.ReadArray(times_.data(), times_.size());
+			for (size_t i = 0; i < monitored_.size(); i++)
+			{
+				values_[i].resize(times_.size());
+				checkpoint.ReadArray(values_[i].data(), values_[i].size());
+				// The running sums are not stored, but recomputed.
+				sums_[i].resize(times_.size() + 1);
+				for (size_t sample = 0; sample < times_.size(); sample++)
+				{
+					sums_[i][sample + 1] = sums_[i][sample] + values_[i][sample];
+				}
+			}
+			numAveraged_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			checkpoint.ReadArray(means_.data(), means_.size());
+			checkpoint.ReadArray(squares_.data(), squares_.size());
+		}
+
+		/// <summary>
+		/// Returns true if a steady state was detected in the current or last simulation.
+		/// </summary>
+		/// <returns>True if steady state was detected.</returns>
+		bool IsSteadyState() const noexcept
+		{
+			return detected_;
+		}
+		/// <summary>
+		/// Returns the simulation time from which on the current or last simulation was found to be stationary, or stochsim::inf if no steady state was detected.
+		/// </summary>
+		/// <returns>Burn-in time.</returns>
+		double GetBurnInTime() const noexcept
+		{
+			return burnInTime_;
+		}
+		/// <summary>
+		/// Returns the names of the monitored states, in the order used by GetMean() and GetVariance().
+		/// </summary>
+		/// <returns>Names of the monitored states.</returns>
+		std::vector<std::string> GetStateNames() const
+		{
+			std::vector<std::string> names;
+			for (const auto& state : monitored_)
+			{
+				names.push_back(state->GetName());
+			}
+			return names;
+		}
+		/// <summary>
+		/// Returns the number of samples taken after the burn-in time, over which GetMean() and GetVariance() are averaged.
+		/// </summary>
+		/// <returns>Number of samples in steady state.</returns>
+		size_t GetNumSamples() const noexcept
+		{
+			return numAveraged_;
+		}
+		/// <summary>
+		/// Returns the mean molecular number of the monitored state with the given index in steady state. Only valid if a steady state was detected.
+		/// </summary>
+		/// <param name="index">Index of the state (see GetStateNames()).</param>
+		/// <returns>Mean molecular number in steady state.</returns>
+		double GetMean(size_t index) const
+		{
+			return means_[index];
+		}
+		/// <summary>
+		/// Returns the variance of the molecular number of the monitored state with the given index in steady state. Only valid if a steady state was detected.
+		/// </summary>
+		/// <param name="index">Index of the state (see GetStateNames()).</param>
+		/// <returns>Variance of the molecular number in steady state.</returns>
+		double GetVariance(size_t index) const
+		{
+			return numAveraged_ > 1 ? squares_[index] / (numAveraged_ - 1) : 0;
+		}
+	private:
+		/// <summary>
+		/// Number of batches in each half of the tested window.
+		/// </summary>
+		static constexpr size_t numBatches = 10;
+		/// <summary>
+		/// Number of consecutive tests which have to pass before a steady state is detected.
+		/// </summary>
+		static constexpr size_t numConsecutivePasses = 3;
+
+		const Mode mode_;
+		const double threshold_;
+		const size_t minSamples_;
+		std::vector<std::shared_ptr<IState>> states_;
+		// States actually monitored, i.e. states_ or all states of the simulation if none were added.
+		std::vector<std::shared_ptr<IState>> monitored_;
+		bool detected_;
+		double burnInTime_;
+		// Number of samples at which the next test is performed, and number of consecutive tests passed so far.
+		size_t nextTest_;
+		size_t numPasses_;
+
+		// Samples taken until a steady state is detected, and their running sums, starting at zero.
+		std::vector<double> times_;
+		std::vector<std::vector<size_t>> values_;
+		std::vector<std::vector<double>> sums_;
+
+		// Running mean and sum of squared deviations of all samples after the burn-in time (Welford's algorithm).
+		size_t numAveraged_;
+		std::vector<double> means_;
+		std::vector<double> squares_;
+
+		void resolveStates(ISimInfo& simInfo)
+		{
+			monitored_ = states_;
+			if (monitored_.empty())
+			{
+				for (const auto& state : simInfo.GetStates())
+				{
+					monitored_.push_back(state);
+				}
+			}
+		}
+		void average(size_t index, double value, size_t count)
+		{
+			double delta = value - means_[index];
+			means_[index] += delta / count;
+			squares_[index] += delta * (value - means_[index]);
+		}
+		void average(size_t index, double value)
+		{
+			average(index, value, numAveraged_);
+		}
+		/// <summary>
+		/// Tests if all monitored states are stationary in the second half of the samples taken so far. If so, returns true and sets windowStart to the index of the first sample of the tested window.
+		/// </summary>
+		bool isStationary(size_t& windowStart) const
+		{
+			const size_t numSamples = times_.size();
+			if (numSamples < minSamples_)
+				return false;
+			const size_t batchLength = numSamples / (4 * numBatches);
+			windowStart = numSamples - 2 * numBatches * batchLength;
+			for (const auto& sums : sums_)
+			{
+				double batchMeans[2 * numBatches];
+				double halfMeans[2] = { 0, 0 };
+				for (size_t batch = 0; batch < 2 * numBatches; batch++)
+				{
+					const size_t start = windowStart + batch * batchLength;
+					batchMeans[batch] = (sums[start + batchLength] - sums[start]) / batchLength;
+					halfMeans[batch / numBatches] += batchMeans[batch] / numBatches;
+				}
+				double squares = 0;
+				for (size_t batch = 0; batch < 2 * numBatches; batch++)
+				{
+					const double deviation = batchMeans[batch] - halfMeans[batch / numBatches];
+					squares += deviation * deviation;
+				}
+				// Standard error of the difference of the two half means, estimated from the pooled variance of the batch means.
+				const double standardError = std::sqrt(squares / (2 * numBatches - 2) * 2 / numBatches);
+				if (std::abs(halfMeans[1] - halfMeans[0]) > threshold_ * standardError)
+					return false;
+			}
+			return true;
+		}
+	};
+}
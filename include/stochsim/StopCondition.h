@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <vector>
+#include "stochsim_common.h"
+#include "expression_common.h"
+#include "ExpressionParser.h"
+#include "ExpressionHolder.h"
+namespace stochsim
+{
+	/// <summary>
+	/// A condition on the state of a simulation, e.g. "P_i == 0" or "Bl_i + Bl_s > 1000", ending the simulation early as soon as it evaluates to a value different from zero.
+	/// The condition is only re-evaluated after a reaction fired which changes at least one of the states referenced by the condition. Conditions referencing random numbers are re-evaluated after every reaction.
+	/// Conditions referencing the simulation time are re-evaluated after every reaction, too, but not in between. All conditions are evaluated once when the simulation starts.
+	/// When a condition is met, the simulation stops at the time of the reaction which changed the state, and the name of the condition is reported as the reason of the stop (see SimulationInstance::GetStopReason()).
+	/// </summary>
+	class StopCondition
+	{
+	public:
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="name">Name of the condition, reported when the condition ends the simulation.</param>
+		/// <param name="condition">Boolean expression which ends the simulation when evaluating to a value different from zero. Can reference the molecular numbers of all states of the model.</param>
+		StopCondition(std::string name, std::unique_ptr<expression::IExpression> condition) : name_(std::move(name))
+		{
+			condition_.SetExpression(std::move(condition));
+		}
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="name">Name of the condition, reported when the condition ends the simulation.</param>
+		/// <param name="condition">Boolean expression as a string, which ends the simulation when evaluating to a value different from zero. The string is parsed immediately. If parsing fails e.g. due to a syntax error,
+		/// an std::exception is thrown.</param>
+		StopCondition(std::string name, std::string condition) : name_(std::move(name))
+		{
+			expression::ExpressionParser parser;
+			condition_.SetExpression(parser.Parse(condition, false, false));
+		}
+		/// <summary>
+		/// Binds the condition to the states of the model. Called when the model is compiled.
+		/// </summary>
+		/// <param name="compiler">Model compiler.</param>
+		void Compile(IModelCompiler& compiler)
+		{
+			condition_.Compile(compiler);
+		}
+		/// <summary>
+		/// Evaluates the condition for the current state of the simulation. Only valid after compilation.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <returns>True if the condition is met, and the simulation should stop.</returns>
+		bool IsMet(ISimInfo& simInfo) const
+		{
+			return condition_(simInfo) != 0;
+		}
+		/// <summary>
+		/// Returns all states whose molecular numbers are referenced by the condition. Only valid after compilation.
+		/// </summary>
+		/// <returns>States referenced by the condition.</returns>
+		const std::vector<std::shared_ptr<IState>>& GetDependencies() const noexcept
+		{
+			return condition_.GetBoundStates();
+		}
+		/// <summary>
+		/// Returns true if the condition has to be re-evaluated after every reaction, since it references random numbers or the simulation time. Only valid after compilation.
+		/// </summary>
+		/// <returns>True if condition has to be re-evaluated after every reaction.</returns>
+		bool IsVolatile() const noexcept
+		{
+			return condition_.IsRandom() || condition_.IsTimeDependent();
+		}
+		/// <summary>
+		/// Returns the name of the condition.
+		/// </summary>
+		/// <returns>Name of the condition.</returns>
+		std::string GetName() const noexcept
+		{
+			return name_;
+		}
+	private:
+		const std::string name_;
+		ExpressionHolder condition_;
+	};
+}
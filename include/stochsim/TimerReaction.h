@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "ExpressionHolder.h"
+#include "Checkpoint.h"
 namespace stochsim
 {
 	/// <summary>
@@ -26,20 +27,12 @@ namespace stochsim
 					propertyExpressions_[i].SetExpression(std::move(propertyExpressions[i]));
 				}
 			}
-			inline void Initialize(ISimInfo& simInfo)
+			inline void Compile(IModelCompiler& compiler)
 			{
 				for (auto& propertyExpression : propertyExpressions_)
 				{
 					if (propertyExpression)
-						propertyExpression.Initialize(simInfo);
-				}
-			}
-			inline void Uninitialize(ISimInfo& simInfo)
-			{
-				for (auto& propertyExpression : propertyExpressions_)
-				{
-					if (propertyExpression)
-						propertyExpression.Uninitialize(simInfo);
+						propertyExpression.Compile(compiler);
 				}
 			}
 			inline Molecule operator() (ISimInfo& simInfo, const std::vector<Variable>& variables = {}) const
@@ -54,7 +47,7 @@ namespace stochsim
 			}
 		};
 	public:
-		TimerReaction(std::string name, double fireTime_) : fireTime_(fireTime_), name_(std::move(name)), hasFired_(false)
+		TimerReaction(std::string name, double fireTime_) : dataSlot_(0), fireTime_(fireTime_), name_(std::move(name))
 		{
 		}
 		/// <summary>
@@ -77,7 +70,7 @@ namespace stochsim
 		}
 		virtual double NextReactionTime(ISimInfo& simInfo) const override
 		{
-			return !hasFired_ ? fireTime_ : stochsim::inf;
+			return !data(simInfo).hasFired_ ? fireTime_ : stochsim::inf;
 		}
 		virtual void Fire(ISimInfo& simInfo) override
 		{
@@ -89,26 +82,27 @@ namespace stochsim
 					product.state_->Add(simInfo, molecule);
 				}
 			}
-			hasFired_ = true;
+			data(simInfo).hasFired_ = true;
 		}
 		virtual std::string GetName() const override
 		{
 			return name_;
 		}
-		virtual void Initialize(ISimInfo& simInfo) override
+		virtual void Compile(IModelCompiler& compiler) override
 		{
-			hasFired_ = false;
+			dataSlot_ = compiler.AddInstanceData(std::make_unique<InstanceData>());
 			for (auto& product : products_)
 			{
-				product.Initialize(simInfo);
+				product.Compile(compiler);
 			}
 		}
+		virtual void Initialize(ISimInfo& simInfo) override
+		{
+			data(simInfo).hasFired_ = false;
+		}
 		virtual void Uninitialize(ISimInfo& simInfo) override
 		{
-			for (auto& product : products_)
-			{
-				product.Uninitialize(simInfo);
-			}
+			// do nothing.
 		}
 
 		/// <summary>
@@ -161,7 +155,34 @@ namespace stochsim
 			products_.emplace_back(state, stochiometry, std::move(propertyExpressions));
 		}
 	private:
-		bool hasFired_;
+		/// <summary>
+		/// Data of the timer changing during a simulation run.
+		/// </summary>
+		struct InstanceData : public IInstanceData
+		{
+			InstanceData() : hasFired_(false)
+			{
+			}
+			virtual std::unique_ptr<IInstanceData> Clone() const override
+			{
+				return std::make_unique<InstanceData>(*this);
+			}
+			virtual void Save(CheckpointWriter& checkpoint) const override
+			{
+				checkpoint.Write(hasFired_);
+			}
+			virtual void Load(CheckpointReader& checkpoint) override
+			{
+				hasFired_ = checkpoint.Read<bool>();
+			}
+			bool hasFired_;
+		};
+		inline InstanceData& data(ISimInfo& simInfo) const
+		{
+			return static_cast<InstanceData&>(simInfo.GetInstanceData(dataSlot_));
+		}
+
+		size_t dataSlot_;
 		double fireTime_;
 		const std::string name_;
 		std::vector<Product> products_;
@@ -9,6 +9,13 @@
 #include <tuple>			
 #include <functional>
 #include "expression_common.h"
+#ifndef STOCHSIM_MAX_PROPERTIES
+/// <summary>
+/// Maximal number of properties a molecule can have. Can be overridden at compile time (e.g. -DSTOCHSIM_MAX_PROPERTIES=6) when models need more properties per molecule.
+/// Note that states only store the properties they actually use (see ComposedState::SetNumProperties()), such that increasing this number mainly increases the size of the molecules passed around by value.
+/// </summary>
+#define STOCHSIM_MAX_PROPERTIES 2
+#endif
 namespace stochsim
 {
 	/// <summary>
@@ -45,9 +52,10 @@ namespace stochsim
 	{
 	public:
 		/// <summary>
-		/// Number of different properties a molecule can have.
+		/// Number of different properties a molecule can have (see STOCHSIM_MAX_PROPERTIES).
 		/// </summary>
-		static constexpr size_t size_ = 2;
+		static constexpr size_t size_ = STOCHSIM_MAX_PROPERTIES;
+		static_assert(size_ > 0, "Molecules must be able to have at least one property.");
 		/// <summary>
 		/// Returns number of different properties a molecule can have. Always same as variable size_.
 		/// </summary>
@@ -62,7 +70,7 @@ namespace stochsim
 	private:
 		std::array<double, size_> properties_;
 	public: 
-		Molecule() : properties_({ 0.,0.})
+		Molecule() : properties_{}
 		{
 		};
 		Molecule(PropertyValues&& properties) : properties_(std::move(properties))
@@ -96,8 +104,66 @@ namespace stochsim
 	/// </summary>
 	const Molecule defaultMolecule;
 
-	// Forward declaration.
+	// Forward declarations.
 	class IState;
+	class CheckpointWriter;
+	class CheckpointReader;
+
+	/// <summary>
+	/// Base class of the data of a state or reaction which changes while a simulation runs, e.g. the molecular number of a state.
+	/// This data is not stored in the state or reaction itself, but in the simulation instance running the model (see ISimInfo::GetInstanceData()), such that
+	/// several simulation instances can run the same (compiled) model concurrently.
+	/// </summary>
+	class IInstanceData
+	{
+	public:
+		virtual ~IInstanceData() {};
+		/// <summary>
+		/// Creates a deep copy of this data.
+		/// </summary>
+		/// <returns>Copy of this data.</returns>
+		virtual std::unique_ptr<IInstanceData> Clone() const = 0;
+		/// <summary>
+		/// Writes this data to a checkpoint of the simulation (see SimulationInstance::SaveCheckpoint()).
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to write to.</param>
+		virtual void Save(CheckpointWriter& checkpoint) const = 0;
+		/// <summary>
+		/// Restores this data from a checkpoint of the simulation, reading exactly what Save() wrote.
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to read from.</param>
+		virtual void Load(CheckpointReader& checkpoint) = 0;
+	};
+
+	/// <summary>
+	/// Passed to all states and reactions when a model is compiled, i.e. once before the first simulation instance of the model runs. Allows states and reactions to request
+	/// slots for their instance data, and to bind the expressions they use to the states of the model.
+	/// </summary>
+	class IModelCompiler
+	{
+	public:
+		virtual ~IModelCompiler() {};
+		/// <summary>
+		/// Requests a slot for instance data. Every simulation instance of the model gets its own copy of the provided initial data, which can be retrieved by the
+		/// returned slot with ISimInfo::GetInstanceData().
+		/// </summary>
+		/// <param name="initialData">Initial value of the instance data.</param>
+		/// <returns>Slot of the instance data.</returns>
+		virtual size_t AddInstanceData(std::unique_ptr<IInstanceData> initialData) = 0;
+		/// <summary>
+		/// Requests a slot for the molecular number of the given state in the flat array of the molecular numbers of all states (see ISimInfo::GetMolecularNumbers()).
+		/// For states storing their molecular number in such a slot, the simulation computes the propensities of mass action reactions directly from this array, without calling IState::Num().
+		/// Every state should request at most one slot. The initial value of the slot is zero.
+		/// </summary>
+		/// <param name="state">State whose molecular number is stored in the slot.</param>
+		/// <returns>Slot of the molecular number.</returns>
+		virtual size_t AddMolecularNumber(const IState& state) = 0;
+		/// <summary>
+		/// Returns a collection of all states defined in the model.
+		/// </summary>
+		/// <returns>States defined in the model.</returns>
+		virtual const Collection<std::shared_ptr<IState>> GetStates() const = 0;
+	};
 
 	/// <summary>
 	/// Provides information about the current global state of the simulation, e.g. the current simulation time.
@@ -134,6 +200,12 @@ namespace stochsim
 		/// <returns></returns>
 		virtual double Rand() = 0;
 		/// <summary>
+		/// Generates an exponentially distributed random double number with rate one, e.g. to sample the waiting time until the next reaction. Dividing the number by a propensity
+		/// gives the waiting time for this propensity. Faster than, but equivalent to, -log(Rand()).
+		/// </summary>
+		/// <returns></returns>
+		virtual double RandExponential() = 0;
+		/// <summary>
 		/// Returns the folder under which the results of the simulation should be saved.
 		/// </summary>
 		/// <returns>Folder where simulation results are saved.</returns>
@@ -148,6 +220,23 @@ namespace stochsim
 		/// </summary>
 		/// <returns>States defined in the simulation.</returns>
 		virtual const Collection<std::shared_ptr<IState>> GetStates() const = 0;
+		/// <summary>
+		/// Returns the instance data stored in the given slot (see IModelCompiler::AddInstanceData()) for the currently running simulation instance.
+		/// </summary>
+		/// <param name="slot">Slot of the instance data.</param>
+		/// <returns>Instance data.</returns>
+		virtual IInstanceData& GetInstanceData(size_t slot) = 0;
+		/// <summary>
+		/// Returns the flat array of the molecular numbers of all states which requested a slot in it (see IModelCompiler::AddMolecularNumber()) for the currently running simulation instance.
+		/// </summary>
+		/// <returns>Molecular numbers, indexed by slot.</returns>
+		virtual size_t* GetMolecularNumbers() = 0;
+		/// <summary>
+		/// Ends the simulation early, after the reaction currently being simulated, e.g. because a logger detected that the simulation reached a steady state. The reason is reported by SimulationInstance::GetStopReason().
+		/// Ignored if the simulation already stopped, or if it is not running, e.g. while it is being started or finished.
+		/// </summary>
+		/// <param name="reason">Reason why the simulation stopped.</param>
+		virtual void Stop(const std::string& reason) = 0;
 	};
 
 	/// <summary>
@@ -175,7 +264,7 @@ namespace stochsim
 		/// </summary>
 		/// <param name="simInfo">Simulation context.</param>
 		/// <returns>Arbitrary molecule.</returns>
-		virtual const Molecule& Peak(ISimInfo& simInfo) const = 0;
+		virtual Molecule Peak(ISimInfo& simInfo) const = 0;
 		/// <summary>
 		/// Increases the value of the state by the given number. Typically called by the simulation as a result of a reaction firing, with this state being a product of the reaction.
 		/// </summary>
@@ -200,6 +289,22 @@ namespace stochsim
 		/// <returns>Molecule which can be transformed.</returns>
 		virtual Molecule& Transform(ISimInfo& simInfo, const Variables& variables = {}) = 0;
 		/// <summary>
+		/// Called after the molecules returned by Transform() since the last call were transformed, and before any other method of the state is called. States which do not store their molecules
+		/// directly (e.g. since they store each property in a separate array) have to write the transformed molecules back. Default implementation does nothing.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		virtual void CommitTransform(ISimInfo& simInfo)
+		{
+		}
+		/// <summary>
+		/// Called once when the model is compiled, before any simulation instance of the model is initialized. States keeping data which changes during a simulation run
+		/// (e.g. their molecular number) should request instance data slots here, instead of storing this data themselves. Default implementation does nothing.
+		/// </summary>
+		/// <param name="compiler">Model compiler.</param>
+		virtual void Compile(IModelCompiler& compiler)
+		{
+		}
+		/// <summary>
 		/// Called by the simulation before the simulation starts. Should ensure that e.g. the current value of the state equals the initial condition.
 		/// </summary>
 		/// <param name="simInfo">Simulation context</param>
@@ -235,6 +340,14 @@ namespace stochsim
 	public:
 		virtual ~IPropensityReaction() {};
 		/// <summary>
+		/// Called once when the model is compiled, before any simulation instance of the model is initialized. Reactions keeping data which changes during a simulation run should
+		/// request instance data slots here, instead of storing this data themselves, and should bind the expressions they evaluate. Default implementation does nothing.
+		/// </summary>
+		/// <param name="compiler">Model compiler.</param>
+		virtual void Compile(IModelCompiler& compiler)
+		{
+		}
+		/// <summary>
 		/// Called by the simulation before the simulation starts. Should ensure that the reaction is at a consistent state.
 		/// </summary>
 		/// <param name="simInfo">Simulation context</param>
@@ -272,6 +385,14 @@ namespace stochsim
 	public:
 		virtual ~IEventReaction() {}
 		/// <summary>
+		/// Called once when the model is compiled, before any simulation instance of the model is initialized. Reactions keeping data which changes during a simulation run should
+		/// request instance data slots here, instead of storing this data themselves, and should bind the expressions they evaluate. Default implementation does nothing.
+		/// </summary>
+		/// <param name="compiler">Model compiler.</param>
+		virtual void Compile(IModelCompiler& compiler)
+		{
+		}
+		/// <summary>
 		/// Called by the simulation before the simulation starts. Should ensure that the reaction is at a consistent state.
 		/// </summary>
 		/// <param name="simInfo">Simulation context</param>
@@ -327,6 +448,25 @@ namespace stochsim
 		/// </summary>
 		/// <returns>True if anything is written to the disk.</returns>
 		virtual bool WritesToDisk() const  = 0;
+		/// <summary>
+		/// Called when a checkpoint of the running simulation is saved (see SimulationInstance::SaveCheckpoint()). Should write everything required to continue logging when the checkpoint is restored,
+		/// e.g. the current size of the log file. Default implementation writes nothing.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="checkpoint">Checkpoint to write to.</param>
+		virtual void SaveCheckpoint(ISimInfo& simInfo, CheckpointWriter& checkpoint)
+		{
+		}
+		/// <summary>
+		/// Called instead of Initialize() when a simulation is restored from a checkpoint. Should read exactly what SaveCheckpoint() wrote, and continue logging where the logger was when the checkpoint was saved,
+		/// e.g. by discarding everything written to the log file afterwards. Default implementation calls Initialize().
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="checkpoint">Checkpoint to read from.</param>
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint)
+		{
+			Initialize(simInfo);
+		}
 	};
 
 	/// <summary>
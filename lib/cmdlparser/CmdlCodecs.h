@@ -84,6 +84,10 @@ namespace cmdlparser
 			{
 				*tokenID = TOKEN_MODEL_NAME;
 			}
+			else if (name == "stop")
+			{
+				*tokenID = TOKEN_STOP;
+			}
 			else
 			{
 				std::stringstream errorMessage;
@@ -2,6 +2,8 @@
 #include <unordered_map>
 #include <memory>
 #include <sstream>
+#include <vector>
+#include <utility>
 #include "expression_common.h"
 #include "NumberExpression.h"
 namespace cmdlparser
@@ -13,6 +15,7 @@ namespace cmdlparser
 		typedef std::unordered_map<expression::identifier, std::unique_ptr<expression::IFunctionHolder>> function_collection;
 		typedef std::unordered_map<expression::identifier, std::unique_ptr<ReactionDefinition>> reaction_collection;
 		typedef std::unordered_map<expression::identifier, std::unique_ptr<ChoiceDefinition>> choice_collection;
+		typedef std::vector<std::pair<expression::identifier, std::unique_ptr<expression::IExpression>>> stop_condition_collection;
 		typedef std::function<void(expression::identifier)> include_file_callback;
 	public:
 		CmdlParseTree() : defaultFunctions_(expression::makeDefaultFunctions())
@@ -79,6 +82,33 @@ namespace cmdlparser
 			return nameI;
 		}
 
+		void CreateStopCondition(std::unique_ptr<expression::IExpression> condition)
+		{
+			std::stringstream name;
+			name << "stop_" << (stopConditions_.size() + 1);
+			auto nameC = name.str();
+			auto nameI = expression::identifier(nameC.begin(), nameC.end());
+			CreateStopCondition(nameI, std::move(condition));
+		}
+		/// <summary>
+		/// Creates a condition ending the simulation early. Stop conditions are kept in the order of their definition, such that the first one met is reported if several are met at once.
+		/// Redefining a stop condition with the same name replaces its condition.
+		/// </summary>
+		/// <param name="name">Name of the stop condition.</param>
+		/// <param name="condition">Condition.</param>
+		void CreateStopCondition(expression::identifier name, std::unique_ptr<expression::IExpression> condition)
+		{
+			for (auto& stopCondition : stopConditions_)
+			{
+				if (stopCondition.first == name)
+				{
+					stopCondition.second = std::move(condition);
+					return;
+				}
+			}
+			stopConditions_.emplace_back(std::move(name), std::move(condition));
+		}
+
 		void IncludeFile(expression::identifier file)
 		{
 			callback_(file);
@@ -211,6 +241,10 @@ namespace cmdlparser
 		{
 			return choices_;
 		}
+		const stop_condition_collection& GetStopConditions()
+		{
+			return stopConditions_;
+		}
 	private:
 		variable_collection finalVariables_;
 		variable_collection variables_;
@@ -219,6 +253,7 @@ namespace cmdlparser
 		function_collection defaultFunctions_;
 		reaction_collection reactions_;
 		choice_collection choices_;
+		stop_condition_collection stopConditions_;
 		include_file_callback callback_;
 	};
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "Choice.h"
 #include "PropensityReaction.h"
 #include "DelayReaction.h"
+#include "StopCondition.h"
 #include "NumberExpression.h"
 #include "CmdlCodecs.h" 
 
@@ -62,10 +63,10 @@ namespace cmdlparser
 				type_composed,
 				type_choice
 			};
-			state_definition() noexcept: type_(type_simple)
+			state_definition() noexcept: type_(type_simple), numProperties_(0)
 			{
 			}
-			state_definition(type type) noexcept : type_(type)
+			state_definition(type type) noexcept : type_(type), numProperties_(0)
 			{
 			}
 			bool require_type(type type) noexcept
@@ -90,7 +91,14 @@ namespace cmdlparser
 						return false;
 				}
 			}
+			// Marks the property with the given index as used, such that the state stores it for each of its molecules.
+			void use_property(size_t index) noexcept
+			{
+				if (index >= numProperties_)
+					numProperties_ = index + 1;
+			}
 			type type_;
+			size_t numProperties_;
 		};
 		// get all state names used in reactions.
 		std::unordered_map<expression::identifier, state_definition> states;
@@ -105,9 +113,10 @@ namespace cmdlparser
 				// define state if yet not existent.
 				states[elem.first];
 
-				for (auto& expression : elem.second->GetPropertyExpressions())
+				auto& expressions = elem.second->GetPropertyExpressions();
+				for (size_t p = 0; p < expressions.size(); p++)
 				{
-					if (expression)
+					if (expressions[p])
 					{
 						if (!states[elem.first].require_type(state_definition::type_composed))
 						{
@@ -115,8 +124,7 @@ namespace cmdlparser
 							errorMessage << "Cannot initialize state '" << elem.first << "': In one reaction it is used as the species having properties, and in another as a choice, which is invalid.";
 							throw std::exception(errorMessage.str().c_str());
 						}
-						else
-							break;
+						states[elem.first].use_property(p);
 					}
 				}		
 			} 
@@ -124,9 +132,10 @@ namespace cmdlparser
 			{
 				// define state if yet not existent.
 				states[elem.first];
-				for (auto& expression : elem.second->GetPropertyExpressions())
+				auto& expressions = elem.second->GetPropertyExpressions();
+				for (size_t p = 0; p < expressions.size(); p++)
 				{
-					if (expression)
+					if (expressions[p])
 					{
 						if (!states[elem.first].require_type(state_definition::type_composed))
 						{
@@ -134,8 +143,7 @@ namespace cmdlparser
 							errorMessage << "Cannot initialize state '" << elem.first << "': In one reaction it is used as the species having properties, and in another as a choice, which is invalid.";
 							throw std::exception(errorMessage.str().c_str());
 						}
-						else
-							break;
+						states[elem.first].use_property(p);
 					}
 				}
 			}
@@ -154,9 +162,10 @@ namespace cmdlparser
 					errorMessage << "Cannot initialize state '" << name << "': In one reaction it is used as the species determining the delay of a reaction and in another as a choice, which is invalid.";
 					throw std::exception(errorMessage.str().c_str());
 				}
-				for (auto& propertyName : elem.second->GetPropertyNames())
+				auto& propertyNames = elem.second->GetPropertyNames();
+				for (size_t p = 0; p < propertyNames.size(); p++)
 				{
-					if (!propertyName.empty())
+					if (!propertyNames[p].empty())
 					{
 						if (!states[elem.first].require_type(state_definition::type_composed))
 						{
@@ -164,8 +173,7 @@ namespace cmdlparser
 							errorMessage << "Cannot initialize state '" << elem.first << "': In one reaction it is used as the species having properties, and in another as a choice, which is invalid.";
 							throw std::exception(errorMessage.str().c_str());
 						}
-						else
-							break;
+						states[elem.first].use_property(p);
 					}
 				}
 			}
@@ -174,9 +182,10 @@ namespace cmdlparser
 				// define state if yet not existent, or get it if already existent.
 				auto name = elem.first;
 				state_definition& state = states[name];
-				for (auto& expression : elem.second->GetPropertyExpressions())
+				auto& expressions = elem.second->GetPropertyExpressions();
+				for (size_t p = 0; p < expressions.size(); p++)
 				{
-					if (expression)
+					if (expressions[p])
 					{
 						if (!states[elem.first].require_type(state_definition::type_composed))
 						{
@@ -184,8 +193,7 @@ namespace cmdlparser
 							errorMessage << "Cannot initialize state '" << elem.first << "': In one reaction it is used as the species having properties, and in another as a choice, which is invalid.";
 							throw std::exception(errorMessage.str().c_str());
 						}
-						else
-							break;
+						states[elem.first].use_property(p);
 					}
 				}
 			}
@@ -208,7 +216,7 @@ namespace cmdlparser
 			if (state.second.type_ == state_definition::type_simple)
 				sim.CreateState<stochsim::State>(state.first, static_cast<size_t>(initialCondition + 0.5));
 			else if (state.second.type_ == state_definition::type_composed)
-				sim.CreateState<stochsim::ComposedState>(state.first, static_cast<size_t>(initialCondition + 0.5));
+				sim.CreateState<stochsim::ComposedState>(state.first, static_cast<size_t>(initialCondition + 0.5), 1000, state.second.numProperties_);
 			else
 			{
 				std::stringstream errorMessage;
@@ -234,14 +242,18 @@ namespace cmdlparser
 			return nullptr;
 		};
 
-		// create choices in order of definition
+		// create all choices before adding their products, since the products of a choice might be other (nested) choices.
 		for (auto& choice : parseTree.GetChoices())
 		{
 			auto condition = choice.second->GetCondition()->Simplify(variableRegister);
 			condition->Bind(functionRegister);
 			condition = condition->Simplify(variableRegister);
 
-			auto choiceState = sim.CreateState<stochsim::Choice>(choice.first, std::move(condition));
+			sim.CreateState<stochsim::Choice>(choice.first, std::move(condition));
+		}
+		for (auto& choice : parseTree.GetChoices())
+		{
+			auto choiceState = std::static_pointer_cast<stochsim::Choice>(sim.GetState(choice.first));
 			for (auto& elem : *choice.second->GetComponentsIfTrue())
 			{
 				choiceState->AddProductIfTrue(sim.GetState(elem.first), elem.second->GetStochiometry(), std::move(elem.second->GetPropertyExpressions()));
@@ -315,9 +327,77 @@ namespace cmdlparser
 						reaction->AddProduct(sim.GetState(component.first), component.second->GetStochiometry(), std::move(component.second->GetPropertyExpressions()));
 					}
 				}
+				auto weightDef = reactionDefinition.second->GetSpecifiers()->GetWeight();
+				if (weightDef)
+				{
+					// The weighted species is the reactant, modifier or transformee whose property names are referenced by the weight. If the weight does not reference any property names,
+					// the reaction must have only one such species.
+					std::vector<std::pair<expression::identifier, const std::array<expression::identifier, stochsim::Molecule::size_>*>> candidates;
+					for (auto& component : *reactionDefinition.second->GetReactants())
+					{
+						candidates.emplace_back(component.first, &component.second->GetPropertyNames());
+					}
+					for (auto& component : *reactionDefinition.second->GetProducts())
+					{
+						if (component.second->IsModifier())
+							candidates.emplace_back(component.first, &component.second->GetPropertyNames());
+					}
+					std::string weighted;
+					auto weightRegister = [&candidates, &weighted, &variableRegister](const expression::identifier variableName) -> std::unique_ptr<expression::IExpression>
+					{
+						for (auto& candidate : candidates)
+						{
+							for (auto& propertyName : *candidate.second)
+							{
+								if (propertyName == variableName)
+								{
+									if (!weighted.empty() && weighted != candidate.first)
+									{
+										std::stringstream errorMessage;
+										errorMessage << "The weight references properties of both " << weighted << " and " << candidate.first << ", but can only depend on the properties of one species.";
+										throw std::exception(errorMessage.str().c_str());
+									}
+									weighted = candidate.first;
+									return nullptr;
+								}
+							}
+						}
+						return variableRegister(variableName);
+					};
+					std::unique_ptr<expression::IExpression> weight;
+					try
+					{
+						weight = weightDef->Simplify(weightRegister);
+						weight->Bind(functionRegister);
+						weight = weight->Simplify(weightRegister);
+					}
+					catch (const std::exception& ex)
+					{
+						std::stringstream errorMessage;
+						errorMessage << "Invalid weight of reaction " << reactionDefinition.first << ": " << ex.what();
+						throw std::exception(errorMessage.str().c_str());
+					}
+					if (weighted.empty())
+					{
+						if (candidates.size() != 1)
+						{
+							std::stringstream errorMessage;
+							errorMessage << "The weight of reaction " << reactionDefinition.first << " does not reference the properties of any species, and the reaction has more than one reactant, modifier or transformee. Cannot determine which species is weighted.";
+							throw std::exception(errorMessage.str().c_str());
+						}
+						weighted = candidates.front().first;
+					}
+					reaction->SetWeight(sim.GetState(weighted), std::move(weight));
+				}
 			}
 			else if (delayDef)
 			{
+				if (reactionDefinition.second->GetSpecifiers()->HasWeight())
+				{
+					std::stringstream errorMessage;
+					errorMessage << "Reaction " << reactionDefinition.first << " is a delay reaction, which cannot have a weight.";
+					throw std::exception(errorMessage.str().c_str());
+				}
 				auto delay = parseTree.GetExpressionValue(delayDef);
 				auto& reactants = *reactionDefinition.second->GetReactants();
 				if (reactants.GetNumComponents() != 1)
@@ -369,6 +449,15 @@ namespace cmdlparser
 				}
 			}
 		}
+
+		// Create stop conditions in order of definition
+		for (auto& stopCondition : parseTree.GetStopConditions())
+		{
+			auto condition = stopCondition.second->Simplify(variableRegister);
+			condition->Bind(functionRegister);
+			condition = condition->Simplify(variableRegister);
+			sim.CreateStopCondition(stopCondition.first, std::move(condition));
+		}
 	}
 
 	cmdlparser::CmdlParser::CmdlParser() noexcept
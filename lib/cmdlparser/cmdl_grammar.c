@@ -122,29 +122,29 @@ using namespace cmdlparser;
 #endif
 /************* Begin control #defines *****************************************/
 #define YYCODETYPE unsigned char
-#define YYNOCODE 56
+#define YYNOCODE 57
 #define YYACTIONTYPE unsigned short int
 #define cmdl_internal_ParseTOKENTYPE TerminalSymbol*
 typedef union {
   int yyinit;
   cmdl_internal_ParseTOKENTYPE yy0;
-  ReactionRightSide* yy5;
-  ReactionLeftComponent* yy14;
-  ReactionSpecifiers* yy29;
-  MoleculePropertyExpressions* yy30;
-  ConjunctionExpression* yy45;
-  ProductExpression* yy50;
-  IExpression* yy64;
-  ConditionalExpression* yy73;
-  ReactionRightComponent* yy77;
-  SumExpression* yy78;
-  DisjunctionExpression* yy87;
-  ReactionLeftSide* yy96;
-  ReactionSpecifier* yy97;
-  identifier* yy100;
-  FunctionArguments* yy103;
-  MoleculePropertyNames* yy110;
-  int yy111;
+  ReactionLeftComponent* yy6;
+  ReactionLeftSide* yy8;
+  MoleculePropertyNames* yy18;
+  ReactionRightComponent* yy25;
+  MoleculePropertyExpressions* yy29;
+  ReactionRightSide* yy31;
+  ConditionalExpression* yy35;
+  identifier* yy46;
+  ProductExpression* yy52;
+  SumExpression* yy56;
+  ConjunctionExpression* yy61;
+  ReactionSpecifier* yy74;
+  IExpression* yy80;
+  ReactionSpecifiers* yy85;
+  FunctionArguments* yy107;
+  DisjunctionExpression* yy109;
+  int yy113;
 } YYMINORTYPE;
 #ifndef YYSTACKDEPTH
 #define YYSTACKDEPTH 100
@@ -153,18 +153,18 @@ typedef union {
 #define cmdl_internal_ParseARG_PDECL ,CmdlParseTree* parseTree
 #define cmdl_internal_ParseARG_FETCH CmdlParseTree* parseTree = yypParser->parseTree
 #define cmdl_internal_ParseARG_STORE yypParser->parseTree = parseTree
-#define YYERRORSYMBOL 32
-#define YYERRSYMDT yy111
-#define YYNSTATE             126
-#define YYNRULE              83
-#define YY_MAX_SHIFT         125
-#define YY_MIN_SHIFTREDUCE   162
-#define YY_MAX_SHIFTREDUCE   244
-#define YY_MIN_REDUCE        245
-#define YY_MAX_REDUCE        327
-#define YY_ERROR_ACTION      328
-#define YY_ACCEPT_ACTION     329
-#define YY_NO_ACTION         330
+#define YYERRORSYMBOL 33
+#define YYERRSYMDT yy113
+#define YYNSTATE             133
+#define YYNRULE              86
+#define YY_MAX_SHIFT         132
+#define YY_MIN_SHIFTREDUCE   172
+#define YY_MAX_SHIFTREDUCE   257
+#define YY_MIN_REDUCE        258
+#define YY_MAX_REDUCE        343
+#define YY_ERROR_ACTION      344
+#define YY_ACCEPT_ACTION     345
+#define YY_NO_ACTION         346
 /************* End control #defines *******************************************/
 
 /* Define the yytestcase() macro to be a no-op if is not already defined
@@ -236,226 +236,244 @@ typedef union {
 **  yy_default[]       Default action for each state.
 **
 *********** Begin parsing tables **********************************************/
-#define YY_ACTTAB_COUNT (845)
+#define YY_ACTTAB_COUNT (927)
 static const YYACTIONTYPE yy_action[] = {
- /*     0 */    49,   42,   41,   39,   38,   37,   36,   35,   34,   46,
- /*    10 */    45,   44,   43,   40,   44,   43,   40,  125,  206,  329,
- /*    20 */     1,   49,   42,   41,   39,   38,   37,   36,   35,   34,
- /*    30 */    21,   45,   10,   43,   40,   28,  200,  201,  109,   29,
- /*    40 */   125,  166,   25,  112,   47,   49,   42,   41,   39,   38,
- /*    50 */    37,   36,   35,   34,   46,   45,   44,   43,   40,   12,
- /*    60 */    12,  114,   16,  116,   19,  198,   49,   42,   41,   39,
- /*    70 */    38,   37,   36,   35,   34,   46,   45,   44,   43,   40,
- /*    80 */    49,   42,   41,   39,   38,   37,   36,   35,   34,   46,
- /*    90 */    45,   44,   43,   40,  297,   22,   22,  236,   56,  233,
- /*   100 */   231,   25,  219,  296,   49,   42,   41,   39,   38,   37,
- /*   110 */    36,   35,   34,   46,   45,   44,   43,   40,  106,  237,
- /*   120 */   110,   56,   14,   40,  167,  217,  296,   49,   42,   41,
- /*   130 */    39,   38,   37,   36,   35,   34,   46,   45,   44,   43,
- /*   140 */    40,  107,  322,   88,   70,  162,  252,  256,  261,  266,
- /*   150 */   269,  322,  322,   97,    9,   51,  165,  291,   48,  199,
- /*   160 */    16,  322,  247,  235,  322,   50,  247,   49,   42,   41,
- /*   170 */    39,   38,   37,   36,   35,   34,   46,   45,   44,   43,
- /*   180 */    40,    4,   42,   41,   39,   38,   37,   36,   35,   34,
- /*   190 */    46,   45,   44,   43,   40,   49,   42,   41,   39,   38,
- /*   200 */    37,   36,   35,   34,   21,   45,   10,   43,   40,   49,
- /*   210 */    42,   41,   39,   38,   37,   36,   35,   34,   23,   45,
- /*   220 */    13,   43,   40,   49,   42,   41,   39,   38,   37,   36,
- /*   230 */    35,   34,  247,   45,   13,   43,   40,   49,   42,   41,
- /*   240 */    39,   38,   37,   36,   35,   34,  247,   45,   10,   43,
- /*   250 */    40,  247,   41,   39,   38,   37,   36,   35,   34,   46,
- /*   260 */    45,   44,   43,   40,   39,   38,   37,   36,   35,   34,
- /*   270 */    46,   45,   44,   43,   40,  328,  328,  328,  328,  328,
- /*   280 */   328,   46,   45,   44,   43,   40,  321,    9,    9,   87,
- /*   290 */    67,   11,  252,  256,  261,  266,  269,  247,   28,    3,
- /*   300 */    96,    6,   29,  125,  166,  305,    2,   47,  247,  247,
- /*   310 */   247,  247,   11,    9,  247,   55,  111,   53,   87,   67,
- /*   320 */   247,  252,  256,  261,  266,  269,    7,    5,  247,  101,
- /*   330 */   247,  299,   87,   58,  305,  252,  256,  261,  266,  269,
- /*   340 */   247,   16,  247,  102,    8,   17,  299,   52,  305,   87,
- /*   350 */    67,  247,  252,  256,  261,  266,  269,  247,  247,  247,
- /*   360 */   100,  247,  247,   99,   64,  305,  252,  256,  261,  266,
- /*   370 */   269,  247,  247,  247,  247,   95,  285,   99,   64,  247,
- /*   380 */   252,  256,  261,  266,  269,  247,  247,  247,  247,   98,
- /*   390 */   285,  247,  247,  247,   90,   70,  247,  252,  256,  261,
- /*   400 */   266,  269,  247,  247,  105,  247,  247,  247,  291,   87,
- /*   410 */    75,  247,  252,  256,  261,  266,  269,   87,  113,  247,
- /*   420 */   252,  256,  261,  266,  269,  306,  293,  247,   44,   43,
- /*   430 */    40,   90,   74,  317,  252,  256,  261,  266,  269,  247,
- /*   440 */   247,  293,  247,   99,   64,  292,  252,  256,  261,  266,
- /*   450 */   269,  247,  247,  247,   90,  115,  286,  252,  256,  261,
- /*   460 */   266,  269,  247,  247,  247,  247,  124,   69,  303,  252,
- /*   470 */   256,  261,  266,  269,  247,  247,  247,  247,  247,  247,
- /*   480 */   247,  124,   69,  103,  252,  256,  261,  266,  269,  124,
- /*   490 */    72,  108,  252,  256,  261,  266,  269,   28,  104,  247,
- /*   500 */   247,   29,  125,  166,   20,  247,   47,  247,  247,  247,
- /*   510 */   247,  247,  247,  247,   54,  124,   60,  247,  252,  256,
- /*   520 */   261,  266,  269,  124,   57,  247,  252,  256,  261,  266,
- /*   530 */   269,  124,   65,  247,  252,  256,  261,  266,  269,  247,
- /*   540 */   124,   66,  247,  252,  256,  261,  266,  269,  124,   86,
- /*   550 */   247,  252,  256,  261,  266,  269,  124,   68,  247,  252,
- /*   560 */   256,  261,  266,  269,  124,   89,  247,  252,  256,  261,
- /*   570 */   266,  269,  124,   59,  247,  252,  256,  261,  266,  269,
- /*   580 */   124,   71,  247,  252,  256,  261,  266,  269,  124,   91,
- /*   590 */   247,  252,  256,  261,  266,  269,  124,  117,  247,  252,
- /*   600 */   256,  261,  266,  269,  124,  118,  247,  252,  256,  261,
- /*   610 */   266,  269,  124,  119,  247,  252,  256,  261,  266,  269,
- /*   620 */   124,   78,  247,  252,  256,  261,  266,  269,  124,   76,
- /*   630 */   247,  252,  256,  261,  266,  269,  124,  120,  247,  252,
- /*   640 */   256,  261,  266,  269,  124,   92,  247,  252,  256,  261,
- /*   650 */   266,  269,  124,   79,  247,  252,  256,  261,  266,  269,
- /*   660 */   124,   80,  247,  252,  256,  261,  266,  269,  124,   81,
- /*   670 */   247,  252,  256,  261,  266,  269,  124,   82,  247,  252,
- /*   680 */   256,  261,  266,  269,  124,   83,  247,  252,  256,  261,
- /*   690 */   266,  269,  124,   84,  247,  252,  256,  261,  266,  269,
- /*   700 */   124,  121,  247,  252,  256,  261,  266,  269,  124,   85,
- /*   710 */   247,  252,  256,  261,  266,  269,  124,   77,  247,  252,
- /*   720 */   256,  261,  266,  269,  124,  122,  247,  252,  256,  261,
- /*   730 */   266,  269,  124,  123,  247,  252,  256,  261,  266,  269,
- /*   740 */   124,   93,  247,  252,  256,  261,  266,  269,  124,   94,
- /*   750 */   247,  252,  256,  261,  266,  269,  124,   62,  247,  252,
- /*   760 */   256,  261,  266,  269,  124,   73,  247,  252,  256,  261,
- /*   770 */   266,  269,  124,   61,  247,  252,  256,  261,  266,  269,
- /*   780 */   124,   63,  247,  252,  256,  261,  266,  269,  307,  247,
- /*   790 */    44,   43,   40,  247,  247,  247,  299,  307,   28,  247,
- /*   800 */   307,  307,   29,  125,  166,   18,   16,   47,  247,  247,
- /*   810 */    28,  299,   52,  247,   29,  125,  166,   28,  247,   47,
- /*   820 */   247,   29,  125,  166,   24,  247,   47,   55,  313,  247,
- /*   830 */   247,  247,  247,  247,  247,  247,  247,  313,   16,  247,
- /*   840 */   313,  313,  247,  247,   15,
+ /*     0 */   248,   52,   45,   44,   42,   41,   40,   39,   38,   37,
+ /*    10 */    49,   48,   47,   46,   43,  249,   52,   45,   44,   42,
+ /*    20 */    41,   40,   39,   38,   37,   49,   48,   47,   46,   43,
+ /*    30 */    52,   45,   44,   42,   41,   40,   39,   38,   37,   49,
+ /*    40 */    48,   47,   46,   43,   47,   46,   43,  132,  216,  345,
+ /*    50 */     1,   52,   45,   44,   42,   41,   40,   39,   38,   37,
+ /*    60 */    49,   48,   47,   46,   43,   53,  210,   25,  116,  217,
+ /*    70 */    19,  244,   52,   45,   44,   42,   41,   40,   39,   38,
+ /*    80 */    37,   24,   48,   10,   46,   43,   31,  211,  119,   12,
+ /*    90 */    32,  132,  176,   28,  121,   50,   52,   45,   44,   42,
+ /*   100 */    41,   40,   39,   38,   37,   49,   48,   47,   46,   43,
+ /*   110 */    12,   16,  311,   17,  123,  247,  208,   52,   45,   44,
+ /*   120 */    42,   41,   40,   39,   38,   37,   49,   48,   47,   46,
+ /*   130 */    43,   52,   45,   44,   42,   41,   40,   39,   38,   37,
+ /*   140 */    49,   48,   47,   46,   43,   31,  175,  117,   51,   32,
+ /*   150 */   101,  176,   28,  250,   50,   52,   45,   44,   42,   41,
+ /*   160 */    40,   39,   38,   37,   49,   48,   47,   46,   43,   25,
+ /*   170 */    59,   14,   43,  242,  230,  177,   54,  310,   52,   45,
+ /*   180 */    44,   42,   41,   40,   39,   38,   37,   49,   48,   47,
+ /*   190 */    46,   43,  113,  338,   94,   76,  172,  265,  269,  274,
+ /*   200 */   279,  282,  338,  338,  104,    9,   59,  209,  305,   16,
+ /*   210 */   228,   53,  338,  260,  246,  338,  260,  260,   52,   45,
+ /*   220 */    44,   42,   41,   40,   39,   38,   37,   49,   48,   47,
+ /*   230 */    46,   43,    4,   45,   44,   42,   41,   40,   39,   38,
+ /*   240 */    37,   49,   48,   47,   46,   43,   52,   45,   44,   42,
+ /*   250 */    41,   40,   39,   38,   37,   24,   48,   10,   46,   43,
+ /*   260 */    52,   45,   44,   42,   41,   40,   39,   38,   37,   26,
+ /*   270 */    48,   13,   46,   43,   52,   45,   44,   42,   41,   40,
+ /*   280 */    39,   38,   37,  260,   48,   13,   46,   43,   52,   45,
+ /*   290 */    44,   42,   41,   40,   39,   38,   37,  260,   48,   10,
+ /*   300 */    46,   43,  260,   44,   42,   41,   40,   39,   38,   37,
+ /*   310 */    49,   48,   47,   46,   43,   42,   41,   40,   39,   38,
+ /*   320 */    37,   49,   48,   47,   46,   43,  344,  344,  344,  344,
+ /*   330 */   344,  344,   49,   48,   47,   46,   43,  337,    9,    9,
+ /*   340 */    93,   73,  260,  265,  269,  274,  279,  282,  310,   31,
+ /*   350 */     3,  103,    6,   32,  132,  176,  319,  307,   50,   47,
+ /*   360 */    46,   43,  260,  114,   11,    9,   58,  118,   56,   20,
+ /*   370 */    93,   73,  307,  265,  269,  274,  279,  282,    7,    2,
+ /*   380 */   260,  108,  260,  313,   93,   64,  319,  265,  269,  274,
+ /*   390 */   279,  282,  260,   16,  260,  109,    8,   18,  313,   55,
+ /*   400 */   319,   93,   73,  260,  265,  269,  274,  279,  282,  260,
+ /*   410 */   260,  260,  107,  260,   11,  260,  260,  319,  313,  106,
+ /*   420 */    70,  260,  265,  269,  274,  279,  282,  260,   16,    5,
+ /*   430 */   260,  102,  298,  313,   55,  106,   70,  260,  265,  269,
+ /*   440 */   274,  279,  282,  260,  260,  260,  260,  105,  298,  260,
+ /*   450 */   260,  260,   96,   76,  260,  265,  269,  274,  279,  282,
+ /*   460 */   260,  260,  112,  260,  260,  260,  305,   93,   81,  260,
+ /*   470 */   265,  269,  274,  279,  282,   93,  120,  260,  265,  269,
+ /*   480 */   274,  279,  282,  320,  260,  260,  260,  260,  260,  260,
+ /*   490 */   260,  331,   96,   80,  260,  265,  269,  274,  279,  282,
+ /*   500 */   260,  260,  260,  260,  260,  260,  306,  106,   70,  260,
+ /*   510 */   265,  269,  274,  279,  282,  260,  260,  260,   96,  122,
+ /*   520 */   299,  265,  269,  274,  279,  282,  260,  260,  260,  260,
+ /*   530 */   131,   75,  317,  265,  269,  274,  279,  282,  260,  260,
+ /*   540 */   260,  260,  260,  260,  260,  131,   75,  110,  265,  269,
+ /*   550 */   274,  279,  282,  131,   78,  115,  265,  269,  274,  279,
+ /*   560 */   282,   31,  111,  327,  260,   32,  132,  176,   23,  260,
+ /*   570 */    50,  260,  327,   16,  260,  327,  327,  260,   57,   15,
+ /*   580 */   131,   71,  260,  265,  269,  274,  279,  282,  131,   66,
+ /*   590 */   260,  265,  269,  274,  279,  282,  131,   61,  260,  265,
+ /*   600 */   269,  274,  279,  282,  260,  131,   60,  260,  265,  269,
+ /*   610 */   274,  279,  282,  131,   62,  260,  265,  269,  274,  279,
+ /*   620 */   282,  131,   63,  260,  265,  269,  274,  279,  282,  131,
+ /*   630 */    72,  260,  265,  269,  274,  279,  282,  131,   92,  260,
+ /*   640 */   265,  269,  274,  279,  282,  131,   74,  260,  265,  269,
+ /*   650 */   274,  279,  282,  131,   95,  260,  265,  269,  274,  279,
+ /*   660 */   282,  131,   65,  260,  265,  269,  274,  279,  282,  131,
+ /*   670 */    77,  260,  265,  269,  274,  279,  282,  131,   97,  260,
+ /*   680 */   265,  269,  274,  279,  282,  131,  124,  260,  265,  269,
+ /*   690 */   274,  279,  282,  131,  125,  260,  265,  269,  274,  279,
+ /*   700 */   282,  131,  126,  260,  265,  269,  274,  279,  282,  131,
+ /*   710 */    84,  260,  265,  269,  274,  279,  282,  131,   82,  260,
+ /*   720 */   265,  269,  274,  279,  282,  131,  127,  260,  265,  269,
+ /*   730 */   274,  279,  282,  131,   98,  260,  265,  269,  274,  279,
+ /*   740 */   282,  131,   85,  260,  265,  269,  274,  279,  282,  131,
+ /*   750 */    86,  260,  265,  269,  274,  279,  282,  131,   87,  260,
+ /*   760 */   265,  269,  274,  279,  282,  131,   88,  260,  265,  269,
+ /*   770 */   274,  279,  282,  131,   89,  260,  265,  269,  274,  279,
+ /*   780 */   282,  131,   90,  260,  265,  269,  274,  279,  282,  131,
+ /*   790 */   128,  260,  265,  269,  274,  279,  282,  131,   91,  260,
+ /*   800 */   265,  269,  274,  279,  282,  131,   83,  260,  265,  269,
+ /*   810 */   274,  279,  282,  131,  129,  260,  265,  269,  274,  279,
+ /*   820 */   282,  131,  130,  260,  265,  269,  274,  279,  282,  131,
+ /*   830 */    99,  260,  265,  269,  274,  279,  282,  131,  100,  260,
+ /*   840 */   265,  269,  274,  279,  282,  131,   68,  260,  265,  269,
+ /*   850 */   274,  279,  282,  131,   79,  260,  265,  269,  274,  279,
+ /*   860 */   282,  131,   67,  260,  265,  269,  274,  279,  282,  131,
+ /*   870 */    69,  260,  265,  269,  274,  279,  282,  321,  260,   47,
+ /*   880 */    46,   43,  260,  260,  260,  260,  321,   31,  260,  321,
+ /*   890 */   321,   32,  132,  176,   21,  260,   50,  260,  260,   31,
+ /*   900 */   260,  260,  260,   32,  132,  176,   31,  260,   50,  260,
+ /*   910 */    32,  132,  176,   22,  260,   50,   58,   31,  260,  260,
+ /*   920 */   260,   32,  132,  176,   27,  260,   50,
 };
 static const YYCODETYPE yy_lookahead[] = {
- /*     0 */     2,    3,    4,    5,    6,    7,    8,    9,   10,   11,
- /*    10 */    12,   13,   14,   15,   13,   14,   15,   17,   20,   52,
- /*    20 */    53,    2,    3,    4,    5,    6,    7,    8,    9,   10,
- /*    30 */    11,   12,   13,   14,   15,   12,    1,    1,   33,   16,
- /*    40 */    17,   18,   23,   33,   21,    2,    3,    4,    5,    6,
- /*    50 */     7,    8,    9,   10,   11,   12,   13,   14,   15,   24,
- /*    60 */    24,   33,   21,   20,   23,    1,    2,    3,    4,    5,
- /*    70 */     6,    7,    8,    9,   10,   11,   12,   13,   14,   15,
- /*    80 */     2,    3,    4,    5,    6,    7,    8,    9,   10,   11,
- /*    90 */    12,   13,   14,   15,   33,   24,   24,    1,   24,   28,
- /*   100 */    28,   23,   28,   33,    2,    3,    4,    5,    6,    7,
- /*   110 */     8,    9,   10,   11,   12,   13,   14,   15,   48,    1,
- /*   120 */    17,   24,   27,   15,   22,   28,   33,    2,    3,    4,
- /*   130 */     5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
- /*   140 */    15,   48,   32,   33,   34,   20,   36,   37,   38,   39,
- /*   150 */    40,   41,   42,   43,   11,   27,   22,   47,   24,    1,
- /*   160 */    21,   51,   55,   20,   54,   19,   55,    2,    3,    4,
- /*   170 */     5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
- /*   180 */    15,    2,    3,    4,    5,    6,    7,    8,    9,   10,
- /*   190 */    11,   12,   13,   14,   15,    2,    3,    4,    5,    6,
- /*   200 */     7,    8,    9,   10,   11,   12,   13,   14,   15,    2,
- /*   210 */     3,    4,    5,    6,    7,    8,    9,   10,   11,   12,
- /*   220 */    13,   14,   15,    2,    3,    4,    5,    6,    7,    8,
- /*   230 */     9,   10,   55,   12,   13,   14,   15,    2,    3,    4,
- /*   240 */     5,    6,    7,    8,    9,   10,   55,   12,   13,   14,
- /*   250 */    15,   55,    4,    5,    6,    7,    8,    9,   10,   11,
- /*   260 */    12,   13,   14,   15,    5,    6,    7,    8,    9,   10,
- /*   270 */    11,   12,   13,   14,   15,    5,    6,    7,    8,    9,
- /*   280 */    10,   11,   12,   13,   14,   15,    0,   11,   11,   33,
- /*   290 */    34,   11,   36,   37,   38,   39,   40,   55,   12,   23,
- /*   300 */    44,   24,   16,   17,   18,   49,   26,   21,   55,   55,
- /*   310 */    55,   55,   11,   11,   55,   29,   30,   31,   33,   34,
- /*   320 */    55,   36,   37,   38,   39,   40,   24,   26,   55,   44,
- /*   330 */    55,   11,   33,   34,   49,   36,   37,   38,   39,   40,
- /*   340 */    55,   21,   55,   44,   24,   25,   26,   27,   49,   33,
- /*   350 */    34,   55,   36,   37,   38,   39,   40,   55,   55,   55,
- /*   360 */    44,   55,   55,   33,   34,   49,   36,   37,   38,   39,
- /*   370 */    40,   55,   55,   55,   55,   45,   46,   33,   34,   55,
- /*   380 */    36,   37,   38,   39,   40,   55,   55,   55,   55,   45,
- /*   390 */    46,   55,   55,   55,   33,   34,   55,   36,   37,   38,
- /*   400 */    39,   40,   55,   55,   43,   55,   55,   55,   47,   33,
- /*   410 */    34,   55,   36,   37,   38,   39,   40,   33,   34,   55,
- /*   420 */    36,   37,   38,   39,   40,   49,   11,   55,   13,   14,
- /*   430 */    15,   33,   34,   49,   36,   37,   38,   39,   40,   55,
- /*   440 */    55,   26,   55,   33,   34,   47,   36,   37,   38,   39,
- /*   450 */    40,   55,   55,   55,   33,   34,   46,   36,   37,   38,
- /*   460 */    39,   40,   55,   55,   55,   55,   33,   34,   47,   36,
- /*   470 */    37,   38,   39,   40,   55,   55,   55,   55,   55,   55,
- /*   480 */    55,   33,   34,   50,   36,   37,   38,   39,   40,   33,
- /*   490 */    34,   35,   36,   37,   38,   39,   40,   12,   50,   55,
- /*   500 */    55,   16,   17,   18,   19,   55,   21,   55,   55,   55,
- /*   510 */    55,   55,   55,   55,   29,   33,   34,   55,   36,   37,
- /*   520 */    38,   39,   40,   33,   34,   55,   36,   37,   38,   39,
- /*   530 */    40,   33,   34,   55,   36,   37,   38,   39,   40,   55,
- /*   540 */    33,   34,   55,   36,   37,   38,   39,   40,   33,   34,
- /*   550 */    55,   36,   37,   38,   39,   40,   33,   34,   55,   36,
- /*   560 */    37,   38,   39,   40,   33,   34,   55,   36,   37,   38,
- /*   570 */    39,   40,   33,   34,   55,   36,   37,   38,   39,   40,
- /*   580 */    33,   34,   55,   36,   37,   38,   39,   40,   33,   34,
- /*   590 */    55,   36,   37,   38,   39,   40,   33,   34,   55,   36,
- /*   600 */    37,   38,   39,   40,   33,   34,   55,   36,   37,   38,
- /*   610 */    39,   40,   33,   34,   55,   36,   37,   38,   39,   40,
- /*   620 */    33,   34,   55,   36,   37,   38,   39,   40,   33,   34,
- /*   630 */    55,   36,   37,   38,   39,   40,   33,   34,   55,   36,
- /*   640 */    37,   38,   39,   40,   33,   34,   55,   36,   37,   38,
- /*   650 */    39,   40,   33,   34,   55,   36,   37,   38,   39,   40,
- /*   660 */    33,   34,   55,   36,   37,   38,   39,   40,   33,   34,
- /*   670 */    55,   36,   37,   38,   39,   40,   33,   34,   55,   36,
- /*   680 */    37,   38,   39,   40,   33,   34,   55,   36,   37,   38,
- /*   690 */    39,   40,   33,   34,   55,   36,   37,   38,   39,   40,
- /*   700 */    33,   34,   55,   36,   37,   38,   39,   40,   33,   34,
- /*   710 */    55,   36,   37,   38,   39,   40,   33,   34,   55,   36,
- /*   720 */    37,   38,   39,   40,   33,   34,   55,   36,   37,   38,
- /*   730 */    39,   40,   33,   34,   55,   36,   37,   38,   39,   40,
- /*   740 */    33,   34,   55,   36,   37,   38,   39,   40,   33,   34,
- /*   750 */    55,   36,   37,   38,   39,   40,   33,   34,   55,   36,
- /*   760 */    37,   38,   39,   40,   33,   34,   55,   36,   37,   38,
- /*   770 */    39,   40,   33,   34,   55,   36,   37,   38,   39,   40,
- /*   780 */    33,   34,   55,   36,   37,   38,   39,   40,   11,   55,
- /*   790 */    13,   14,   15,   55,   55,   55,   11,   20,   12,   55,
- /*   800 */    23,   24,   16,   17,   18,   19,   21,   21,   55,   55,
- /*   810 */    12,   26,   27,   55,   16,   17,   18,   12,   55,   21,
- /*   820 */    55,   16,   17,   18,   19,   55,   21,   29,   11,   55,
- /*   830 */    55,   55,   55,   55,   55,   55,   55,   20,   21,   55,
- /*   840 */    23,   24,   55,   55,   27,
+ /*     0 */     1,    2,    3,    4,    5,    6,    7,    8,    9,   10,
+ /*    10 */    11,   12,   13,   14,   15,    1,    2,    3,    4,    5,
+ /*    20 */     6,    7,    8,    9,   10,   11,   12,   13,   14,   15,
+ /*    30 */     2,    3,    4,    5,    6,    7,    8,    9,   10,   11,
+ /*    40 */    12,   13,   14,   15,   13,   14,   15,   17,   20,   53,
+ /*    50 */    54,    2,    3,    4,    5,    6,    7,    8,    9,   10,
+ /*    60 */    11,   12,   13,   14,   15,   19,    1,   24,   34,   20,
+ /*    70 */    24,   28,    2,    3,    4,    5,    6,    7,    8,    9,
+ /*    80 */    10,   11,   12,   13,   14,   15,   12,    1,   34,   24,
+ /*    90 */    16,   17,   18,   23,   34,   21,    2,    3,    4,    5,
+ /*   100 */     6,    7,    8,    9,   10,   11,   12,   13,   14,   15,
+ /*   110 */    24,   21,   34,   23,   20,    1,    1,    2,    3,    4,
+ /*   120 */     5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+ /*   130 */    15,    2,    3,    4,    5,    6,    7,    8,    9,   10,
+ /*   140 */    11,   12,   13,   14,   15,   12,   22,   17,   24,   16,
+ /*   150 */    17,   18,   23,    1,   21,    2,    3,    4,    5,    6,
+ /*   160 */     7,    8,    9,   10,   11,   12,   13,   14,   15,   24,
+ /*   170 */    24,   27,   15,   28,   28,   22,   27,   34,    2,    3,
+ /*   180 */     4,    5,    6,    7,    8,    9,   10,   11,   12,   13,
+ /*   190 */    14,   15,   49,   33,   34,   35,   20,   37,   38,   39,
+ /*   200 */    40,   41,   42,   43,   44,   11,   24,    1,   48,   21,
+ /*   210 */    28,   19,   52,   56,   20,   55,   56,   56,    2,    3,
+ /*   220 */     4,    5,    6,    7,    8,    9,   10,   11,   12,   13,
+ /*   230 */    14,   15,    2,    3,    4,    5,    6,    7,    8,    9,
+ /*   240 */    10,   11,   12,   13,   14,   15,    2,    3,    4,    5,
+ /*   250 */     6,    7,    8,    9,   10,   11,   12,   13,   14,   15,
+ /*   260 */     2,    3,    4,    5,    6,    7,    8,    9,   10,   11,
+ /*   270 */    12,   13,   14,   15,    2,    3,    4,    5,    6,    7,
+ /*   280 */     8,    9,   10,   56,   12,   13,   14,   15,    2,    3,
+ /*   290 */     4,    5,    6,    7,    8,    9,   10,   56,   12,   13,
+ /*   300 */    14,   15,   56,    4,    5,    6,    7,    8,    9,   10,
+ /*   310 */    11,   12,   13,   14,   15,    5,    6,    7,    8,    9,
+ /*   320 */    10,   11,   12,   13,   14,   15,    5,    6,    7,    8,
+ /*   330 */     9,   10,   11,   12,   13,   14,   15,    0,   11,   11,
+ /*   340 */    34,   35,   56,   37,   38,   39,   40,   41,   34,   12,
+ /*   350 */    23,   45,   24,   16,   17,   18,   50,   11,   21,   13,
+ /*   360 */    14,   15,   56,   49,   11,   11,   29,   30,   31,   32,
+ /*   370 */    34,   35,   26,   37,   38,   39,   40,   41,   24,   26,
+ /*   380 */    56,   45,   56,   11,   34,   35,   50,   37,   38,   39,
+ /*   390 */    40,   41,   56,   21,   56,   45,   24,   25,   26,   27,
+ /*   400 */    50,   34,   35,   56,   37,   38,   39,   40,   41,   56,
+ /*   410 */    56,   56,   45,   56,   11,   56,   56,   50,   11,   34,
+ /*   420 */    35,   56,   37,   38,   39,   40,   41,   56,   21,   26,
+ /*   430 */    56,   46,   47,   26,   27,   34,   35,   56,   37,   38,
+ /*   440 */    39,   40,   41,   56,   56,   56,   56,   46,   47,   56,
+ /*   450 */    56,   56,   34,   35,   56,   37,   38,   39,   40,   41,
+ /*   460 */    56,   56,   44,   56,   56,   56,   48,   34,   35,   56,
+ /*   470 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   480 */    39,   40,   41,   50,   56,   56,   56,   56,   56,   56,
+ /*   490 */    56,   50,   34,   35,   56,   37,   38,   39,   40,   41,
+ /*   500 */    56,   56,   56,   56,   56,   56,   48,   34,   35,   56,
+ /*   510 */    37,   38,   39,   40,   41,   56,   56,   56,   34,   35,
+ /*   520 */    47,   37,   38,   39,   40,   41,   56,   56,   56,   56,
+ /*   530 */    34,   35,   48,   37,   38,   39,   40,   41,   56,   56,
+ /*   540 */    56,   56,   56,   56,   56,   34,   35,   51,   37,   38,
+ /*   550 */    39,   40,   41,   34,   35,   36,   37,   38,   39,   40,
+ /*   560 */    41,   12,   51,   11,   56,   16,   17,   18,   19,   56,
+ /*   570 */    21,   56,   20,   21,   56,   23,   24,   56,   29,   27,
+ /*   580 */    34,   35,   56,   37,   38,   39,   40,   41,   34,   35,
+ /*   590 */    56,   37,   38,   39,   40,   41,   34,   35,   56,   37,
+ /*   600 */    38,   39,   40,   41,   56,   34,   35,   56,   37,   38,
+ /*   610 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   620 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   630 */    35,   56,   37,   38,   39,   40,   41,   34,   35,   56,
+ /*   640 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   650 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   660 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   670 */    35,   56,   37,   38,   39,   40,   41,   34,   35,   56,
+ /*   680 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   690 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   700 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   710 */    35,   56,   37,   38,   39,   40,   41,   34,   35,   56,
+ /*   720 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   730 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   740 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   750 */    35,   56,   37,   38,   39,   40,   41,   34,   35,   56,
+ /*   760 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   770 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   780 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   790 */    35,   56,   37,   38,   39,   40,   41,   34,   35,   56,
+ /*   800 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   810 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   820 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   830 */    35,   56,   37,   38,   39,   40,   41,   34,   35,   56,
+ /*   840 */    37,   38,   39,   40,   41,   34,   35,   56,   37,   38,
+ /*   850 */    39,   40,   41,   34,   35,   56,   37,   38,   39,   40,
+ /*   860 */    41,   34,   35,   56,   37,   38,   39,   40,   41,   34,
+ /*   870 */    35,   56,   37,   38,   39,   40,   41,   11,   56,   13,
+ /*   880 */    14,   15,   56,   56,   56,   56,   20,   12,   56,   23,
+ /*   890 */    24,   16,   17,   18,   19,   56,   21,   56,   56,   12,
+ /*   900 */    56,   56,   56,   16,   17,   18,   12,   56,   21,   56,
+ /*   910 */    16,   17,   18,   19,   56,   21,   29,   12,   56,   56,
+ /*   920 */    56,   16,   17,   18,   19,   56,   21,
 };
-#define YY_SHIFT_USE_DFLT (845)
-#define YY_SHIFT_COUNT    (125)
-#define YY_SHIFT_MIN      (-2)
-#define YY_SHIFT_MAX      (817)
+#define YY_SHIFT_USE_DFLT (927)
+#define YY_SHIFT_COUNT    (132)
+#define YY_SHIFT_MIN      (-1)
+#define YY_SHIFT_MAX      (905)
 static const short yy_shift_ofst[] = {
- /*     0 */   845,  286,  485,  485,  485,  485,  786,  786,  798,  485,
- /*    10 */   485,  798,  786,  798,   23,   23,   23,  805,   23,   23,
- /*    20 */    23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
- /*    30 */    23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
- /*    40 */    23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
- /*    50 */    23,    0,    0,    0,    0,    0,    0,   -2,   19,   43,
- /*    60 */    64,   78,  102,  125,  165,  165,  179,  193,  165,  165,
- /*    70 */   207,  165,  165,  165,  221,  235,  248,  248,  259,  270,
- /*    80 */   270,  270,  270,  270,  270,  259,  777,  817,  320,  415,
- /*    90 */   785,    1,    1,    1,    1,   35,  277,  280,   36,   41,
- /*   100 */   302,  143,  276,   71,   72,  301,   74,   97,  134,   96,
- /*   110 */   118,  103,   95,  108,  128,  108,  158,  108,  108,  108,
- /*   120 */   108,  108,  108,  108,  139,  146,
+ /*     0 */   927,  337,  549,  549,  549,  549,  875,  875,  887,  549,
+ /*    10 */   549,  887,  875,  887,   74,   74,   74,  894,  905,   74,
+ /*    20 */   133,   74,   74,   74,   74,   74,   74,   74,   74,   74,
+ /*    30 */    74,   74,   74,   74,   74,   74,   74,   74,   74,   74,
+ /*    40 */    74,   74,   74,   74,   74,   74,   74,   74,   74,   74,
+ /*    50 */    74,   74,   74,   74,   30,   30,   30,   30,   30,   30,
+ /*    60 */    -1,   14,   28,   49,   70,   94,  115,  129,  153,  176,
+ /*    70 */   216,  216,  230,  244,  216,  216,  258,  216,  216,  216,
+ /*    80 */   272,  286,  299,  299,  310,  321,  321,  321,  321,  321,
+ /*    90 */   321,  310,  866,  552,  372,  346,  407,   31,   31,   31,
+ /*   100 */    31,   46,   65,  328,  353,   86,   90,  354,  194,  327,
+ /*   110 */    43,  145,  403,  146,  182,  124,  114,  152,  130,  144,
+ /*   120 */   157,  149,  157,  206,  157,  157,  157,  157,  157,  157,
+ /*   130 */   157,  188,  192,
 };
-#define YY_REDUCE_USE_DFLT (-34)
-#define YY_REDUCE_COUNT (56)
-#define YY_REDUCE_MIN   (-33)
-#define YY_REDUCE_MAX   (747)
+#define YY_REDUCE_USE_DFLT (-5)
+#define YY_REDUCE_COUNT (59)
+#define YY_REDUCE_MIN   (-4)
+#define YY_REDUCE_MAX   (835)
 static const short yy_reduce_ofst[] = {
- /*     0 */   -33,  110,  256,  285,  299,  316,  330,  344,  361,  376,
- /*    10 */   384,  398,  410,  421,  433,  448,  456,  482,  490,  498,
- /*    20 */   507,  515,  523,  531,  539,  547,  555,  563,  571,  579,
- /*    30 */   587,  595,  603,  611,  619,  627,  635,  643,  651,  659,
- /*    40 */   667,  675,  683,  691,  699,  707,  715,  723,  731,  739,
- /*    50 */   747,   70,   93,    5,   10,   28,   61,
+ /*     0 */    -4,  160,  306,  336,  350,  367,  385,  401,  418,  433,
+ /*    10 */   441,  458,  473,  484,  496,  511,  519,  546,  554,  562,
+ /*    20 */   571,  579,  587,  595,  603,  611,  619,  627,  635,  643,
+ /*    30 */   651,  659,  667,  675,  683,  691,  699,  707,  715,  723,
+ /*    40 */   731,  739,  747,  755,  763,  771,  779,  787,  795,  803,
+ /*    50 */   811,  819,  827,  835,  143,  314,   34,   54,   60,   78,
 };
 static const YYACTIONTYPE yy_default[] = {
- /*     0 */   323,  290,  304,  304,  304,  304,  328,  328,  290,  328,
- /*    10 */   328,  328,  328,  328,  309,  309,  253,  328,  328,  328,
- /*    20 */   328,  328,  312,  328,  328,  328,  328,  328,  328,  328,
- /*    30 */   328,  328,  328,  328,  328,  328,  328,  328,  328,  328,
- /*    40 */   328,  328,  328,  328,  328,  328,  328,  328,  328,  328,
- /*    50 */   328,  295,  295,  328,  328,  328,  298,  328,  328,  328,
- /*    60 */   328,  328,  328,  328,  287,  288,  328,  328,  311,  310,
- /*    70 */   328,  251,  254,  255,  294,  308,  268,  267,  271,  280,
- /*    80 */   279,  278,  277,  276,  275,  270,  257,  247,  247,  257,
- /*    90 */   247,  260,  259,  258,  257,  328,  328,  328,  328,  247,
- /*   100 */   328,  328,  328,  328,  328,  328,  328,  328,  328,  328,
- /*   110 */   328,  328,  315,  262,  301,  262,  328,  265,  273,  272,
- /*   120 */   264,  274,  263,  262,  247,  246,
+ /*     0 */   339,  304,  318,  318,  318,  318,  344,  344,  304,  344,
+ /*    10 */   344,  344,  344,  344,  323,  323,  266,  344,  344,  344,
+ /*    20 */   344,  344,  344,  344,  344,  326,  344,  344,  344,  344,
+ /*    30 */   344,  344,  344,  344,  344,  344,  344,  344,  344,  344,
+ /*    40 */   344,  344,  344,  344,  344,  344,  344,  344,  344,  344,
+ /*    50 */   344,  344,  344,  344,  309,  309,  344,  344,  344,  312,
+ /*    60 */   344,  344,  344,  344,  344,  344,  344,  344,  344,  344,
+ /*    70 */   300,  301,  344,  344,  325,  324,  344,  264,  267,  268,
+ /*    80 */   308,  322,  281,  280,  284,  293,  292,  291,  290,  289,
+ /*    90 */   288,  283,  270,  260,  260,  270,  260,  273,  272,  271,
+ /*   100 */   270,  259,  344,  344,  344,  344,  260,  344,  344,  344,
+ /*   110 */   344,  344,  344,  344,  344,  344,  344,  344,  344,  329,
+ /*   120 */   275,  315,  275,  344,  278,  286,  285,  277,  287,  276,
+ /*   130 */   275,  260,  259,
 };
 /********** End of lemon-generated parsing tables *****************************/
 
@@ -569,12 +587,12 @@ static const char *const yyTokenName[] = {
   "RIGHT_SQUARE",  "LEFT_ROUND",    "RIGHT_ROUND",   "COLON",       
   "COMMA",         "ASSIGN",        "ARROW",         "LEFT_CURLY",  
   "RIGHT_CURLY",   "DOLLAR",        "MODEL_NAME",    "INCLUDE",     
-  "error",         "variable",      "expression",    "arguments",   
-  "comparison",    "sum",           "product",       "conjunction", 
-  "disjunction",   "assignment",    "reaction",      "reactionLeftSide",
-  "reactionRightSide",  "reactionSpecifiers",  "reactionSpecifier",  "reactionLeftComponent",
-  "moleculePropertyNames",  "reactionRightComponent",  "moleculePropertyExpressions",  "preprocessorDirective",
-  "model",         "statements",    "statement",   
+  "STOP",          "error",         "variable",      "expression",  
+  "arguments",     "comparison",    "sum",           "product",     
+  "conjunction",   "disjunction",   "assignment",    "reaction",    
+  "reactionLeftSide",  "reactionRightSide",  "reactionSpecifiers",  "reactionSpecifier",
+  "reactionLeftComponent",  "moleculePropertyNames",  "reactionRightComponent",  "moleculePropertyExpressions",
+  "preprocessorDirective",  "model",         "statements",    "statement",   
 };
 #endif /* NDEBUG */
 
@@ -627,44 +645,47 @@ static const char *const yyRuleName[] = {
  /*  42 */ "reactionSpecifier ::= expression",
  /*  43 */ "reactionSpecifier ::= variable COLON expression",
  /*  44 */ "reactionSpecifier ::= LEFT_SQUARE expression RIGHT_SQUARE",
- /*  45 */ "reactionLeftSide ::=",
- /*  46 */ "reactionLeftSide ::= reactionLeftComponent",
- /*  47 */ "reactionLeftSide ::= reactionLeftSide PLUS reactionLeftComponent",
- /*  48 */ "reactionLeftSide ::= expression PLUS expression",
- /*  49 */ "reactionLeftSide ::= reactionLeftSide PLUS expression",
- /*  50 */ "moleculePropertyNames ::=",
- /*  51 */ "moleculePropertyNames ::= variable",
- /*  52 */ "moleculePropertyNames ::= moleculePropertyNames COMMA variable",
- /*  53 */ "moleculePropertyNames ::= moleculePropertyNames COMMA",
- /*  54 */ "reactionLeftComponent ::= variable",
- /*  55 */ "reactionLeftComponent ::= variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY",
- /*  56 */ "reactionLeftComponent ::= DOLLAR variable",
- /*  57 */ "reactionLeftComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY",
- /*  58 */ "reactionLeftComponent ::= expression MULTIPLY reactionLeftComponent",
- /*  59 */ "reactionRightSide ::=",
- /*  60 */ "reactionRightSide ::= reactionRightComponent",
- /*  61 */ "reactionRightSide ::= reactionRightSide PLUS reactionRightComponent",
- /*  62 */ "reactionRightSide ::= expression PLUS expression",
- /*  63 */ "reactionRightSide ::= reactionRightSide PLUS expression",
- /*  64 */ "moleculePropertyExpressions ::=",
- /*  65 */ "moleculePropertyExpressions ::= expression",
- /*  66 */ "moleculePropertyExpressions ::= moleculePropertyExpressions COMMA expression",
- /*  67 */ "moleculePropertyExpressions ::= moleculePropertyExpressions COMMA",
- /*  68 */ "reactionRightComponent ::= variable",
- /*  69 */ "reactionRightComponent ::= variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY",
- /*  70 */ "reactionRightComponent ::= DOLLAR variable",
- /*  71 */ "reactionRightComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY",
- /*  72 */ "reactionRightComponent ::= expression MULTIPLY reactionRightComponent",
- /*  73 */ "reactionRightComponent ::= LEFT_SQUARE expression QUESTIONMARK reactionRightSide COLON reactionRightSide RIGHT_SQUARE",
- /*  74 */ "preprocessorDirective ::= INCLUDE variable SEMICOLON",
- /*  75 */ "preprocessorDirective ::= MODEL_NAME IDENTIFIER SEMICOLON",
- /*  76 */ "model ::= statements",
- /*  77 */ "statements ::= statements statement",
- /*  78 */ "statements ::=",
- /*  79 */ "statement ::= assignment",
- /*  80 */ "statement ::= reaction",
- /*  81 */ "statement ::= preprocessorDirective",
- /*  82 */ "statement ::= error",
+ /*  45 */ "reactionSpecifier ::= variable COLON LEFT_SQUARE expression RIGHT_SQUARE",
+ /*  46 */ "reactionLeftSide ::=",
+ /*  47 */ "reactionLeftSide ::= reactionLeftComponent",
+ /*  48 */ "reactionLeftSide ::= reactionLeftSide PLUS reactionLeftComponent",
+ /*  49 */ "reactionLeftSide ::= expression PLUS expression",
+ /*  50 */ "reactionLeftSide ::= reactionLeftSide PLUS expression",
+ /*  51 */ "moleculePropertyNames ::=",
+ /*  52 */ "moleculePropertyNames ::= variable",
+ /*  53 */ "moleculePropertyNames ::= moleculePropertyNames COMMA variable",
+ /*  54 */ "moleculePropertyNames ::= moleculePropertyNames COMMA",
+ /*  55 */ "reactionLeftComponent ::= variable",
+ /*  56 */ "reactionLeftComponent ::= variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY",
+ /*  57 */ "reactionLeftComponent ::= DOLLAR variable",
+ /*  58 */ "reactionLeftComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY",
+ /*  59 */ "reactionLeftComponent ::= expression MULTIPLY reactionLeftComponent",
+ /*  60 */ "reactionRightSide ::=",
+ /*  61 */ "reactionRightSide ::= reactionRightComponent",
+ /*  62 */ "reactionRightSide ::= reactionRightSide PLUS reactionRightComponent",
+ /*  63 */ "reactionRightSide ::= expression PLUS expression",
+ /*  64 */ "reactionRightSide ::= reactionRightSide PLUS expression",
+ /*  65 */ "moleculePropertyExpressions ::=",
+ /*  66 */ "moleculePropertyExpressions ::= expression",
+ /*  67 */ "moleculePropertyExpressions ::= moleculePropertyExpressions COMMA expression",
+ /*  68 */ "moleculePropertyExpressions ::= moleculePropertyExpressions COMMA",
+ /*  69 */ "reactionRightComponent ::= variable",
+ /*  70 */ "reactionRightComponent ::= variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY",
+ /*  71 */ "reactionRightComponent ::= DOLLAR variable",
+ /*  72 */ "reactionRightComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY",
+ /*  73 */ "reactionRightComponent ::= expression MULTIPLY reactionRightComponent",
+ /*  74 */ "reactionRightComponent ::= LEFT_SQUARE expression QUESTIONMARK reactionRightSide COLON reactionRightSide RIGHT_SQUARE",
+ /*  75 */ "preprocessorDirective ::= INCLUDE variable SEMICOLON",
+ /*  76 */ "preprocessorDirective ::= STOP expression SEMICOLON",
+ /*  77 */ "preprocessorDirective ::= STOP IDENTIFIER COMMA expression SEMICOLON",
+ /*  78 */ "preprocessorDirective ::= MODEL_NAME IDENTIFIER SEMICOLON",
+ /*  79 */ "model ::= statements",
+ /*  80 */ "statements ::= statements statement",
+ /*  81 */ "statements ::=",
+ /*  82 */ "statement ::= assignment",
+ /*  83 */ "statement ::= reaction",
+ /*  84 */ "statement ::= preprocessorDirective",
+ /*  85 */ "statement ::= error",
 };
 #endif /* NDEBUG */
 
@@ -817,173 +838,174 @@ static void yy_destructor(
     case 29: /* DOLLAR */
     case 30: /* MODEL_NAME */
     case 31: /* INCLUDE */
+    case 32: /* STOP */
 {
 #line 8 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 
 	delete (yypminor->yy0);
 	(yypminor->yy0) = nullptr;
 
-#line 827 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 849 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 33: /* variable */
+    case 34: /* variable */
 {
 #line 81 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy100);
-	(yypminor->yy100) = nullptr;
+	delete (yypminor->yy46);
+	(yypminor->yy46) = nullptr;
 
-#line 837 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 859 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 34: /* expression */
+    case 35: /* expression */
 {
 #line 108 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy64);
-	(yypminor->yy64) = nullptr;
+	delete (yypminor->yy80);
+	(yypminor->yy80) = nullptr;
 
-#line 847 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 869 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 35: /* arguments */
+    case 36: /* arguments */
 {
 #line 158 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy103);
-	(yypminor->yy103) = nullptr;
+	delete (yypminor->yy107);
+	(yypminor->yy107) = nullptr;
 
-#line 857 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 879 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 36: /* comparison */
+    case 37: /* comparison */
 {
 #line 142 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy73);
-	(yypminor->yy73) = nullptr;
+	delete (yypminor->yy35);
+	(yypminor->yy35) = nullptr;
 
-#line 867 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 889 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 37: /* sum */
+    case 38: /* sum */
 {
 #line 179 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy78);
-	(yypminor->yy78) = nullptr;
+	delete (yypminor->yy56);
+	(yypminor->yy56) = nullptr;
 
-#line 877 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 899 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 38: /* product */
+    case 39: /* product */
 {
 #line 208 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy50);
-	(yypminor->yy50) = nullptr;
+	delete (yypminor->yy52);
+	(yypminor->yy52) = nullptr;
 
-#line 887 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 909 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 39: /* conjunction */
+    case 40: /* conjunction */
 {
 #line 238 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy45);
-	(yypminor->yy45) = nullptr;
+	delete (yypminor->yy61);
+	(yypminor->yy61) = nullptr;
 
-#line 897 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 919 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 40: /* disjunction */
+    case 41: /* disjunction */
 {
 #line 258 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy87);
-	(yypminor->yy87) = nullptr;
+	delete (yypminor->yy109);
+	(yypminor->yy109) = nullptr;
 
-#line 907 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 929 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 43: /* reactionLeftSide */
+    case 44: /* reactionLeftSide */
 {
-#line 434 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 444 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy96);
-	(yypminor->yy96) = nullptr;
+	delete (yypminor->yy8);
+	(yypminor->yy8) = nullptr;
 
-#line 917 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 939 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 44: /* reactionRightSide */
+    case 45: /* reactionRightSide */
 {
-#line 570 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 580 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy5);
-	(yypminor->yy5) = nullptr;
+	delete (yypminor->yy31);
+	(yypminor->yy31) = nullptr;
 
-#line 927 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 949 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 45: /* reactionSpecifiers */
+    case 46: /* reactionSpecifiers */
 {
 #line 376 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy29);
-	(yypminor->yy29) = nullptr;
+	delete (yypminor->yy85);
+	(yypminor->yy85) = nullptr;
 
-#line 937 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 959 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 46: /* reactionSpecifier */
+    case 47: /* reactionSpecifier */
 {
 #line 399 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy97);
-	(yypminor->yy97) = nullptr;
+	delete (yypminor->yy74);
+	(yypminor->yy74) = nullptr;
 
-#line 947 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 969 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 47: /* reactionLeftComponent */
+    case 48: /* reactionLeftComponent */
 {
-#line 508 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 518 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy14);
-	(yypminor->yy14) = nullptr;
+	delete (yypminor->yy6);
+	(yypminor->yy6) = nullptr;
 
-#line 957 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 979 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 48: /* moleculePropertyNames */
+    case 49: /* moleculePropertyNames */
 {
-#line 476 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 486 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy110);
-	(yypminor->yy110) = nullptr;
+	delete (yypminor->yy18);
+	(yypminor->yy18) = nullptr;
 
-#line 967 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 989 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 49: /* reactionRightComponent */
+    case 50: /* reactionRightComponent */
 {
-#line 643 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 653 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy77);
-	(yypminor->yy77) = nullptr;
+	delete (yypminor->yy25);
+	(yypminor->yy25) = nullptr;
 
-#line 977 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 999 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
-    case 50: /* moleculePropertyExpressions */
+    case 51: /* moleculePropertyExpressions */
 {
-#line 612 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 622 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
  
-	delete (yypminor->yy30);
-	(yypminor->yy30) = nullptr;
+	delete (yypminor->yy29);
+	(yypminor->yy29) = nullptr;
 
-#line 987 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1009 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
       break;
 /********* End destructor definitions *****************************************/
@@ -1164,7 +1186,7 @@ static void yyStackOverflow(yyParser *yypParser){
 /******** Begin %stack_overflow code ******************************************/
 #line 5 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 throw std::exception("Parser stack overflow while parsing cmdl file.");
-#line 1168 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1190 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 /******** End %stack_overflow code ********************************************/
    cmdl_internal_ParseARG_STORE; /* Suppress warning about unused %extra_argument var */
 }
@@ -1238,89 +1260,92 @@ static const struct {
   YYCODETYPE lhs;       /* Symbol on the left-hand side of the rule */
   signed char nrhs;     /* Negative of the number of RHS symbols in the rule */
 } yyRuleInfo[] = {
-  { 33, -4 },
-  { 33, -1 },
-  { 34, -1 },
   { 34, -4 },
   { 34, -1 },
-  { 34, -3 },
-  { 36, -5 },
-  { 34, -1 },
-  { 35, 0 },
+  { 35, -1 },
+  { 35, -4 },
   { 35, -1 },
   { 35, -3 },
-  { 34, -1 },
-  { 37, -3 },
-  { 37, -3 },
-  { 37, -3 },
-  { 37, -3 },
-  { 34, -1 },
+  { 37, -5 },
+  { 35, -1 },
+  { 36, 0 },
+  { 36, -1 },
+  { 36, -3 },
+  { 35, -1 },
   { 38, -3 },
   { 38, -3 },
   { 38, -3 },
   { 38, -3 },
-  { 34, -1 },
+  { 35, -1 },
   { 39, -3 },
   { 39, -3 },
-  { 34, -1 },
+  { 39, -3 },
+  { 39, -3 },
+  { 35, -1 },
   { 40, -3 },
   { 40, -3 },
-  { 34, -2 },
-  { 34, -2 },
-  { 34, -3 },
-  { 34, -3 },
-  { 34, -3 },
-  { 34, -3 },
-  { 34, -3 },
-  { 34, -3 },
-  { 34, -3 },
-  { 41, -4 },
-  { 41, -6 },
+  { 35, -1 },
+  { 41, -3 },
+  { 41, -3 },
+  { 35, -2 },
+  { 35, -2 },
+  { 35, -3 },
+  { 35, -3 },
+  { 35, -3 },
+  { 35, -3 },
+  { 35, -3 },
+  { 35, -3 },
+  { 35, -3 },
+  { 42, -4 },
   { 42, -6 },
-  { 42, -8 },
-  { 45, -1 },
-  { 45, -3 },
+  { 43, -6 },
+  { 43, -8 },
   { 46, -1 },
   { 46, -3 },
-  { 46, -3 },
-  { 43, 0 },
-  { 43, -1 },
-  { 43, -3 },
-  { 43, -3 },
-  { 43, -3 },
-  { 48, 0 },
-  { 48, -1 },
-  { 48, -3 },
-  { 48, -2 },
   { 47, -1 },
-  { 47, -4 },
-  { 47, -2 },
-  { 47, -5 },
   { 47, -3 },
+  { 47, -3 },
+  { 47, -5 },
   { 44, 0 },
   { 44, -1 },
   { 44, -3 },
   { 44, -3 },
   { 44, -3 },
-  { 50, 0 },
-  { 50, -1 },
-  { 50, -3 },
-  { 50, -2 },
+  { 49, 0 },
   { 49, -1 },
-  { 49, -4 },
-  { 49, -2 },
-  { 49, -5 },
   { 49, -3 },
-  { 49, -7 },
-  { 51, -3 },
+  { 49, -2 },
+  { 48, -1 },
+  { 48, -4 },
+  { 48, -2 },
+  { 48, -5 },
+  { 48, -3 },
+  { 45, 0 },
+  { 45, -1 },
+  { 45, -3 },
+  { 45, -3 },
+  { 45, -3 },
+  { 51, 0 },
+  { 51, -1 },
   { 51, -3 },
-  { 52, -1 },
-  { 53, -2 },
-  { 53, 0 },
-  { 54, -1 },
-  { 54, -1 },
-  { 54, -1 },
-  { 54, -1 },
+  { 51, -2 },
+  { 50, -1 },
+  { 50, -4 },
+  { 50, -2 },
+  { 50, -5 },
+  { 50, -3 },
+  { 50, -7 },
+  { 52, -3 },
+  { 52, -3 },
+  { 52, -5 },
+  { 52, -3 },
+  { 53, -1 },
+  { 54, -2 },
+  { 54, 0 },
+  { 55, -1 },
+  { 55, -1 },
+  { 55, -1 },
+  { 55, -1 },
 };
 
 static void yy_accept(yyParser*);  /* Forward Declaration */
@@ -1390,403 +1415,403 @@ static void yy_reduce(
 	identifier name = *yymsp[-3].minor.yy0;
 	delete yymsp[-3].minor.yy0;
 	yymsp[-3].minor.yy0 = nullptr;
-	yylhsminor.yy100 = nullptr;
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy64);
-	yymsp[-1].minor.yy64 = nullptr;
+	yylhsminor.yy46 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy80);
+	yymsp[-1].minor.yy80 = nullptr;
 
 	auto value = static_cast<size_t>(parseTree->GetExpressionValue(e_temp.get())+0.5);
-	yylhsminor.yy100 = new identifier(name+"["+std::to_string(value)+"]");
+	yylhsminor.yy46 = new identifier(name+"["+std::to_string(value)+"]");
 }
-#line 1401 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1426 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,19,&yymsp[-2].minor);
   yy_destructor(yypParser,20,&yymsp[0].minor);
-  yymsp[-3].minor.yy100 = yylhsminor.yy100;
+  yymsp[-3].minor.yy46 = yylhsminor.yy46;
         break;
       case 1: /* variable ::= IDENTIFIER */
 #line 96 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy100 = new identifier(*yymsp[0].minor.yy0);
+	yylhsminor.yy46 = new identifier(*yymsp[0].minor.yy0);
 	delete yymsp[0].minor.yy0;
 	yymsp[0].minor.yy0 = nullptr;
 }
-#line 1413 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy100 = yylhsminor.yy100;
+#line 1438 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy46 = yylhsminor.yy46;
         break;
       case 2: /* expression ::= variable */
 #line 112 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new VariableExpression(*yymsp[0].minor.yy100);
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
+	yylhsminor.yy80 = new VariableExpression(*yymsp[0].minor.yy46);
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
 }
-#line 1423 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1448 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 3: /* expression ::= variable LEFT_ROUND arguments RIGHT_ROUND */
 #line 117 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto func = new FunctionExpression(*yymsp[-3].minor.yy100);
-	delete yymsp[-3].minor.yy100;
-	yymsp[-3].minor.yy100 = nullptr;
-	yylhsminor.yy64 = nullptr;
-	for(auto& argument : *yymsp[-1].minor.yy103)
+	auto func = new FunctionExpression(*yymsp[-3].minor.yy46);
+	delete yymsp[-3].minor.yy46;
+	yymsp[-3].minor.yy46 = nullptr;
+	yylhsminor.yy80 = nullptr;
+	for(auto& argument : *yymsp[-1].minor.yy107)
 	{
 		func->PushBack(std::move(argument));
 	}
-	delete yymsp[-1].minor.yy103;
-	yymsp[-1].minor.yy103 = nullptr;
-	yylhsminor.yy64 = func;
+	delete yymsp[-1].minor.yy107;
+	yymsp[-1].minor.yy107 = nullptr;
+	yylhsminor.yy80 = func;
 	func = nullptr;
 }
-#line 1442 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1467 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,21,&yymsp[-2].minor);
   yy_destructor(yypParser,22,&yymsp[0].minor);
-  yymsp[-3].minor.yy64 = yylhsminor.yy64;
+  yymsp[-3].minor.yy80 = yylhsminor.yy80;
         break;
       case 4: /* expression ::= VALUE */
 #line 132 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new NumberExpression(*yymsp[0].minor.yy0);
+	yylhsminor.yy80 = new NumberExpression(*yymsp[0].minor.yy0);
 	delete yymsp[0].minor.yy0;
 	yymsp[0].minor.yy0 = nullptr;
 }
-#line 1454 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1479 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 5: /* expression ::= LEFT_ROUND expression RIGHT_ROUND */
 {  yy_destructor(yypParser,21,&yymsp[-2].minor);
 #line 137 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[-2].minor.yy64 = yymsp[-1].minor.yy64;
+	yymsp[-2].minor.yy80 = yymsp[-1].minor.yy80;
 }
-#line 1463 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1488 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,22,&yymsp[0].minor);
 }
         break;
       case 6: /* comparison ::= expression QUESTIONMARK expression COLON expression */
 #line 146 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy73 = new ConditionalExpression(std::unique_ptr<IExpression>(yymsp[-4].minor.yy64), std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
-	yymsp[-2].minor.yy64 = nullptr;
-	yymsp[0].minor.yy64 = nullptr;
-	yymsp[-4].minor.yy64 = nullptr;
+	yylhsminor.yy35 = new ConditionalExpression(std::unique_ptr<IExpression>(yymsp[-4].minor.yy80), std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
+	yymsp[-2].minor.yy80 = nullptr;
+	yymsp[0].minor.yy80 = nullptr;
+	yymsp[-4].minor.yy80 = nullptr;
 }
-#line 1475 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1500 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,2,&yymsp[-3].minor);
   yy_destructor(yypParser,23,&yymsp[-1].minor);
-  yymsp[-4].minor.yy73 = yylhsminor.yy73;
+  yymsp[-4].minor.yy35 = yylhsminor.yy35;
         break;
       case 7: /* expression ::= comparison */
 #line 152 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = yymsp[0].minor.yy73;
+	yylhsminor.yy80 = yymsp[0].minor.yy35;
 }
-#line 1485 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1510 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 8: /* arguments ::= */
 #line 162 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[1].minor.yy103 = new FunctionArguments();
+	yymsp[1].minor.yy107 = new FunctionArguments();
 }
-#line 1493 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1518 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
         break;
       case 9: /* arguments ::= expression */
 #line 165 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy103 = new FunctionArguments();
-	yylhsminor.yy103->push_back(typename FunctionArguments::value_type(yymsp[0].minor.yy64));
-	yymsp[0].minor.yy64 = nullptr;
+	yylhsminor.yy107 = new FunctionArguments();
+	yylhsminor.yy107->push_back(typename FunctionArguments::value_type(yymsp[0].minor.yy80));
+	yymsp[0].minor.yy80 = nullptr;
 }
-#line 1502 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy103 = yylhsminor.yy103;
+#line 1527 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy107 = yylhsminor.yy107;
         break;
       case 10: /* arguments ::= arguments COMMA expression */
 #line 170 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy103 = yymsp[-2].minor.yy103;
-	yymsp[-2].minor.yy103 = nullptr;
-	yylhsminor.yy103->push_back(typename FunctionArguments::value_type(yymsp[0].minor.yy64));
-	yymsp[0].minor.yy64 = nullptr;
+	yylhsminor.yy107 = yymsp[-2].minor.yy107;
+	yymsp[-2].minor.yy107 = nullptr;
+	yylhsminor.yy107->push_back(typename FunctionArguments::value_type(yymsp[0].minor.yy80));
+	yymsp[0].minor.yy80 = nullptr;
 }
-#line 1513 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1538 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[-1].minor);
-  yymsp[-2].minor.yy103 = yylhsminor.yy103;
+  yymsp[-2].minor.yy107 = yylhsminor.yy107;
         break;
       case 11: /* expression ::= sum */
 #line 183 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = yymsp[0].minor.yy78;
+	yylhsminor.yy80 = yymsp[0].minor.yy56;
 }
-#line 1522 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1547 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 12: /* sum ::= expression PLUS expression */
 #line 186 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy78 = new SumExpression();
-	yylhsminor.yy78->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy64));
-	yylhsminor.yy78->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy56 = new SumExpression();
+	yylhsminor.yy56->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy80));
+	yylhsminor.yy56->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1532 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1557 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
-  yymsp[-2].minor.yy78 = yylhsminor.yy78;
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
         break;
       case 13: /* sum ::= expression MINUS expression */
 #line 191 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy78 = new SumExpression();
-	yylhsminor.yy78->PushBack(false,  std::unique_ptr<IExpression>(yymsp[-2].minor.yy64));
-	yylhsminor.yy78->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy56 = new SumExpression();
+	yylhsminor.yy56->PushBack(false,  std::unique_ptr<IExpression>(yymsp[-2].minor.yy80));
+	yylhsminor.yy56->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1543 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1568 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,12,&yymsp[-1].minor);
-  yymsp[-2].minor.yy78 = yylhsminor.yy78;
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
         break;
       case 14: /* sum ::= sum PLUS expression */
 #line 196 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy78 = yymsp[-2].minor.yy78;
-	yylhsminor.yy78->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy56 = yymsp[-2].minor.yy56;
+	yylhsminor.yy56->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1553 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1578 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
-  yymsp[-2].minor.yy78 = yylhsminor.yy78;
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
         break;
       case 15: /* sum ::= sum MINUS expression */
 #line 200 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy78 = yymsp[-2].minor.yy78;
-	yylhsminor.yy78->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy56 = yymsp[-2].minor.yy56;
+	yylhsminor.yy56->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1563 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1588 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,12,&yymsp[-1].minor);
-  yymsp[-2].minor.yy78 = yylhsminor.yy78;
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
         break;
       case 16: /* expression ::= product */
 #line 212 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = yymsp[0].minor.yy50;
+	yylhsminor.yy80 = yymsp[0].minor.yy52;
 }
-#line 1572 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1597 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 17: /* product ::= expression MULTIPLY expression */
 #line 215 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy50 = new ProductExpression();
-	yylhsminor.yy50->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy64));
-	yylhsminor.yy50->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy52 = new ProductExpression();
+	yylhsminor.yy52->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy80));
+	yylhsminor.yy52->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 
 }
-#line 1583 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1608 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,13,&yymsp[-1].minor);
-  yymsp[-2].minor.yy50 = yylhsminor.yy50;
+  yymsp[-2].minor.yy52 = yylhsminor.yy52;
         break;
       case 18: /* product ::= expression DIVIDE expression */
 #line 221 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy50 = new ProductExpression();
-	yylhsminor.yy50->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy64));
-	yylhsminor.yy50->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy52 = new ProductExpression();
+	yylhsminor.yy52->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy80));
+	yylhsminor.yy52->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 
 }
-#line 1595 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1620 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,14,&yymsp[-1].minor);
-  yymsp[-2].minor.yy50 = yylhsminor.yy50;
+  yymsp[-2].minor.yy52 = yylhsminor.yy52;
         break;
       case 19: /* product ::= product MULTIPLY expression */
 #line 227 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy50 = yymsp[-2].minor.yy50;
-	yylhsminor.yy50->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy52 = yymsp[-2].minor.yy52;
+	yylhsminor.yy52->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1605 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1630 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,13,&yymsp[-1].minor);
-  yymsp[-2].minor.yy50 = yylhsminor.yy50;
+  yymsp[-2].minor.yy52 = yylhsminor.yy52;
         break;
       case 20: /* product ::= product DIVIDE expression */
 #line 231 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy50 = yymsp[-2].minor.yy50;
-	yylhsminor.yy50->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy52 = yymsp[-2].minor.yy52;
+	yylhsminor.yy52->PushBack(true, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1615 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1640 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,14,&yymsp[-1].minor);
-  yymsp[-2].minor.yy50 = yylhsminor.yy50;
+  yymsp[-2].minor.yy52 = yylhsminor.yy52;
         break;
       case 21: /* expression ::= conjunction */
 #line 242 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = yymsp[0].minor.yy45;
+	yylhsminor.yy80 = yymsp[0].minor.yy61;
 }
-#line 1624 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1649 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 22: /* conjunction ::= expression AND expression */
 #line 245 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy45 = new ConjunctionExpression();
-	yylhsminor.yy45->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy64));
-	yylhsminor.yy45->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy61 = new ConjunctionExpression();
+	yylhsminor.yy61->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy80));
+	yylhsminor.yy61->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 
 }
-#line 1635 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1660 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,3,&yymsp[-1].minor);
-  yymsp[-2].minor.yy45 = yylhsminor.yy45;
+  yymsp[-2].minor.yy61 = yylhsminor.yy61;
         break;
       case 23: /* conjunction ::= conjunction AND expression */
 #line 251 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy45 = yymsp[-2].minor.yy45;
-	yylhsminor.yy45->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy61 = yymsp[-2].minor.yy61;
+	yylhsminor.yy61->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1645 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1670 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,3,&yymsp[-1].minor);
-  yymsp[-2].minor.yy45 = yylhsminor.yy45;
+  yymsp[-2].minor.yy61 = yylhsminor.yy61;
         break;
       case 24: /* expression ::= disjunction */
 #line 262 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = yymsp[0].minor.yy87;
+	yylhsminor.yy80 = yymsp[0].minor.yy109;
 }
-#line 1654 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy64 = yylhsminor.yy64;
+#line 1679 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy80 = yylhsminor.yy80;
         break;
       case 25: /* disjunction ::= expression OR expression */
 #line 265 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy87 = new DisjunctionExpression();
-	yylhsminor.yy87->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy64));
-	yylhsminor.yy87->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy109 = new DisjunctionExpression();
+	yylhsminor.yy109->PushBack(false, std::unique_ptr<IExpression>(yymsp[-2].minor.yy80));
+	yylhsminor.yy109->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 
 }
-#line 1665 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1690 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,4,&yymsp[-1].minor);
-  yymsp[-2].minor.yy87 = yylhsminor.yy87;
+  yymsp[-2].minor.yy109 = yylhsminor.yy109;
         break;
       case 26: /* disjunction ::= disjunction OR expression */
 #line 271 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy87 = yymsp[-2].minor.yy87;
-	yylhsminor.yy87->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy109 = yymsp[-2].minor.yy109;
+	yylhsminor.yy109->PushBack(false, std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1675 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1700 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,4,&yymsp[-1].minor);
-  yymsp[-2].minor.yy87 = yylhsminor.yy87;
+  yymsp[-2].minor.yy109 = yylhsminor.yy109;
         break;
       case 27: /* expression ::= NOT expression */
 {  yy_destructor(yypParser,16,&yymsp[-1].minor);
 #line 277 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[-1].minor.yy64 = new UnaryNotExpression(std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yymsp[-1].minor.yy80 = new UnaryNotExpression(std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1685 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1710 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
         break;
       case 28: /* expression ::= MINUS expression */
 {  yy_destructor(yypParser,12,&yymsp[-1].minor);
 #line 282 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[-1].minor.yy64 = new UnaryMinusExpression(std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yymsp[-1].minor.yy80 = new UnaryMinusExpression(std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1694 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1719 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
         break;
       case 29: /* expression ::= expression EXP expression */
 #line 287 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ExponentiationExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64));
+	yylhsminor.yy80 = new ExponentiationExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80));
 }
-#line 1702 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1727 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,15,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 30: /* expression ::= expression EQUAL expression */
 #line 293 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64), ComparisonExpression::type_equal);
+	yylhsminor.yy80 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80), ComparisonExpression::type_equal);
 }
-#line 1711 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1736 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,5,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 31: /* expression ::= expression NOT_EQUAL expression */
 #line 296 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64), ComparisonExpression::type_not_equal);
+	yylhsminor.yy80 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80), ComparisonExpression::type_not_equal);
 }
-#line 1720 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1745 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,6,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 32: /* expression ::= expression GREATER expression */
 #line 299 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64), ComparisonExpression::type_greater);
+	yylhsminor.yy80 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80), ComparisonExpression::type_greater);
 }
-#line 1729 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1754 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,7,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 33: /* expression ::= expression GREATER_EQUAL expression */
 #line 302 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64), ComparisonExpression::type_greater_equal);
+	yylhsminor.yy80 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80), ComparisonExpression::type_greater_equal);
 }
-#line 1738 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1763 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,8,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 34: /* expression ::= expression LESS expression */
 #line 305 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64), ComparisonExpression::type_less);
+	yylhsminor.yy80 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80), ComparisonExpression::type_less);
 }
-#line 1747 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1772 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,9,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 35: /* expression ::= expression LESS_EQUAL expression */
 #line 308 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy64 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy64), std::unique_ptr<IExpression>(yymsp[0].minor.yy64), ComparisonExpression::type_less_equal);
+	yylhsminor.yy80 = new ComparisonExpression(std::unique_ptr<IExpression>(yymsp[-2].minor.yy80), std::unique_ptr<IExpression>(yymsp[0].minor.yy80), ComparisonExpression::type_less_equal);
 }
-#line 1756 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1781 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,10,&yymsp[-1].minor);
-  yymsp[-2].minor.yy64 = yylhsminor.yy64;
+  yymsp[-2].minor.yy80 = yylhsminor.yy80;
         break;
       case 36: /* assignment ::= variable ASSIGN expression SEMICOLON */
 #line 320 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	// create_variable might throw an exception, which results in automatic destruction of yymsp[-3].minor.yy100 and yymsp[-1].minor.yy64 by the parser. We thus have to make sure that
+	// create_variable might throw an exception, which results in automatic destruction of yymsp[-3].minor.yy46 and yymsp[-1].minor.yy80 by the parser. We thus have to make sure that
 	// they point to null to avoid double deletion.
-	identifier name = *yymsp[-3].minor.yy100;
-	delete yymsp[-3].minor.yy100;
-	yymsp[-3].minor.yy100 = nullptr;
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy64);
-	yymsp[-1].minor.yy64 = nullptr;
+	identifier name = *yymsp[-3].minor.yy46;
+	delete yymsp[-3].minor.yy46;
+	yymsp[-3].minor.yy46 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy80);
+	yymsp[-1].minor.yy80 = nullptr;
 
 	parseTree->CreateVariable(std::move(name), parseTree->GetExpressionValue(e_temp.get()));
 }
-#line 1773 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1798 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,25,&yymsp[-2].minor);
   yy_destructor(yypParser,1,&yymsp[0].minor);
         break;
       case 37: /* assignment ::= variable ASSIGN LEFT_SQUARE expression RIGHT_SQUARE SEMICOLON */
 #line 332 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	// create_variable might throw an exception, which results in automatic destruction of yymsp[-5].minor.yy100 and yymsp[-2].minor.yy64 by the parser. We thus have to make sure that
+	// create_variable might throw an exception, which results in automatic destruction of yymsp[-5].minor.yy46 and yymsp[-2].minor.yy80 by the parser. We thus have to make sure that
 	// they point to null to avoid double deletion.
-	identifier name = *yymsp[-5].minor.yy100;
-	delete yymsp[-5].minor.yy100;
-	yymsp[-5].minor.yy100 = nullptr;
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-2].minor.yy64);
-	yymsp[-2].minor.yy64 = nullptr;
+	identifier name = *yymsp[-5].minor.yy46;
+	delete yymsp[-5].minor.yy46;
+	yymsp[-5].minor.yy46 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-2].minor.yy80);
+	yymsp[-2].minor.yy80 = nullptr;
 
 	parseTree->CreateVariable(std::move(name), std::move(e_temp));
 }
-#line 1790 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1815 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,25,&yymsp[-4].minor);
   yy_destructor(yypParser,19,&yymsp[-3].minor);
   yy_destructor(yypParser,20,&yymsp[-1].minor);
@@ -1795,18 +1820,18 @@ static void yy_reduce(
       case 38: /* reaction ::= reactionLeftSide ARROW reactionRightSide COMMA reactionSpecifiers SEMICOLON */
 #line 346 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	// create_reaction might throw an exception, which results in automatic destruction of yymsp[-5].minor.yy96, yymsp[-3].minor.yy5 and e by the parser. We thus have to make sure that
+	// create_reaction might throw an exception, which results in automatic destruction of yymsp[-5].minor.yy8, yymsp[-3].minor.yy31 and e by the parser. We thus have to make sure that
 	// they point to null to avoid double deletion.
-	auto reactants_temp = std::unique_ptr<ReactionLeftSide>(yymsp[-5].minor.yy96);
-	auto products_temp = std::unique_ptr<ReactionRightSide>(yymsp[-3].minor.yy5);
-	auto rss_temp = std::unique_ptr<ReactionSpecifiers>(yymsp[-1].minor.yy29);
-	yymsp[-1].minor.yy29 = nullptr;
-	yymsp[-5].minor.yy96 = nullptr;
-	yymsp[-3].minor.yy5 = nullptr;
+	auto reactants_temp = std::unique_ptr<ReactionLeftSide>(yymsp[-5].minor.yy8);
+	auto products_temp = std::unique_ptr<ReactionRightSide>(yymsp[-3].minor.yy31);
+	auto rss_temp = std::unique_ptr<ReactionSpecifiers>(yymsp[-1].minor.yy85);
+	yymsp[-1].minor.yy85 = nullptr;
+	yymsp[-5].minor.yy8 = nullptr;
+	yymsp[-3].minor.yy31 = nullptr;
 
 	parseTree->CreateReaction(std::move(reactants_temp), std::move(products_temp), std::move(rss_temp));
 }
-#line 1810 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1835 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,26,&yymsp[-4].minor);
   yy_destructor(yypParser,24,&yymsp[-2].minor);
   yy_destructor(yypParser,1,&yymsp[0].minor);
@@ -1814,21 +1839,21 @@ static void yy_reduce(
       case 39: /* reaction ::= variable COMMA reactionLeftSide ARROW reactionRightSide COMMA reactionSpecifiers SEMICOLON */
 #line 359 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	// create_reaction might throw an exception, which results in automatic destruction of yymsp[-5].minor.yy96, yymsp[-3].minor.yy5 and e by the parser. We thus have to make sure that
+	// create_reaction might throw an exception, which results in automatic destruction of yymsp[-5].minor.yy8, yymsp[-3].minor.yy31 and e by the parser. We thus have to make sure that
 	// they point to null to avoid double deletion.
-	auto reactants_temp = std::unique_ptr<ReactionLeftSide>(yymsp[-5].minor.yy96);
-	auto products_temp = std::unique_ptr<ReactionRightSide>(yymsp[-3].minor.yy5);
-	auto rss_temp = std::unique_ptr<ReactionSpecifiers>(yymsp[-1].minor.yy29);
-	identifier name = *yymsp[-7].minor.yy100; 
-	yymsp[-1].minor.yy29 = nullptr;
-	yymsp[-5].minor.yy96 = nullptr;
-	yymsp[-3].minor.yy5 = nullptr;
-	delete yymsp[-7].minor.yy100;
-	yymsp[-7].minor.yy100 = nullptr;
+	auto reactants_temp = std::unique_ptr<ReactionLeftSide>(yymsp[-5].minor.yy8);
+	auto products_temp = std::unique_ptr<ReactionRightSide>(yymsp[-3].minor.yy31);
+	auto rss_temp = std::unique_ptr<ReactionSpecifiers>(yymsp[-1].minor.yy85);
+	identifier name = *yymsp[-7].minor.yy46; 
+	yymsp[-1].minor.yy85 = nullptr;
+	yymsp[-5].minor.yy8 = nullptr;
+	yymsp[-3].minor.yy31 = nullptr;
+	delete yymsp[-7].minor.yy46;
+	yymsp[-7].minor.yy46 = nullptr;
 
 	parseTree->CreateReaction(std::move(name), std::move(reactants_temp), std::move(products_temp), std::move(rss_temp));
 }
-#line 1832 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1857 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[-6].minor);
   yy_destructor(yypParser,26,&yymsp[-4].minor);
   yy_destructor(yypParser,24,&yymsp[-2].minor);
@@ -1838,496 +1863,541 @@ static void yy_reduce(
 #line 380 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
 	auto rss_temp = std::make_unique<ReactionSpecifiers>();
-	auto rs_temp = std::unique_ptr<ReactionSpecifier>(yymsp[0].minor.yy97);
-	yymsp[0].minor.yy97 = nullptr;
-	yylhsminor.yy29 = nullptr;
+	auto rs_temp = std::unique_ptr<ReactionSpecifier>(yymsp[0].minor.yy74);
+	yymsp[0].minor.yy74 = nullptr;
+	yylhsminor.yy85 = nullptr;
 	rss_temp->PushBack(std::move(rs_temp));
-	yylhsminor.yy29 = rss_temp.release();
+	yylhsminor.yy85 = rss_temp.release();
 }
-#line 1848 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy29 = yylhsminor.yy29;
+#line 1873 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy85 = yylhsminor.yy85;
         break;
       case 41: /* reactionSpecifiers ::= reactionSpecifiers COMMA reactionSpecifier */
 #line 388 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto rss_temp = std::unique_ptr<ReactionSpecifiers>(yymsp[-2].minor.yy29);
-	yymsp[-2].minor.yy29 = nullptr;
-	yylhsminor.yy29 = nullptr;
-	auto rs_temp = std::unique_ptr<ReactionSpecifier>(yymsp[0].minor.yy97);
-	yymsp[0].minor.yy97 = nullptr;
+	auto rss_temp = std::unique_ptr<ReactionSpecifiers>(yymsp[-2].minor.yy85);
+	yymsp[-2].minor.yy85 = nullptr;
+	yylhsminor.yy85 = nullptr;
+	auto rs_temp = std::unique_ptr<ReactionSpecifier>(yymsp[0].minor.yy74);
+	yymsp[0].minor.yy74 = nullptr;
 	rss_temp->PushBack(std::move(rs_temp));
-	yylhsminor.yy29 = rss_temp.release();
+	yylhsminor.yy85 = rss_temp.release();
 }
-#line 1862 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1887 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[-1].minor);
-  yymsp[-2].minor.yy29 = yylhsminor.yy29;
+  yymsp[-2].minor.yy85 = yylhsminor.yy85;
         break;
       case 42: /* reactionSpecifier ::= expression */
 #line 403 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64 = nullptr;
-	yylhsminor.yy97 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80 = nullptr;
+	yylhsminor.yy74 = nullptr;
 	auto value = parseTree->GetExpressionValue(e_temp.get());
-	yylhsminor.yy97 = new ReactionSpecifier(ReactionSpecifier::rate_type, std::make_unique<NumberExpression>(value));
+	yylhsminor.yy74 = new ReactionSpecifier(ReactionSpecifier::rate_type, std::make_unique<NumberExpression>(value));
 }
-#line 1875 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy97 = yylhsminor.yy97;
+#line 1900 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy74 = yylhsminor.yy74;
         break;
       case 43: /* reactionSpecifier ::= variable COLON expression */
 #line 411 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64 = nullptr;
-	yylhsminor.yy97 = nullptr;
-	identifier name = *yymsp[-2].minor.yy100;
-	delete yymsp[-2].minor.yy100;
-	yymsp[-2].minor.yy100 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80 = nullptr;
+	yylhsminor.yy74 = nullptr;
+	identifier name = *yymsp[-2].minor.yy46;
+	delete yymsp[-2].minor.yy46;
+	yymsp[-2].minor.yy46 = nullptr;
 	auto value = parseTree->GetExpressionValue(e_temp.get());
-	yylhsminor.yy97 = new ReactionSpecifier(name, std::make_unique<NumberExpression>(value));
+	yylhsminor.yy74 = new ReactionSpecifier(name, std::make_unique<NumberExpression>(value));
 }
-#line 1890 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1915 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,23,&yymsp[-1].minor);
-  yymsp[-2].minor.yy97 = yylhsminor.yy97;
+  yymsp[-2].minor.yy74 = yylhsminor.yy74;
         break;
       case 44: /* reactionSpecifier ::= LEFT_SQUARE expression RIGHT_SQUARE */
 {  yy_destructor(yypParser,19,&yymsp[-2].minor);
 #line 422 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy64);
-	yymsp[-1].minor.yy64 = nullptr;
-	yymsp[-2].minor.yy97 = nullptr;
-	yymsp[-2].minor.yy97 = new ReactionSpecifier(ReactionSpecifier::rate_type, std::move(e_temp));
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy80);
+	yymsp[-1].minor.yy80 = nullptr;
+	yymsp[-2].minor.yy74 = nullptr;
+	yymsp[-2].minor.yy74 = new ReactionSpecifier(ReactionSpecifier::rate_type, std::move(e_temp));
 }
-#line 1903 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1928 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,20,&yymsp[0].minor);
 }
         break;
-      case 45: /* reactionLeftSide ::= */
-#line 438 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 45: /* reactionSpecifier ::= variable COLON LEFT_SQUARE expression RIGHT_SQUARE */
+#line 429 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+{
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy80);
+	yymsp[-1].minor.yy80 = nullptr;
+	yylhsminor.yy74 = nullptr;
+	identifier name = *yymsp[-4].minor.yy46;
+	delete yymsp[-4].minor.yy46;
+	yymsp[-4].minor.yy46 = nullptr;
+	yylhsminor.yy74 = new ReactionSpecifier(name, std::move(e_temp));
+}
+#line 1943 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yy_destructor(yypParser,23,&yymsp[-3].minor);
+  yy_destructor(yypParser,19,&yymsp[-2].minor);
+  yy_destructor(yypParser,20,&yymsp[0].minor);
+  yymsp[-4].minor.yy74 = yylhsminor.yy74;
+        break;
+      case 46: /* reactionLeftSide ::= */
+#line 448 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[1].minor.yy96 = new ReactionLeftSide();
+	yymsp[1].minor.yy8 = new ReactionLeftSide();
 }
-#line 1912 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1954 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
         break;
-      case 46: /* reactionLeftSide ::= reactionLeftComponent */
-#line 441 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 47: /* reactionLeftSide ::= reactionLeftComponent */
+#line 451 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto rc_temp = std::unique_ptr<ReactionLeftComponent>(yymsp[0].minor.yy14);
-	yymsp[0].minor.yy14 = nullptr;
-	yylhsminor.yy96 = nullptr;
+	auto rc_temp = std::unique_ptr<ReactionLeftComponent>(yymsp[0].minor.yy6);
+	yymsp[0].minor.yy6 = nullptr;
+	yylhsminor.yy8 = nullptr;
 
 	auto rs_temp = std::make_unique<ReactionLeftSide>();
 	rs_temp->PushBack(std::move(rc_temp));
-	yylhsminor.yy96 = rs_temp.release();
+	yylhsminor.yy8 = rs_temp.release();
 }
-#line 1925 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy96 = yylhsminor.yy96;
+#line 1967 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy8 = yylhsminor.yy8;
         break;
-      case 47: /* reactionLeftSide ::= reactionLeftSide PLUS reactionLeftComponent */
-#line 450 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 48: /* reactionLeftSide ::= reactionLeftSide PLUS reactionLeftComponent */
+#line 460 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy96 = yymsp[-2].minor.yy96;
-	yymsp[-2].minor.yy96 = nullptr;
-	auto rc_temp = std::unique_ptr<ReactionLeftComponent>(yymsp[0].minor.yy14);
-	yymsp[0].minor.yy14 = nullptr;
+	yylhsminor.yy8 = yymsp[-2].minor.yy8;
+	yymsp[-2].minor.yy8 = nullptr;
+	auto rc_temp = std::unique_ptr<ReactionLeftComponent>(yymsp[0].minor.yy6);
+	yymsp[0].minor.yy6 = nullptr;
 
-	yylhsminor.yy96->PushBack(std::move(rc_temp));
+	yylhsminor.yy8->PushBack(std::move(rc_temp));
 }
-#line 1938 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1980 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
-  yymsp[-2].minor.yy96 = yylhsminor.yy96;
+  yymsp[-2].minor.yy8 = yylhsminor.yy8;
         break;
-      case 48: /* reactionLeftSide ::= expression PLUS expression */
-#line 459 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 49: /* reactionLeftSide ::= expression PLUS expression */
+#line 469 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	delete(yymsp[-2].minor.yy64);
-	yymsp[-2].minor.yy64=nullptr;
-	delete(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64=nullptr;
+	delete(yymsp[-2].minor.yy80);
+	yymsp[-2].minor.yy80=nullptr;
+	delete(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80=nullptr;
 	throw std::exception("Reactants or modifiers of a reaction must either be state names, or an expression (representing the stochiometry of the state) times the state name, in this order.");
 }
-#line 1951 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 1993 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
         break;
-      case 49: /* reactionLeftSide ::= reactionLeftSide PLUS expression */
-#line 467 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 50: /* reactionLeftSide ::= reactionLeftSide PLUS expression */
+#line 477 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	delete(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64=nullptr;
-	delete(yymsp[-2].minor.yy96);
-	yymsp[-2].minor.yy96=nullptr;
+	delete(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80=nullptr;
+	delete(yymsp[-2].minor.yy8);
+	yymsp[-2].minor.yy8=nullptr;
 	throw std::exception("Reactants or modifiers of a reaction must either be state names, or an expression (representing the stochiometry of the state) times the state name, in this order.");
 }
-#line 1963 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2005 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
         break;
-      case 50: /* moleculePropertyNames ::= */
-#line 480 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 51: /* moleculePropertyNames ::= */
+#line 490 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[1].minor.yy110 = new MoleculePropertyNames();
-	yymsp[1].minor.yy110->push_back("");
+	yymsp[1].minor.yy18 = new MoleculePropertyNames();
+	yymsp[1].minor.yy18->push_back("");
 }
-#line 1972 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2014 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
         break;
-      case 51: /* moleculePropertyNames ::= variable */
-#line 484 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 52: /* moleculePropertyNames ::= variable */
+#line 494 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier name = *yymsp[0].minor.yy100;
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
+	identifier name = *yymsp[0].minor.yy46;
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
 
-	yylhsminor.yy110 = new MoleculePropertyNames();
-	yylhsminor.yy110->push_back(name);
+	yylhsminor.yy18 = new MoleculePropertyNames();
+	yylhsminor.yy18->push_back(name);
 }
-#line 1984 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy110 = yylhsminor.yy110;
+#line 2026 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy18 = yylhsminor.yy18;
         break;
-      case 52: /* moleculePropertyNames ::= moleculePropertyNames COMMA variable */
-#line 492 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 53: /* moleculePropertyNames ::= moleculePropertyNames COMMA variable */
+#line 502 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy110 = yymsp[-2].minor.yy110;
-	yymsp[-2].minor.yy110 = nullptr;
-	identifier name = *yymsp[0].minor.yy100;
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
+	yylhsminor.yy18 = yymsp[-2].minor.yy18;
+	yymsp[-2].minor.yy18 = nullptr;
+	identifier name = *yymsp[0].minor.yy46;
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
 
-	yylhsminor.yy110->push_back(name);
+	yylhsminor.yy18->push_back(name);
 }
-#line 1998 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2040 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[-1].minor);
-  yymsp[-2].minor.yy110 = yylhsminor.yy110;
+  yymsp[-2].minor.yy18 = yylhsminor.yy18;
         break;
-      case 53: /* moleculePropertyNames ::= moleculePropertyNames COMMA */
-#line 501 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 54: /* moleculePropertyNames ::= moleculePropertyNames COMMA */
+#line 511 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy110 = yymsp[-1].minor.yy110;
-	yymsp[-1].minor.yy110 = nullptr;
-	yylhsminor.yy110->push_back("");
+	yylhsminor.yy18 = yymsp[-1].minor.yy18;
+	yymsp[-1].minor.yy18 = nullptr;
+	yylhsminor.yy18->push_back("");
 }
-#line 2009 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2051 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[0].minor);
-  yymsp[-1].minor.yy110 = yylhsminor.yy110;
+  yymsp[-1].minor.yy18 = yylhsminor.yy18;
         break;
-      case 54: /* reactionLeftComponent ::= variable */
-#line 512 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 55: /* reactionLeftComponent ::= variable */
+#line 522 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[0].minor.yy100;
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
-	yylhsminor.yy14 = nullptr;
+	identifier state = *yymsp[0].minor.yy46;
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
+	yylhsminor.yy6 = nullptr;
 
-	yylhsminor.yy14 = new ReactionLeftComponent(state, 1, false);
+	yylhsminor.yy6 = new ReactionLeftComponent(state, 1, false);
 }
-#line 2023 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy14 = yylhsminor.yy14;
+#line 2065 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy6 = yylhsminor.yy6;
         break;
-      case 55: /* reactionLeftComponent ::= variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY */
-#line 520 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 56: /* reactionLeftComponent ::= variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY */
+#line 530 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[-3].minor.yy100;
-	delete yymsp[-3].minor.yy100;
-	yymsp[-3].minor.yy100 = nullptr;
-	yylhsminor.yy14 = nullptr;
-	auto as_temp = std::unique_ptr<MoleculePropertyNames>(yymsp[-1].minor.yy110);
-	yymsp[-1].minor.yy110 = nullptr;
+	identifier state = *yymsp[-3].minor.yy46;
+	delete yymsp[-3].minor.yy46;
+	yymsp[-3].minor.yy46 = nullptr;
+	yylhsminor.yy6 = nullptr;
+	auto as_temp = std::unique_ptr<MoleculePropertyNames>(yymsp[-1].minor.yy18);
+	yymsp[-1].minor.yy18 = nullptr;
 
-	yylhsminor.yy14 = new ReactionLeftComponent(state, 1, false, std::move(as_temp));
+	yylhsminor.yy6 = new ReactionLeftComponent(state, 1, false, std::move(as_temp));
 }
-#line 2038 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2080 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,27,&yymsp[-2].minor);
   yy_destructor(yypParser,28,&yymsp[0].minor);
-  yymsp[-3].minor.yy14 = yylhsminor.yy14;
+  yymsp[-3].minor.yy6 = yylhsminor.yy6;
         break;
-      case 56: /* reactionLeftComponent ::= DOLLAR variable */
+      case 57: /* reactionLeftComponent ::= DOLLAR variable */
 {  yy_destructor(yypParser,29,&yymsp[-1].minor);
-#line 531 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 541 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[0].minor.yy100;
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
-	yymsp[-1].minor.yy14 = nullptr;
+	identifier state = *yymsp[0].minor.yy46;
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
+	yymsp[-1].minor.yy6 = nullptr;
 
-	yymsp[-1].minor.yy14 = new ReactionLeftComponent(state, 1, true);
+	yymsp[-1].minor.yy6 = new ReactionLeftComponent(state, 1, true);
 }
-#line 2054 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2096 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
         break;
-      case 57: /* reactionLeftComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY */
+      case 58: /* reactionLeftComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyNames RIGHT_CURLY */
 {  yy_destructor(yypParser,29,&yymsp[-4].minor);
-#line 540 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 550 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[-3].minor.yy100;
-	delete yymsp[-3].minor.yy100;
-	yymsp[-3].minor.yy100 = nullptr;
-	yymsp[-4].minor.yy14 = nullptr;
-	auto as_temp = std::unique_ptr<MoleculePropertyNames>(yymsp[-1].minor.yy110);
-	yymsp[-1].minor.yy110 = nullptr;
+	identifier state = *yymsp[-3].minor.yy46;
+	delete yymsp[-3].minor.yy46;
+	yymsp[-3].minor.yy46 = nullptr;
+	yymsp[-4].minor.yy6 = nullptr;
+	auto as_temp = std::unique_ptr<MoleculePropertyNames>(yymsp[-1].minor.yy18);
+	yymsp[-1].minor.yy18 = nullptr;
 
-	yymsp[-4].minor.yy14 = new ReactionLeftComponent(state, 1, true, std::move(as_temp));
+	yymsp[-4].minor.yy6 = new ReactionLeftComponent(state, 1, true, std::move(as_temp));
 }
-#line 2070 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2112 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,27,&yymsp[-2].minor);
   yy_destructor(yypParser,28,&yymsp[0].minor);
 }
         break;
-      case 58: /* reactionLeftComponent ::= expression MULTIPLY reactionLeftComponent */
-#line 551 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 59: /* reactionLeftComponent ::= expression MULTIPLY reactionLeftComponent */
+#line 561 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto rc_temp = std::unique_ptr<ReactionLeftComponent>(yymsp[0].minor.yy14);
-	yymsp[0].minor.yy14 = nullptr;
-	yylhsminor.yy14 = nullptr;
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-2].minor.yy64);
-	yymsp[-2].minor.yy64 = nullptr;
+	auto rc_temp = std::unique_ptr<ReactionLeftComponent>(yymsp[0].minor.yy6);
+	yymsp[0].minor.yy6 = nullptr;
+	yylhsminor.yy6 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-2].minor.yy80);
+	yymsp[-2].minor.yy80 = nullptr;
 
 	auto stochiometry = parseTree->GetExpressionValue(e_temp.get());
 	if(stochiometry<=0)
 		throw std::exception("Stochiometry must be positive.");
 	rc_temp->SetStochiometry(static_cast<stochsim::Stochiometry>(rc_temp->GetStochiometry()*stochiometry));
-	yylhsminor.yy14 = rc_temp.release();
+	yylhsminor.yy6 = rc_temp.release();
 }
-#line 2090 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2132 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,13,&yymsp[-1].minor);
-  yymsp[-2].minor.yy14 = yylhsminor.yy14;
+  yymsp[-2].minor.yy6 = yylhsminor.yy6;
         break;
-      case 59: /* reactionRightSide ::= */
-#line 574 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 60: /* reactionRightSide ::= */
+#line 584 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[1].minor.yy5 = new ReactionRightSide();
+	yymsp[1].minor.yy31 = new ReactionRightSide();
 }
-#line 2099 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2141 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
         break;
-      case 60: /* reactionRightSide ::= reactionRightComponent */
-#line 577 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 61: /* reactionRightSide ::= reactionRightComponent */
+#line 587 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto rc_temp = std::unique_ptr<ReactionRightComponent>(yymsp[0].minor.yy77);
-	yymsp[0].minor.yy77 = nullptr;
-	yylhsminor.yy5 = nullptr;
+	auto rc_temp = std::unique_ptr<ReactionRightComponent>(yymsp[0].minor.yy25);
+	yymsp[0].minor.yy25 = nullptr;
+	yylhsminor.yy31 = nullptr;
 
 	auto rs_temp = std::make_unique<ReactionRightSide>();
 	rs_temp->PushBack(std::move(rc_temp));
-	yylhsminor.yy5 = rs_temp.release();
+	yylhsminor.yy31 = rs_temp.release();
 }
-#line 2112 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy5 = yylhsminor.yy5;
+#line 2154 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy31 = yylhsminor.yy31;
         break;
-      case 61: /* reactionRightSide ::= reactionRightSide PLUS reactionRightComponent */
-#line 586 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 62: /* reactionRightSide ::= reactionRightSide PLUS reactionRightComponent */
+#line 596 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy5 = yymsp[-2].minor.yy5;
-	yymsp[-2].minor.yy5 = nullptr;
-	auto rc_temp = std::unique_ptr<ReactionRightComponent>(yymsp[0].minor.yy77);
-	yymsp[0].minor.yy77 = nullptr;
+	yylhsminor.yy31 = yymsp[-2].minor.yy31;
+	yymsp[-2].minor.yy31 = nullptr;
+	auto rc_temp = std::unique_ptr<ReactionRightComponent>(yymsp[0].minor.yy25);
+	yymsp[0].minor.yy25 = nullptr;
 
-	yylhsminor.yy5->PushBack(std::move(rc_temp));
+	yylhsminor.yy31->PushBack(std::move(rc_temp));
 }
-#line 2125 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2167 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
-  yymsp[-2].minor.yy5 = yylhsminor.yy5;
+  yymsp[-2].minor.yy31 = yylhsminor.yy31;
         break;
-      case 62: /* reactionRightSide ::= expression PLUS expression */
-#line 595 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 63: /* reactionRightSide ::= expression PLUS expression */
+#line 605 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	delete(yymsp[-2].minor.yy64);
-	yymsp[-2].minor.yy64=nullptr;
-	delete(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64=nullptr;
+	delete(yymsp[-2].minor.yy80);
+	yymsp[-2].minor.yy80=nullptr;
+	delete(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80=nullptr;
 	throw std::exception("Products or transformees of a reaction must either be state names, or an expression (representing the stochiometry of the state) times the state name, in this order.");
 }
-#line 2138 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2180 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
         break;
-      case 63: /* reactionRightSide ::= reactionRightSide PLUS expression */
-#line 603 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 64: /* reactionRightSide ::= reactionRightSide PLUS expression */
+#line 613 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	delete(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64=nullptr;
-	delete(yymsp[-2].minor.yy5);
-	yymsp[-2].minor.yy5=nullptr;
+	delete(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80=nullptr;
+	delete(yymsp[-2].minor.yy31);
+	yymsp[-2].minor.yy31=nullptr;
 	throw std::exception("Products or transformees of a reaction must either be state names, or an expression (representing the stochiometry of the state) times the state name, in this order.");
 }
-#line 2150 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2192 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,11,&yymsp[-1].minor);
         break;
-      case 64: /* moleculePropertyExpressions ::= */
-#line 616 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 65: /* moleculePropertyExpressions ::= */
+#line 626 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yymsp[1].minor.yy30 = new MoleculePropertyExpressions();
-	yymsp[1].minor.yy30->push_back(std::unique_ptr<IExpression>(nullptr));
+	yymsp[1].minor.yy29 = new MoleculePropertyExpressions();
+	yymsp[1].minor.yy29->push_back(std::unique_ptr<IExpression>(nullptr));
 }
-#line 2159 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2201 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
         break;
-      case 65: /* moleculePropertyExpressions ::= expression */
-#line 620 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 66: /* moleculePropertyExpressions ::= expression */
+#line 630 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80 = nullptr;
 
-	yylhsminor.yy30 = new MoleculePropertyExpressions();
-	yylhsminor.yy30->push_back(std::move(e_temp));
+	yylhsminor.yy29 = new MoleculePropertyExpressions();
+	yylhsminor.yy29->push_back(std::move(e_temp));
 }
-#line 2170 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy30 = yylhsminor.yy30;
+#line 2212 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy29 = yylhsminor.yy29;
         break;
-      case 66: /* moleculePropertyExpressions ::= moleculePropertyExpressions COMMA expression */
-#line 627 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 67: /* moleculePropertyExpressions ::= moleculePropertyExpressions COMMA expression */
+#line 637 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy30 = yymsp[-2].minor.yy30;
-	yymsp[-2].minor.yy30 = nullptr;
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy64);
-	yymsp[0].minor.yy64 = nullptr;
+	yylhsminor.yy29 = yymsp[-2].minor.yy29;
+	yymsp[-2].minor.yy29 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[0].minor.yy80);
+	yymsp[0].minor.yy80 = nullptr;
 
-	yylhsminor.yy30->push_back(std::move(e_temp));
+	yylhsminor.yy29->push_back(std::move(e_temp));
 }
-#line 2183 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2225 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[-1].minor);
-  yymsp[-2].minor.yy30 = yylhsminor.yy30;
+  yymsp[-2].minor.yy29 = yylhsminor.yy29;
         break;
-      case 67: /* moleculePropertyExpressions ::= moleculePropertyExpressions COMMA */
-#line 635 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 68: /* moleculePropertyExpressions ::= moleculePropertyExpressions COMMA */
+#line 645 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	yylhsminor.yy30 = yymsp[-1].minor.yy30;
-	yymsp[-1].minor.yy30 = nullptr;
+	yylhsminor.yy29 = yymsp[-1].minor.yy29;
+	yymsp[-1].minor.yy29 = nullptr;
 
-	yylhsminor.yy30->push_back(std::unique_ptr<IExpression>(nullptr));
+	yylhsminor.yy29->push_back(std::unique_ptr<IExpression>(nullptr));
 }
-#line 2195 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2237 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,24,&yymsp[0].minor);
-  yymsp[-1].minor.yy30 = yylhsminor.yy30;
+  yymsp[-1].minor.yy29 = yylhsminor.yy29;
         break;
-      case 68: /* reactionRightComponent ::= variable */
-#line 647 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 69: /* reactionRightComponent ::= variable */
+#line 657 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[0].minor.yy100;
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
-	yylhsminor.yy77 = nullptr;
+	identifier state = *yymsp[0].minor.yy46;
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
+	yylhsminor.yy25 = nullptr;
 
-	yylhsminor.yy77 = new ReactionRightComponent(state, 1, false);
+	yylhsminor.yy25 = new ReactionRightComponent(state, 1, false);
 }
-#line 2209 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
-  yymsp[0].minor.yy77 = yylhsminor.yy77;
+#line 2251 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yymsp[0].minor.yy25 = yylhsminor.yy25;
         break;
-      case 69: /* reactionRightComponent ::= variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY */
-#line 655 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 70: /* reactionRightComponent ::= variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY */
+#line 665 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[-3].minor.yy100;
-	delete yymsp[-3].minor.yy100;
-	yymsp[-3].minor.yy100 = nullptr;
-	yylhsminor.yy77 = nullptr;
-	auto as_temp = std::unique_ptr<MoleculePropertyExpressions>(yymsp[-1].minor.yy30);
-	yymsp[-1].minor.yy30 = nullptr;
+	identifier state = *yymsp[-3].minor.yy46;
+	delete yymsp[-3].minor.yy46;
+	yymsp[-3].minor.yy46 = nullptr;
+	yylhsminor.yy25 = nullptr;
+	auto as_temp = std::unique_ptr<MoleculePropertyExpressions>(yymsp[-1].minor.yy29);
+	yymsp[-1].minor.yy29 = nullptr;
 
-	yylhsminor.yy77 = new ReactionRightComponent(state, 1, false, std::move(as_temp));
+	yylhsminor.yy25 = new ReactionRightComponent(state, 1, false, std::move(as_temp));
 }
-#line 2224 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2266 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,27,&yymsp[-2].minor);
   yy_destructor(yypParser,28,&yymsp[0].minor);
-  yymsp[-3].minor.yy77 = yylhsminor.yy77;
+  yymsp[-3].minor.yy25 = yylhsminor.yy25;
         break;
-      case 70: /* reactionRightComponent ::= DOLLAR variable */
+      case 71: /* reactionRightComponent ::= DOLLAR variable */
 {  yy_destructor(yypParser,29,&yymsp[-1].minor);
-#line 666 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 676 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[0].minor.yy100;
-	delete yymsp[0].minor.yy100;
-	yymsp[0].minor.yy100 = nullptr;
-	yymsp[-1].minor.yy77 = nullptr;
+	identifier state = *yymsp[0].minor.yy46;
+	delete yymsp[0].minor.yy46;
+	yymsp[0].minor.yy46 = nullptr;
+	yymsp[-1].minor.yy25 = nullptr;
 
-	yymsp[-1].minor.yy77 = new ReactionRightComponent(state, 1, true);
+	yymsp[-1].minor.yy25 = new ReactionRightComponent(state, 1, true);
 }
-#line 2240 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2282 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 }
         break;
-      case 71: /* reactionRightComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY */
+      case 72: /* reactionRightComponent ::= DOLLAR variable LEFT_CURLY moleculePropertyExpressions RIGHT_CURLY */
 {  yy_destructor(yypParser,29,&yymsp[-4].minor);
-#line 675 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 685 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier state = *yymsp[-3].minor.yy100;
-	delete yymsp[-3].minor.yy100;
-	yymsp[-3].minor.yy100 = nullptr;
-	yymsp[-4].minor.yy77 = nullptr;
-	auto as_temp = std::unique_ptr<MoleculePropertyExpressions>(yymsp[-1].minor.yy30);
-	yymsp[-1].minor.yy30 = nullptr;
+	identifier state = *yymsp[-3].minor.yy46;
+	delete yymsp[-3].minor.yy46;
+	yymsp[-3].minor.yy46 = nullptr;
+	yymsp[-4].minor.yy25 = nullptr;
+	auto as_temp = std::unique_ptr<MoleculePropertyExpressions>(yymsp[-1].minor.yy29);
+	yymsp[-1].minor.yy29 = nullptr;
 
-	yymsp[-4].minor.yy77 = new ReactionRightComponent(state, 1, true, std::move(as_temp));
+	yymsp[-4].minor.yy25 = new ReactionRightComponent(state, 1, true, std::move(as_temp));
 }
-#line 2256 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2298 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,27,&yymsp[-2].minor);
   yy_destructor(yypParser,28,&yymsp[0].minor);
 }
         break;
-      case 72: /* reactionRightComponent ::= expression MULTIPLY reactionRightComponent */
-#line 686 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+      case 73: /* reactionRightComponent ::= expression MULTIPLY reactionRightComponent */
+#line 696 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto rc_temp = std::unique_ptr<ReactionRightComponent>(yymsp[0].minor.yy77);
-	yymsp[0].minor.yy77 = nullptr;
-	yylhsminor.yy77 = nullptr;
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-2].minor.yy64);
-	yymsp[-2].minor.yy64 = nullptr;
+	auto rc_temp = std::unique_ptr<ReactionRightComponent>(yymsp[0].minor.yy25);
+	yymsp[0].minor.yy25 = nullptr;
+	yylhsminor.yy25 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-2].minor.yy80);
+	yymsp[-2].minor.yy80 = nullptr;
 
 	auto stochiometry = parseTree->GetExpressionValue(e_temp.get());
 	if(stochiometry<=0)
 		throw std::exception("Stochiometry must be positive.");
 	rc_temp->SetStochiometry(static_cast<stochsim::Stochiometry>(rc_temp->GetStochiometry()*stochiometry));
-	yylhsminor.yy77 = rc_temp.release();
+	yylhsminor.yy25 = rc_temp.release();
 }
-#line 2276 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2318 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,13,&yymsp[-1].minor);
-  yymsp[-2].minor.yy77 = yylhsminor.yy77;
+  yymsp[-2].minor.yy25 = yylhsminor.yy25;
         break;
-      case 73: /* reactionRightComponent ::= LEFT_SQUARE expression QUESTIONMARK reactionRightSide COLON reactionRightSide RIGHT_SQUARE */
+      case 74: /* reactionRightComponent ::= LEFT_SQUARE expression QUESTIONMARK reactionRightSide COLON reactionRightSide RIGHT_SQUARE */
 {  yy_destructor(yypParser,19,&yymsp[-6].minor);
-#line 700 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 710 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	auto e_temp = std::unique_ptr<IExpression>(yymsp[-5].minor.yy64);
-	yymsp[-5].minor.yy64 = nullptr;
-	auto s1_temp = std::unique_ptr<ReactionRightSide>(yymsp[-3].minor.yy5);
-	auto s2_temp = std::unique_ptr<ReactionRightSide>(yymsp[-1].minor.yy5);
-	yymsp[-3].minor.yy5 = nullptr;
-	yymsp[-1].minor.yy5 = nullptr;
-	yymsp[-6].minor.yy77 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-5].minor.yy80);
+	yymsp[-5].minor.yy80 = nullptr;
+	auto s1_temp = std::unique_ptr<ReactionRightSide>(yymsp[-3].minor.yy31);
+	auto s2_temp = std::unique_ptr<ReactionRightSide>(yymsp[-1].minor.yy31);
+	yymsp[-3].minor.yy31 = nullptr;
+	yymsp[-1].minor.yy31 = nullptr;
+	yymsp[-6].minor.yy25 = nullptr;
 
 	identifier state = parseTree->CreateChoice(std::move(e_temp), std::move(s1_temp), std::move(s2_temp));
-	yymsp[-6].minor.yy77 = new ReactionRightComponent(state, 1, false);
+	yymsp[-6].minor.yy25 = new ReactionRightComponent(state, 1, false);
 }
-#line 2295 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2337 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,2,&yymsp[-4].minor);
   yy_destructor(yypParser,23,&yymsp[-2].minor);
   yy_destructor(yypParser,20,&yymsp[0].minor);
 }
         break;
-      case 74: /* preprocessorDirective ::= INCLUDE variable SEMICOLON */
+      case 75: /* preprocessorDirective ::= INCLUDE variable SEMICOLON */
 {  yy_destructor(yypParser,31,&yymsp[-2].minor);
-#line 720 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 730 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
-	identifier fileName = *yymsp[-1].minor.yy100;
-	delete yymsp[-1].minor.yy100;
-	yymsp[-1].minor.yy100 = nullptr;
+	identifier fileName = *yymsp[-1].minor.yy46;
+	delete yymsp[-1].minor.yy46;
+	yymsp[-1].minor.yy46 = nullptr;
 	parseTree->IncludeFile(fileName);
 }
-#line 2310 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2352 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yy_destructor(yypParser,1,&yymsp[0].minor);
+}
+        break;
+      case 76: /* preprocessorDirective ::= STOP expression SEMICOLON */
+{  yy_destructor(yypParser,32,&yymsp[-2].minor);
+#line 738 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+{
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy80);
+	yymsp[-1].minor.yy80 = nullptr;
+	parseTree->CreateStopCondition(std::move(e_temp));
+}
+#line 2364 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yy_destructor(yypParser,1,&yymsp[0].minor);
+}
+        break;
+      case 77: /* preprocessorDirective ::= STOP IDENTIFIER COMMA expression SEMICOLON */
+{  yy_destructor(yypParser,32,&yymsp[-4].minor);
+#line 743 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+{
+	identifier name = *yymsp[-3].minor.yy0;
+	delete yymsp[-3].minor.yy0;
+	yymsp[-3].minor.yy0 = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(yymsp[-1].minor.yy80);
+	yymsp[-1].minor.yy80 = nullptr;
+	parseTree->CreateStopCondition(std::move(name), std::move(e_temp));
+}
+#line 2379 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+  yy_destructor(yypParser,24,&yymsp[-2].minor);
   yy_destructor(yypParser,1,&yymsp[0].minor);
 }
         break;
-      case 75: /* preprocessorDirective ::= MODEL_NAME IDENTIFIER SEMICOLON */
+      case 78: /* preprocessorDirective ::= MODEL_NAME IDENTIFIER SEMICOLON */
 {  yy_destructor(yypParser,30,&yymsp[-2].minor);
-#line 717 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
+#line 727 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 {
 }
-#line 2319 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2389 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
   yy_destructor(yypParser,17,&yymsp[-1].minor);
   yy_destructor(yypParser,1,&yymsp[0].minor);
 }
         break;
       default:
-      /* (76) model ::= statements */ yytestcase(yyruleno==76);
-      /* (77) statements ::= statements statement */ yytestcase(yyruleno==77);
-      /* (78) statements ::= */ yytestcase(yyruleno==78);
-      /* (79) statement ::= assignment (OPTIMIZED OUT) */ assert(yyruleno!=79);
-      /* (80) statement ::= reaction (OPTIMIZED OUT) */ assert(yyruleno!=80);
-      /* (81) statement ::= preprocessorDirective (OPTIMIZED OUT) */ assert(yyruleno!=81);
-      /* (82) statement ::= error (OPTIMIZED OUT) */ assert(yyruleno!=82);
+      /* (79) model ::= statements */ yytestcase(yyruleno==79);
+      /* (80) statements ::= statements statement */ yytestcase(yyruleno==80);
+      /* (81) statements ::= */ yytestcase(yyruleno==81);
+      /* (82) statement ::= assignment (OPTIMIZED OUT) */ assert(yyruleno!=82);
+      /* (83) statement ::= reaction (OPTIMIZED OUT) */ assert(yyruleno!=83);
+      /* (84) statement ::= preprocessorDirective (OPTIMIZED OUT) */ assert(yyruleno!=84);
+      /* (85) statement ::= error (OPTIMIZED OUT) */ assert(yyruleno!=85);
         break;
 /********** End reduce actions ************************************************/
   };
@@ -2374,7 +2444,7 @@ static void yy_parse_failed(
 /************ Begin %parse_failure code ***************************************/
 #line 4 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.y"
 throw std::exception("Syntax error.");
-#line 2378 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
+#line 2448 "C:\\stochsim\\lib\\cmdlparser\\cmdl_grammar.c"
 /************ End %parse_failure code *****************************************/
   cmdl_internal_ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
 }
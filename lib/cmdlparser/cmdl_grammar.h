@@ -29,3 +29,4 @@
 #define TOKEN_DOLLAR                          29
 #define TOKEN_MODEL_NAME                      30
 #define TOKEN_INCLUDE                         31
+#define TOKEN_STOP                            32
@@ -426,6 +426,16 @@ reactionSpecifier(rs) ::= LEFT_SQUARE expression(e) RIGHT_SQUARE. {
 	rs = new ReactionSpecifier(ReactionSpecifier::rate_type, std::move(e_temp));
 }
 
+reactionSpecifier(rs) ::= variable(I) COLON LEFT_SQUARE expression(e) RIGHT_SQUARE. {
+	auto e_temp = std::unique_ptr<IExpression>(e);
+	e = nullptr;
+	rs = nullptr;
+	identifier name = *I;
+	delete I;
+	I = nullptr;
+	rs = new ReactionSpecifier(name, std::move(e_temp));
+}
+
 ///////////////////////////
 // Left side of reaction
 ///////////////////////////
@@ -724,6 +734,21 @@ preprocessorDirective ::= INCLUDE variable(I) SEMICOLON. {
 	parseTree->IncludeFile(fileName);
 }
 
+// stop the simulation as soon as a condition is met, optionally giving the condition a name
+preprocessorDirective ::= STOP expression(e) SEMICOLON. {
+	auto e_temp = std::unique_ptr<IExpression>(e);
+	e = nullptr;
+	parseTree->CreateStopCondition(std::move(e_temp));
+}
+preprocessorDirective ::= STOP IDENTIFIER(I) COMMA expression(e) SEMICOLON. {
+	identifier name = *I;
+	delete I;
+	I = nullptr;
+	auto e_temp = std::unique_ptr<IExpression>(e);
+	e = nullptr;
+	parseTree->CreateStopCondition(std::move(name), std::move(e_temp));
+}
+
 // A model consists of a set of statements.
 model ::= statements.
 statements ::= statements statement.
@@ -392,6 +392,7 @@ namespace cmdlparser
 	public:
 		static constexpr char rate_type[] = "rate";
 		static constexpr char delay_type[] = "delay";
+		static constexpr char weight_type[] = "weight";
 		ReactionSpecifier(expression::identifier type, std::unique_ptr<expression::IExpression> value) : type_(std::move(type)), value_(std::move(value))
 		{
 		}
@@ -437,6 +438,10 @@ namespace cmdlparser
 		{
 			return HasType(ReactionSpecifier::delay_type);
 		}
+		bool HasWeight() const noexcept
+		{
+			return HasType(ReactionSpecifier::weight_type);
+		}
 		const expression::IExpression* GetType(expression::identifier type) const noexcept
 		{
 			auto search = specifiers_.find(type);
@@ -453,6 +458,10 @@ namespace cmdlparser
 		{
 			return GetType(ReactionSpecifier::delay_type);
 		}
+		const expression::IExpression* GetWeight() const noexcept
+		{
+			return GetType(ReactionSpecifier::weight_type);
+		}
 	private:
 		std::unordered_map<expression::identifier, std::unique_ptr<ReactionSpecifier> > specifiers_;
 		
@@ -2,9 +2,17 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <map>
+#include <cctype>
+#include <cmath>
 #include "CmdlParser.h"
 #include "StateLogger.h"
 #include "ProgressLogger.h"
+#include "Ensemble.h"
+#include "CompiledModel.h"
+#include "Checkpoint.h"
+#include "StopCondition.h"
+#include "SteadyStateDetector.h"
 
 std::string cmdGetOption(int &argc, char **argv, const std::string & option)
 {
@@ -43,84 +51,412 @@ void cmdHelp(std::ostream& stream, int &argc, char **argv)
 
 	stream << "         -dt   stepsize of saving state to disk" << std::endl;
 	stream << "               default: 1" << std::endl;
+
+	stream << "         -a    simulation algorithm, one of" << std::endl;
+	stream << "               direct: Gillespie's direct method" << std::endl;
+	stream << "               nrm:    Gibson and Bruck's next reaction method" << std::endl;
+	stream << "               sdm:    McCollum et al.'s sorting direct method" << std::endl;
+	stream << "               pdm:    Ramaswamy et al.'s partial-propensity direct method" << std::endl;
+	stream << "               cr:     Slepoy et al.'s composition-rejection method" << std::endl;
+	stream << "               tau:    Cao et al.'s tau-leaping method (approximate)" << std::endl;
+	stream << "               hybrid: hybrid stochastic/deterministic method (approximate)" << std::endl;
+	stream << "               sssa:   Cao et al.'s slow-scale SSA (approximate)" << std::endl;
+	stream << "               default: direct" << std::endl;
+
+	stream << "         -n    number of replicates to simulate. Results of replicate i are saved" << std::endl;
+	stream << "               in the sub-folder replicate<i> of the results folder" << std::endl;
+	stream << "               default: 1" << std::endl;
+
+	stream << "         -threads" << std::endl;
+	stream << "               number of replicates simulated in parallel" << std::endl;
+	stream << "               default: number of processor cores" << std::endl;
+
+	stream << "         -seed seed of the random number generator. Runs with the same seed produce" << std::endl;
+	stream << "               identical results, independent of the number of threads" << std::endl;
+	stream << "               default: random seed, printed after the simulation finished" << std::endl;
+
+	stream << "         -checkpoint" << std::endl;
+	stream << "               file to which the complete simulation state is saved periodically," << std::endl;
+	stream << "               such that the simulation can be restored with -restore. Only" << std::endl;
+	stream << "               supported for a single replicate" << std::endl;
+	stream << "               default: no checkpoints" << std::endl;
+
+	stream << "         -cdt  period of saving checkpoints, in simulation time units" << std::endl;
+	stream << "               default: 10 times the stepsize of saving the state" << std::endl;
+
+	stream << "         -restore" << std::endl;
+	stream << "               checkpoint file from which the simulation is restored and continued" << std::endl;
+	stream << "               until the runtime. The model and the options must be the same as for" << std::endl;
+	stream << "               the simulation which saved the checkpoint" << std::endl;
+
+	stream << "         -fork checkpoint file from whose state all replicates branch off, each with" << std::endl;
+	stream << "               its own random numbers. The replicates run from the time of the" << std::endl;
+	stream << "               checkpoint until the runtime" << std::endl;
+	stream << "               default: replicates start at time zero" << std::endl;
+
+	stream << "         -stop condition ending a simulation early as soon as it is met, e.g. \"P == 0\"." << std::endl;
+	stream << "               Stop conditions can also be defined in the CMDL file with" << std::endl;
+	stream << "               #stop [name,] condition;" << std::endl;
+	stream << "               default: run until the runtime" << std::endl;
+
+	stream << "         -steady" << std::endl;
+	stream << "               detect when the simulation reached a steady state, and then" << std::endl;
+	stream << "               stop:    stop the simulation" << std::endl;
+	stream << "               average: average the states until the runtime" << std::endl;
+	stream << "               The burn-in time and the mean and variance of all states in steady" << std::endl;
+	stream << "               state are printed after the simulation finished" << std::endl;
+	stream << "               default: no steady state detection" << std::endl;
+
+	stream << "         -compare" << std::endl;
+	stream << "               additionally simulate all replicates with the direct method, and compare" << std::endl;
+	stream << "               the mean molecular numbers at the end of the simulation. Fails if any" << std::endl;
+	stream << "               mean differs by more than four standard errors, e.g. to check that an" << std::endl;
+	stream << "               approximate algorithm is unbiased. Requires more than one replicate" << std::endl;
+	stream << "               default: no comparison" << std::endl;
+
+	stream << "         -selftest" << std::endl;
+	stream << "               check that all implementations of the mass action kernel supported by" << std::endl;
+	stream << "               the CPU compute the same propensities as the reactions, and exit" << std::endl;
 	stream << "         -h,-? display this help" << std::endl;
 }
 
-void runCustomModel(std::string modelPath, std::string folder, double runtime, double stepTime)
+stochsim::Simulation::Algorithm cmdParseAlgorithm(const std::string& algorithmStr)
+{
+	if (algorithmStr.empty() || algorithmStr == "direct")
+		return stochsim::Simulation::Algorithm::DirectMethod;
+	else if (algorithmStr == "nrm")
+		return stochsim::Simulation::Algorithm::NextReactionMethod;
+	else if (algorithmStr == "cr")
+		return stochsim::Simulation::Algorithm::CompositionRejection;
+	else if (algorithmStr == "tau")
+		return stochsim::Simulation::Algorithm::TauLeaping;
+	else if (algorithmStr == "hybrid")
+		return stochsim::Simulation::Algorithm::Hybrid;
+	else if (algorithmStr == "sdm")
+		return stochsim::Simulation::Algorithm::SortingDirectMethod;
+	else if (algorithmStr == "pdm")
+		return stochsim::Simulation::Algorithm::PartialPropensityMethod;
+	else if (algorithmStr == "sssa")
+		return stochsim::Simulation::Algorithm::SlowScale;
+	std::string errorMessage = "Unknown simulation algorithm ";
+	errorMessage += algorithmStr;
+	errorMessage += ".";
+	throw std::exception(errorMessage.c_str());
+}
+
+bool cmdParseSteadyStateMode(const std::string& modeStr, stochsim::SteadyStateDetector::Mode& mode)
+{
+	if (modeStr.empty())
+		return false;
+	else if (modeStr == "stop")
+		mode = stochsim::SteadyStateDetector::Mode::Stop;
+	else if (modeStr == "average")
+		mode = stochsim::SteadyStateDetector::Mode::Average;
+	else
+	{
+		std::string errorMessage = "Unknown steady state mode ";
+		errorMessage += modeStr;
+		errorMessage += ".";
+		throw std::exception(errorMessage.c_str());
+	}
+	return true;
+}
+
+void printSteadyState(const stochsim::SteadyStateDetector& detector)
+{
+	if (!detector.IsSteadyState())
+	{
+		std::cout << "No steady state detected." << std::endl;
+		return;
+	}
+	std::cout << "Steady state detected after burn-in time " << detector.GetBurnInTime() << " (" << detector.GetNumSamples() << " samples):" << std::endl;
+	auto stateNames = detector.GetStateNames();
+	for (size_t i = 0; i < stateNames.size(); i++)
+	{
+		std::cout << "\t" << stateNames[i] << ": mean " << detector.GetMean(i) << ", variance " << detector.GetVariance(i) << std::endl;
+	}
+}
+
+void runCustomModel(std::string modelPath, std::string folder, double runtime, double stepTime, stochsim::Simulation::Algorithm algorithm, bool hasSeed, unsigned long long seed, std::string checkpointFile, double checkpointPeriod, std::string restoreFile, std::string stopCondition, bool detectSteadyState, stochsim::SteadyStateDetector::Mode steadyStateMode)
 {
 	// Construct simulation
 	stochsim::Simulation sim;
 	sim.SetBaseFolder(folder);
 	sim.SetLogPeriod(stepTime);
+	sim.SetAlgorithm(algorithm);
+	if (hasSeed)
+		sim.SetSeed(seed);
+	sim.SetCheckpointFile(checkpointFile);
+	sim.SetCheckpointPeriod(checkpointPeriod);
 
 	// Logging state values
 	auto logger = sim.CreateLogger<stochsim::StateLogger>("states.csv");
 
+	// Detecting steady state
+	std::shared_ptr<stochsim::SteadyStateDetector> detector;
+	if (detectSteadyState)
+		detector = sim.CreateLogger<stochsim::SteadyStateDetector>(steadyStateMode);
+
 	// Display simulation progress in console
 	sim.CreateLogger<stochsim::ProgressLogger>();
 	cmdlparser::CmdlParser cmdlParser;
 	cmdlParser.Parse(modelPath, sim);
+	if (!stopCondition.empty())
+		sim.CreateStopCondition("stop", stopCondition);
 	for (auto& state : sim.GetStates())
 	{
 		logger->AddState(state);
 	}
-	sim.Run(runtime);
+	if (restoreFile.empty())
+		sim.Run(runtime);
+	else
+	{
+		sim.LoadCheckpoint(restoreFile);
+		sim.RunUntil(runtime);
+		sim.Finish();
+	}
+	if (!sim.GetStopReason().empty())
+		std::cout << "Stopped at time " << sim.GetStopTime() << " by stop condition " << sim.GetStopReason() << "." << std::endl;
+	if (detector)
+		printSteadyState(*detector);
+	std::cout << "Random seed: " << sim.GetSeed() << std::endl;
 }
 
+void runEnsemble(stochsim::Ensemble& ensemble, size_t numReplicates, double runtime, const std::string& forkFile)
+{
+	if (forkFile.empty())
+		ensemble.Run(numReplicates, runtime);
+	else
+		ensemble.Fork(stochsim::ReadCheckpointFile(forkFile), numReplicates, runtime);
+}
 
-int main(int argc, char *argv[])
+void compareWithDirectMethod(std::shared_ptr<const stochsim::CompiledModel> model, const stochsim::Ensemble& ensemble, double runtime, double stepTime, size_t numReplicates, size_t numThreads, std::string forkFile)
 {
-	if (argc<=1 || cmdOptionExists(argc, argv, "-h")
-		|| cmdOptionExists(argc, argv, "-help")
-		|| cmdOptionExists(argc, argv, "--help")
-		|| cmdOptionExists(argc, argv, "-?"))
+	// The reference replicates only keep their results in memory, such that the results of the compared algorithm are not overwritten.
+	stochsim::Ensemble reference(model, [&](stochsim::SimulationInstance& instance, size_t)
 	{
-		cmdHelp(std::cout, argc, argv);
-		return 0;
-	}
-	std::string outputFolder = cmdGetOption(argc, argv, "-o");
-	if (outputFolder.empty())
-		outputFolder = "simulations";
+		instance.SetLogPeriod(stepTime);
+		instance.SetAlgorithm(stochsim::Simulation::Algorithm::DirectMethod);
+	});
+	reference.SetNumThreads(numThreads);
+	reference.SetSeed(ensemble.GetSeed());
+	runEnsemble(reference, numReplicates, runtime, forkFile);
 
-	std::string endTimeStr = cmdGetOption(argc, argv, "-t");
-	double endTime;
-	if (endTimeStr.empty())
-		endTime = 100;
-	else
+	// Compare the means of the last recorded molecular numbers with a two-sample z-test.
+	const double maxDeviation = 4;
+	const auto& stateNames = ensemble.GetStateNames();
+	std::string deviatingStates;
+	std::cout << "Comparison with the direct method (mean, standard error of the difference, deviation in standard errors):" << std::endl;
+	for (size_t s = 0; s < stateNames.size(); s++)
 	{
-		auto stream = endTimeStr.c_str();
-		errno = 0; // strtod sets errno to ERANGE if number too large.
-		char* pEnd;
-		endTime = ::strtod(stream, &pEnd);
-		if (errno != 0)
+		double sums[2] = { 0, 0 };
+		double squareSums[2] = { 0, 0 };
+		for (size_t replicate = 0; replicate < numReplicates; replicate++)
 		{
-			errno = 0;
-			throw std::exception("Number too large or number format invalid.");
+			const double numbers[2] = { static_cast<double>(ensemble.GetResult(replicate).numbers_.back()[s]), static_cast<double>(reference.GetResult(replicate).numbers_.back()[s]) };
+			for (int i = 0; i < 2; i++)
+			{
+				sums[i] += numbers[i];
+				squareSums[i] += numbers[i] * numbers[i];
+			}
+		}
+		double means[2];
+		double variance = 0;
+		for (int i = 0; i < 2; i++)
+		{
+			means[i] = sums[i] / numReplicates;
+			variance += (squareSums[i] - numReplicates * means[i] * means[i]) / (numReplicates - 1) / numReplicates;
+		}
+		const double standardError = ::sqrt(variance > 0 ? variance : 0);
+		const double difference = means[0] - means[1];
+		// Without any variance, e.g. for a state which is constant in all replicates, the means must be identical.
+		const double deviation = standardError > 0 ? difference / standardError : (difference == 0 ? 0 : stochsim::inf);
+		std::cout << "\t" << stateNames[s] << ": " << means[0] << " vs. " << means[1] << ", " << standardError << ", " << deviation << std::endl;
+		if (::fabs(deviation) > maxDeviation)
+		{
+			if (!deviatingStates.empty())
+				deviatingStates += ", ";
+			deviatingStates += stateNames[s];
 		}
 	}
+	if (!deviatingStates.empty())
+	{
+		std::string errorMessage = "Mean molecular numbers deviate significantly from the direct method for states ";
+		errorMessage += deviatingStates;
+		errorMessage += ".";
+		throw std::exception(errorMessage.c_str());
+	}
+	std::cout << "No significant deviation from the direct method." << std::endl;
+}
 
-	std::string stepTimeStr = cmdGetOption(argc, argv, "-dt");
-	double stepTime;
-	if (stepTimeStr.empty())
-		stepTime = 1;
-	else
+void runCustomModelEnsemble(std::string modelPath, std::string folder, double runtime, double stepTime, stochsim::Simulation::Algorithm algorithm, size_t numReplicates, size_t numThreads, bool hasSeed, unsigned long long seed, std::string forkFile, std::string stopCondition, bool detectSteadyState, stochsim::SteadyStateDetector::Mode steadyStateMode, bool compare)
+{
+	// Parse the model only once, and let all replicates share it.
+	stochsim::Simulation sim;
+	cmdlparser::CmdlParser cmdlParser;
+	cmdlParser.Parse(modelPath, sim);
+	if (!stopCondition.empty())
+		sim.CreateStopCondition("stop", stopCondition);
+	auto model = sim.Compile();
+
+	// Every replicate needs its own steady state detector.
+	std::vector<std::shared_ptr<stochsim::SteadyStateDetector>> detectors(numReplicates);
+	stochsim::Ensemble ensemble(model, [&](stochsim::SimulationInstance& instance, size_t replicate)
+	{
+		instance.SetBaseFolder(folder + "/replicate" + std::to_string(replicate));
+		instance.SetLogPeriod(stepTime);
+		instance.SetAlgorithm(algorithm);
+
+		// Logging state values
+		auto logger = instance.CreateLogger<stochsim::StateLogger>("states.csv");
+		for (auto& state : model->GetStates())
+		{
+			logger->AddState(state);
+		}
+
+		if (detectSteadyState)
+			detectors[replicate] = instance.CreateLogger<stochsim::SteadyStateDetector>(steadyStateMode);
+	});
+	ensemble.SetNumThreads(numThreads);
+	if (hasSeed)
+		ensemble.SetSeed(seed);
+	runEnsemble(ensemble, numReplicates, runtime, forkFile);
+
+	// Summarize which stop conditions ended replicates early.
+	std::map<std::string, size_t> stopCounts;
+	for (size_t replicate = 0; replicate < numReplicates; replicate++)
+	{
+		const auto& stopReason = ensemble.GetResult(replicate).stopReason_;
+		if (!stopReason.empty())
+			stopCounts[stopReason]++;
+	}
+	for (const auto& stopCount : stopCounts)
+	{
+		std::cout << stopCount.second << " of " << numReplicates << " replicates stopped by stop condition " << stopCount.first << "." << std::endl;
+	}
+	if (detectSteadyState)
 	{
-		auto stream = stepTimeStr.c_str();
-		errno = 0; // strtod sets errno to ERANGE if number too large.
-		char* pEnd;
-		stepTime = ::strtod(stream, &pEnd);
-		if (errno != 0)
+		size_t numSteady = 0;
+		double burnInTime = 0;
+		for (const auto& detector : detectors)
 		{
-			errno = 0;
-			throw std::exception("Number too large or number format invalid.");
+			if (!detector->IsSteadyState())
+				continue;
+			numSteady++;
+			burnInTime += detector->GetBurnInTime();
 		}
+		std::cout << numSteady << " of " << numReplicates << " replicates reached steady state";
+		if (numSteady > 0)
+			std::cout << ", mean burn-in time " << burnInTime / numSteady;
+		std::cout << "." << std::endl;
 	}
+	std::cout << "Random seed: " << ensemble.GetSeed() << std::endl;
+	if (compare)
+		compareWithDirectMethod(model, ensemble, runtime, stepTime, numReplicates, numThreads, forkFile);
+}
 
-	// The last parameter must be the model path
-	std::string model(argv[argc - 1]);
+unsigned long long cmdParseUnsigned(const std::string& numberStr)
+{
+	// strtoull accepts a sign and negates the number, such that e.g. -5 would wrap around to a huge number.
+	if (numberStr.empty() || !isdigit(static_cast<unsigned char>(numberStr[0])))
+	{
+		std::string errorMessage = "Expected a non-negative integer, but found '";
+		errorMessage += numberStr;
+		errorMessage += "'.";
+		throw std::exception(errorMessage.c_str());
+	}
+	errno = 0;
+	char* pEnd;
+	unsigned long long number = ::strtoull(numberStr.c_str(), &pEnd, 10);
+	if (errno != 0 || *pEnd != '\0')
+	{
+		errno = 0;
+		throw std::exception("Number too large or number format invalid.");
+	}
+	return number;
+}
+
+double cmdParseDouble(const std::string& numberStr, double defaultValue)
+{
+	if (numberStr.empty())
+		return defaultValue;
+	errno = 0; // strtod sets errno to ERANGE if number too large.
+	char* pEnd;
+	double number = ::strtod(numberStr.c_str(), &pEnd);
+	if (errno != 0)
+	{
+		errno = 0;
+		throw std::exception("Number too large or number format invalid.");
+	}
+	return number;
+}
+
+size_t cmdParseCount(const std::string& countStr, size_t defaultValue)
+{
+	if (countStr.empty())
+		return defaultValue;
+	return static_cast<size_t>(cmdParseUnsigned(countStr));
+}
+
+
+int main(int argc, char *argv[])
+{
+	if (argc<=1 || cmdOptionExists(argc, argv, "-h")
+		|| cmdOptionExists(argc, argv, "-help")
+		|| cmdOptionExists(argc, argv, "--help")
+		|| cmdOptionExists(argc, argv, "-?"))
+	{
+		cmdHelp(std::cout, argc, argv);
+		return 0;
+	}
 	try
 	{
-		runCustomModel(model, outputFolder, endTime, stepTime);
+		if (cmdOptionExists(argc, argv, "-selftest"))
+		{
+			std::cout << "Testing mass action kernel:";
+			for (const auto& instructionSet : stochsim::CompiledModel::TestMassActionKernel())
+			{
+				std::cout << " " << instructionSet;
+			}
+			std::cout << " OK" << std::endl;
+			return 0;
+		}
+		// Options are parsed inside the try block, such that invalid values are reported like all other errors.
+		std::string outputFolder = cmdGetOption(argc, argv, "-o");
+		if (outputFolder.empty())
+			outputFolder = "simulations";
+
+		double endTime = cmdParseDouble(cmdGetOption(argc, argv, "-t"), 100);
+		double stepTime = cmdParseDouble(cmdGetOption(argc, argv, "-dt"), 1);
+
+		stochsim::Simulation::Algorithm algorithm = cmdParseAlgorithm(cmdGetOption(argc, argv, "-a"));
+
+		size_t numReplicates = cmdParseCount(cmdGetOption(argc, argv, "-n"), 1);
+		size_t numThreads = cmdParseCount(cmdGetOption(argc, argv, "-threads"), 0);
+
+		std::string seedStr = cmdGetOption(argc, argv, "-seed");
+		bool hasSeed = !seedStr.empty();
+		unsigned long long seed = hasSeed ? cmdParseUnsigned(seedStr) : 0;
+
+		std::string checkpointFile = cmdGetOption(argc, argv, "-checkpoint");
+		double checkpointPeriod = cmdParseDouble(cmdGetOption(argc, argv, "-cdt"), 10 * stepTime);
+		std::string restoreFile = cmdGetOption(argc, argv, "-restore");
+		std::string forkFile = cmdGetOption(argc, argv, "-fork");
+		std::string stopCondition = cmdGetOption(argc, argv, "-stop");
+		stochsim::SteadyStateDetector::Mode steadyStateMode = stochsim::SteadyStateDetector::Mode::Stop;
+		bool detectSteadyState = cmdParseSteadyStateMode(cmdGetOption(argc, argv, "-steady"), steadyStateMode);
+		bool compare = cmdOptionExists(argc, argv, "-compare");
+
+		// The last parameter must be the model path
+		std::string model(argv[argc - 1]);
+		if (compare && numReplicates < 2)
+			throw std::exception("Comparing with the direct method requires more than one replicate.");
+		else if (numReplicates == 1 && forkFile.empty())
+			runCustomModel(model, outputFolder, endTime, stepTime, algorithm, hasSeed, seed, checkpointFile, checkpointPeriod, restoreFile, stopCondition, detectSteadyState, steadyStateMode);
+		else if (!checkpointFile.empty() || !restoreFile.empty())
+			throw std::exception("Checkpoints are only supported when simulating a single replicate.");
+		else
+			runCustomModelEnsemble(model, outputFolder, endTime, stepTime, algorithm, numReplicates, numThreads, hasSeed, seed, forkFile, stopCondition, detectSteadyState, steadyStateMode, compare);
 	}
 	catch (const std::runtime_error& re)
 	{
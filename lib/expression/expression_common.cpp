@@ -3,6 +3,15 @@
 #include "NumberExpression.h"
 namespace expression
 {
+	// Source of random numbers of the default function rand() on the current thread, if any.
+	static thread_local RandomSource randomSource = nullptr;
+
+	RandomSource setRandomSource(RandomSource source) noexcept
+	{
+		std::swap(randomSource, source);
+		return source;
+	}
+
 	std::unordered_map<identifier, number> makeDefaultVariables() noexcept
 	{
 		std::unordered_map<identifier, number> defaultVariables;
@@ -85,8 +94,10 @@ namespace expression
 			static_cast<std::function<number()>>(
 				[]() -> number
 		{
-			static std::default_random_engine randomEngine(std::random_device{}());
-			static std::uniform_real<number> randomUniform;
+			if (randomSource)
+				return randomSource();
+			static thread_local std::default_random_engine randomEngine(std::random_device{}());
+			static thread_local std::uniform_real<number> randomUniform;
 			return randomUniform(randomEngine);
 		}
 		), true));
@@ -64,6 +64,52 @@ std::string GetReactionReference(const std::shared_ptr<stochsim::IEventReaction>
 	return reactionRef;
 }
 
+std::string GetAlgorithmName(stochsim::Simulation::Algorithm algorithm)
+{
+	switch (algorithm)
+	{
+	case stochsim::Simulation::Algorithm::NextReactionMethod:
+		return "nrm";
+	case stochsim::Simulation::Algorithm::CompositionRejection:
+		return "cr";
+	case stochsim::Simulation::Algorithm::TauLeaping:
+		return "tau";
+	case stochsim::Simulation::Algorithm::Hybrid:
+		return "hybrid";
+	case stochsim::Simulation::Algorithm::SortingDirectMethod:
+		return "sdm";
+	case stochsim::Simulation::Algorithm::PartialPropensityMethod:
+		return "pdm";
+	case stochsim::Simulation::Algorithm::SlowScale:
+		return "sssa";
+	case stochsim::Simulation::Algorithm::DirectMethod:
+	default:
+		return "direct";
+	}
+}
+stochsim::Simulation::Algorithm GetAlgorithmFromName(const std::string& algorithmName)
+{
+	if (algorithmName == "direct")
+		return stochsim::Simulation::Algorithm::DirectMethod;
+	else if (algorithmName == "nrm")
+		return stochsim::Simulation::Algorithm::NextReactionMethod;
+	else if (algorithmName == "cr")
+		return stochsim::Simulation::Algorithm::CompositionRejection;
+	else if (algorithmName == "tau")
+		return stochsim::Simulation::Algorithm::TauLeaping;
+	else if (algorithmName == "hybrid")
+		return stochsim::Simulation::Algorithm::Hybrid;
+	else if (algorithmName == "sdm")
+		return stochsim::Simulation::Algorithm::SortingDirectMethod;
+	else if (algorithmName == "pdm")
+		return stochsim::Simulation::Algorithm::PartialPropensityMethod;
+	else if (algorithmName == "sssa")
+		return stochsim::Simulation::Algorithm::SlowScale;
+	std::stringstream errorMessage;
+	errorMessage << "Simulation algorithm " << algorithmName << " unknown.";
+	throw std::exception(errorMessage.str().c_str());
+}
+
 std::tuple<MatlabParams::MatlabVariable, MatlabParams::MatlabVariable, MatlabParams::MatlabVariable> toMatlab(const stochsim::Collection<stochsim::ReactionLeftElement>& reactionElements)
 {
 	size_t numElements = reactionElements.size();
@@ -375,6 +421,15 @@ void SimulationWrapper::ParseSimulationCommand(const std::string & methodName, M
 		bool uniqueSubFolder = IsUniqueSubfolder();
 		params.Set(0, uniqueSubFolder);
 	}
+	else if (methodName == "SetAlgorithm")
+	{
+		std::string algorithmName = params.Get<std::string>(0);
+		SetAlgorithm(GetAlgorithmFromName(algorithmName));
+	}
+	else if (methodName == "GetAlgorithm")
+	{
+		params.Set(0, GetAlgorithmName(GetAlgorithm()));
+	}
 	else if (methodName == "SetLogConsole")
 	{
 		bool logConsole = params.Get<bool>(0);
@@ -0,0 +1,90 @@
+#include "Checkpoint.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#if defined(_WIN32)
+// Exclude rarely-used stuff from Windows headers
+#define WIN32_LEAN_AND_MEAN
+// Windows Header Files:
+#include <SDKDDKVer.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+namespace stochsim
+{
+	void WriteCheckpointFile(const std::string& fileName, const std::vector<char>& data)
+	{
+		const std::string temporaryFileName = fileName + ".tmp";
+		{
+			std::ofstream file(temporaryFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				std::stringstream errorMessage;
+				errorMessage << "Could not open file " << temporaryFileName << " to save checkpoint.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			file.write(data.data(), data.size());
+			file.close();
+			if (file.fail())
+			{
+				std::stringstream errorMessage;
+				errorMessage << "Could not write checkpoint to file " << temporaryFileName << ".";
+				throw std::exception(errorMessage.str().c_str());
+			}
+		}
+#if defined(_WIN32)
+		const bool replaced = MoveFileExA(temporaryFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		const bool replaced = std::rename(temporaryFileName.c_str(), fileName.c_str()) == 0;
+#endif
+		if (!replaced)
+		{
+			std::stringstream errorMessage;
+			errorMessage << "Could not replace checkpoint file " << fileName << " by " << temporaryFileName << ".";
+			throw std::exception(errorMessage.str().c_str());
+		}
+	}
+	std::vector<char> ReadCheckpointFile(const std::string& fileName)
+	{
+		std::ifstream file(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			std::stringstream errorMessage;
+			errorMessage << "Could not open checkpoint file " << fileName << ".";
+			throw std::exception(errorMessage.str().c_str());
+		}
+		std::vector<char> data(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), data.size());
+		if (file.fail())
+		{
+			std::stringstream errorMessage;
+			errorMessage << "Could not read checkpoint file " << fileName << ".";
+			throw std::exception(errorMessage.str().c_str());
+		}
+		return data;
+	}
+	void TruncateFile(const std::string& fileName, std::uint64_t size)
+	{
+#if defined(_WIN32)
+		bool truncated = false;
+		HANDLE file = CreateFileA(fileName.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER position;
+			position.QuadPart = static_cast<LONGLONG>(size);
+			truncated = SetFilePointerEx(file, position, NULL, FILE_BEGIN) && SetEndOfFile(file);
+			CloseHandle(file);
+		}
+#else
+		const bool truncated = truncate(fileName.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+		if (!truncated)
+		{
+			std::stringstream errorMessage;
+			errorMessage << "Could not truncate file " << fileName << " to the size it had when the checkpoint was saved.";
+			throw std::exception(errorMessage.str().c_str());
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#include "CompiledModel.h"
+#include <unordered_map>
+#include "DependencyGraph.h"
+#include "MassActionKernel.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Collects the instance data and molecular number slots requested by the states and reactions while a model is compiled.
+	/// </summary>
+	class ModelCompiler : public IModelCompiler
+	{
+	public:
+		ModelCompiler(const std::vector<std::shared_ptr<IState>>& states, std::vector<std::unique_ptr<IInstanceData>>& initialData) : states_(states), initialData_(initialData)
+		{
+		}
+		virtual size_t AddInstanceData(std::unique_ptr<IInstanceData> initialData) override
+		{
+			initialData_.push_back(std::move(initialData));
+			return initialData_.size() - 1;
+		}
+		virtual size_t AddMolecularNumber(const IState& state) override
+		{
+			auto slot = molecularNumberSlots_.find(&state);
+			if (slot != molecularNumberSlots_.end())
+				return slot->second;
+			size_t newSlot = molecularNumberSlots_.size();
+			molecularNumberSlots_.emplace(&state, newSlot);
+			return newSlot;
+		}
+		virtual const Collection<std::shared_ptr<IState>> GetStates() const override
+		{
+			return Collection<std::shared_ptr<IState>>(states_.begin(), states_.end());
+		}
+		const std::unordered_map<const IState*, size_t>& GetMolecularNumberSlots() const
+		{
+			return molecularNumberSlots_;
+		}
+	private:
+		const std::vector<std::shared_ptr<IState>>& states_;
+		std::vector<std::unique_ptr<IInstanceData>>& initialData_;
+		std::unordered_map<const IState*, size_t> molecularNumberSlots_;
+	};
+
+	CompiledModel::CompiledModel(std::vector<std::shared_ptr<IState>> states, std::vector<std::shared_ptr<IPropensityReaction>> propensityReactions, std::vector<std::shared_ptr<IEventReaction>> eventReactions, std::vector<std::shared_ptr<StopCondition>> stopConditions, bool vectorized) :
+		states_(std::move(states)), propensityReactions_(std::move(propensityReactions)), eventReactions_(std::move(eventReactions)), stopConditions_(std::move(stopConditions)), numMolecularNumbers_(0)
+	{
+		ModelCompiler compiler(states_, initialData_);
+		for (auto& state : states_)
+		{
+			state->Compile(compiler);
+		}
+		for (auto& reaction : propensityReactions_)
+		{
+			reaction->Compile(compiler);
+		}
+		for (auto& reaction : eventReactions_)
+		{
+			reaction->Compile(compiler);
+		}
+		for (auto& stopCondition : stopConditions_)
+		{
+			stopCondition->Compile(compiler);
+		}
+		numMolecularNumbers_ = compiler.GetMolecularNumberSlots().size();
+		// The dependencies of custom rate equations and stop conditions are only known after the equations were bound.
+		dependencyGraph_ = std::make_unique<DependencyGraph>(propensityReactions_, eventReactions_, stopConditions_);
+		massActionKernel_ = std::make_unique<MassActionKernel>(propensityReactions_, compiler.GetMolecularNumberSlots(), vectorized);
+	}
+	CompiledModel::~CompiledModel()
+	{
+	}
+	std::vector<std::string> CompiledModel::TestMassActionKernel()
+	{
+		return MassActionKernel::SelfTest();
+	}
+	std::vector<std::unique_ptr<IInstanceData>> CompiledModel::CreateInstanceData() const
+	{
+		std::vector<std::unique_ptr<IInstanceData>> data;
+		data.reserve(initialData_.size());
+		for (const auto& initialData : initialData_)
+		{
+			data.push_back(initialData->Clone());
+		}
+		return data;
+	}
+}
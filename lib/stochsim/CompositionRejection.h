@@ -0,0 +1,274 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <climits>
+#include <math.h>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Composition-rejection method, as outlined in
+	/// Slepoy, Alexander, Aidan P. Thompson, and Steven J. Plimpton. "A constant-time kinetic Monte Carlo algorithm for simulation of large biochemical reaction networks." The journal of chemical physics 128.20 (2008): 205101.
+	/// Reactions are grouped into bins such that all propensities in bin e lie in [2^(e-1), 2^e). The bin is selected by a linear search over the (few) bin sums, and the reaction within the bin by rejection sampling,
+	/// which accepts with a probability of at least 1/2. Since the number of bins only depends on the range of the propensities, but not on the number of reactions, each step costs O(1) on average.
+	/// </summary>
+	class CompositionRejection : public ISimulationAlgorithm
+	{
+	public:
+		CompositionRejection() : reactions_(nullptr), kernel_(nullptr), dependencyGraph_(nullptr), dirty_(nullptr), minExponent_(0)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			dependencyGraph_ = &dependencyGraph;
+			dirty_ = nullptr;
+			bins_.clear();
+			minExponent_ = 0;
+			propensities_.assign(reactions.size(), 0);
+			exponents_.resize(reactions.size());
+			positions_.assign(reactions.size(), 0);
+			std::vector<double> propensities(reactions.size());
+			kernel.ComputeRates(simInfo, propensities.data());
+			for (size_t i = 0; i < reactions.size(); i++)
+			{
+				exponents_[i] = noBin;
+				update(i, propensities[i]);
+			}
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			// Update propensities which might have changed since the last call.
+			if (dirty_)
+			{
+				for (auto reactionIndex : *dirty_)
+				{
+					update(reactionIndex, kernel_->ComputeRate(simInfo, reactionIndex));
+				}
+				dirty_ = nullptr;
+			}
+
+			// Calculate time span to next propensity reaction event
+			double a0 = 0;
+			for (const auto& bin : bins_)
+			{
+				a0 += bin.sum_;
+			}
+			if (a0 > 0)
+			{
+				return simInfo.GetSimTime() + simInfo.RandExponential() / a0;
+			}
+			else
+			{
+				return stochsim::inf;
+			}
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			// Composition: select bin with probability proportional to its sum. Due to rounding errors, the search might not stop, in which case the last non-empty bin is chosen.
+			double a0 = 0;
+			for (const auto& bin : bins_)
+			{
+				a0 += bin.sum_;
+			}
+			double afraction = simInfo.Rand() * a0;
+			double asum = 0;
+			size_t binIndex = bins_.size();
+			for (size_t b = 0; b < bins_.size(); b++)
+			{
+				if (bins_[b].members_.empty())
+					continue;
+				binIndex = b;
+				asum += bins_[b].sum_;
+				if (asum >= afraction)
+					break;
+			}
+			if (binIndex >= bins_.size())
+				return reactions_->size();
+
+			// Rejection: select reaction uniformly within the bin, and accept with probability propensity/upper bound of bin.
+			const auto& binReactions = bins_[binIndex].members_;
+			const double maxPropensity = ldexp(1.0, static_cast<int>(binIndex) + minExponent_);
+			size_t reactionIndex;
+			while (true)
+			{
+				reactionIndex = binReactions[static_cast<size_t>(simInfo.Rand() * binReactions.size())];
+				if (simInfo.Rand() * maxPropensity < propensities_[reactionIndex])
+					break;
+			}
+			(*reactions_)[reactionIndex]->Fire(simInfo);
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+			return reactionIndex;
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			// do nothing. Propensity reactions are memoryless.
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetEventDependents(eventIndex);
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// The bins are saved with their members in order and with their incrementally updated sums, such that the same reactions are selected after the checkpoint is restored.
+			checkpoint.WriteArray(propensities_.data(), propensities_.size());
+			checkpoint.WriteArray(exponents_.data(), exponents_.size());
+			checkpoint.Write(static_cast<std::int32_t>(minExponent_));
+			checkpoint.Write<std::uint64_t>(bins_.size());
+			for (const auto& bin : bins_)
+			{
+				saveReactions(checkpoint, &bin.members_);
+				checkpoint.Write(bin.sum_);
+				checkpoint.Write<std::uint64_t>(bin.numUpdates_);
+			}
+			saveReactions(checkpoint, dirty_);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			checkpoint.ReadArray(propensities_.data(), propensities_.size());
+			checkpoint.ReadArray(exponents_.data(), exponents_.size());
+			minExponent_ = checkpoint.Read<std::int32_t>();
+			bins_.resize(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+			for (auto& bin : bins_)
+			{
+				restoreReactions(checkpoint, bin.members_, reactions_->size());
+				bin.sum_ = checkpoint.Read<double>();
+				bin.numUpdates_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				for (size_t position = 0; position < bin.members_.size(); position++)
+				{
+					positions_[bin.members_[position]] = position;
+				}
+			}
+			restoreReactions(checkpoint, restoredDirty_, reactions_->size());
+			dirty_ = restoredDirty_.empty() ? nullptr : &restoredDirty_;
+		}
+	private:
+		/// <summary>
+		/// Group of reactions whose propensities are in the same range [2^(e-1), 2^e).
+		/// </summary>
+		struct Bin
+		{
+			Bin() : sum_(0), numUpdates_(0)
+			{
+			}
+			std::vector<size_t> members_;
+			// Sum of propensities of all reactions in bin. Updated incrementally, and re-summed in regular intervals to prevent the accumulation of rounding errors.
+			double sum_;
+			size_t numUpdates_;
+		};
+		/// <summary>
+		/// Exponent of reactions with zero propensity, which are not part of any bin.
+		/// </summary>
+		static constexpr int noBin = INT_MIN;
+
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		const DependencyGraph* dependencyGraph_;
+		// Reactions whose propensities have to be recomputed before the next step. Since every reaction or event firing is followed by a call to NextReactionTime, at most one set of reactions is dirty at any time.
+		const std::vector<size_t>* dirty_;
+		// Owns the dirty reactions restored from a checkpoint.
+		std::vector<size_t> restoredDirty_;
+		std::vector<double> propensities_;
+		// Exponent e of the bin of every reaction, or noBin.
+		std::vector<int> exponents_;
+		// Position of every reaction in its bin.
+		std::vector<size_t> positions_;
+		// Bin with index b contains all propensities with exponent b + minExponent_.
+		std::vector<Bin> bins_;
+		int minExponent_;
+
+		/// <summary>
+		/// Sets the propensity of the given reaction, and moves the reaction to the corresponding bin if necessary.
+		/// </summary>
+		void update(size_t reactionIndex, double propensity)
+		{
+			const double oldPropensity = propensities_[reactionIndex];
+			if (propensity == oldPropensity)
+				return;
+			propensities_[reactionIndex] = propensity;
+			int exponent = noBin;
+			if (propensity > 0)
+				frexp(propensity, &exponent);
+			const int oldExponent = exponents_[reactionIndex];
+			if (exponent == oldExponent)
+			{
+				Bin& bin = getBin(exponent);
+				bin.sum_ += propensity - oldPropensity;
+				if (++bin.numUpdates_ > bin.members_.size())
+					resum(bin);
+				return;
+			}
+			if (oldExponent != noBin)
+			{
+				// Remove from old bin by swapping with last reaction in bin.
+				Bin& bin = getBin(oldExponent);
+				size_t position = positions_[reactionIndex];
+				size_t last = bin.members_.back();
+				bin.members_[position] = last;
+				positions_[last] = position;
+				bin.members_.pop_back();
+				if (bin.members_.empty())
+				{
+					bin.sum_ = 0;
+					bin.numUpdates_ = 0;
+				}
+				else
+				{
+					bin.sum_ -= oldPropensity;
+					if (++bin.numUpdates_ > bin.members_.size())
+						resum(bin);
+				}
+			}
+			exponents_[reactionIndex] = exponent;
+			if (exponent != noBin)
+			{
+				Bin& bin = getBin(exponent);
+				positions_[reactionIndex] = bin.members_.size();
+				bin.members_.push_back(reactionIndex);
+				bin.sum_ += propensity;
+				if (++bin.numUpdates_ > bin.members_.size())
+					resum(bin);
+			}
+		}
+		/// <summary>
+		/// Returns the bin for the given exponent, and creates it (and all bins in between) if it does not yet exist.
+		/// </summary>
+		Bin& getBin(int exponent)
+		{
+			if (bins_.empty())
+			{
+				minExponent_ = exponent;
+				bins_.resize(1);
+			}
+			else if (exponent < minExponent_)
+			{
+				bins_.insert(bins_.begin(), static_cast<size_t>(minExponent_ - exponent), Bin());
+				minExponent_ = exponent;
+			}
+			else if (exponent - minExponent_ >= static_cast<int>(bins_.size()))
+			{
+				bins_.resize(static_cast<size_t>(exponent - minExponent_) + 1);
+			}
+			return bins_[static_cast<size_t>(exponent - minExponent_)];
+		}
+		/// <summary>
+		/// Recalculates the sum of the propensities of all reactions in the bin.
+		/// </summary>
+		void resum(Bin& bin) noexcept
+		{
+			bin.sum_ = 0;
+			for (auto reactionIndex : bin.members_)
+			{
+				bin.sum_ += propensities_[reactionIndex];
+			}
+			bin.numUpdates_ = 0;
+		}
+	};
+}
@@ -0,0 +1,341 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include "stochsim_common.h"
+#include "PropensityReaction.h"
+#include "DelayReaction.h"
+#include "TimerReaction.h"
+#include "Choice.h"
+#include "StopCondition.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Graph determining which propensities and event times have to be recomputed after a given propensity or event reaction fired.
+	/// The graph is constructed from the reactants, modifiers, transformees and products of the reactions. For reactions whose structure is unknown (i.e. which are not PropensityReactions, DelayReactions or TimerReactions),
+	/// the graph conservatively assumes that they depend on, respectively change, every state. Reactions having a custom rate equation depend on the states referenced by the equation.
+	/// Since these are only known after the equations were bound, the graph has to be constructed after all reactions were compiled. Reactions whose rate equation references random numbers are
+	/// recomputed after every firing. Reactions whose rate equation references the simulation time are simulated by the TimeDependentScheduler, which integrates their propensities over time, and only depend on the states referenced by their equation.
+	/// The next firing time of a DelayReaction only depends on the first molecule of its reactant, and the one of a TimerReaction only changes when it fires itself. The firing times of all other event reactions are recomputed after every firing.
+	/// The propensity of a reaction with weighted species (see PropensityReaction::SetWeight()) additionally changes when a molecule of a weighted state is transformed.
+	/// Similarly, the graph determines which stop conditions have to be re-evaluated after a reaction fired. Stop conditions referencing random numbers or the simulation time are re-evaluated after every firing.
+	/// </summary>
+	class DependencyGraph
+	{
+	public:
+		DependencyGraph(const std::vector<std::shared_ptr<IPropensityReaction>>& propensityReactions, const std::vector<std::shared_ptr<IEventReaction>>& eventReactions, const std::vector<std::shared_ptr<StopCondition>>& stopConditions = {})
+		{
+			const size_t numReactions = propensityReactions.size();
+			// For every state, collect the propensity reactions whose propensity depends on its molecular number.
+			std::unordered_map<const IState*, std::vector<size_t>> readers;
+			std::vector<size_t> alwaysDirty;
+			// For every state, collect the propensity reactions whose propensity depends on the properties of its molecules.
+			std::unordered_map<const IState*, std::vector<size_t>> weightReaders;
+			for (size_t i = 0; i < numReactions; i++)
+			{
+				std::vector<const IState*> states;
+				if (getRateStates(*propensityReactions[i], states))
+				{
+					for (auto state : states)
+					{
+						readers[state].push_back(i);
+					}
+				}
+				else
+					alwaysDirty.push_back(i);
+				if (auto propensityReaction = dynamic_cast<const PropensityReaction*>(propensityReactions[i].get()))
+				{
+					for (const auto& state : propensityReaction->GetWeightedStates())
+					{
+						weightReaders[state.get()].push_back(i);
+					}
+				}
+			}
+
+			// For every state, collect the event reactions whose next firing time depends on it.
+			const size_t numEvents = eventReactions.size();
+			std::unordered_map<const IState*, std::vector<size_t>> eventReaders;
+			std::vector<size_t> alwaysDirtyEvents;
+			for (size_t e = 0; e < numEvents; e++)
+			{
+				std::vector<const IState*> states;
+				if (getFireTimeStates(*eventReactions[e], states))
+				{
+					for (auto state : states)
+					{
+						eventReaders[state].push_back(e);
+					}
+				}
+				else
+					alwaysDirtyEvents.push_back(e);
+			}
+
+			// For every state, collect the stop conditions referencing it.
+			const size_t numConditions = stopConditions.size();
+			std::unordered_map<const IState*, std::vector<size_t>> conditionReaders;
+			std::vector<size_t> alwaysDirtyConditions;
+			for (size_t c = 0; c < numConditions; c++)
+			{
+				if (stopConditions[c]->IsVolatile())
+				{
+					alwaysDirtyConditions.push_back(c);
+					continue;
+				}
+				for (const auto& state : stopConditions[c]->GetDependencies())
+				{
+					conditionReaders[state.get()].push_back(c);
+				}
+			}
+
+			propensityDependents_.reserve(numReactions);
+			propensityEventDependents_.reserve(numReactions);
+			propensityConditionDependents_.reserve(numReactions);
+			for (size_t i = 0; i < numReactions; i++)
+			{
+				std::vector<const IState*> states;
+				bool known = getModifiedStates(*propensityReactions[i], states);
+				std::vector<size_t> dependents = collectDependents(known, states, readers, alwaysDirty, numReactions);
+				if (!weightReaders.empty())
+				{
+					std::vector<const IState*> transformedStates;
+					getTransformedStates(*propensityReactions[i], transformedStates);
+					for (size_t dependent : collectDependents(true, transformedStates, weightReaders, {}, numReactions))
+					{
+						insertSorted(dependents, dependent);
+					}
+				}
+				// The propensity of a reaction typically changes when it fires. In any case, its next firing time has to be redrawn.
+				insertSorted(dependents, i);
+				propensityDependents_.push_back(std::move(dependents));
+				propensityEventDependents_.push_back(collectDependents(known, states, eventReaders, alwaysDirtyEvents, numEvents));
+				propensityConditionDependents_.push_back(collectDependents(known, states, conditionReaders, alwaysDirtyConditions, numConditions));
+			}
+			eventDependents_.reserve(numEvents);
+			eventEventDependents_.reserve(numEvents);
+			eventConditionDependents_.reserve(numEvents);
+			for (size_t e = 0; e < numEvents; e++)
+			{
+				std::vector<const IState*> states;
+				bool known = getModifiedStates(*eventReactions[e], states);
+				eventDependents_.push_back(collectDependents(known, states, readers, alwaysDirty, numReactions));
+				// The next firing time of an event reaction always changes when it fires.
+				std::vector<size_t> eventDependents = collectDependents(known, states, eventReaders, alwaysDirtyEvents, numEvents);
+				insertSorted(eventDependents, e);
+				eventEventDependents_.push_back(std::move(eventDependents));
+				eventConditionDependents_.push_back(collectDependents(known, states, conditionReaders, alwaysDirtyConditions, numConditions));
+			}
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all propensity reactions whose propensity might have changed after the propensity reaction with the given index fired. Always contains the index of the reaction itself.
+		/// </summary>
+		/// <param name="reactionIndex">Index of the propensity reaction which fired.</param>
+		/// <returns>Indices of propensity reactions which have to be updated.</returns>
+		inline const std::vector<size_t>& GetPropensityDependents(size_t reactionIndex) const
+		{
+			return propensityDependents_[reactionIndex];
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all propensity reactions whose propensity might have changed after the event reaction with the given index fired.
+		/// </summary>
+		/// <param name="eventIndex">Index of the event reaction which fired.</param>
+		/// <returns>Indices of propensity reactions which have to be updated.</returns>
+		inline const std::vector<size_t>& GetEventDependents(size_t eventIndex) const
+		{
+			return eventDependents_[eventIndex];
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all event reactions whose next firing time might have changed after the propensity reaction with the given index fired.
+		/// </summary>
+		/// <param name="reactionIndex">Index of the propensity reaction which fired.</param>
+		/// <returns>Indices of event reactions which have to be updated.</returns>
+		inline const std::vector<size_t>& GetPropensityEventDependents(size_t reactionIndex) const
+		{
+			return propensityEventDependents_[reactionIndex];
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all event reactions whose next firing time might have changed after the event reaction with the given index fired. Always contains the index of the event reaction itself.
+		/// </summary>
+		/// <param name="eventIndex">Index of the event reaction which fired.</param>
+		/// <returns>Indices of event reactions which have to be updated.</returns>
+		inline const std::vector<size_t>& GetEventEventDependents(size_t eventIndex) const
+		{
+			return eventEventDependents_[eventIndex];
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all stop conditions which might have become true after the propensity reaction with the given index fired.
+		/// </summary>
+		/// <param name="reactionIndex">Index of the propensity reaction which fired.</param>
+		/// <returns>Indices of stop conditions which have to be re-evaluated.</returns>
+		inline const std::vector<size_t>& GetPropensityConditionDependents(size_t reactionIndex) const
+		{
+			return propensityConditionDependents_[reactionIndex];
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all stop conditions which might have become true after the event reaction with the given index fired.
+		/// </summary>
+		/// <param name="eventIndex">Index of the event reaction which fired.</param>
+		/// <returns>Indices of stop conditions which have to be re-evaluated.</returns>
+		inline const std::vector<size_t>& GetEventConditionDependents(size_t eventIndex) const
+		{
+			return eventConditionDependents_[eventIndex];
+		}
+	private:
+		std::vector<std::vector<size_t>> propensityDependents_;
+		std::vector<std::vector<size_t>> eventDependents_;
+		std::vector<std::vector<size_t>> propensityEventDependents_;
+		std::vector<std::vector<size_t>> eventEventDependents_;
+		std::vector<std::vector<size_t>> propensityConditionDependents_;
+		std::vector<std::vector<size_t>> eventConditionDependents_;
+
+		/// <summary>
+		/// Collects the states on whose molecular numbers the propensity of the reaction depends. Returns false if these states cannot be determined.
+		/// </summary>
+		static bool getRateStates(const IPropensityReaction& reaction, std::vector<const IState*>& states)
+		{
+			auto propensityReaction = dynamic_cast<const PropensityReaction*>(&reaction);
+			// Rates depending on random numbers change even if no state changes. The change of time dependent rates over time is taken care of by the TimeDependentScheduler.
+			if (!propensityReaction || propensityReaction->IsRateRandom())
+				return false;
+			for (const auto& state : propensityReaction->GetRateDependencies())
+			{
+				states.push_back(state.get());
+			}
+			return true;
+		}
+		/// <summary>
+		/// Collects the states on which the next firing time of the event reaction depends. Returns false if these states cannot be determined.
+		/// </summary>
+		static bool getFireTimeStates(const IEventReaction& reaction, std::vector<const IState*>& states)
+		{
+			if (auto delayReaction = dynamic_cast<const DelayReaction*>(&reaction))
+			{
+				states.push_back(delayReaction->GetReactant().state_.get());
+				return true;
+			}
+			else if (dynamic_cast<const TimerReaction*>(&reaction))
+			{
+				return true;
+			}
+			return false;
+		}
+		/// <summary>
+		/// Collects the states whose molecular numbers change when the reaction fires. Returns false if these states cannot be determined.
+		/// </summary>
+		static bool getModifiedStates(const IPropensityReaction& reaction, std::vector<const IState*>& states)
+		{
+			auto propensityReaction = dynamic_cast<const PropensityReaction*>(&reaction);
+			if (!propensityReaction)
+				return false;
+			for (const auto& reactant : propensityReaction->GetReactants())
+			{
+				addModifiedState(reactant.state_, states);
+			}
+			for (const auto& product : propensityReaction->GetProducts())
+			{
+				addModifiedState(product.state_, states);
+			}
+			return true;
+		}
+		/// <summary>
+		/// Collects the states whose molecules might change their properties when the reaction fires.
+		/// </summary>
+		static void getTransformedStates(const IPropensityReaction& reaction, std::vector<const IState*>& states)
+		{
+			auto propensityReaction = dynamic_cast<const PropensityReaction*>(&reaction);
+			if (!propensityReaction)
+				return;
+			for (const auto& transformee : propensityReaction->GetTransformees())
+			{
+				for (const auto& propertyExpression : transformee.propertyExpressions_)
+				{
+					if (propertyExpression)
+					{
+						states.push_back(transformee.state_.get());
+						break;
+					}
+				}
+			}
+		}
+		/// <summary>
+		/// Collects the states whose molecular numbers change when the event reaction fires. Returns false if these states cannot be determined.
+		/// </summary>
+		static bool getModifiedStates(const IEventReaction& reaction, std::vector<const IState*>& states)
+		{
+			if (auto delayReaction = dynamic_cast<const DelayReaction*>(&reaction))
+			{
+				addModifiedState(delayReaction->GetReactant().state_, states);
+				for (const auto& product : delayReaction->GetProducts())
+				{
+					addModifiedState(product.state_, states);
+				}
+				return true;
+			}
+			else if (auto timerReaction = dynamic_cast<const TimerReaction*>(&reaction))
+			{
+				for (const auto& product : timerReaction->GetProducts())
+				{
+					addModifiedState(product.state_, states);
+				}
+				return true;
+			}
+			return false;
+		}
+		/// <summary>
+		/// Adds the state to the modified states. If the state is a choice, all states which might be increased by the choice are added, too.
+		/// </summary>
+		static void addModifiedState(const std::shared_ptr<IState>& state, std::vector<const IState*>& states)
+		{
+			// Also prevents infinite recursion for choices having themselves as products.
+			if (std::find(states.begin(), states.end(), state.get()) != states.end())
+				return;
+			states.push_back(state.get());
+			if (auto choice = dynamic_cast<const Choice*>(state.get()))
+			{
+				for (const auto& product : choice->GetProductsIfTrue())
+				{
+					addModifiedState(product.state_, states);
+				}
+				for (const auto& product : choice->GetProductsIfFalse())
+				{
+					addModifiedState(product.state_, states);
+				}
+			}
+		}
+		/// <summary>
+		/// Inserts the index into the sorted indices, if not already present.
+		/// </summary>
+		static void insertSorted(std::vector<size_t>& indices, size_t index)
+		{
+			auto position = std::lower_bound(indices.begin(), indices.end(), index);
+			if (position == indices.end() || *position != index)
+				indices.insert(position, index);
+		}
+		/// <summary>
+		/// Returns the sorted indices of all reactions depending on at least one of the modified states.
+		/// </summary>
+		static std::vector<size_t> collectDependents(bool known, const std::vector<const IState*>& modifiedStates, const std::unordered_map<const IState*, std::vector<size_t>>& readers, const std::vector<size_t>& alwaysDirty, size_t numReactions)
+		{
+			std::vector<size_t> dependents;
+			if (!known)
+			{
+				dependents.resize(numReactions);
+				for (size_t i = 0; i < numReactions; i++)
+				{
+					dependents[i] = i;
+				}
+				return dependents;
+			}
+			dependents = alwaysDirty;
+			for (auto state : modifiedStates)
+			{
+				auto search = readers.find(state);
+				if (search != readers.end())
+					dependents.insert(dependents.end(), search->second.begin(), search->second.end());
+			}
+			std::sort(dependents.begin(), dependents.end());
+			dependents.erase(std::unique(dependents.begin(), dependents.end()), dependents.end());
+			return dependents;
+		}
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <math.h>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "PropensityTree.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Gillespie's direct method, as outlined in
+	/// Gillespie, Daniel T. "Exact stochastic simulation of coupled chemical reactions." The journal of physical chemistry 81.25 (1977): 2340-2361.
+	/// Default algorithm, and the reference implementation for all other algorithms. After a reaction fired, only the propensities of the reactions depending on it are recomputed.
+	/// The propensities are stored in a sum tree, such that updating a propensity as well as selecting the reaction which fires next runs in O(log M), with M the number of reactions,
+	/// and the aggregated propensity is directly available at the root of the tree.
+	/// </summary>
+	class DirectMethod : public ISimulationAlgorithm
+	{
+	public:
+		DirectMethod() : reactions_(nullptr), kernel_(nullptr), dependencyGraph_(nullptr), dirty_(nullptr)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			dependencyGraph_ = &dependencyGraph;
+			dirty_ = nullptr;
+			std::vector<double> propensities(reactions.size());
+			kernel.ComputeRates(simInfo, propensities.data());
+			propensities_.Reset(propensities);
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			// Update propensities which might have changed since the last call.
+			if (dirty_)
+			{
+				for (auto reactionIndex : *dirty_)
+				{
+					propensities_.Update(reactionIndex, kernel_->ComputeRate(simInfo, reactionIndex));
+				}
+				dirty_ = nullptr;
+			}
+
+			// Calculate time span to next propensity reaction event
+			double a0 = propensities_.Total();
+			if (a0 > 0)
+			{
+				return simInfo.GetSimTime() + simInfo.RandExponential() / a0;
+			}
+			else
+			{
+				return stochsim::inf;
+			}
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			// decide on identity of next reaction event and fire this event
+			double r2 = simInfo.Rand();
+			size_t reactionIndex = propensities_.Find(r2 * propensities_.Total());
+			(*reactions_)[reactionIndex]->Fire(simInfo);
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+			return reactionIndex;
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			// do nothing. Propensity reactions are memoryless.
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetEventDependents(eventIndex);
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// The propensities are saved instead of recomputed, since the reactions which are still dirty might be selected by the pending step with their old propensities.
+			propensities_.Save(checkpoint);
+			saveReactions(checkpoint, dirty_);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			propensities_.Load(checkpoint);
+			if (propensities_.Size() != reactions_->size())
+				throw std::exception("Checkpoint was saved for a different number of propensity reactions.");
+			restoreReactions(checkpoint, restoredDirty_, reactions_->size());
+			dirty_ = restoredDirty_.empty() ? nullptr : &restoredDirty_;
+		}
+	private:
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		const DependencyGraph* dependencyGraph_;
+		// Reactions whose propensities have to be recomputed before the next step. Since every reaction or event firing is followed by a call to NextReactionTime, at most one set of reactions is dirty at any time.
+		const std::vector<size_t>* dirty_;
+		// Owns the dirty reactions restored from a checkpoint.
+		std::vector<size_t> restoredDirty_;
+		PropensityTree propensities_;
+	};
+}
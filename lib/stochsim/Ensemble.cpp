@@ -0,0 +1,250 @@
+#include "Ensemble.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <random>
+namespace stochsim
+{
+	/// <summary>
+	/// Logger recording the molecular numbers of all states of a replicate at every log time.
+	/// </summary>
+	class EnsembleRecorder : public ILogger
+	{
+	public:
+		explicit EnsembleRecorder(Ensemble::Result& result) : result_(result)
+		{
+		}
+		virtual void WriteLog(ISimInfo& simInfo, double time) override
+		{
+			result_.times_.push_back(time);
+			result_.numbers_.emplace_back(states_.size());
+			auto& numbers = result_.numbers_.back();
+			for (size_t i = 0; i < states_.size(); i++)
+			{
+				numbers[i] = states_[i]->Num(simInfo);
+			}
+		}
+		virtual void Initialize(ISimInfo& simInfo) override
+		{
+			states_.clear();
+			stateNames_.clear();
+			for (const auto& state : simInfo.GetStates())
+			{
+				states_.push_back(state);
+				stateNames_.push_back(state->GetName());
+			}
+			result_.times_.clear();
+			result_.numbers_.clear();
+		}
+		virtual void Uninitialize(ISimInfo& simInfo) override
+		{
+			states_.clear();
+		}
+		virtual bool WritesToDisk() const override
+		{
+			return false;
+		}
+		const std::vector<std::string>& GetStateNames() const
+		{
+			return stateNames_;
+		}
+	private:
+		Ensemble::Result& result_;
+		std::vector<std::shared_ptr<IState>> states_;
+		std::vector<std::string> stateNames_;
+	};
+
+	class Ensemble::Impl
+	{
+	public:
+		Impl(std::shared_ptr<const CompiledModel> model, InstanceSetup instanceSetup) : model_(std::move(model)), instanceSetup_(std::move(instanceSetup)), numThreads_(0), seed_((static_cast<unsigned long long>(std::random_device{}()) << 32) | std::random_device{}())
+		{
+		}
+		void Run(size_t numReplicates, double maxTime)
+		{
+			runReplicates(numReplicates, [maxTime](SimulationInstance& instance)
+			{
+				instance.Run(maxTime);
+			});
+		}
+		void Fork(const std::vector<char>& checkpoint, size_t numReplicates, double maxTime)
+		{
+			// All replicates read the same checkpoint, which is not modified while they run.
+			runReplicates(numReplicates, [&checkpoint, maxTime](SimulationInstance& instance)
+			{
+				instance.StartFromCheckpoint(checkpoint, maxTime);
+				instance.RunUntil(maxTime);
+				instance.Finish();
+			});
+		}
+		void SetNumThreads(size_t numThreads)
+		{
+			numThreads_ = numThreads;
+		}
+		size_t GetNumThreads() const
+		{
+			return numThreads_;
+		}
+		void SetSeed(unsigned long long seed)
+		{
+			seed_ = seed;
+		}
+		unsigned long long GetSeed() const
+		{
+			return seed_;
+		}
+		unsigned long long GetReplicateSeed(size_t replicate) const
+		{
+			// seed_seq scrambles the ensemble seed and the replicate index, such that the seeds of neighbouring replicates are uncorrelated.
+			const unsigned long long index = replicate;
+			std::seed_seq seedSequence{ static_cast<unsigned int>(seed_), static_cast<unsigned int>(seed_ >> 32), static_cast<unsigned int>(index), static_cast<unsigned int>(index >> 32) };
+			unsigned int words[2];
+			seedSequence.generate(words, words + 2);
+			return (static_cast<unsigned long long>(words[1]) << 32) | words[0];
+		}
+		size_t NumReplicates() const
+		{
+			return results_.size();
+		}
+		const std::vector<std::string>& GetStateNames() const
+		{
+			return stateNames_;
+		}
+		const Result& GetResult(size_t replicate) const
+		{
+			if (replicate >= results_.size())
+			{
+				std::string errorMessage = "Replicate index ";
+				errorMessage += std::to_string(replicate);
+				errorMessage += " out of range.";
+				throw std::exception(errorMessage.c_str());
+			}
+			return results_[replicate];
+		}
+	private:
+		/// <summary>
+		/// Sets up and runs the given number of replicates in parallel, each in its own simulation instance. The given function runs a replicate after its instance was set up.
+		/// </summary>
+		void runReplicates(size_t numReplicates, const std::function<void(SimulationInstance&)>& runReplicate)
+		{
+			results_.clear();
+			results_.resize(numReplicates);
+			stateNames_.clear();
+
+			size_t numThreads = numThreads_ > 0 ? numThreads_ : std::thread::hardware_concurrency();
+			if (numThreads == 0)
+				numThreads = 1;
+			if (numThreads > numReplicates)
+				numThreads = numReplicates;
+
+			// Replicates are handed out one at a time, such that threads finishing early pick up the remaining work.
+			std::atomic<size_t> nextReplicate(0);
+			std::atomic<bool> failed(false);
+			std::exception_ptr error;
+			std::mutex mutex;
+			auto worker = [&]()
+			{
+				while (!failed)
+				{
+					size_t replicate = nextReplicate++;
+					if (replicate >= numReplicates)
+						return;
+					try
+					{
+						SimulationInstance instance(model_);
+						if (instanceSetup_)
+							instanceSetup_(instance, replicate);
+						instance.SetSeed(GetReplicateSeed(replicate));
+						auto recorder = std::make_shared<EnsembleRecorder>(results_[replicate]);
+						instance.AddLogger(recorder);
+						runReplicate(instance);
+						results_[replicate].stopReason_ = instance.GetStopReason();
+						if (replicate == 0)
+						{
+							std::lock_guard<std::mutex> lock(mutex);
+							stateNames_ = recorder->GetStateNames();
+						}
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						if (!error)
+							error = std::current_exception();
+						failed = true;
+					}
+				}
+			};
+			std::vector<std::thread> threads;
+			for (size_t t = 1; t < numThreads; t++)
+			{
+				threads.emplace_back(worker);
+			}
+			worker();
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			if (error)
+			{
+				results_.clear();
+				stateNames_.clear();
+				std::rethrow_exception(error);
+			}
+		}
+		const std::shared_ptr<const CompiledModel> model_;
+		InstanceSetup instanceSetup_;
+		size_t numThreads_;
+		unsigned long long seed_;
+		std::vector<Result> results_;
+		std::vector<std::string> stateNames_;
+	};
+
+	Ensemble::Ensemble(std::shared_ptr<const CompiledModel> model, InstanceSetup instanceSetup) : impl_(new Ensemble::Impl(std::move(model), std::move(instanceSetup)))
+	{
+	}
+	Ensemble::~Ensemble()
+	{
+		delete impl_;
+	}
+	void Ensemble::Run(size_t numReplicates, double maxTime)
+	{
+		impl_->Run(numReplicates, maxTime);
+	}
+	void Ensemble::Fork(const std::vector<char>& checkpoint, size_t numReplicates, double maxTime)
+	{
+		impl_->Fork(checkpoint, numReplicates, maxTime);
+	}
+	void Ensemble::SetNumThreads(size_t numThreads)
+	{
+		impl_->SetNumThreads(numThreads);
+	}
+	size_t Ensemble::GetNumThreads() const
+	{
+		return impl_->GetNumThreads();
+	}
+	void Ensemble::SetSeed(unsigned long long seed)
+	{
+		impl_->SetSeed(seed);
+	}
+	unsigned long long Ensemble::GetSeed() const
+	{
+		return impl_->GetSeed();
+	}
+	unsigned long long Ensemble::GetReplicateSeed(size_t replicate) const
+	{
+		return impl_->GetReplicateSeed(replicate);
+	}
+	size_t Ensemble::NumReplicates() const
+	{
+		return impl_->NumReplicates();
+	}
+	const std::vector<std::string>& Ensemble::GetStateNames() const
+	{
+		return impl_->GetStateNames();
+	}
+	const Ensemble::Result& Ensemble::GetResult(size_t replicate) const
+	{
+		return impl_->GetResult(replicate);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "stochsim_common.h"
+#include "DependencyGraph.h"
+#include "IndexedPriorityQueue.h"
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Keeps track of the next firing times of all event reactions in an indexed priority queue, such that the next event reaction is known without asking every event reaction for its next firing time
+	/// in every step. After a propensity or event reaction fired, only the firing times of the event reactions depending on it (see DependencyGraph) are recomputed, and the queue only changes if
+	/// these times actually changed, e.g. when the ComposedState a DelayReaction depends on gained or lost its first molecule.
+	/// </summary>
+	class EventScheduler
+	{
+	public:
+		EventScheduler() : events_(nullptr), dependencyGraph_(nullptr)
+		{
+		}
+		/// <summary>
+		/// Called by the simulation before the simulation starts, after all states and reactions were initialized.
+		/// The reaction collection and the dependency graph must stay valid until the simulation finished.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="events">Event reactions of the simulation.</param>
+		/// <param name="dependencyGraph">Dependency graph of the reactions of the simulation.</param>
+		void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IEventReaction>>& events, const DependencyGraph& dependencyGraph)
+		{
+			events_ = &events;
+			dependencyGraph_ = &dependencyGraph;
+			std::vector<double> fireTimes(events.size());
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				fireTimes[i] = events[i]->NextReactionTime(simInfo);
+			}
+			queue_.Reset(std::move(fireTimes));
+		}
+		/// <summary>
+		/// Returns the simulation time when the next event reaction fires, or stochsim::inf if no event reaction will fire anymore.
+		/// </summary>
+		/// <returns>Simulation time of next event reaction.</returns>
+		inline double NextEventTime() const
+		{
+			return queue_.Empty() ? stochsim::inf : queue_.TopKey();
+		}
+		/// <summary>
+		/// Returns the index of the event reaction firing next. Behavior undefined if there are no event reactions.
+		/// </summary>
+		/// <returns>Index of next event reaction.</returns>
+		inline size_t NextEvent() const
+		{
+			return queue_.Top();
+		}
+		/// <summary>
+		/// Updates the firing times of all event reactions depending on the propensity reaction which fired.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactionIndex">Index of the propensity reaction which fired.</param>
+		inline void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex)
+		{
+			update(simInfo, dependencyGraph_->GetPropensityEventDependents(reactionIndex));
+		}
+		/// <summary>
+		/// Updates the firing times of all event reactions depending on the event reaction which fired, including the one of the event reaction itself.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="eventIndex">Index of the event reaction which fired.</param>
+		inline void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex)
+		{
+			update(simInfo, dependencyGraph_->GetEventEventDependents(eventIndex));
+		}
+		/// <summary>
+		/// Recomputes the firing times of all event reactions, e.g. after several propensity reactions fired at once.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		void NotifyAllChanged(ISimInfo& simInfo)
+		{
+			for (size_t eventIndex = 0; eventIndex < events_->size(); eventIndex++)
+			{
+				double fireTime = (*events_)[eventIndex]->NextReactionTime(simInfo);
+				if (fireTime != queue_.GetKey(eventIndex))
+					queue_.Update(eventIndex, fireTime);
+			}
+		}
+		/// <summary>
+		/// Writes the queue of firing times to a checkpoint. The queue is saved instead of rebuilt, such that event reactions firing at the same time fire in the same order after the checkpoint is restored.
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to write to.</param>
+		void SaveCheckpoint(CheckpointWriter& checkpoint) const
+		{
+			queue_.Save(checkpoint);
+		}
+		/// <summary>
+		/// Restores the queue written by SaveCheckpoint(). Called after Initialize().
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to read from.</param>
+		void RestoreCheckpoint(CheckpointReader& checkpoint)
+		{
+			queue_.Load(checkpoint);
+			if (queue_.Size() != events_->size())
+				throw std::exception("Checkpoint was saved for a different number of event reactions.");
+		}
+	private:
+		const std::vector<std::shared_ptr<IEventReaction>>* events_;
+		const DependencyGraph* dependencyGraph_;
+		IndexedPriorityQueue queue_;
+
+		void update(ISimInfo& simInfo, const std::vector<size_t>& dependents)
+		{
+			for (auto eventIndex : dependents)
+			{
+				double fireTime = (*events_)[eventIndex]->NextReactionTime(simInfo);
+				if (fireTime != queue_.GetKey(eventIndex))
+					queue_.Update(eventIndex, fireTime);
+			}
+		}
+	};
+}
@@ -0,0 +1,481 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <math.h>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "ReactionNetwork.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Hybrid stochastic-deterministic method, similar to the one outlined in
+	/// Salis, Howard, and Yiannis Kaznessis. "Accurate hybrid stochastic simulation of a system of coupled chemical or biochemical reactions." The Journal of chemical physics 122.5 (2005): 054103.
+	/// Before every step, the reactions are partitioned into fast and slow reactions. A reaction is fast if it follows mass action kinetics, does not transform the molecules of weighted states (see PropensityReaction::SetWeight()), all its reactants and products have at least fastNumber molecules,
+	/// and its propensity is at least fastRatio times larger than the sum of the propensities of all other reactions. The extents of the fast reactions are integrated deterministically with an adaptive
+	/// Dormand-Prince RK45 solver, and fast reactions fire whenever their extent passes an integer. Slow reactions fire stochastically: the integral of their aggregated propensity is integrated together with
+	/// the fast reactions, and the next slow reaction fires when this integral reaches an exponentially distributed threshold. If no reaction is fast, the algorithm reduces to the direct method.
+	/// The algorithm is approximate. Event reactions still fire exactly at their scheduled times.
+	/// </summary>
+	class HybridMethod : public ISimulationAlgorithm
+	{
+	public:
+		HybridMethod() : reactions_(nullptr), kernel_(nullptr), mode_(Mode::None), stepStart_(0), stepSize_(0), slowDue_(false), remainingHazard_(0), aSlow_(0)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			mode_ = Mode::None;
+			network_.Initialize(reactions);
+			propensities_.assign(reactions.size(), 0);
+			fast_.assign(reactions.size(), false);
+			carry_.assign(reactions.size(), 0);
+			numbers_.assign(network_.NumStates(), 0);
+			continuousNumbers_.assign(network_.NumStates(), 0);
+			stepSize_ = 0;
+			remainingHazard_ = simInfo.RandExponential();
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			stepStart_ = simInfo.GetSimTime();
+			mode_ = Mode::None;
+			for (size_t i = 0; i < network_.NumStates(); i++)
+			{
+				numbers_[i] = static_cast<double>(network_.GetState(i)->Num(simInfo));
+			}
+			double aFast = partition(simInfo);
+			if (fastReactions_.empty())
+			{
+				// Only slow reactions, i.e. a step of the direct method.
+				if (aSlow_ <= 0)
+					return stochsim::inf;
+				mode_ = Mode::Exact;
+				return stepStart_ + remainingHazard_ / aSlow_;
+			}
+
+			if (stepSize_ <= 0)
+				stepSize_ = initialFirings / aFast;
+			while (true)
+			{
+				double error = integrate(stepSize_, extents_);
+				if (error > 1)
+				{
+					stepSize_ *= std::max(0.2, 0.9 * pow(error, -0.2));
+					continue;
+				}
+				double usedStepSize = stepSize_;
+				stepSize_ *= error > 0 ? std::min(5.0, 0.9 * pow(error, -0.2)) : 5.0;
+				double hazard = extents_.back();
+				slowDue_ = hazard >= remainingHazard_;
+				if (slowDue_)
+				{
+					// Shorten step such that it ends when the next slow reaction fires. Since the slow propensities change during the step, the integrated hazard is not linear in the
+					// step size, and the step size where it reaches the remaining hazard is determined by the secant method. The hazard is monotonically increasing in the step size.
+					double lowerStepSize = 0;
+					double lowerExcess = -remainingHazard_;
+					double upperStepSize = usedStepSize;
+					double upperExcess = hazard - remainingHazard_;
+					int side = 0;
+					for (int iteration = 0; iteration < maxCrossingIterations; iteration++)
+					{
+						// Illinois variant of the regula falsi, which prevents one end of the bracket from getting stuck.
+						usedStepSize = (lowerStepSize * upperExcess - upperStepSize * lowerExcess) / (upperExcess - lowerExcess);
+						integrate(usedStepSize, extents_);
+						hazard = extents_.back();
+						double excess = hazard - remainingHazard_;
+						if (std::abs(excess) <= crossingTolerance * remainingHazard_)
+							break;
+						if (excess < 0)
+						{
+							lowerStepSize = usedStepSize;
+							lowerExcess = excess;
+							if (side < 0)
+								upperExcess /= 2;
+							side = -1;
+						}
+						else
+						{
+							upperStepSize = usedStepSize;
+							upperExcess = excess;
+							if (side > 0)
+								lowerExcess /= 2;
+							side = 1;
+						}
+					}
+					// If the crossing could not be located precisely, stop short of it and continue integrating from there.
+					if (std::abs(hazard - remainingHazard_) > crossingTolerance * remainingHazard_)
+					{
+						usedStepSize = lowerStepSize;
+						integrate(usedStepSize, extents_);
+						slowDue_ = false;
+					}
+				}
+				mode_ = Mode::Ode;
+				return stepStart_ + usedStepSize;
+			}
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			if (mode_ == Mode::Exact)
+			{
+				mode_ = Mode::None;
+				remainingHazard_ = simInfo.RandExponential();
+				size_t reactionIndex = selectSlow(simInfo, false);
+				if (reactionIndex >= reactions_->size())
+					return reactions_->size();
+				(*reactions_)[reactionIndex]->Fire(simInfo);
+				return reactionIndex;
+			}
+			else if (mode_ == Mode::Ode)
+			{
+				mode_ = Mode::None;
+				bool anyFired = fireFast(simInfo);
+				size_t reactionIndex = reactions_->size();
+				if (slowDue_)
+				{
+					remainingHazard_ = simInfo.RandExponential();
+					reactionIndex = selectSlow(simInfo, true);
+					if (reactionIndex < reactions_->size())
+						(*reactions_)[reactionIndex]->Fire(simInfo);
+				}
+				else
+					remainingHazard_ -= extents_.back();
+				if (anyFired)
+					return severalReactions;
+				return reactionIndex;
+			}
+			return reactions_->size();
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			double stepSize = simInfo.GetSimTime() - stepStart_;
+			if (mode_ == Mode::Exact)
+			{
+				mode_ = Mode::None;
+				remainingHazard_ -= aSlow_ * stepSize;
+				return false;
+			}
+			else if (mode_ == Mode::Ode)
+			{
+				mode_ = Mode::None;
+				if (stepSize <= 0)
+					return false;
+				integrate(stepSize, extents_);
+				remainingHazard_ -= extents_.back();
+				return fireFast(simInfo);
+			}
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			// do nothing. All propensities are recomputed anyways.
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			// do nothing. All propensities are recomputed anyways.
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// The state carried from step to step, i.e. the step size, the remaining hazard and the fractional extents, together with the step determined by the last call to NextReactionTime, which might not have been fired yet.
+			checkpoint.Write(static_cast<std::int32_t>(mode_));
+			checkpoint.Write(stepStart_);
+			checkpoint.Write(stepSize_);
+			checkpoint.Write(slowDue_);
+			checkpoint.Write(remainingHazard_);
+			checkpoint.Write(aSlow_);
+			checkpoint.WriteArray(propensities_.data(), propensities_.size());
+			checkpoint.WriteArray(carry_.data(), carry_.size());
+			checkpoint.WriteArray(numbers_.data(), numbers_.size());
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				checkpoint.Write<bool>(fast_[j]);
+			}
+			checkpoint.Write<std::uint64_t>(extents_.size());
+			checkpoint.WriteArray(extents_.data(), extents_.size());
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			mode_ = static_cast<Mode>(checkpoint.Read<std::int32_t>());
+			stepStart_ = checkpoint.Read<double>();
+			stepSize_ = checkpoint.Read<double>();
+			slowDue_ = checkpoint.Read<bool>();
+			remainingHazard_ = checkpoint.Read<double>();
+			aSlow_ = checkpoint.Read<double>();
+			checkpoint.ReadArray(propensities_.data(), propensities_.size());
+			checkpoint.ReadArray(carry_.data(), carry_.size());
+			checkpoint.ReadArray(numbers_.data(), numbers_.size());
+			fastReactions_.clear();
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				fast_[j] = checkpoint.Read<bool>();
+				if (fast_[j])
+					fastReactions_.push_back(j);
+			}
+			extents_.resize(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+			checkpoint.ReadArray(extents_.data(), extents_.size());
+			if (extents_.size() != fastReactions_.size() + 1 && !extents_.empty())
+				throw std::exception("Checkpoint is truncated or corrupt.");
+			for (auto& k : k_)
+			{
+				k.resize(fastReactions_.size() + 1);
+			}
+			stage_.resize(fastReactions_.size() + 1);
+			extents_.resize(fastReactions_.size() + 1);
+		}
+	private:
+		/// <summary>
+		/// Minimal molecular number of all reactants and products of a fast reaction.
+		/// </summary>
+		static constexpr double fastNumber = 100;
+		/// <summary>
+		/// Minimal ratio between the propensity of a fast reaction and the aggregated propensity of all slow reactions.
+		/// </summary>
+		static constexpr double fastRatio = 10;
+		/// <summary>
+		/// Number of firings of fast reactions during the first step, before the step size is adapted.
+		/// </summary>
+		static constexpr double initialFirings = 10;
+		static constexpr double relativeTolerance = 1e-3;
+		static constexpr double absoluteTolerance = 1e-2;
+		/// <summary>
+		/// Relative tolerance and maximal number of iterations when locating the time when the next slow reaction fires.
+		/// </summary>
+		static constexpr double crossingTolerance = 1e-6;
+		static constexpr int maxCrossingIterations = 50;
+
+		enum class Mode
+		{
+			None,
+			Exact,
+			Ode
+		};
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		ReactionNetwork network_;
+		Mode mode_;
+		double stepStart_;
+		// Step size of the ODE solver, adapted from step to step.
+		double stepSize_;
+		// True if the next slow reaction fires at the end of the current step.
+		bool slowDue_;
+		// Remaining integral of the aggregated propensity of the slow reactions until the next slow reaction fires.
+		double remainingHazard_;
+		// Aggregated propensity of the slow reactions at the beginning of the step.
+		double aSlow_;
+		std::vector<double> propensities_;
+		std::vector<bool> fast_;
+		std::vector<size_t> fastReactions_;
+		// Fractional extent of every fast reaction not yet fired.
+		std::vector<double> carry_;
+		// Number of firings of every fast reaction at the end of the current step not yet performed.
+		std::vector<size_t> firings_;
+		std::vector<double> numbers_;
+		std::vector<double> continuousNumbers_;
+		// Extents of the fast reactions, followed by the integral of the aggregated propensity of the slow reactions, since the beginning of the step.
+		std::vector<double> extents_;
+		// Stages of the RK45 solver.
+		std::vector<double> k_[7];
+		std::vector<double> stage_;
+
+		/// <summary>
+		/// Computes all propensities and partitions the reactions into fast and slow reactions. Returns the aggregated propensity of all fast reactions.
+		/// </summary>
+		double partition(ISimInfo& simInfo)
+		{
+			aSlow_ = 0;
+			kernel_->ComputeRates(simInfo, propensities_.data());
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				propensities_[j] = propensities_[j] > 0 ? propensities_[j] : 0;
+				fast_[j] = isFastCandidate(j);
+				if (!fast_[j])
+					aSlow_ += propensities_[j];
+			}
+			double aFast = 0;
+			const double minFastPropensity = fastRatio * aSlow_;
+			fastReactions_.clear();
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (fast_[j] && propensities_[j] < minFastPropensity)
+				{
+					fast_[j] = false;
+					aSlow_ += propensities_[j];
+				}
+				if (fast_[j])
+				{
+					fastReactions_.push_back(j);
+					aFast += propensities_[j];
+				}
+				else
+					carry_[j] = 0;
+			}
+			for (auto& k : k_)
+			{
+				k.resize(fastReactions_.size() + 1);
+			}
+			stage_.resize(fastReactions_.size() + 1);
+			extents_.resize(fastReactions_.size() + 1);
+			return aFast;
+		}
+		bool isFastCandidate(size_t reactionIndex) const
+		{
+			const ReactionNetwork::Reaction& reaction = network_.GetReaction(reactionIndex);
+			if (!reaction.known_ || !reaction.massAction_ || !reaction.exactChanges_ || reaction.weighted_ || propensities_[reactionIndex] <= 0)
+				return false;
+			for (const auto& rateState : reaction.rateStates_)
+			{
+				if (numbers_[rateState.first] < fastNumber)
+					return false;
+			}
+			for (const auto& change : reaction.changes_)
+			{
+				if (numbers_[change.first] < fastNumber)
+					return false;
+			}
+			return true;
+		}
+		/// <summary>
+		/// Computes the time derivatives of the extents of the fast reactions and of the integral of the propensities of the slow reactions.
+		/// </summary>
+		void derivatives(const std::vector<double>& extents, std::vector<double>& rates)
+		{
+			continuousNumbers_ = numbers_;
+			for (size_t f = 0; f < fastReactions_.size(); f++)
+			{
+				for (const auto& change : network_.GetReaction(fastReactions_[f]).changes_)
+				{
+					continuousNumbers_[change.first] += change.second * extents[f];
+				}
+			}
+			for (size_t f = 0; f < fastReactions_.size(); f++)
+			{
+				rates[f] = network_.ComputeMassActionRate(fastReactions_[f], continuousNumbers_);
+			}
+			double aSlow = 0;
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (fast_[j])
+					continue;
+				const ReactionNetwork::Reaction& reaction = network_.GetReaction(j);
+				// Propensities which are not mass action are assumed to be constant during a step.
+				aSlow += reaction.known_ && reaction.massAction_ ? network_.ComputeMassActionRate(j, continuousNumbers_) : propensities_[j];
+			}
+			rates.back() = aSlow;
+		}
+		/// <summary>
+		/// Performs a single step of the Dormand-Prince RK45 method from the beginning of the step, i.e. with all extents being zero. Returns the estimated error relative to the tolerances.
+		/// </summary>
+		double integrate(double stepSize, std::vector<double>& extents)
+		{
+			static const double a[7][6] = {
+				{ 0, 0, 0, 0, 0, 0 },
+				{ 1.0 / 5, 0, 0, 0, 0, 0 },
+				{ 3.0 / 40, 9.0 / 40, 0, 0, 0, 0 },
+				{ 44.0 / 45, -56.0 / 15, 32.0 / 9, 0, 0, 0 },
+				{ 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729, 0, 0 },
+				{ 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656, 0 },
+				{ 35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 }
+			};
+			// Difference between the fifth and the fourth order solution.
+			static const double e[7] = { 71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40 };
+			const size_t n = stage_.size();
+			for (size_t s = 0; s < 7; s++)
+			{
+				for (size_t i = 0; i < n; i++)
+				{
+					double sum = 0;
+					for (size_t r = 0; r < s; r++)
+					{
+						sum += a[s][r] * k_[r][i];
+					}
+					stage_[i] = stepSize * sum;
+				}
+				derivatives(stage_, k_[s]);
+			}
+			// The last stage was evaluated at the fifth order solution.
+			extents = stage_;
+			double error = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				double localError = 0;
+				for (size_t s = 0; s < 7; s++)
+				{
+					localError += e[s] * k_[s][i];
+				}
+				localError = fabs(stepSize * localError) / (absoluteTolerance + relativeTolerance * fabs(extents[i]));
+				error = std::max(error, localError);
+			}
+			return error;
+		}
+		/// <summary>
+		/// Fires every fast reaction as many times as its extent (including the extent not fired in previous steps) passed an integer. Returns true if any reaction fired.
+		/// </summary>
+		bool fireFast(ISimInfo& simInfo)
+		{
+			firings_.resize(fastReactions_.size());
+			for (size_t f = 0; f < fastReactions_.size(); f++)
+			{
+				size_t reactionIndex = fastReactions_[f];
+				double extent = carry_[reactionIndex] + std::max(extents_[f], 0.0);
+				double firings = floor(extent);
+				carry_[reactionIndex] = extent - firings;
+				firings_[f] = static_cast<size_t>(firings);
+			}
+			// During a step, a fast reaction might consume more molecules than were present at its beginning, e.g. for A -> and -> A. The reactions are thus fired in rounds until no reaction can fire anymore,
+			// such that they can consume the molecules produced by the other fast reactions. Firings which are still not possible are discarded.
+			bool anyFired = false;
+			bool firedInRound = true;
+			while (firedInRound)
+			{
+				firedInRound = false;
+				for (size_t f = 0; f < fastReactions_.size(); f++)
+				{
+					size_t reactionIndex = fastReactions_[f];
+					for (; firings_[f] > 0 && network_.CanFire(simInfo, reactionIndex); firings_[f]--)
+					{
+						(*reactions_)[reactionIndex]->Fire(simInfo);
+						firedInRound = true;
+					}
+				}
+				anyFired = anyFired || firedInRound;
+			}
+			return anyFired;
+		}
+		/// <summary>
+		/// Selects a slow reaction with probability proportional to its propensity. If recompute is true, the propensities are recomputed, since the molecular numbers might have changed during the step.
+		/// Returns the number of reactions if no slow reaction can fire.
+		/// </summary>
+		size_t selectSlow(ISimInfo& simInfo, bool recompute)
+		{
+			double aSlow = 0;
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (fast_[j])
+					continue;
+				if (recompute)
+				{
+					double propensity = kernel_->ComputeRate(simInfo, j);
+					propensities_[j] = propensity > 0 ? propensity : 0;
+				}
+				aSlow += propensities_[j];
+			}
+			double afraction = simInfo.Rand() * aSlow;
+			double asum = 0;
+			size_t reactionIndex = reactions_->size();
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (fast_[j] || propensities_[j] <= 0)
+					continue;
+				reactionIndex = j;
+				asum += propensities_[j];
+				if (asum >= afraction)
+					break;
+			}
+			if (reactionIndex < reactions_->size() && !network_.CanFire(simInfo, reactionIndex))
+				return reactions_->size();
+			return reactionIndex;
+		}
+	};
+}
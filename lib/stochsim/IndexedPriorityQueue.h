@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Binary min-heap of the elements 0...N-1, each associated with a key (e.g. a time). Different to std::priority_queue, the heap additionally keeps track of the position of every element,
+	/// such that the key of an arbitrary element can be changed in O(log N).
+	/// </summary>
+	class IndexedPriorityQueue
+	{
+	public:
+		/// <summary>
+		/// Re-initializes the queue with the given keys. Element i gets the key keys[i]. Runs in O(N).
+		/// </summary>
+		/// <param name="keys">Keys of the elements.</param>
+		void Reset(std::vector<double> keys)
+		{
+			keys_ = std::move(keys);
+			heap_.resize(keys_.size());
+			positions_.resize(keys_.size());
+			for (size_t i = 0; i < keys_.size(); i++)
+			{
+				heap_[i] = i;
+				positions_[i] = i;
+			}
+			for (size_t pos = heap_.size() / 2; pos > 0; pos--)
+			{
+				siftDown(pos - 1);
+			}
+		}
+		/// <summary>
+		/// Returns true if the queue does not contain any element.
+		/// </summary>
+		/// <returns>True if empty.</returns>
+		inline bool Empty() const noexcept
+		{
+			return heap_.empty();
+		}
+		/// <summary>
+		/// Returns the number of elements in the queue.
+		/// </summary>
+		/// <returns>Number of elements.</returns>
+		inline size_t Size() const noexcept
+		{
+			return heap_.size();
+		}
+		/// <summary>
+		/// Returns the element with the smallest key. Behavior undefined if the queue is empty.
+		/// </summary>
+		/// <returns>Element with the smallest key.</returns>
+		inline size_t Top() const
+		{
+			return heap_[0];
+		}
+		/// <summary>
+		/// Returns the smallest key. Behavior undefined if the queue is empty.
+		/// </summary>
+		/// <returns>Smallest key.</returns>
+		inline double TopKey() const
+		{
+			return keys_[heap_[0]];
+		}
+		/// <summary>
+		/// Returns the key of the given element.
+		/// </summary>
+		/// <param name="element">Element, between 0 and Size()-1.</param>
+		/// <returns>Key of element.</returns>
+		inline double GetKey(size_t element) const
+		{
+			return keys_[element];
+		}
+		/// <summary>
+		/// Changes the key of the given element and restores the heap property. Runs in O(log N).
+		/// </summary>
+		/// <param name="element">Element, between 0 and Size()-1.</param>
+		/// <param name="key">New key of the element.</param>
+		inline void Update(size_t element, double key)
+		{
+			double oldKey = keys_[element];
+			keys_[element] = key;
+			if (key < oldKey)
+				siftUp(positions_[element]);
+			else
+				siftDown(positions_[element]);
+		}
+		/// <summary>
+		/// Writes the keys and the order of the heap to a checkpoint. The order is stored, since elements with equal keys might otherwise be returned in a different order after restoring.
+		/// </summary>
+		void Save(CheckpointWriter& checkpoint) const
+		{
+			checkpoint.Write<std::uint64_t>(keys_.size());
+			checkpoint.WriteArray(keys_.data(), keys_.size());
+			for (auto element : heap_)
+			{
+				checkpoint.Write<std::uint64_t>(element);
+			}
+		}
+		/// <summary>
+		/// Re-initializes the queue with the keys and the heap written by Save().
+		/// </summary>
+		void Load(CheckpointReader& checkpoint)
+		{
+			const size_t size = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			keys_.resize(size);
+			checkpoint.ReadArray(keys_.data(), size);
+			heap_.resize(size);
+			positions_.assign(size, size);
+			for (size_t pos = 0; pos < size; pos++)
+			{
+				const size_t element = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				if (element >= size || positions_[element] != size)
+					throw std::exception("Checkpoint is truncated or corrupt.");
+				heap_[pos] = element;
+				positions_[element] = pos;
+			}
+		}
+	private:
+		/// <summary>
+		/// Maps the position in the heap to the element.
+		/// </summary>
+		std::vector<size_t> heap_;
+		/// <summary>
+		/// Maps the element to its position in the heap.
+		/// </summary>
+		std::vector<size_t> positions_;
+		/// <summary>
+		/// Maps the element to its key.
+		/// </summary>
+		std::vector<double> keys_;
+
+		inline void swap(size_t posA, size_t posB)
+		{
+			std::swap(heap_[posA], heap_[posB]);
+			positions_[heap_[posA]] = posA;
+			positions_[heap_[posB]] = posB;
+		}
+		void siftUp(size_t pos)
+		{
+			while (pos > 0)
+			{
+				size_t parent = (pos - 1) / 2;
+				if (keys_[heap_[parent]] <= keys_[heap_[pos]])
+					break;
+				swap(parent, pos);
+				pos = parent;
+			}
+		}
+		void siftDown(size_t pos)
+		{
+			const size_t size = heap_.size();
+			while (true)
+			{
+				size_t smallest = pos;
+				size_t left = 2 * pos + 1;
+				size_t right = left + 1;
+				if (left < size && keys_[heap_[left]] < keys_[heap_[smallest]])
+					smallest = left;
+				if (right < size && keys_[heap_[right]] < keys_[heap_[smallest]])
+					smallest = right;
+				if (smallest == pos)
+					break;
+				swap(pos, smallest);
+				pos = smallest;
+			}
+		}
+	};
+}
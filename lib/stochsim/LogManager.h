@@ -0,0 +1,174 @@
+#pragma once
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#define __STDC_WANT_LIB_EXT1__ 1
+#include <time.h>
+#include "stochsim_common.h"
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Recursively creates all folders of the given path, and returns the path under which results should be saved.
+	/// </summary>
+	/// <param name="rawPath">Path to create.</param>
+	/// <returns>Path where results should be saved.</returns>
+	std::string CreatePathRecursively(std::string rawPath);
+
+	/// <summary>
+	/// Manages the loggers of a simulation run, i.e. creates the folder where results are saved and calls the loggers every time the simulation time exceeds the log period.
+	/// </summary>
+	class LogManager
+	{
+	public:
+		LogManager() : logPeriod_(1.0), baseFolder_("simulations"), uniqueSubFolder_(true), saveFolder_("")
+		{
+		}
+		void SetUniqueSubfolder(bool uniqueSubFolder)
+		{
+			uniqueSubFolder_ = uniqueSubFolder;
+		}
+		bool IsUniqueSubfolder() const
+		{
+			return uniqueSubFolder_;
+		}
+		double GetLogPeriod() const
+		{
+			return logPeriod_;
+		}
+		std::string GetBaseFolder() const 
+		{
+			return baseFolder_;
+		}
+
+		std::string GetSaveFolder() const
+		{
+			return saveFolder_;
+		}
+
+		void AddTask(std::shared_ptr<ILogger> task)
+		{
+			tasks_.push_back(std::move(task));
+		}
+		void Initialize(ISimInfo& simInfo)
+		{
+			// Test if any logger is writing anything to the disk, i.e. if we have to create a results folder at all...
+			bool shouldCreate = false;
+			for (auto& task : tasks_)
+			{
+				if (task->WritesToDisk())
+				{
+					shouldCreate = true;
+					break;
+				}
+			}
+			if (shouldCreate)
+			{
+				time_t t = std::time(0);
+				struct tm now;
+				localtime_s(&now, &t);
+				std::stringstream buffer;
+				buffer << baseFolder_;
+				if (uniqueSubFolder_)
+				{
+					buffer << "/"
+						<< (now.tm_year + 1900) << '-'
+						<< (now.tm_mon + 1) << '-'
+						<< now.tm_mday << '_'
+						<< now.tm_hour << '-'
+						<< now.tm_min << '-'
+						<< now.tm_sec << '/';
+				}
+				saveFolder_ = buffer.str();
+				saveFolder_ = CreatePathRecursively(saveFolder_);
+			}
+			else
+				saveFolder_ = "";
+
+			for (auto& task : tasks_)
+			{
+				task->Initialize(simInfo);
+			}
+			auto time = simInfo.GetSimTime();
+			WriteLog(simInfo, time);
+			lastLogTime_ = time;
+		}
+		void Uninitialize(ISimInfo& simInfo)
+		{
+			auto time = simInfo.GetSimTime();
+			NotifyBeforeChange(simInfo);
+			WriteLog(simInfo, time);
+			lastLogTime_ = time;
+			for (auto& task : tasks_)
+			{
+				task->Uninitialize(simInfo);
+			}
+		}
+		void NotifyBeforeChange(ISimInfo& simInfo)
+		{
+			auto time = simInfo.GetSimTime();
+			while (lastLogTime_ + logPeriod_ < time)
+			{
+				lastLogTime_ += logPeriod_;
+				WriteLog(simInfo, lastLogTime_);
+			}
+		}
+		/// <summary>
+		/// Writes the time of the last log, the folder where results are saved, and the checkpoints of all loggers to a checkpoint.
+		/// </summary>
+		void SaveCheckpoint(ISimInfo& simInfo, CheckpointWriter& checkpoint)
+		{
+			checkpoint.Write(lastLogTime_);
+			checkpoint.WriteString(saveFolder_);
+			checkpoint.Write<std::uint64_t>(tasks_.size());
+			for (auto& task : tasks_)
+			{
+				task->SaveCheckpoint(simInfo, checkpoint);
+			}
+		}
+		/// <summary>
+		/// Restores the state written by SaveCheckpoint(), and lets all loggers continue logging where they were when the checkpoint was saved. Called instead of Initialize().
+		/// </summary>
+		void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint)
+		{
+			lastLogTime_ = checkpoint.Read<double>();
+			saveFolder_ = checkpoint.ReadString();
+			const std::uint64_t numTasks = checkpoint.Read<std::uint64_t>();
+			if (numTasks != tasks_.size())
+			{
+				std::stringstream errorMessage;
+				errorMessage << "Checkpoint was saved by a simulation with " << numTasks << " loggers, but the simulation restoring it has " << tasks_.size() << " loggers.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			for (auto& task : tasks_)
+			{
+				task->RestoreCheckpoint(simInfo, checkpoint);
+			}
+		}
+		void SetLogPeriod(double logPeriod)
+		{
+			assert(logPeriod > 0);
+			logPeriod_ = logPeriod;
+		}
+		void SetBaseFolder(std::string baseFolder)
+		{
+			baseFolder_ = std::move(baseFolder);
+		}
+	private:
+		inline void WriteLog(ISimInfo& simInfo, double time)
+		{
+			for (auto& task : tasks_)
+			{
+				task->WriteLog(simInfo, time);
+			}
+		}
+		std::vector<std::shared_ptr<ILogger>> tasks_;
+		double lastLogTime_;
+		double logPeriod_;
+		std::string baseFolder_;
+		bool uniqueSubFolder_;
+		std::string saveFolder_;
+	};
+}
@@ -0,0 +1,440 @@
+#include "MassActionKernel.h"
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include "CompiledModel.h"
+#include "State.h"
+#if defined(__x86_64__) || defined(_M_X64)
+#define STOCHSIM_X64
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC always allows AVX intrinsics, independent of the target architecture.
+#define STOCHSIM_TARGET_AVX2
+#define STOCHSIM_TARGET_AVX512
+#else
+// GCC and clang only allow AVX intrinsics in functions explicitly compiled for the respective instruction set.
+#define STOCHSIM_TARGET_AVX2 __attribute__((target("avx2")))
+#define STOCHSIM_TARGET_AVX512 __attribute__((target("avx512f,avx512dq")))
+#endif
+#endif
+namespace stochsim
+{
+#ifdef STOCHSIM_X64
+	/// <summary>
+	/// Returns true if both the CPU and the operating system support AVX2, i.e. if the CPU supports the instructions and the operating system saves the YMM registers on context switches.
+	/// </summary>
+	static bool supportsAVX2() noexcept
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+	/// <summary>
+	/// Returns true if both the CPU and the operating system support the AVX-512 foundation and doubleword/quadword instructions.
+	/// </summary>
+	static bool supportsAVX512() noexcept
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		if (!supportsAVX2())
+			return false;
+		// Besides the YMM registers, the operating system has to save the opmask and upper ZMM registers.
+		if ((_xgetbv(0) & 0xe6) != 0xe6)
+			return false;
+		int info[4];
+		__cpuidex(info, 7, 0);
+		const bool avx512f = (info[1] & (1 << 16)) != 0;
+		const bool avx512dq = (info[1] & (1 << 17)) != 0;
+		return avx512f && avx512dq;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+#endif
+	}
+#endif
+
+	MassActionKernel::MassActionKernel(const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const std::unordered_map<const IState*, size_t>& molecularNumberSlots, bool vectorized) :
+		reactions_(&reactions), instructionSet_(InstructionSet::Scalar), maxFactors_(0)
+	{
+		massAction_.resize(reactions.size(), 0);
+		timeDependent_.resize(reactions.size(), 0);
+		rateConstants_.resize(reactions.size(), 0);
+		factorsBegin_.resize(reactions.size() + 1, 0);
+		for (size_t j = 0; j < reactions.size(); j++)
+		{
+			factorsBegin_[j] = factorSlots_.size();
+			auto propensityReaction = dynamic_cast<const PropensityReaction*>(reactions[j].get());
+			// Time dependent reactions are simulated by the TimeDependentScheduler, and have a propensity of zero in the table.
+			if (propensityReaction && propensityReaction->IsRateTimeDependent() && !propensityReaction->IsRateRandom())
+			{
+				timeDependent_[j] = 1;
+				timeDependentReactions_.push_back(j);
+				continue;
+			}
+			if (!propensityReaction || !propensityReaction->IsMassAction())
+			{
+				customReactions_.push_back(j);
+				continue;
+			}
+			// Same order of factors as in PropensityReaction::ComputeRate(), such that both produce identical propensities.
+			std::vector<std::pair<std::shared_ptr<IState>, Stochiometry>> rateStates;
+			for (const auto& reactant : propensityReaction->GetReactants())
+			{
+				rateStates.emplace_back(reactant.state_, reactant.stochiometry_);
+			}
+			for (const auto& modifier : propensityReaction->GetModifiers())
+			{
+				rateStates.emplace_back(modifier.state_, modifier.stochiometry_);
+			}
+			for (const auto& transformee : propensityReaction->GetTransformees())
+			{
+				rateStates.emplace_back(transformee.state_, transformee.stochiometry_);
+			}
+			bool allSlotted = true;
+			for (const auto& rateState : rateStates)
+			{
+				if (molecularNumberSlots.find(rateState.first.get()) == molecularNumberSlots.end())
+				{
+					allSlotted = false;
+					break;
+				}
+			}
+			if (!allSlotted)
+			{
+				customReactions_.push_back(j);
+				continue;
+			}
+			massAction_[j] = 1;
+			rateConstants_[j] = propensityReaction->GetRateConstant();
+			// A stochiometry s contributes the factors n, n-1, ..., n-s+1.
+			for (const auto& rateState : rateStates)
+			{
+				const size_t slot = molecularNumberSlots.find(rateState.first.get())->second;
+				for (Stochiometry s = 0; s < rateState.second; s++)
+				{
+					factorSlots_.push_back(slot);
+					factorOffsets_.push_back(s);
+				}
+			}
+		}
+		factorsBegin_[reactions.size()] = factorSlots_.size();
+
+		// Transpose the factors, such that factor k of consecutive reactions is stored contiguously. Non mass action reactions have no factors, and a rate constant of zero
+		// in the table; the propensities of custom reactions are overwritten after the mass action propensities were computed.
+		const size_t numReactions = reactions.size();
+		numFactors_.resize(numReactions, 0);
+		for (size_t j = 0; j < numReactions; j++)
+		{
+			numFactors_[j] = factorsBegin_[j + 1] - factorsBegin_[j];
+			if (numFactors_[j] > maxFactors_)
+				maxFactors_ = static_cast<size_t>(numFactors_[j]);
+		}
+		vectorSlots_.resize(maxFactors_ * numReactions, 0);
+		vectorOffsets_.resize(maxFactors_ * numReactions, 0);
+		for (size_t j = 0; j < numReactions; j++)
+		{
+			for (size_t f = factorsBegin_[j]; f < factorsBegin_[j + 1]; f++)
+			{
+				const size_t k = f - factorsBegin_[j];
+				vectorSlots_[k * numReactions + j] = factorSlots_[f];
+				vectorOffsets_[k * numReactions + j] = factorOffsets_[f];
+			}
+		}
+
+#ifdef STOCHSIM_X64
+		if (vectorized)
+		{
+			if (supportsAVX512())
+				instructionSet_ = InstructionSet::AVX512;
+			else if (supportsAVX2())
+				instructionSet_ = InstructionSet::AVX2;
+		}
+#else
+		(void)vectorized;
+#endif
+	}
+
+	void MassActionKernel::ComputeRates(ISimInfo& simInfo, double* propensities) const
+	{
+		const size_t* numbers = simInfo.GetMolecularNumbers();
+		size_t vectorized = 0;
+		switch (instructionSet_)
+		{
+		case InstructionSet::AVX512:
+			vectorized = computeMassActionRatesAVX512(numbers, propensities);
+			break;
+		case InstructionSet::AVX2:
+			vectorized = computeMassActionRatesAVX2(numbers, propensities);
+			break;
+		case InstructionSet::Scalar:
+		default:
+			break;
+		}
+		computeMassActionRatesScalar(numbers, propensities, vectorized);
+		// In the order of the reactions, since custom rate equations might draw random numbers.
+		for (size_t j : customReactions_)
+		{
+			propensities[j] = (*reactions_)[j]->ComputeRate(simInfo);
+		}
+#ifndef NDEBUG
+		for (size_t j = 0; j < massAction_.size(); j++)
+		{
+			if (massAction_[j])
+			{
+				assert(propensities[j] == computeMassActionRate(numbers, j));
+				assert(propensities[j] == (*reactions_)[j]->ComputeRate(simInfo));
+			}
+		}
+#endif
+	}
+
+	const char* MassActionKernel::GetInstructionSet() const noexcept
+	{
+		switch (instructionSet_)
+		{
+		case InstructionSet::AVX512:
+			return "AVX-512";
+		case InstructionSet::AVX2:
+			return "AVX2";
+		case InstructionSet::Scalar:
+		default:
+			return "scalar";
+		}
+	}
+
+	/// <summary>
+	/// Minimal simulation context of the self test, which only provides the flat array of molecular numbers.
+	/// </summary>
+	class SelfTestInfo : public ISimInfo
+	{
+	public:
+		explicit SelfTestInfo(size_t numMolecularNumbers) : numbers_(numMolecularNumbers, 0)
+		{
+		}
+		virtual double GetSimTime() const override
+		{
+			return 0;
+		}
+		virtual double GetRunTime() const override
+		{
+			return 0;
+		}
+		virtual size_t Rand(size_t lower, size_t upper) override
+		{
+			throw std::exception("Mass action propensities must not depend on random numbers.");
+		}
+		virtual double Rand() override
+		{
+			throw std::exception("Mass action propensities must not depend on random numbers.");
+		}
+		virtual double RandExponential() override
+		{
+			throw std::exception("Mass action propensities must not depend on random numbers.");
+		}
+		virtual std::string GetSaveFolder() const override
+		{
+			return "";
+		}
+		virtual double GetLogPeriod() const override
+		{
+			return 0;
+		}
+		virtual const Collection<std::shared_ptr<IState>> GetStates() const override
+		{
+			return Collection<std::shared_ptr<IState>>();
+		}
+		virtual IInstanceData& GetInstanceData(size_t slot) override
+		{
+			throw std::exception("Mass action propensities must not depend on instance data.");
+		}
+		virtual size_t* GetMolecularNumbers() override
+		{
+			return numbers_.data();
+		}
+		virtual void Stop(const std::string& reason) override
+		{
+		}
+	private:
+		std::vector<size_t> numbers_;
+	};
+
+	std::vector<std::string> MassActionKernel::SelfTest()
+	{
+		// One reaction for every combination of the stochiometries of a reactant and a modifier between zero and three, i.e. 16 reactions, such that all reactions are computed by the vectorized
+		// kernels. The rate constants are not exactly representable, such that every multiplication rounds.
+		constexpr Stochiometry maxStochiometry = 3;
+		auto reactant = std::make_shared<State>("A", 0);
+		auto modifier = std::make_shared<State>("B", 0);
+		std::vector<std::shared_ptr<IPropensityReaction>> reactions;
+		for (Stochiometry reactantStochiometry = 0; reactantStochiometry <= maxStochiometry; reactantStochiometry++)
+		{
+			for (Stochiometry modifierStochiometry = 0; modifierStochiometry <= maxStochiometry; modifierStochiometry++)
+			{
+				auto reaction = std::make_shared<PropensityReaction>("reaction" + std::to_string(reactions.size()), 0.1 * (reactions.size() + 1));
+				if (reactantStochiometry > 0)
+					reaction->AddReactant(reactant, reactantStochiometry);
+				if (modifierStochiometry > 0)
+					reaction->AddModifier(modifier, modifierStochiometry);
+				reactions.push_back(std::move(reaction));
+			}
+		}
+		CompiledModel model({ reactant, modifier }, reactions, {}, {}, false);
+		const MassActionKernel& kernel = model.GetMassActionKernel();
+		for (size_t j = 0; j < reactions.size(); j++)
+		{
+			if (!kernel.IsMassAction(j))
+				throw std::exception("Reaction of the self test of the mass action kernel is not a mass action reaction.");
+		}
+		// Reactions 4 and 1 only depend on the reactant, respectively the modifier, with a stochiometry of one.
+		const size_t reactantSlot = kernel.GetFactorSlot(maxStochiometry + 1, 0);
+		const size_t modifierSlot = kernel.GetFactorSlot(1, 0);
+
+		std::vector<std::string> instructionSets = { "scalar" };
+#ifdef STOCHSIM_X64
+		if (supportsAVX2())
+			instructionSets.push_back("AVX2");
+		if (supportsAVX512())
+			instructionSets.push_back("AVX-512");
+#endif
+		// Molecular numbers below, at and above the stochiometries, and large numbers which are not exactly representable as doubles, such that their conversion rounds.
+		const size_t numbers[] = { 0, 1, 2, 3, 4, 1000, (size_t(1) << 32) + 3, (size_t(1) << 53) + 1, std::numeric_limits<size_t>::max() };
+		SelfTestInfo simInfo(model.NumMolecularNumbers());
+		std::vector<double> propensities(reactions.size());
+		for (size_t reactantNumber : numbers)
+		{
+			for (size_t modifierNumber : numbers)
+			{
+				simInfo.GetMolecularNumbers()[reactantSlot] = reactantNumber;
+				simInfo.GetMolecularNumbers()[modifierSlot] = modifierNumber;
+				for (const auto& instructionSet : instructionSets)
+				{
+					size_t vectorized = 0;
+					if (instructionSet == "AVX2")
+						vectorized = kernel.computeMassActionRatesAVX2(simInfo.GetMolecularNumbers(), propensities.data());
+					else if (instructionSet == "AVX-512")
+						vectorized = kernel.computeMassActionRatesAVX512(simInfo.GetMolecularNumbers(), propensities.data());
+					kernel.computeMassActionRatesScalar(simInfo.GetMolecularNumbers(), propensities.data(), vectorized);
+					for (size_t j = 0; j < reactions.size(); j++)
+					{
+						const double expected = reactions[j]->ComputeRate(simInfo);
+						if (std::memcmp(&propensities[j], &expected, sizeof(double)) == 0)
+							continue;
+						std::stringstream errorMessage;
+						errorMessage.precision(17);
+						errorMessage << "Mass action kernel (" << instructionSet << ") computed the propensity " << propensities[j] << " instead of " << expected << " for reaction " << j
+							<< " (stochiometries " << j / (maxStochiometry + 1) << " and " << j % (maxStochiometry + 1) << ", molecular numbers " << reactantNumber << " and " << modifierNumber << ").";
+						throw std::exception(errorMessage.str().c_str());
+					}
+				}
+			}
+		}
+		return instructionSets;
+	}
+
+	void MassActionKernel::computeMassActionRatesScalar(const size_t* numbers, double* propensities, size_t begin) const noexcept
+	{
+		for (size_t j = begin; j < massAction_.size(); j++)
+		{
+			propensities[j] = computeMassActionRate(numbers, j);
+		}
+	}
+
+#ifdef STOCHSIM_X64
+	/// <summary>
+	/// Computes the propensities of four reactions at a time. Lane j of every iteration k multiplies the propensity of reaction j by its k-th factor, exactly as computeMassActionRate() does,
+	/// such that the propensities are bit-for-bit identical.
+	/// </summary>
+	/// <returns>Number of reactions whose propensities were computed, always a multiple of four.</returns>
+	STOCHSIM_TARGET_AVX2 size_t MassActionKernel::computeMassActionRatesAVX2(const size_t* numbers, double* propensities) const noexcept
+	{
+		constexpr size_t numLanes = 4;
+		const size_t numReactions = massAction_.size();
+		const size_t end = numReactions - numReactions % numLanes;
+		const long long* base = reinterpret_cast<const long long*>(numbers);
+		const __m256i signBit = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+		// Constants for converting unsigned 64 bit integers to doubles (AVX2 has no such instruction). The upper and lower 32 bits are placed into the mantissas of 2^84 and 2^52,
+		// respectively, and the offsets are subtracted exactly, such that only the final addition rounds, exactly as a scalar conversion.
+		const __m256i lowMask = _mm256_set1_epi64x(0xffffffffLL);
+		const __m256i lowExponent = _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)); // 2^52
+		const __m256i highExponent = _mm256_castpd_si256(_mm256_set1_pd(19342813113834066795298816.0)); // 2^84
+		const __m256d highAndLowExponent = _mm256_set1_pd(19342813118337666422669312.0); // 2^84 + 2^52
+		for (size_t j = 0; j < end; j += numLanes)
+		{
+			const __m256i count = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(numFactors_.data() + j));
+			__m256d rate = _mm256_loadu_pd(rateConstants_.data() + j);
+			for (size_t k = 0; k < maxFactors_; k++)
+			{
+				const __m256i active = _mm256_cmpgt_epi64(count, _mm256_set1_epi64x(static_cast<long long>(k)));
+				if (_mm256_testz_si256(active, active))
+					break;
+				const size_t index = k * numReactions + j;
+				const __m256i slots = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vectorSlots_.data() + index));
+				const __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vectorOffsets_.data() + index));
+				const __m256i num = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), base, slots, active, 8);
+				// Unsigned comparison num > offset, by flipping the sign bits.
+				const __m256i positive = _mm256_cmpgt_epi64(_mm256_xor_si256(num, signBit), _mm256_xor_si256(offsets, signBit));
+				const __m256i difference = _mm256_and_si256(_mm256_sub_epi64(num, offsets), positive);
+				const __m256d low = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(difference, lowMask), lowExponent));
+				const __m256d high = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(difference, 32), highExponent)), highAndLowExponent);
+				const __m256d factor = _mm256_add_pd(high, low);
+				rate = _mm256_blendv_pd(rate, _mm256_mul_pd(rate, factor), _mm256_castsi256_pd(active));
+			}
+			_mm256_storeu_pd(propensities + j, rate);
+		}
+		return end;
+	}
+	/// <summary>
+	/// Computes the propensities of eight reactions at a time, analogously to computeMassActionRatesAVX2().
+	/// </summary>
+	/// <returns>Number of reactions whose propensities were computed, always a multiple of eight.</returns>
+	STOCHSIM_TARGET_AVX512 size_t MassActionKernel::computeMassActionRatesAVX512(const size_t* numbers, double* propensities) const noexcept
+	{
+		constexpr size_t numLanes = 8;
+		const size_t numReactions = massAction_.size();
+		const size_t end = numReactions - numReactions % numLanes;
+		for (size_t j = 0; j < end; j += numLanes)
+		{
+			const __m512i count = _mm512_loadu_si512(numFactors_.data() + j);
+			__m512d rate = _mm512_loadu_pd(rateConstants_.data() + j);
+			for (size_t k = 0; k < maxFactors_; k++)
+			{
+				const __mmask8 active = _mm512_cmpgt_epu64_mask(count, _mm512_set1_epi64(static_cast<long long>(k)));
+				if (!active)
+					break;
+				const size_t index = k * numReactions + j;
+				const __m512i slots = _mm512_loadu_si512(vectorSlots_.data() + index);
+				const __m512i offsets = _mm512_loadu_si512(vectorOffsets_.data() + index);
+				const __m512i num = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), active, slots, numbers, 8);
+				const __mmask8 positive = _mm512_mask_cmpgt_epu64_mask(active, num, offsets);
+				const __m512d factor = _mm512_maskz_cvtepu64_pd(positive, _mm512_sub_epi64(num, offsets));
+				rate = _mm512_mask_mul_pd(rate, active, rate, factor);
+			}
+			_mm512_storeu_pd(propensities + j, rate);
+		}
+		return end;
+	}
+#else
+	size_t MassActionKernel::computeMassActionRatesAVX2(const size_t*, double*) const noexcept
+	{
+		return 0;
+	}
+	size_t MassActionKernel::computeMassActionRatesAVX512(const size_t*, double*) const noexcept
+	{
+		return 0;
+	}
+#endif
+}
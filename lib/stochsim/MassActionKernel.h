@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <string>
+#include "stochsim_common.h"
+#include "PropensityReaction.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Computes the propensities of the propensity reactions of a compiled model. The propensities of all PropensityReactions following mass action kinetics, and whose rate only depends on states storing their
+	/// molecular number in the flat array of molecular numbers (see IModelCompiler::AddMolecularNumber()), are compiled into a contiguous table (structure of arrays) of rate constants, slots and
+	/// stochiometries, and are computed directly from the flat array without any virtual calls. The propensities of all other reactions (e.g. with custom rate equations) are computed by
+	/// IPropensityReaction::ComputeRate().
+	/// When all propensities are recomputed at once (see ComputeRates()), the mass action propensities of several reactions are computed in parallel with AVX-512 or AVX2 instructions, if vectorization
+	/// is enabled and the CPU supports them. All implementations produce bit-for-bit identical propensities.
+	/// PropensityReactions whose custom rate equation references the simulation time, but no random numbers, are not simulated by the algorithms but by the TimeDependentScheduler. Their propensity
+	/// computed by the kernel is always zero.
+	/// </summary>
+	class MassActionKernel
+	{
+	public:
+		/// <summary>
+		/// Compiles the table of mass action reactions. Must be called after all states and reactions were compiled.
+		/// The reaction collection must stay valid as long as the kernel is used.
+		/// </summary>
+		/// <param name="reactions">Propensity reactions of the model.</param>
+		/// <param name="molecularNumberSlots">Slots of the molecular numbers of all states which requested one.</param>
+		/// <param name="vectorized">True if SIMD instructions should be used to compute all propensities at once, if supported by the CPU.</param>
+		MassActionKernel(const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const std::unordered_map<const IState*, size_t>& molecularNumberSlots, bool vectorized = true);
+		/// <summary>
+		/// Returns true if the propensity of the reaction is computed from the table of mass action reactions.
+		/// </summary>
+		/// <param name="reactionIndex">Index of reaction.</param>
+		/// <returns>True if mass action reaction.</returns>
+		inline bool IsMassAction(size_t reactionIndex) const noexcept
+		{
+			return massAction_[reactionIndex] != 0;
+		}
+		/// <summary>
+		/// Returns true if the propensity of the reaction explicitly depends on the simulation time, and the reaction is thus simulated by the TimeDependentScheduler.
+		/// </summary>
+		/// <param name="reactionIndex">Index of reaction.</param>
+		/// <returns>True if time dependent reaction.</returns>
+		inline bool IsTimeDependent(size_t reactionIndex) const noexcept
+		{
+			return timeDependent_[reactionIndex] != 0;
+		}
+		/// <summary>
+		/// Returns the (sorted) indices of all reactions whose propensity explicitly depends on the simulation time.
+		/// </summary>
+		/// <returns>Indices of time dependent reactions.</returns>
+		inline const std::vector<size_t>& GetTimeDependentReactions() const noexcept
+		{
+			return timeDependentReactions_;
+		}
+		/// <summary>
+		/// Returns the rate constant of a mass action reaction.
+		/// </summary>
+		/// <param name="reactionIndex">Index of mass action reaction.</param>
+		/// <returns>Rate constant.</returns>
+		inline double GetRateConstant(size_t reactionIndex) const noexcept
+		{
+			return rateConstants_[reactionIndex];
+		}
+		/// <summary>
+		/// Returns the number of factors of the propensity of a mass action reaction, i.e. the sum of the stochiometries of all states the propensity depends on. The propensity is the product of the rate constant
+		/// and the factors max(n_k - o_k, 0), with n_k the molecular number in the slot and o_k the offset of factor k.
+		/// </summary>
+		/// <param name="reactionIndex">Index of mass action reaction.</param>
+		/// <returns>Number of factors.</returns>
+		inline size_t NumFactors(size_t reactionIndex) const noexcept
+		{
+			return factorsBegin_[reactionIndex + 1] - factorsBegin_[reactionIndex];
+		}
+		/// <summary>
+		/// Returns the slot of the molecular number of a factor of the propensity of a mass action reaction (see NumFactors()).
+		/// </summary>
+		/// <param name="reactionIndex">Index of mass action reaction.</param>
+		/// <param name="factor">Index of factor, between 0 and NumFactors()-1.</param>
+		/// <returns>Slot of molecular number.</returns>
+		inline size_t GetFactorSlot(size_t reactionIndex, size_t factor) const noexcept
+		{
+			return factorSlots_[factorsBegin_[reactionIndex] + factor];
+		}
+		/// <summary>
+		/// Returns the offset subtracted from the molecular number of a factor of the propensity of a mass action reaction (see NumFactors()).
+		/// </summary>
+		/// <param name="reactionIndex">Index of mass action reaction.</param>
+		/// <param name="factor">Index of factor, between 0 and NumFactors()-1.</param>
+		/// <returns>Offset of factor.</returns>
+		inline size_t GetFactorOffset(size_t reactionIndex, size_t factor) const noexcept
+		{
+			return factorOffsets_[factorsBegin_[reactionIndex] + factor];
+		}
+		/// <summary>
+		/// Computes the propensity of the reaction with the given index. Zero for time dependent reactions.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactionIndex">Index of reaction.</param>
+		/// <returns>Propensity of reaction.</returns>
+		inline double ComputeRate(ISimInfo& simInfo, size_t reactionIndex) const
+		{
+			if (!massAction_[reactionIndex])
+				return timeDependent_[reactionIndex] ? 0.0 : (*reactions_)[reactionIndex]->ComputeRate(simInfo);
+			return computeMassActionRate(simInfo.GetMolecularNumbers(), reactionIndex);
+		}
+		/// <summary>
+		/// Computes the propensities of all reactions. Zero for time dependent reactions.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="propensities">Array receiving the propensities, of the size of the number of reactions.</param>
+		void ComputeRates(ISimInfo& simInfo, double* propensities) const;
+		/// <summary>
+		/// Returns the name of the instruction set used by ComputeRates(), i.e. "AVX-512", "AVX2" or "scalar".
+		/// </summary>
+		/// <returns>Name of instruction set.</returns>
+		const char* GetInstructionSet() const noexcept;
+		/// <summary>
+		/// Computes the propensities of a table of mass action reactions with every instruction set supported by the CPU, and compares them bit-for-bit to PropensityReaction::ComputeRate()
+		/// (see CompiledModel::TestMassActionKernel()). Throws an exception describing the first difference.
+		/// </summary>
+		/// <returns>Names of the tested instruction sets.</returns>
+		static std::vector<std::string> SelfTest();
+	private:
+		enum class InstructionSet
+		{
+			Scalar,
+			AVX2,
+			AVX512
+		};
+
+		inline double computeMassActionRate(const size_t* numbers, size_t reactionIndex) const noexcept
+		{
+			double rate = rateConstants_[reactionIndex];
+			const size_t end = factorsBegin_[reactionIndex + 1];
+			for (size_t f = factorsBegin_[reactionIndex]; f < end; f++)
+			{
+				const size_t num = numbers[factorSlots_[f]];
+				const size_t offset = factorOffsets_[f];
+				rate *= num > offset ? static_cast<double>(num - offset) : 0.0;
+			}
+			return rate;
+		}
+		void computeMassActionRatesScalar(const size_t* numbers, double* propensities, size_t begin) const noexcept;
+		size_t computeMassActionRatesAVX2(const size_t* numbers, double* propensities) const noexcept;
+		size_t computeMassActionRatesAVX512(const size_t* numbers, double* propensities) const noexcept;
+
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		InstructionSet instructionSet_;
+		// Reaction-wise table, with the factors of reaction j stored in [factorsBegin_[j], factorsBegin_[j+1]).
+		std::vector<char> massAction_;
+		std::vector<double> rateConstants_;
+		std::vector<size_t> factorsBegin_;
+		std::vector<size_t> factorSlots_;
+		std::vector<size_t> factorOffsets_;
+		// Indices of all reactions which are neither mass action nor time dependent reactions.
+		std::vector<size_t> customReactions_;
+		std::vector<char> timeDependent_;
+		std::vector<size_t> timeDependentReactions_;
+		// Factor-wise table for vectorization, with factor k of reaction j stored at k*NumReactions+j. Only the first numFactors_[j] factors of reaction j are valid.
+		size_t maxFactors_;
+		std::vector<std::uint64_t> numFactors_;
+		std::vector<std::uint64_t> vectorSlots_;
+		std::vector<std::uint64_t> vectorOffsets_;
+	};
+}
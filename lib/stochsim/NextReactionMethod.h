@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <math.h>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "IndexedPriorityQueue.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Next reaction method, as outlined in
+	/// Gibson, Michael A., and Jehoshua Bruck. "Efficient exact stochastic simulation of chemical systems with many species and many channels." The journal of physical chemistry A 104.9 (2000): 1876-1889.
+	/// Every reaction keeps its own putative (absolute) firing time in an indexed priority queue. After a reaction fired, only the propensities of the reactions depending on it are recomputed, and their
+	/// firing times are rescaled instead of redrawn. Each step thus costs O(log M) instead of O(M), with M the number of reactions.
+	/// </summary>
+	class NextReactionMethod : public ISimulationAlgorithm
+	{
+	public:
+		NextReactionMethod() : reactions_(nullptr), kernel_(nullptr), dependencyGraph_(nullptr)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			dependencyGraph_ = &dependencyGraph;
+			double time = simInfo.GetSimTime();
+			propensities_.resize(reactions.size());
+			kernel.ComputeRates(simInfo, propensities_.data());
+			std::vector<double> fireTimes(reactions.size());
+			for (size_t i = 0; i < reactions.size(); i++)
+			{
+				fireTimes[i] = drawFireTime(simInfo, time, propensities_[i]);
+			}
+			queue_.Reset(std::move(fireTimes));
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			return queue_.Empty() ? stochsim::inf : queue_.TopKey();
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			size_t reactionIndex = queue_.Top();
+			(*reactions_)[reactionIndex]->Fire(simInfo);
+			update(simInfo, dependencyGraph_->GetPropensityDependents(reactionIndex), reactionIndex);
+			return reactionIndex;
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			// do nothing. Propensity reactions are memoryless.
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			update(simInfo, dependencyGraph_->GetEventDependents(eventIndex), reactions_->size());
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			update(simInfo, dependencyGraph_->GetPropensityDependents(reactionIndex), reactions_->size());
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			checkpoint.WriteArray(propensities_.data(), propensities_.size());
+			queue_.Save(checkpoint);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			checkpoint.ReadArray(propensities_.data(), propensities_.size());
+			queue_.Load(checkpoint);
+			if (queue_.Size() != reactions_->size())
+				throw std::exception("Checkpoint was saved for a different number of propensity reactions.");
+		}
+	private:
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		const DependencyGraph* dependencyGraph_;
+		std::vector<double> propensities_;
+		IndexedPriorityQueue queue_;
+
+		/// <summary>
+		/// Draws an exponentially distributed absolute firing time for a reaction with the given propensity.
+		/// </summary>
+		inline static double drawFireTime(ISimInfo& simInfo, double time, double propensity)
+		{
+			if (propensity > 0)
+				return time + simInfo.RandExponential() / propensity;
+			else
+				return stochsim::inf;
+		}
+		/// <summary>
+		/// Recomputes the propensities of the given reactions and updates their firing times. The firing time of the reaction which just fired is redrawn, while the firing times of all other
+		/// reactions are rescaled according to the change of their propensity.
+		/// </summary>
+		void update(ISimInfo& simInfo, const std::vector<size_t>& dependents, size_t firedReaction)
+		{
+			double time = simInfo.GetSimTime();
+			for (auto reactionIndex : dependents)
+			{
+				double oldPropensity = propensities_[reactionIndex];
+				double newPropensity = kernel_->ComputeRate(simInfo, reactionIndex);
+				propensities_[reactionIndex] = newPropensity;
+				double fireTime;
+				if (reactionIndex == firedReaction || oldPropensity <= 0)
+					fireTime = drawFireTime(simInfo, time, newPropensity);
+				else if (newPropensity == oldPropensity)
+					continue;
+				else if (newPropensity <= 0)
+					fireTime = stochsim::inf;
+				else
+					fireTime = time + oldPropensity / newPropensity * (queue_.GetKey(reactionIndex) - time);
+				queue_.Update(reactionIndex, fireTime);
+			}
+		}
+	};
+}
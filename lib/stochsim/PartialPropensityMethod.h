@@ -0,0 +1,385 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "DependencyGraph.h"
+#include "MassActionKernel.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Ramaswamy, González-Segredo and Sbalzarini's partial-propensity direct method, as outlined in
+	/// Ramaswamy, Rajesh, Nélido González-Segredo, and Ivo F. Sbalzarini. "A new class of highly efficient exact stochastic simulation algorithms for chemical reaction networks." The Journal of chemical physics 130.24 (2009): 244104.
+	/// The propensity of every mass action reaction with at most two factors (e.g. A -> B, A + B -> C or 2 A -> B) is factorized into the molecular number of its first reactant species i and a partial
+	/// propensity pi, which only depends on the molecular number of the second reactant species (if any). The partial propensities are grouped by i, such that the aggregated propensity of group i is
+	/// n_i * Sigma_i, with Sigma_i the sum of its partial propensities.
+	/// The reaction firing next is selected by a linear search over the groups, followed by a linear search within the group. When the molecular number of a species changes, only the partial propensities
+	/// depending on it and the aggregated propensity of its group have to be updated. The costs per step thus scale with the number of species instead of the number of reactions, which pays off for networks
+	/// dominated by bimolecular reactions whose number grows quadratically with the number of species.
+	/// All other propensity reactions (custom rate equations, higher order reactions and reactions without reactants) form one additional group, whose propensities are updated according to the dependency graph.
+	/// </summary>
+	class PartialPropensityMethod : public ISimulationAlgorithm
+	{
+	public:
+		PartialPropensityMethod() : reactions_(nullptr), kernel_(nullptr), dependencyGraph_(nullptr), dirty_(nullptr), numSpecies_(0), a0_(0), stepsSinceSum_(0)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			dependencyGraph_ = &dependencyGraph;
+			dirty_ = nullptr;
+			factorize(reactions.size());
+
+			// Initialize partial propensities.
+			const size_t* numbers = simInfo.GetMolecularNumbers();
+			for (size_t species = 0; species < numSpecies_; species++)
+			{
+				numbers_[species] = numbers[slots_[species]];
+			}
+			std::vector<double> propensities(reactions.size());
+			kernel.ComputeRates(simInfo, propensities.data());
+			for (size_t entry = 0; entry < entryReactions_.size(); entry++)
+			{
+				if (entrySpecies_[entry] == custom)
+					partials_[entry] = propensities[entryReactions_[entry]] > 0 ? propensities[entryReactions_[entry]] : 0;
+				else
+					partials_[entry] = computePartial(entry);
+			}
+			sum();
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			// Update partial propensities of custom reactions which might have changed since the last call.
+			if (dirty_)
+			{
+				for (auto reactionIndex : *dirty_)
+				{
+					const size_t entry = customEntries_[reactionIndex];
+					if (entry != noEntry)
+					{
+						const double propensity = kernel_->ComputeRate(simInfo, reactionIndex);
+						setPartial(entry, propensity > 0 ? propensity : 0);
+					}
+				}
+				dirty_ = nullptr;
+			}
+			// Update the partial propensities depending on species whose molecular numbers changed.
+			const size_t* numbers = simInfo.GetMolecularNumbers();
+			for (size_t species = 0; species < numSpecies_; species++)
+			{
+				const size_t num = numbers[slots_[species]];
+				if (num == numbers_[species])
+					continue;
+				numbers_[species] = num;
+				for (size_t i = dependentsBegin_[species]; i < dependentsBegin_[species + 1]; i++)
+				{
+					setPartial(dependents_[i], computePartial(dependents_[i]));
+				}
+			}
+			// The sums of the partial propensities are updated incrementally and accumulate rounding errors. Re-sum from time to time.
+			if (++stepsSinceSum_ >= resumPeriod)
+				sum();
+
+			// Calculate time span to next propensity reaction event
+			a0_ = 0;
+			for (size_t group = 0; group < groupSums_.size(); group++)
+			{
+				a0_ += groupPropensity(group);
+			}
+			if (a0_ > 0)
+			{
+				return simInfo.GetSimTime() + simInfo.RandExponential() / a0_;
+			}
+			else
+			{
+				return stochsim::inf;
+			}
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			// Select the group. Due to rounding errors, the target might not be reached. Then, the last group, respectively the last reaction, with positive propensity fires.
+			double target = simInfo.Rand() * a0_;
+			size_t group = groupSums_.size();
+			for (size_t g = 0; g < groupSums_.size(); g++)
+			{
+				const double propensity = groupPropensity(g);
+				if (propensity <= 0)
+					continue;
+				group = g;
+				if (target < propensity)
+					break;
+				target -= propensity;
+			}
+			// Select the reaction within the group.
+			const double multiplier = groupMultiplier(group);
+			target = target / multiplier;
+			size_t entry = groupsBegin_[group + 1];
+			for (size_t e = groupsBegin_[group]; e < groupsBegin_[group + 1]; e++)
+			{
+				if (partials_[e] <= 0)
+					continue;
+				entry = e;
+				if (target < partials_[e])
+					break;
+				target -= partials_[e];
+			}
+			const size_t reactionIndex = entryReactions_[entry];
+			(*reactions_)[reactionIndex]->Fire(simInfo);
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+			return reactionIndex;
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			// do nothing. Propensity reactions are memoryless.
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetEventDependents(eventIndex);
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// The molecular numbers of the last step are saved, too, since the partial propensities of species which changed since then are only updated by the next step.
+			for (auto number : numbers_)
+			{
+				checkpoint.Write<std::uint64_t>(number);
+			}
+			checkpoint.WriteArray(partials_.data(), partials_.size());
+			checkpoint.WriteArray(groupSums_.data(), groupSums_.size());
+			for (auto positives : groupPositives_)
+			{
+				checkpoint.Write<std::uint64_t>(positives);
+			}
+			checkpoint.Write(a0_);
+			checkpoint.Write<std::uint64_t>(stepsSinceSum_);
+			saveReactions(checkpoint, dirty_);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			for (auto& number : numbers_)
+			{
+				number = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			}
+			checkpoint.ReadArray(partials_.data(), partials_.size());
+			checkpoint.ReadArray(groupSums_.data(), groupSums_.size());
+			for (auto& positives : groupPositives_)
+			{
+				positives = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			}
+			a0_ = checkpoint.Read<double>();
+			stepsSinceSum_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			restoreReactions(checkpoint, restoredDirty_, reactions_->size());
+			dirty_ = restoredDirty_.empty() ? nullptr : &restoredDirty_;
+		}
+	private:
+		/// <summary>
+		/// Number of steps after which the sums of the partial propensities are recomputed from scratch.
+		/// </summary>
+		static constexpr size_t resumPeriod = 1024;
+		/// <summary>
+		/// Species index of partial propensities which do not depend on any molecular number.
+		/// </summary>
+		static constexpr size_t constant = static_cast<size_t>(-1);
+		/// <summary>
+		/// Species index of propensities of custom reactions.
+		/// </summary>
+		static constexpr size_t custom = static_cast<size_t>(-2);
+		static constexpr size_t noEntry = static_cast<size_t>(-1);
+
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		const DependencyGraph* dependencyGraph_;
+		// Reactions whose propensities have to be recomputed before the next step. Only the custom reactions among them are recomputed.
+		const std::vector<size_t>* dirty_;
+		// Owns the dirty reactions restored from a checkpoint.
+		std::vector<size_t> restoredDirty_;
+
+		// Species, i.e. slots of molecular numbers which some partial propensity or group depends on, and their molecular numbers in the last step.
+		size_t numSpecies_;
+		std::vector<size_t> slots_;
+		std::vector<size_t> numbers_;
+		// Partial propensities, grouped by the species of the first factor. Group i < numSpecies_ is multiplied by the molecular number of species i, the last group contains all custom reactions and is multiplied by one.
+		std::vector<size_t> groupsBegin_;
+		std::vector<size_t> entryReactions_;
+		std::vector<size_t> entryGroups_;
+		// Species of the second factor, and its offset.
+		std::vector<size_t> entrySpecies_;
+		std::vector<size_t> entryOffsets_;
+		std::vector<double> entryRateConstants_;
+		std::vector<double> partials_;
+		// For every species, the partial propensities depending on it.
+		std::vector<size_t> dependentsBegin_;
+		std::vector<size_t> dependents_;
+		// For every reaction, its entry in the custom group, or noEntry.
+		std::vector<size_t> customEntries_;
+		// Sum and number of positive partial propensities of every group.
+		std::vector<double> groupSums_;
+		std::vector<size_t> groupPositives_;
+		double a0_;
+		size_t stepsSinceSum_;
+
+		/// <summary>
+		/// Sorts the reactions into groups of partial propensities.
+		/// </summary>
+		void factorize(size_t numReactions)
+		{
+			std::unordered_map<size_t, size_t> speciesOfSlot;
+			auto getSpecies = [&](size_t slot) -> size_t
+			{
+				auto search = speciesOfSlot.find(slot);
+				if (search != speciesOfSlot.end())
+					return search->second;
+				speciesOfSlot.emplace(slot, slots_.size());
+				slots_.push_back(slot);
+				return slots_.size() - 1;
+			};
+			slots_.clear();
+			// First species, second species and offset of the second factor of every reaction.
+			std::vector<size_t> firstSpecies(numReactions, custom);
+			std::vector<size_t> secondSpecies(numReactions, custom);
+			std::vector<size_t> secondOffsets(numReactions, 0);
+			for (size_t j = 0; j < numReactions; j++)
+			{
+				if (!kernel_->IsMassAction(j))
+					continue;
+				const size_t numFactors = kernel_->NumFactors(j);
+				if (numFactors == 0 || numFactors > 2)
+					continue;
+				firstSpecies[j] = getSpecies(kernel_->GetFactorSlot(j, 0));
+				secondSpecies[j] = constant;
+				if (numFactors == 2)
+				{
+					secondSpecies[j] = getSpecies(kernel_->GetFactorSlot(j, 1));
+					secondOffsets[j] = kernel_->GetFactorOffset(j, 1);
+				}
+			}
+			numSpecies_ = slots_.size();
+			numbers_.assign(numSpecies_, 0);
+
+			// Sort reactions into groups, keeping the order of definition within every group.
+			const size_t numGroups = numSpecies_ + 1;
+			groupsBegin_.assign(numGroups + 1, 0);
+			for (size_t j = 0; j < numReactions; j++)
+			{
+				const size_t group = firstSpecies[j] == custom ? numSpecies_ : firstSpecies[j];
+				groupsBegin_[group + 1]++;
+			}
+			for (size_t group = 0; group < numGroups; group++)
+			{
+				groupsBegin_[group + 1] += groupsBegin_[group];
+			}
+			std::vector<size_t> next(groupsBegin_.begin(), groupsBegin_.end() - 1);
+			entryReactions_.assign(numReactions, 0);
+			entryGroups_.assign(numReactions, 0);
+			entrySpecies_.assign(numReactions, custom);
+			entryOffsets_.assign(numReactions, 0);
+			entryRateConstants_.assign(numReactions, 0);
+			partials_.assign(numReactions, 0);
+			customEntries_.assign(numReactions, noEntry);
+			std::vector<size_t> numDependents(numSpecies_ + 1, 0);
+			for (size_t j = 0; j < numReactions; j++)
+			{
+				const size_t group = firstSpecies[j] == custom ? numSpecies_ : firstSpecies[j];
+				const size_t entry = next[group]++;
+				entryReactions_[entry] = j;
+				entryGroups_[entry] = group;
+				if (group == numSpecies_)
+				{
+					customEntries_[j] = entry;
+					continue;
+				}
+				entrySpecies_[entry] = secondSpecies[j];
+				entryOffsets_[entry] = secondOffsets[j];
+				entryRateConstants_[entry] = kernel_->GetRateConstant(j);
+				if (secondSpecies[j] != constant)
+					numDependents[secondSpecies[j] + 1]++;
+			}
+
+			// Dependencies of the partial propensities on the species.
+			for (size_t species = 0; species < numSpecies_; species++)
+			{
+				numDependents[species + 1] += numDependents[species];
+			}
+			dependentsBegin_ = numDependents;
+			dependents_.assign(dependentsBegin_[numSpecies_], 0);
+			std::vector<size_t> nextDependent(dependentsBegin_.begin(), dependentsBegin_.end() - 1);
+			for (size_t entry = 0; entry < numReactions; entry++)
+			{
+				const size_t species = entrySpecies_[entry];
+				if (species != constant && species != custom)
+					dependents_[nextDependent[species]++] = entry;
+			}
+			groupSums_.assign(numGroups, 0);
+			groupPositives_.assign(numGroups, 0);
+		}
+		/// <summary>
+		/// Computes the partial propensity of a factorized reaction from the current molecular numbers.
+		/// </summary>
+		inline double computePartial(size_t entry) const
+		{
+			const size_t species = entrySpecies_[entry];
+			if (species == constant)
+				return entryRateConstants_[entry];
+			const size_t num = numbers_[species];
+			const size_t offset = entryOffsets_[entry];
+			return entryRateConstants_[entry] * (num > offset ? static_cast<double>(num - offset) : 0.0);
+		}
+		/// <summary>
+		/// Sets a partial propensity, and updates the sum of its group.
+		/// </summary>
+		inline void setPartial(size_t entry, double partial)
+		{
+			const double oldPartial = partials_[entry];
+			if (partial == oldPartial)
+				return;
+			const size_t group = entryGroups_[entry];
+			groupSums_[group] += partial - oldPartial;
+			if (oldPartial > 0)
+				groupPositives_[group]--;
+			if (partial > 0)
+				groupPositives_[group]++;
+			partials_[entry] = partial;
+		}
+		inline double groupMultiplier(size_t group) const
+		{
+			return group < numSpecies_ ? static_cast<double>(numbers_[group]) : 1.0;
+		}
+		/// <summary>
+		/// Returns the aggregated propensity of a group. Groups without any positive partial propensity have exactly zero propensity, independent of rounding errors.
+		/// </summary>
+		inline double groupPropensity(size_t group) const
+		{
+			if (groupPositives_[group] == 0)
+				return 0;
+			const double propensity = groupMultiplier(group) * groupSums_[group];
+			return propensity > 0 ? propensity : 0;
+		}
+		/// <summary>
+		/// Recomputes the sums of the partial propensities from scratch.
+		/// </summary>
+		void sum()
+		{
+			for (size_t group = 0; group < groupSums_.size(); group++)
+			{
+				groupSums_[group] = 0;
+				groupPositives_[group] = 0;
+				for (size_t entry = groupsBegin_[group]; entry < groupsBegin_[group + 1]; entry++)
+				{
+					if (partials_[entry] > 0)
+					{
+						groupSums_[group] += partials_[entry];
+						groupPositives_[group]++;
+					}
+				}
+			}
+			stepsSinceSum_ = 0;
+		}
+	};
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Complete binary tree whose leaves are the propensities of the reactions 0...N-1, and whose inner nodes store the sum of their two children. The root thus stores the aggregated propensity.
+	/// Changing a single propensity, as well as finding the reaction corresponding to a given fraction of the aggregated propensity, runs in O(log N).
+	/// Since every inner node is recomputed from its children instead of being updated incrementally, no rounding errors accumulate over time.
+	/// </summary>
+	class PropensityTree
+	{
+	public:
+		PropensityTree() : numLeaves_(0), firstLeaf_(1), nodes_(2, 0)
+		{
+		}
+		/// <summary>
+		/// Re-initializes the tree with the given propensities. Runs in O(N).
+		/// </summary>
+		/// <param name="propensities">Propensities of the reactions.</param>
+		void Reset(const std::vector<double>& propensities)
+		{
+			numLeaves_ = propensities.size();
+			firstLeaf_ = 1;
+			while (firstLeaf_ < numLeaves_)
+				firstLeaf_ *= 2;
+			nodes_.assign(2 * firstLeaf_, 0);
+			for (size_t i = 0; i < numLeaves_; i++)
+			{
+				nodes_[firstLeaf_ + i] = propensities[i];
+			}
+			for (size_t node = firstLeaf_ - 1; node > 0; node--)
+			{
+				nodes_[node] = nodes_[2 * node] + nodes_[2 * node + 1];
+			}
+		}
+		/// <summary>
+		/// Returns the number of propensities stored in the tree.
+		/// </summary>
+		/// <returns>Number of propensities.</returns>
+		inline size_t Size() const noexcept
+		{
+			return numLeaves_;
+		}
+		/// <summary>
+		/// Returns the sum of all propensities. Runs in O(1).
+		/// </summary>
+		/// <returns>Aggregated propensity.</returns>
+		inline double Total() const noexcept
+		{
+			return nodes_[1];
+		}
+		/// <summary>
+		/// Returns the propensity of the given reaction.
+		/// </summary>
+		/// <param name="reactionIndex">Index of reaction, between 0 and Size()-1.</param>
+		/// <returns>Propensity of reaction.</returns>
+		inline double Get(size_t reactionIndex) const
+		{
+			return nodes_[firstLeaf_ + reactionIndex];
+		}
+		/// <summary>
+		/// Sets the propensity of the given reaction, and updates all sums depending on it. Runs in O(log N).
+		/// </summary>
+		/// <param name="reactionIndex">Index of reaction, between 0 and Size()-1.</param>
+		/// <param name="propensity">New propensity of reaction.</param>
+		void Update(size_t reactionIndex, double propensity)
+		{
+			size_t node = firstLeaf_ + reactionIndex;
+			nodes_[node] = propensity;
+			for (node /= 2; node > 0; node /= 2)
+			{
+				nodes_[node] = nodes_[2 * node] + nodes_[2 * node + 1];
+			}
+		}
+		/// <summary>
+		/// Returns the index of the reaction i for which a_0 + ... + a_(i-1) &lt;= target &lt; a_0 + ... + a_i, with a_j the propensity of reaction j. Reactions with zero propensity are never returned,
+		/// also not when rounding errors occur. Behavior undefined if Total() is not positive. Runs in O(log N).
+		/// </summary>
+		/// <param name="target">Value between zero and Total().</param>
+		/// <returns>Index of reaction.</returns>
+		size_t Find(double target) const
+		{
+			size_t node = 1;
+			while (node < firstLeaf_)
+			{
+				const double left = nodes_[2 * node];
+				const double right = nodes_[2 * node + 1];
+				if ((target < left || right <= 0) && left > 0)
+				{
+					node = 2 * node;
+				}
+				else
+				{
+					target -= left;
+					node = 2 * node + 1;
+				}
+			}
+			return node - firstLeaf_;
+		}
+		/// <summary>
+		/// Writes the propensities to a checkpoint.
+		/// </summary>
+		void Save(CheckpointWriter& checkpoint) const
+		{
+			checkpoint.Write<std::uint64_t>(numLeaves_);
+			checkpoint.WriteArray(nodes_.data() + firstLeaf_, numLeaves_);
+		}
+		/// <summary>
+		/// Re-initializes the tree with the propensities written by Save(). Since the inner nodes only depend on the leaves, the restored tree is bit-identical to the saved one.
+		/// </summary>
+		void Load(CheckpointReader& checkpoint)
+		{
+			std::vector<double> propensities(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+			checkpoint.ReadArray(propensities.data(), propensities.size());
+			Reset(propensities);
+		}
+	private:
+		size_t numLeaves_;
+		/// <summary>
+		/// Index of the node corresponding to the first reaction. All leaves are stored consecutively starting from this index. The root is stored at index 1, and the children of node n at 2n and 2n+1.
+		/// </summary>
+		size_t firstLeaf_;
+		std::vector<double> nodes_;
+	};
+}
@@ -0,0 +1,249 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <cmath>
+#include "Checkpoint.h"
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+namespace stochsim
+{
+	/// <summary>
+	/// xoshiro256++ pseudo random number generator by Blackman and Vigna (see http://prng.di.unimi.it/). Much faster than the standard library engines, has a period of 2^256-1 and passes
+	/// all common statistical test suites.
+	/// To amortize the costs per draw, the generator runs several independent xoshiro256++ lanes side by side, and generates random words in blocks. The state of the lanes is stored lane-wise
+	/// (structure of arrays), such that the compiler can vectorize the generation of a block.
+	/// Besides uniformly distributed words, the generator provides uniformly distributed doubles, bounded integers (Lemire's nearly divisionless method) and exponentially distributed
+	/// doubles (Marsaglia and Tsang's ziggurat method).
+	/// Satisfies the requirements of a uniform random bit generator, and can thus be used with all standard library distributions.
+	/// </summary>
+	class RandomEngine
+	{
+	public:
+		typedef std::uint64_t result_type;
+
+		RandomEngine(std::uint64_t seed = 0) noexcept
+		{
+			Seed(seed);
+		}
+		/// <summary>
+		/// Re-seeds the generator. The state words of all lanes are generated from the seed by splitmix64, which guarantees that no lane is all zero and that similar seeds result in uncorrelated streams.
+		/// </summary>
+		/// <param name="seed">Seed.</param>
+		inline void Seed(std::uint64_t seed) noexcept
+		{
+			for (size_t lane = 0; lane < numLanes; lane++)
+			{
+				for (size_t word = 0; word < 4; word++)
+				{
+					seed += 0x9e3779b97f4a7c15ULL;
+					std::uint64_t z = seed;
+					z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+					z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+					state_[word][lane] = z ^ (z >> 31);
+				}
+			}
+			next_ = blockSize;
+		}
+		/// <summary>
+		/// Returns the next random 64 bit word.
+		/// </summary>
+		/// <returns>Random word.</returns>
+		inline result_type operator()() noexcept
+		{
+			if (next_ >= blockSize)
+				refill();
+			return block_[next_++];
+		}
+		/// <summary>
+		/// Returns a uniformly distributed random number in [0,1), using the upper 53 bits of the next random word.
+		/// </summary>
+		/// <returns>Random number in [0,1).</returns>
+		inline double Uniform() noexcept
+		{
+			return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0);
+		}
+		/// <summary>
+		/// Returns a uniformly distributed random integer in [0, range), using Lemire's nearly divisionless method ("Fast random integer generation in an interval", 2019).
+		/// Unbiased, and in nearly all cases requires a single multiplication and no division.
+		/// </summary>
+		/// <param name="range">Number of possible values. Must be larger than zero.</param>
+		/// <returns>Random integer in [0, range).</returns>
+		inline std::uint64_t Bounded(std::uint64_t range) noexcept
+		{
+			std::uint64_t low;
+			std::uint64_t high = multiply((*this)(), range, low);
+			if (low < range)
+			{
+				// Only the first low < 2^64 mod range values have to be rejected to get an unbiased result.
+				const std::uint64_t threshold = (0 - range) % range;
+				while (low < threshold)
+				{
+					high = multiply((*this)(), range, low);
+				}
+			}
+			return high;
+		}
+		/// <summary>
+		/// Returns an exponentially distributed random number with rate one, using Marsaglia and Tsang's ziggurat method ("The ziggurat method for generating random variables", 2000).
+		/// In about 99% of all cases, only requires one random word, one comparison and one multiplication, instead of a logarithm.
+		/// </summary>
+		/// <returns>Exponentially distributed random number.</returns>
+		inline double Exponential() noexcept
+		{
+			const Ziggurat& ziggurat = getZiggurat();
+			for (;;)
+			{
+				// Lower bits select the layer, upper 53 bits the position within the layer.
+				const std::uint64_t word = (*this)();
+				const size_t layer = static_cast<size_t>(word & (Ziggurat::numLayers - 1));
+				const std::uint64_t position = word >> 11;
+				const double x = position * ziggurat.width[layer];
+				if (position < ziggurat.threshold[layer])
+					return x;
+				if (layer == 0)
+				{
+					// Tail of the distribution. Since the exponential distribution is memoryless, the tail is a shifted exponential distribution.
+					return Ziggurat::tailStart - std::log(1.0 - Uniform());
+				}
+				if (ziggurat.density[layer] + Uniform() * (ziggurat.density[layer - 1] - ziggurat.density[layer]) < std::exp(-x))
+					return x;
+			}
+		}
+		/// <summary>
+		/// Writes the complete state of the generator, including the random words already generated for the current block, to a checkpoint.
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to write to.</param>
+		void Save(CheckpointWriter& checkpoint) const
+		{
+			checkpoint.WriteArray(&state_[0][0], 4 * numLanes);
+			checkpoint.WriteArray(block_, blockSize);
+			checkpoint.Write<std::uint64_t>(next_);
+		}
+		/// <summary>
+		/// Restores the state of the generator written by Save(), such that it continues with exactly the same random numbers.
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to read from.</param>
+		void Load(CheckpointReader& checkpoint)
+		{
+			checkpoint.ReadArray(&state_[0][0], 4 * numLanes);
+			checkpoint.ReadArray(block_, blockSize);
+			const std::uint64_t next = checkpoint.Read<std::uint64_t>();
+			if (next > blockSize)
+				throw std::exception("Checkpoint is truncated or corrupt.");
+			next_ = static_cast<size_t>(next);
+		}
+		static constexpr result_type min() noexcept
+		{
+			return std::numeric_limits<result_type>::min();
+		}
+		static constexpr result_type max() noexcept
+		{
+			return std::numeric_limits<result_type>::max();
+		}
+	private:
+		static constexpr size_t numLanes = 4;
+		static constexpr size_t blockSize = 16 * numLanes;
+
+		/// <summary>
+		/// Tables of the 256 layers of the ziggurat for the exponential distribution.
+		/// </summary>
+		struct Ziggurat
+		{
+			static constexpr size_t numLayers = 256;
+			// Start of the tail, i.e. right edge of the base layer.
+			static constexpr double tailStart = 7.697117470131487;
+			// Area of every layer.
+			static constexpr double layerArea = 3.949659822581572e-3;
+			// Positions (53 bit) below which a sample lies completely inside the layer and is accepted immediately.
+			std::uint64_t threshold[numLayers];
+			// Width of the layers divided by 2^53.
+			double width[numLayers];
+			// Exponential density at the right edge of the layers.
+			double density[numLayers];
+
+			Ziggurat() noexcept
+			{
+				const double scale = 9007199254740992.0; // 2^53
+				double edge = tailStart;
+				double previousEdge = edge;
+				const double q = layerArea / std::exp(-edge);
+				threshold[0] = static_cast<std::uint64_t>((edge / q) * scale);
+				threshold[1] = 0;
+				width[0] = q / scale;
+				width[numLayers - 1] = edge / scale;
+				density[0] = 1.0;
+				density[numLayers - 1] = std::exp(-edge);
+				for (size_t layer = numLayers - 2; layer >= 1; layer--)
+				{
+					edge = -std::log(layerArea / edge + std::exp(-edge));
+					threshold[layer + 1] = static_cast<std::uint64_t>((edge / previousEdge) * scale);
+					previousEdge = edge;
+					density[layer] = std::exp(-edge);
+					width[layer] = edge / scale;
+				}
+			}
+		};
+		static const Ziggurat& getZiggurat() noexcept
+		{
+			static const Ziggurat ziggurat;
+			return ziggurat;
+		}
+
+		/// <summary>
+		/// Generates the next block of random words. Every round advances all lanes by one step, and the loop over the lanes has no dependencies, such that it can be vectorized.
+		/// </summary>
+		void refill() noexcept
+		{
+			for (size_t round = 0; round < blockSize / numLanes; round++)
+			{
+				std::uint64_t* const output = block_ + round * numLanes;
+				for (size_t lane = 0; lane < numLanes; lane++)
+				{
+					output[lane] = rotl(state_[0][lane] + state_[3][lane], 23) + state_[0][lane];
+					const std::uint64_t t = state_[1][lane] << 17;
+					state_[2][lane] ^= state_[0][lane];
+					state_[3][lane] ^= state_[1][lane];
+					state_[1][lane] ^= state_[2][lane];
+					state_[0][lane] ^= state_[3][lane];
+					state_[2][lane] ^= t;
+					state_[3][lane] = rotl(state_[3][lane], 45);
+				}
+			}
+			next_ = 0;
+		}
+		static inline std::uint64_t rotl(const std::uint64_t x, int k) noexcept
+		{
+			return (x << k) | (x >> (64 - k));
+		}
+		/// <summary>
+		/// Returns the upper 64 bits of the 128 bit product of a and b, and stores the lower 64 bits in low.
+		/// </summary>
+		static inline std::uint64_t multiply(std::uint64_t a, std::uint64_t b, std::uint64_t& low) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+			low = static_cast<std::uint64_t>(product);
+			return static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			std::uint64_t high;
+			low = _umul128(a, b, &high);
+			return high;
+#else
+			const std::uint64_t aLow = a & 0xffffffffULL, aHigh = a >> 32;
+			const std::uint64_t bLow = b & 0xffffffffULL, bHigh = b >> 32;
+			const std::uint64_t lowLow = aLow * bLow;
+			const std::uint64_t highLow = aHigh * bLow;
+			const std::uint64_t lowHigh = aLow * bHigh;
+			const std::uint64_t cross = (lowLow >> 32) + (highLow & 0xffffffffULL) + lowHigh;
+			low = (cross << 32) | (lowLow & 0xffffffffULL);
+			return aHigh * bHigh + (highLow >> 32) + (cross >> 32);
+#endif
+		}
+
+		std::uint64_t state_[4][numLanes];
+		std::uint64_t block_[blockSize];
+		size_t next_;
+	};
+}
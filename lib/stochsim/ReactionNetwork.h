@@ -0,0 +1,264 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include "stochsim_common.h"
+#include "PropensityReaction.h"
+#include "Choice.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Flattened structure of the propensity reactions of a simulation, with all states referred to by their index. Used by algorithms which have to predict how the molecular numbers change over a time step,
+	/// instead of only firing one reaction after the other (e.g. tau-leaping). The structure is only known for PropensityReactions. All other reactions are marked as unknown.
+	/// </summary>
+	class ReactionNetwork
+	{
+	public:
+		/// <summary>
+		/// Structure of a single reaction.
+		/// </summary>
+		struct Reaction
+		{
+			Reaction() : known_(false), massAction_(false), exactChanges_(true), weighted_(false), rateConstant_(0), order_(0)
+			{
+			}
+			/// <summary>
+			/// False if the structure of the reaction is unknown. All other fields are then empty.
+			/// </summary>
+			bool known_;
+			/// <summary>
+			/// True if the propensity follows mass action kinetics, i.e. if it is completely determined by rateConstant_ and rateStates_.
+			/// </summary>
+			bool massAction_;
+			/// <summary>
+			/// False if changes_ only represents an upper bound of the changes, since some products are choices whose outcome is not known in advance.
+			/// </summary>
+			bool exactChanges_;
+			/// <summary>
+			/// True if the propensity depends on the properties of the molecules of a weighted state (see PropensityReaction::SetWeight()), or if firing the reaction transforms the molecules of such a state.
+			/// The propensities of such reactions might change even if no molecular number changes.
+			/// </summary>
+			bool weighted_;
+			double rateConstant_;
+			/// <summary>
+			/// Sum of the stochiometries of all states the propensity depends on. One for custom rate equations and reactions with weighted species.
+			/// </summary>
+			double order_;
+			/// <summary>
+			/// States which are consumed when the reaction fires, and their stochiometries.
+			/// </summary>
+			std::vector<std::pair<size_t, Stochiometry>> consumed_;
+			/// <summary>
+			/// States which must have at least the given molecular number such that the reaction can fire.
+			/// </summary>
+			std::vector<std::pair<size_t, Stochiometry>> required_;
+			/// <summary>
+			/// States the propensity depends on, and their stochiometries. For custom rate equations and reactions with weighted species, all stochiometries are one.
+			/// </summary>
+			std::vector<std::pair<size_t, Stochiometry>> rateStates_;
+			/// <summary>
+			/// Net change of the molecular numbers of the states when the reaction fires once. For choices, the products of both branches are added.
+			/// </summary>
+			std::vector<std::pair<size_t, double>> changes_;
+		};
+
+		/// <summary>
+		/// Determines the structure of the given reactions. Must be called after the reactions were initialized.
+		/// </summary>
+		/// <param name="reactions">Propensity reactions of the simulation.</param>
+		void Initialize(const std::vector<std::shared_ptr<IPropensityReaction>>& reactions)
+		{
+			states_.clear();
+			stateIndices_.clear();
+			reactions_.clear();
+			reactions_.resize(reactions.size());
+			std::vector<const IState*> weightedStates;
+			for (const auto& reaction : reactions)
+			{
+				if (auto propensityReaction = dynamic_cast<const PropensityReaction*>(reaction.get()))
+				{
+					for (const auto& state : propensityReaction->GetWeightedStates())
+					{
+						weightedStates.push_back(state.get());
+					}
+				}
+			}
+			for (size_t j = 0; j < reactions.size(); j++)
+			{
+				auto propensityReaction = dynamic_cast<const PropensityReaction*>(reactions[j].get());
+				Reaction& reaction = reactions_[j];
+				reaction.known_ = propensityReaction != nullptr;
+				if (!reaction.known_)
+					continue;
+				for (const auto& reactant : propensityReaction->GetReactants())
+				{
+					size_t stateIndex = getStateIndex(reactant.state_);
+					reaction.consumed_.emplace_back(stateIndex, reactant.stochiometry_);
+					reaction.required_.emplace_back(stateIndex, reactant.stochiometry_);
+					addChange(reaction.changes_, stateIndex, -static_cast<double>(reactant.stochiometry_));
+				}
+				reaction.weighted_ = propensityReaction->HasWeights();
+				for (const auto& transformee : propensityReaction->GetTransformees())
+				{
+					reaction.required_.emplace_back(getStateIndex(transformee.state_), transformee.stochiometry_);
+					if (std::find(weightedStates.begin(), weightedStates.end(), transformee.state_.get()) != weightedStates.end())
+						reaction.weighted_ = true;
+				}
+				for (const auto& product : propensityReaction->GetProducts())
+				{
+					addProduct(reaction, product.state_, product.stochiometry_, 0);
+				}
+				if (!propensityReaction->IsMassAction())
+				{
+					for (const auto& state : propensityReaction->GetRateDependencies())
+					{
+						reaction.rateStates_.emplace_back(getStateIndex(state), 1);
+					}
+					reaction.order_ = 1;
+				}
+				else
+				{
+					reaction.massAction_ = true;
+					reaction.rateConstant_ = propensityReaction->GetRateConstant();
+					for (const auto& reactant : propensityReaction->GetReactants())
+					{
+						reaction.rateStates_.emplace_back(getStateIndex(reactant.state_), reactant.stochiometry_);
+					}
+					for (const auto& modifier : propensityReaction->GetModifiers())
+					{
+						reaction.rateStates_.emplace_back(getStateIndex(modifier.state_), modifier.stochiometry_);
+					}
+					for (const auto& transformee : propensityReaction->GetTransformees())
+					{
+						reaction.rateStates_.emplace_back(getStateIndex(transformee.state_), transformee.stochiometry_);
+					}
+					for (const auto& rateState : reaction.rateStates_)
+					{
+						reaction.order_ += rateState.second;
+					}
+				}
+			}
+		}
+		/// <summary>
+		/// Returns the number of states involved in any reaction.
+		/// </summary>
+		/// <returns>Number of states.</returns>
+		inline size_t NumStates() const noexcept
+		{
+			return states_.size();
+		}
+		/// <summary>
+		/// Returns the state with the given index.
+		/// </summary>
+		/// <param name="stateIndex">Index of state, between 0 and NumStates()-1.</param>
+		/// <returns>State.</returns>
+		inline IState* GetState(size_t stateIndex) const
+		{
+			return states_[stateIndex];
+		}
+		/// <summary>
+		/// Returns the number of reactions.
+		/// </summary>
+		/// <returns>Number of reactions.</returns>
+		inline size_t NumReactions() const noexcept
+		{
+			return reactions_.size();
+		}
+		/// <summary>
+		/// Returns the structure of the reaction with the given index.
+		/// </summary>
+		/// <param name="reactionIndex">Index of reaction, between 0 and NumReactions()-1.</param>
+		/// <returns>Structure of reaction.</returns>
+		inline const Reaction& GetReaction(size_t reactionIndex) const
+		{
+			return reactions_[reactionIndex];
+		}
+		/// <summary>
+		/// Returns true if all states required by the reaction currently have enough molecules such that the reaction can fire.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactionIndex">Index of reaction.</param>
+		/// <returns>True if reaction can fire.</returns>
+		bool CanFire(ISimInfo& simInfo, size_t reactionIndex) const
+		{
+			for (const auto& required : reactions_[reactionIndex].required_)
+			{
+				if (states_[required.first]->Num(simInfo) < required.second)
+					return false;
+			}
+			return true;
+		}
+		/// <summary>
+		/// Computes the propensity of a mass action reaction for the given (possibly non-integer) molecular numbers of all states.
+		/// </summary>
+		/// <param name="reactionIndex">Index of mass action reaction.</param>
+		/// <param name="numbers">Molecular numbers of all states.</param>
+		/// <returns>Propensity of reaction.</returns>
+		double ComputeMassActionRate(size_t reactionIndex, const std::vector<double>& numbers) const
+		{
+			const Reaction& reaction = reactions_[reactionIndex];
+			double rate = reaction.rateConstant_;
+			for (const auto& rateState : reaction.rateStates_)
+			{
+				for (Stochiometry s = 0; s < rateState.second; s++)
+				{
+					double factor = numbers[rateState.first] - s;
+					if (factor <= 0)
+						return 0;
+					rate *= factor;
+				}
+			}
+			return rate;
+		}
+	private:
+		std::vector<IState*> states_;
+		std::unordered_map<const IState*, size_t> stateIndices_;
+		std::vector<Reaction> reactions_;
+
+		size_t getStateIndex(const std::shared_ptr<IState>& state)
+		{
+			auto search = stateIndices_.find(state.get());
+			if (search != stateIndices_.end())
+				return search->second;
+			stateIndices_[state.get()] = states_.size();
+			states_.push_back(state.get());
+			return states_.size() - 1;
+		}
+		static void addChange(std::vector<std::pair<size_t, double>>& changes, size_t stateIndex, double change)
+		{
+			for (auto& existing : changes)
+			{
+				if (existing.first == stateIndex)
+				{
+					existing.second += change;
+					return;
+				}
+			}
+			changes.emplace_back(stateIndex, change);
+		}
+		/// <summary>
+		/// Adds the product to the changes of a reaction. For choices, the products of both branches are added, which overestimates the change.
+		/// </summary>
+		void addProduct(Reaction& reaction, const std::shared_ptr<IState>& state, Stochiometry stochiometry, int depth)
+		{
+			if (auto choice = dynamic_cast<const Choice*>(state.get()))
+			{
+				reaction.exactChanges_ = false;
+				// Prevent infinite recursion for choices having themselves as products.
+				if (depth > 10)
+					return;
+				for (const auto& product : choice->GetProductsIfTrue())
+				{
+					addProduct(reaction, product.state_, stochiometry * product.stochiometry_, depth + 1);
+				}
+				for (const auto& product : choice->GetProductsIfFalse())
+				{
+					addProduct(reaction, product.state_, stochiometry * product.stochiometry_, depth + 1);
+				}
+				return;
+			}
+			addChange(reaction.changes_, getStateIndex(state), static_cast<double>(stochiometry));
+		}
+	};
+}
@@ -2,13 +2,14 @@
 #include <math.h>    
 #include <cassert>
 #include <sstream> 
-#define __STDC_WANT_LIB_EXT1__ 1
-#include <time.h>
 #include <locale>
 #include <codecvt>
 #include <iostream>
 #include <vector>
-#include <random>
+#include "CompiledModel.h"
+#include "SimulationInstance.h"
+#include "Ensemble.h"
+#include "StopCondition.h"
 #if defined(_WIN32)
 // Exclude rarely-used stuff from Windows headers
 #define WIN32_LEAN_AND_MEAN
@@ -18,279 +19,172 @@
 #endif
 namespace stochsim
 {
-	std::string CreatePathRecursively(std::string rawPath);
-
-	class LogManager
+	class Simulation::Impl
 	{
 	public:
-		LogManager() : logPeriod_(1.0), baseFolder_("simulations"), uniqueSubFolder_(true), saveFolder_("")
+		Impl() : logPeriod_(1.0), baseFolder_("simulations"), uniqueSubFolder_(true), algorithm_(Algorithm::DirectMethod), seed_(0), hasSeed_(false), vectorized_(true), checkpointFile_(""), checkpointPeriod_(0), stopTime_(stochsim::inf)
 		{
 		}
-		void SetUniqueSubfolder(bool uniqueSubFolder)
+		~Impl() {}
+		std::shared_ptr<const CompiledModel> Compile() const
 		{
-			uniqueSubFolder_ = uniqueSubFolder;
+			return std::make_shared<const CompiledModel>(states_, propensityReactions_, eventReactions_, stopConditions_, vectorized_);
 		}
-		bool IsUniqueSubfolder() const
+		void Run(double runtime)
 		{
-			return uniqueSubFolder_;
+			Finish();
+			std::unique_ptr<SimulationInstance> instance = createInstance();
+			instance->Run(runtime);
+			seed_ = instance->GetSeed();
+			stopReason_ = instance->GetStopReason();
+			stopTime_ = instance->GetStopTime();
 		}
-		double GetLogPeriod() const
+		void RunUntil(double time)
 		{
-			return logPeriod_;
+			if (!instance_)
+				instance_ = createInstance();
+			instance_->RunUntil(time);
 		}
-		std::string GetBaseFolder() const 
+		void Continue(double duration)
 		{
-			return baseFolder_;
+			if (!instance_)
+				instance_ = createInstance();
+			instance_->Continue(duration);
 		}
-
-		std::string GetSaveFolder() const
+		size_t Step(size_t numSteps)
 		{
-			return saveFolder_;
+			if (!instance_)
+				instance_ = createInstance();
+			return instance_->Step(numSteps);
 		}
-
-		void AddTask(std::shared_ptr<ILogger> task)
+		void Finish()
 		{
-			tasks_.push_back(std::move(task));
+			if (!instance_)
+				return;
+			instance_->Finish();
+			seed_ = instance_->GetSeed();
+			stopReason_ = instance_->GetStopReason();
+			stopTime_ = instance_->GetStopTime();
+			instance_.reset();
 		}
-		void Initialize(ISimInfo& simInfo)
+		bool IsRunning() const
 		{
-			// Test if any logger is writing anything to the disk, i.e. if we have to create a results folder at all...
-			bool shouldCreate = false;
-			for (auto& task : tasks_)
-			{
-				if (task->WritesToDisk())
-				{
-					shouldCreate = true;
-					break;
-				}
-			}
-			if (shouldCreate)
-			{
-				time_t t = std::time(0);
-				struct tm now;
-				localtime_s(&now, &t);
-				std::stringstream buffer;
-				buffer << baseFolder_;
-				if (uniqueSubFolder_)
-				{
-					buffer << "/"
-						<< (now.tm_year + 1900) << '-'
-						<< (now.tm_mon + 1) << '-'
-						<< now.tm_mday << '_'
-						<< now.tm_hour << '-'
-						<< now.tm_min << '-'
-						<< now.tm_sec << '/';
-				}
-				saveFolder_ = buffer.str();
-				saveFolder_ = CreatePathRecursively(saveFolder_);
-			}
-			else
-				saveFolder_ = "";
-
-			for (auto& task : tasks_)
-			{
-				task->Initialize(simInfo);
-			}
-			auto time = simInfo.GetSimTime();
-			WriteLog(simInfo, time);
-			lastLogTime_ = time;
+			return instance_ && instance_->IsRunning();
 		}
-		void Uninitialize(ISimInfo& simInfo)
+		double GetSimTime() const
 		{
-			auto time = simInfo.GetSimTime();
-			NotifyBeforeChange(simInfo);
-			WriteLog(simInfo, time);
-			lastLogTime_ = time;
-			for (auto& task : tasks_)
-			{
-				task->Uninitialize(simInfo);
-			}
+			return instance_ ? instance_->GetSimTime() : 0;
+		}
+		size_t Num(const IState& state)
+		{
+			if (!IsRunning())
+				throw std::exception("Simulation is not running.");
+			return instance_->Num(state);
+		}
+		void SaveCheckpoint(const std::string& fileName)
+		{
+			if (!IsRunning())
+				throw std::exception("Simulation is not running.");
+			instance_->SaveCheckpoint(fileName);
+		}
+		void LoadCheckpoint(const std::string& fileName)
+		{
+			Finish();
+			instance_ = createInstance();
+			instance_->LoadCheckpoint(fileName);
+		}
+		std::vector<char> CreateCheckpoint()
+		{
+			if (!IsRunning())
+				throw std::exception("Simulation is not running.");
+			return instance_->CreateCheckpoint();
 		}
-		void NotifyBeforeChange(ISimInfo& simInfo)
+		std::unique_ptr<Ensemble> Fork(size_t numReplicates, double maxTime)
 		{
-			auto time = simInfo.GetSimTime();
-			while (lastLogTime_ + logPeriod_ < time)
+			if (!IsRunning())
+				throw std::exception("Simulation is not running.");
+			const std::vector<char> checkpoint = instance_->CreateCheckpoint();
+			const double logPeriod = instance_->GetLogPeriod();
+			const Algorithm algorithm = instance_->GetAlgorithm();
+			auto ensemble = std::make_unique<Ensemble>(instance_->GetModel(), [logPeriod, algorithm](SimulationInstance& instance, size_t)
 			{
-				lastLogTime_ += logPeriod_;
-				WriteLog(simInfo, lastLogTime_);
-			}
+				instance.SetLogPeriod(logPeriod);
+				instance.SetAlgorithm(algorithm);
+			});
+			ensemble->SetSeed(instance_->GetSeed());
+			ensemble->Fork(checkpoint, numReplicates, maxTime);
+			return ensemble;
+		}
+
+		void AddLogger(std::shared_ptr<ILogger> logger)
+		{
+			loggers_.push_back(std::move(logger));
 		}
 		void SetLogPeriod(double logPeriod)
 		{
 			assert(logPeriod > 0);
 			logPeriod_ = logPeriod;
 		}
+		double GetLogPeriod() const
+		{
+			return logPeriod_;
+		}
 		void SetBaseFolder(std::string baseFolder)
 		{
 			baseFolder_ = std::move(baseFolder);
 		}
-	private:
-		inline void WriteLog(ISimInfo& simInfo, double time)
+		std::string GetBaseFolder() const
 		{
-			for (auto& task : tasks_)
-			{
-				task->WriteLog(simInfo, time);
-			}
+			return baseFolder_;
 		}
-		std::vector<std::shared_ptr<ILogger>> tasks_;
-		double lastLogTime_;
-		double logPeriod_;
-		std::string baseFolder_;
-		bool uniqueSubFolder_;
-		std::string saveFolder_;
-	};
-	
-	class Simulation::Impl : public ISimInfo
-	{
-	public:
-		Impl() : randomEngine_(std::random_device{}()), time_(0), runtime_(0)
+		void SetUniqueSubfolder(bool uniqueSubFolder)
 		{
+			uniqueSubFolder_ = uniqueSubFolder;
 		}
-		~Impl() {}
-		void Run(double runtime)
+		bool IsUniqueSubfolder() const
 		{
-			/**
-			** Run a modified version of Gillespies algorithm. The base algorithm is implemented as outlined in
-			** Gillespie, Daniel T. "Exact stochastic simulation of coupled chemical reactions." The journal of physical chemistry 81.25 (1977): 2340-2361.
-			** What we added is the support of fixed time delays and other events happening at given times instead with continuous propensities.
-			**/
-			runtime_ = runtime;
-			time_ = 0;
-
-			// Initialize
-			for (auto& state : states_)
-			{
-				state->Initialize(*this);
-			}
-			for (auto& reaction : propensityReactions_)
-			{
-				reaction->Initialize(*this);
-			}
-			for (auto& reaction : eventReactions_)
-			{
-				reaction->Initialize(*this);
-			}
-			logger_.Initialize(*this);
-
-			// propensities of reactions
-			std::vector<double> ai(propensityReactions_.size());
-
-			// iterate
-			while (time_ <= runtime)
-			{
-				// Calculate aggregated reaction probability
-				double a0 = 0;
-				for (size_t i = 0; i < propensityReactions_.size(); i++)
-				{
-					ai[i] = propensityReactions_[i]->ComputeRate(*this);
-					a0 += ai[i];
-				}
-
-				// Calculate time span to next propensity reaction event
-				double tau;
-				if (a0 > 0)
-				{
-					double r1 = randomUniform_(randomEngine_);
-					tau = 1 / a0 * log(1.0 / r1);
-				}
-				else
-				{
-					tau = stochsim::inf;
-				}
-
-				// Calculate time to next event reaction
-				size_t nextEventIndex = 0;
-				double nextEventT = stochsim::inf;
-				for (size_t i = 0; i < eventReactions_.size(); i++)
-				{
-					double temp = eventReactions_[i]->NextReactionTime(*this);
-					if (temp < nextEventT)
-					{
-						nextEventT = temp;
-						nextEventIndex = i;
-					}
-				}
-
-				// Fire either next event or next propensity reaction, whichever is earlier
-				if (nextEventT > time_ + tau)
-				{
-					// Fire a propensity reaction
-					time_ += tau;
-					if (time_ > runtime)
-					{
-						time_ = runtime;
-						break;
-					}
-
-					// notify logger about the time of the next reaction event
-					logger_.NotifyBeforeChange(*this);
-
-					// decide on identity of next reaction event and fire this event
-					double r2 = randomUniform_(randomEngine_);
-					double afraction = r2 * a0;
-					double asum = 0;
-					for (size_t i = 0; i < propensityReactions_.size(); i++)
-					{
-						asum += ai[i];
-						if (asum >= afraction)
-						{
-							propensityReactions_[i]->Fire(*this);
-							break;
-						}
-					}
-				}
-				else
-				{
-					time_ = nextEventT;
-					if (time_ > runtime)
-					{
-						time_ = runtime;
-						break;
-					}
-					// notify logger about the time of the next reaction event
-					logger_.NotifyBeforeChange(*this);
-					eventReactions_[nextEventIndex]->Fire(*this);
-				}
-			}
-
-			// Uninitialize
-			logger_.Uninitialize(*this);
-			for (auto& state : states_)
-			{
-				state->Uninitialize(*this);
-			}
+			return uniqueSubFolder_;
 		}
-		
-		virtual double GetSimTime() const override
+		void SetAlgorithm(Algorithm algorithm)
 		{
-			return time_;
+			algorithm_ = algorithm;
 		}
-		virtual double GetLogPeriod() const override
+		Algorithm GetAlgorithm() const
 		{
-			return logger_.GetLogPeriod();
+			return algorithm_;
 		}
-		virtual std::string GetSaveFolder() const override
+		void SetSeed(unsigned long long seed)
 		{
-			return logger_.GetSaveFolder();
+			seed_ = seed;
+			hasSeed_ = true;
 		}
-		virtual double GetRunTime() const override
+		unsigned long long GetSeed() const
 		{
-			return runtime_;
+			return seed_;
 		}
-		virtual size_t Rand(size_t lower, size_t upper) override
+		void SetVectorized(bool vectorized)
 		{
-			std::uniform_int_distribution<size_t> randomIndex(lower, upper);
-			return randomIndex(randomEngine_);
+			vectorized_ = vectorized;
 		}
-
-		virtual double Rand() override
+		bool IsVectorized() const
 		{
-			return randomUniform_(randomEngine_);
+			return vectorized_;
 		}
-
-		LogManager& GetLogger()
+		void SetCheckpointFile(std::string checkpointFile)
+		{
+			checkpointFile_ = std::move(checkpointFile);
+		}
+		std::string GetCheckpointFile() const
 		{
-			return logger_;
+			return checkpointFile_;
+		}
+		void SetCheckpointPeriod(double checkpointPeriod)
+		{
+			checkpointPeriod_ = checkpointPeriod;
+		}
+		double GetCheckpointPeriod() const
+		{
+			return checkpointPeriod_;
 		}
 
 		void AddReaction(std::shared_ptr<IPropensityReaction> reaction)
@@ -324,6 +218,23 @@ namespace stochsim
 			states_.push_back(std::move(state));
 		}
 
+		void AddStopCondition(std::shared_ptr<StopCondition> stopCondition)
+		{
+			stopConditions_.push_back(std::move(stopCondition));
+		}
+		const Collection<std::shared_ptr<StopCondition>> GetStopConditions() const
+		{
+			return Collection<std::shared_ptr<StopCondition>>(stopConditions_.begin(), stopConditions_.end());
+		}
+		std::string GetStopReason() const
+		{
+			return instance_ ? instance_->GetStopReason() : stopReason_;
+		}
+		double GetStopTime() const
+		{
+			return instance_ ? instance_->GetStopTime() : stopTime_;
+		}
+
 		const std::shared_ptr<IState> GetState(const std::string & name) const
 		{
 			for (const std::shared_ptr<IState>& state : states_)
@@ -333,7 +244,7 @@ namespace stochsim
 			}
 			return nullptr;
 		}
-		const Collection<std::shared_ptr<IState>>  GetStates() const override
+		const Collection<std::shared_ptr<IState>>  GetStates() const
 		{
 			return Collection<std::shared_ptr<IState>>(states_.begin(), states_.end());
 		}
@@ -365,15 +276,45 @@ namespace stochsim
 		}
 
 	private:
+		/// <summary>
+		/// Compiles the model and creates an instance with the current settings and loggers.
+		/// </summary>
+		std::unique_ptr<SimulationInstance> createInstance() const
+		{
+			auto instance = std::make_unique<SimulationInstance>(Compile());
+			instance->SetLogPeriod(logPeriod_);
+			instance->SetBaseFolder(baseFolder_);
+			instance->SetUniqueSubfolder(uniqueSubFolder_);
+			instance->SetAlgorithm(algorithm_);
+			if (hasSeed_)
+				instance->SetSeed(seed_);
+			instance->SetCheckpointFile(checkpointFile_);
+			instance->SetCheckpointPeriod(checkpointPeriod_);
+			for (auto& logger : loggers_)
+			{
+				instance->AddLogger(logger);
+			}
+			return instance;
+		}
 		std::vector<std::shared_ptr<IPropensityReaction>> propensityReactions_;
 		std::vector<std::shared_ptr<IEventReaction>> eventReactions_;
 		std::vector<std::shared_ptr<IState>> states_;
-		double time_;
-		double runtime_;
-		LogManager logger_;
-		std::default_random_engine randomEngine_;
-		// function to generate uniformly distributed random numbers in [0,1)
-		std::uniform_real<double> randomUniform_;
+		std::vector<std::shared_ptr<StopCondition>> stopConditions_;
+		std::vector<std::shared_ptr<ILogger>> loggers_;
+		double logPeriod_;
+		std::string baseFolder_;
+		bool uniqueSubFolder_;
+		Algorithm algorithm_;
+		unsigned long long seed_;
+		bool hasSeed_;
+		bool vectorized_;
+		std::string checkpointFile_;
+		double checkpointPeriod_;
+		// Stop condition which ended the last run early, if any.
+		std::string stopReason_;
+		double stopTime_;
+		// Instance advanced by RunUntil(), Continue() and Step(), until it is finished.
+		std::unique_ptr<SimulationInstance> instance_;
 	};
 
 	Simulation::Simulation() : impl_(new Simulation::Impl())
@@ -399,6 +340,23 @@ namespace stochsim
 		impl_->AddState(std::move(state));
 	}
 
+	void Simulation::AddStopCondition(std::shared_ptr<StopCondition> stopCondition)
+	{
+		impl_->AddStopCondition(std::move(stopCondition));
+	}
+	const Collection<std::shared_ptr<StopCondition>> Simulation::GetStopConditions() const
+	{
+		return impl_->GetStopConditions();
+	}
+	std::string Simulation::GetStopReason() const
+	{
+		return impl_->GetStopReason();
+	}
+	double Simulation::GetStopTime() const
+	{
+		return impl_->GetStopTime();
+	}
+
 	const std::shared_ptr<IState> Simulation::GetState(const std::string & name) const
 	{
 		return impl_->GetState(name);
@@ -431,34 +389,122 @@ namespace stochsim
 	{
 		impl_->Run(maxTime);
 	}
+	void Simulation::RunUntil(double time)
+	{
+		impl_->RunUntil(time);
+	}
+	void Simulation::Continue(double duration)
+	{
+		impl_->Continue(duration);
+	}
+	size_t Simulation::Step(size_t numSteps)
+	{
+		return impl_->Step(numSteps);
+	}
+	void Simulation::Finish()
+	{
+		impl_->Finish();
+	}
+	bool Simulation::IsRunning() const
+	{
+		return impl_->IsRunning();
+	}
+	double Simulation::GetSimTime() const
+	{
+		return impl_->GetSimTime();
+	}
+	size_t Simulation::Num(const IState& state)
+	{
+		return impl_->Num(state);
+	}
+	void Simulation::SaveCheckpoint(const std::string& fileName)
+	{
+		impl_->SaveCheckpoint(fileName);
+	}
+	void Simulation::LoadCheckpoint(const std::string& fileName)
+	{
+		impl_->LoadCheckpoint(fileName);
+	}
+	std::vector<char> Simulation::CreateCheckpoint()
+	{
+		return impl_->CreateCheckpoint();
+	}
+	std::unique_ptr<Ensemble> Simulation::Fork(size_t numReplicates, double maxTime)
+	{
+		return impl_->Fork(numReplicates, maxTime);
+	}
+	std::shared_ptr<const CompiledModel> Simulation::Compile() const
+	{
+		return impl_->Compile();
+	}
 
 	void Simulation::AddLogger(std::shared_ptr<ILogger> logger)
 	{
-		impl_->GetLogger().AddTask(logger);
+		impl_->AddLogger(std::move(logger));
 	}
 	void Simulation::SetLogPeriod(double logPeriod)
 	{
-		impl_->GetLogger().SetLogPeriod(logPeriod);
+		impl_->SetLogPeriod(logPeriod);
 	}
 	double Simulation::GetLogPeriod() const
 	{
-		return impl_->GetLogger().GetLogPeriod();
+		return impl_->GetLogPeriod();
 	}
 	void Simulation::SetBaseFolder(std::string baseFolder)
 	{
-		impl_->GetLogger().SetBaseFolder(baseFolder);
+		impl_->SetBaseFolder(std::move(baseFolder));
 	}
 	std::string Simulation::GetBaseFolder() const
 	{
-		return impl_->GetLogger().GetBaseFolder();
+		return impl_->GetBaseFolder();
 	}
 	void Simulation::SetUniqueSubfolder(bool uniqueSubFolder)
 	{
-		impl_->GetLogger().SetUniqueSubfolder(uniqueSubFolder);
+		impl_->SetUniqueSubfolder(uniqueSubFolder);
 	}
 	bool Simulation::IsUniqueSubfolder() const
 	{
-		return impl_->GetLogger().IsUniqueSubfolder();
+		return impl_->IsUniqueSubfolder();
+	}
+	void Simulation::SetAlgorithm(Algorithm algorithm)
+	{
+		impl_->SetAlgorithm(algorithm);
+	}
+	Simulation::Algorithm Simulation::GetAlgorithm() const
+	{
+		return impl_->GetAlgorithm();
+	}
+	void Simulation::SetSeed(unsigned long long seed)
+	{
+		impl_->SetSeed(seed);
+	}
+	unsigned long long Simulation::GetSeed() const
+	{
+		return impl_->GetSeed();
+	}
+	void Simulation::SetVectorized(bool vectorized)
+	{
+		impl_->SetVectorized(vectorized);
+	}
+	bool Simulation::IsVectorized() const
+	{
+		return impl_->IsVectorized();
+	}
+	void Simulation::SetCheckpointFile(std::string checkpointFile)
+	{
+		impl_->SetCheckpointFile(std::move(checkpointFile));
+	}
+	std::string Simulation::GetCheckpointFile() const
+	{
+		return impl_->GetCheckpointFile();
+	}
+	void Simulation::SetCheckpointPeriod(double checkpointPeriod)
+	{
+		impl_->SetCheckpointPeriod(checkpointPeriod);
+	}
+	double Simulation::GetCheckpointPeriod() const
+	{
+		return impl_->GetCheckpointPeriod();
 	}
 
 
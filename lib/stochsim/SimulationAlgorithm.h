@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "stochsim_common.h"
+#include "DependencyGraph.h"
+#include "MassActionKernel.h"
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Base class of all algorithms determining when and which propensity reaction fires next.
+	/// The simulation itself takes care of event reactions and logging, and asks the algorithm for the time of the next propensity reaction. If this time is earlier than the
+	/// time of the next event reaction, the simulation advances the simulation time and lets the algorithm fire the reaction. Otherwise, the simulation fires the event reaction
+	/// and notifies the algorithm about it.
+	/// </summary>
+	class ISimulationAlgorithm
+	{
+	public:
+		/// <summary>
+		/// Returned by FireNextReaction if more than one propensity reaction fired, e.g. during a leap.
+		/// </summary>
+		static constexpr size_t severalReactions = static_cast<size_t>(-1);
+
+		virtual ~ISimulationAlgorithm() {}
+		/// <summary>
+		/// Called by the simulation before the simulation starts, after all states and reactions were initialized.
+		/// The reaction collection, the dependency graph and the kernel stay valid until the simulation finished.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactions">Propensity reactions of the simulation.</param>
+		/// <param name="dependencyGraph">Dependency graph of the reactions of the simulation.</param>
+		/// <param name="kernel">Kernel computing the propensities of the reactions. Should be used instead of IPropensityReaction::ComputeRate().</param>
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) = 0;
+		/// <summary>
+		/// Returns the simulation time when the next propensity reaction fires, or stochsim::inf if, given the current state, no propensity reaction will fire anymore.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <returns>Simulation time of next propensity reaction.</returns>
+		virtual double NextReactionTime(ISimInfo& simInfo) = 0;
+		/// <summary>
+		/// Fires the next propensity reaction. Called by the simulation after the simulation time was advanced to the time returned by the last call to NextReactionTime.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <returns>Index of the propensity reaction which fired, severalReactions if more than one reaction fired, or the number of propensity reactions if no reaction fired.</returns>
+		virtual size_t FireNextReaction(ISimInfo& simInfo) = 0;
+		/// <summary>
+		/// Called by the simulation if the simulation time was advanced to a time earlier than the one returned by the last call to NextReactionTime, i.e. before an event reaction fires
+		/// or when the simulation ends. Since propensity reactions are memoryless, exact algorithms do nothing. Algorithms advancing the system by leaps have to fire all reactions happening until the current time.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <returns>True if any propensity reaction fired.</returns>
+		virtual bool Interrupt(ISimInfo& simInfo) = 0;
+		/// <summary>
+		/// Called by the simulation after an event reaction fired instead of the next propensity reaction.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="eventIndex">Index of the event reaction which fired.</param>
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) = 0;
+		/// <summary>
+		/// Called by the simulation after a time dependent propensity reaction fired instead of the next propensity reaction. Time dependent reactions (see MassActionKernel::IsTimeDependent()) are not simulated
+		/// by the algorithm, but by the simulation itself, and their propensities computed by the kernel are always zero.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactionIndex">Index of the time dependent propensity reaction which fired.</param>
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) = 0;
+		/// <summary>
+		/// Writes the state of the algorithm which cannot be recomputed from the state of the model, e.g. the putative firing times of the reactions or the step determined by the last call to NextReactionTime
+		/// if it was not yet fired, to a checkpoint. Together with the state of the random number generator, this allows a restored simulation to continue exactly as the simulation which saved the checkpoint.
+		/// Must not change the state of the algorithm. Algorithms without such state do not have to override this method.
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to write to.</param>
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const
+		{
+		}
+		/// <summary>
+		/// Restores the state written by SaveCheckpoint(). Called by the simulation after Initialize(), when the state of the model was already restored.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="checkpoint">Checkpoint to read from.</param>
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint)
+		{
+		}
+	protected:
+		/// <summary>
+		/// Writes a set of reactions, e.g. the reactions whose propensities have to be recomputed before the next step, to a checkpoint. No set (nullptr) is written as an empty set.
+		/// </summary>
+		static void saveReactions(CheckpointWriter& checkpoint, const std::vector<size_t>* reactions)
+		{
+			if (!reactions)
+			{
+				checkpoint.Write<std::uint64_t>(0);
+				return;
+			}
+			checkpoint.Write<std::uint64_t>(reactions->size());
+			for (auto reactionIndex : *reactions)
+			{
+				checkpoint.Write<std::uint64_t>(reactionIndex);
+			}
+		}
+		/// <summary>
+		/// Reads a set of reactions written by saveReactions(). Throws an exception if any reaction index is not smaller than the number of reactions.
+		/// </summary>
+		static void restoreReactions(CheckpointReader& checkpoint, std::vector<size_t>& reactions, size_t numReactions)
+		{
+			reactions.resize(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+			for (auto& reactionIndex : reactions)
+			{
+				reactionIndex = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+				if (reactionIndex >= numReactions)
+					throw std::exception("Checkpoint is truncated or corrupt.");
+			}
+		}
+	};
+}
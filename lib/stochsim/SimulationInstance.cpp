@@ -0,0 +1,845 @@
+#include "SimulationInstance.h"
+#include <random>
+#include <sstream>
+#include <future>
+#include <cstdint>
+#include "LogManager.h"
+#include "DependencyGraph.h"
+#include "MassActionKernel.h"
+#include "SimulationAlgorithm.h"
+#include "DirectMethod.h"
+#include "NextReactionMethod.h"
+#include "CompositionRejection.h"
+#include "TauLeaping.h"
+#include "HybridMethod.h"
+#include "SortingDirectMethod.h"
+#include "PartialPropensityMethod.h"
+#include "SlowScaleMethod.h"
+#include "EventScheduler.h"
+#include "TimeDependentScheduler.h"
+#include "RandomEngine.h"
+#include "Checkpoint.h"
+#include "StopCondition.h"
+#include "expression_common.h"
+namespace stochsim
+{
+	/// <summary>
+	/// While in scope, lets the default function rand() of all expressions evaluated on the current thread draw from the random number stream of the given simulation,
+	/// e.g. when custom reactions evaluate expressions they bound themselves.
+	/// </summary>
+	class RandomSourceGuard
+	{
+	public:
+		RandomSourceGuard(ISimInfo& simInfo) : previous_(expression::setRandomSource([&simInfo]() -> expression::number {return static_cast<expression::number>(simInfo.Rand()); }))
+		{
+		}
+		~RandomSourceGuard()
+		{
+			expression::setRandomSource(std::move(previous_));
+		}
+	private:
+		expression::RandomSource previous_;
+	};
+
+	/// <summary>
+	/// Identifies checkpoint files, and the version of their format.
+	/// </summary>
+	static constexpr char checkpointMagic[8] = { 'S', 'T', 'O', 'C', 'H', 'C', 'K', 'P' };
+	static constexpr std::uint32_t checkpointVersion = 3;
+
+	class SimulationInstance::Impl : public ISimInfo
+	{
+	public:
+		Impl(std::shared_ptr<const CompiledModel> model) : model_(std::move(model)), data_(model_->CreateInstanceData()), molecularNumbers_(model_->NumMolecularNumbers(), 0), time_(0), runtime_(0), algorithm_(Simulation::Algorithm::DirectMethod), seed_(0), hasSeed_(false), running_(false), pendingReactionT_(0), hasPendingReaction_(false), checkpointFile_(""), checkpointPeriod_(0), nextCheckpointT_(0), stopReason_(""), stopped_(false), stopTime_(stochsim::inf)
+		{
+		}
+		~Impl()
+		{
+			// Destructors must not throw. Loggers failing to write their last log are ignored.
+			try
+			{
+				Finish();
+			}
+			catch (...)
+			{
+			}
+		}
+		void Run(double runtime)
+		{
+			Finish();
+			start(runtime);
+			advanceCheckpointed(runtime);
+			Finish();
+		}
+		void RunUntil(double time)
+		{
+			if (!running_)
+				start(time);
+			if (time < time_)
+			{
+				std::stringstream errorMessage;
+				errorMessage << "Cannot run simulation until time " << time << ", since the simulation time is already " << time_ << ".";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			advanceCheckpointed(time);
+		}
+		size_t Step(size_t numSteps)
+		{
+			if (!running_)
+				start(stochsim::inf);
+			return advance(stochsim::inf, numSteps, true);
+		}
+		void Finish()
+		{
+			waitForCheckpoint();
+			if (!running_)
+				return;
+			running_ = false;
+			simulationAlgorithm_.reset();
+			logger_.Uninitialize(*this);
+			for (auto& state : model_->GetStates())
+			{
+				state->Uninitialize(*this);
+			}
+		}
+		bool IsRunning() const
+		{
+			return running_;
+		}
+		void SaveCheckpoint(const std::string& fileName)
+		{
+			if (!running_)
+				throw std::exception("Cannot save checkpoint, since the simulation is not running.");
+			std::vector<char> data = saveCheckpoint();
+			// A checkpoint still being written in the background must not replace this one afterwards.
+			waitForCheckpoint();
+			WriteCheckpointFile(fileName, data);
+		}
+		void LoadCheckpoint(const std::string& fileName)
+		{
+			CheckpointReader checkpoint(ReadCheckpointFile(fileName));
+			// Check that the checkpoint matches the model before finishing the current simulation.
+			readCheckpointHeader(checkpoint, "File " + fileName);
+			const std::int32_t algorithm = checkpoint.Read<std::int32_t>();
+			if (algorithm < static_cast<std::int32_t>(Simulation::Algorithm::DirectMethod) || algorithm > static_cast<std::int32_t>(Simulation::Algorithm::SlowScale))
+				throw std::exception("Checkpoint is truncated or corrupt.");
+			Finish();
+
+			algorithm_ = static_cast<Simulation::Algorithm>(algorithm);
+			seed_ = checkpoint.Read<unsigned long long>();
+			time_ = checkpoint.Read<double>();
+			runtime_ = checkpoint.Read<double>();
+			nextCheckpointT_ = checkpoint.Read<double>();
+			// Initializing the model and the algorithm draws random numbers. The saved state of the generator thus only replaces the current one when everything else was restored.
+			RandomEngine randomEngine;
+			randomEngine.Load(checkpoint);
+			RandomSourceGuard randomSourceGuard(*this);
+
+			// Initialize states, reactions, the algorithm and the schedulers as if the simulation started, and then overwrite their data by the checkpoint.
+			initializeModel();
+			readModelData(checkpoint);
+			logger_.RestoreCheckpoint(*this, checkpoint);
+			restartAlgorithm();
+			readAlgorithmData(checkpoint);
+			if (!checkpoint.AtEnd())
+			{
+				std::stringstream errorMessage;
+				errorMessage << "Checkpoint " << fileName << " is corrupt.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			running_ = true;
+			resetStopConditions();
+			randomEngine_ = randomEngine;
+		}
+		std::vector<char> CreateCheckpoint()
+		{
+			if (!running_)
+				throw std::exception("Cannot create checkpoint, since the simulation is not running.");
+			return saveCheckpoint();
+		}
+		void StartFromCheckpoint(const std::vector<char>& data, double runtime)
+		{
+			CheckpointReader checkpoint(data);
+			readCheckpointHeader(checkpoint, "Data");
+			Finish();
+
+			// Only the state of the model is taken from the checkpoint. The branch uses its own algorithm, random number stream, runtime and loggers, and ignores the rest of the checkpoint.
+			checkpoint.Read<std::int32_t>();
+			checkpoint.Read<unsigned long long>();
+			time_ = checkpoint.Read<double>();
+			checkpoint.Read<double>();
+			checkpoint.Read<double>();
+			RandomEngine().Load(checkpoint);
+			runtime_ = runtime;
+			seedRandomEngine();
+			RandomSourceGuard randomSourceGuard(*this);
+
+			initializeModel();
+			readModelData(checkpoint);
+			logger_.Initialize(*this);
+
+			restartAlgorithm();
+			nextCheckpointT_ = time_ + checkpointPeriod_;
+			running_ = true;
+			resetStopConditions();
+		}
+		size_t Num(const IState& state)
+		{
+			return state.Num(*this);
+		}
+		std::string GetStopReason() const
+		{
+			return stopReason_;
+		}
+		double GetStopTime() const
+		{
+			return stopTime_;
+		}
+
+		virtual double GetSimTime() const override
+		{
+			return time_;
+		}
+		virtual double GetLogPeriod() const override
+		{
+			return logger_.GetLogPeriod();
+		}
+		virtual std::string GetSaveFolder() const override
+		{
+			return logger_.GetSaveFolder();
+		}
+		virtual double GetRunTime() const override
+		{
+			return runtime_;
+		}
+		virtual size_t Rand(size_t lower, size_t upper) override
+		{
+			const std::uint64_t range = static_cast<std::uint64_t>(upper - lower) + 1;
+			if (range == 0)
+				return static_cast<size_t>(randomEngine_());
+			return lower + static_cast<size_t>(randomEngine_.Bounded(range));
+		}
+
+		virtual double Rand() override
+		{
+			return randomEngine_.Uniform();
+		}
+		virtual double RandExponential() override
+		{
+			return randomEngine_.Exponential();
+		}
+		virtual const Collection<std::shared_ptr<IState>> GetStates() const override
+		{
+			const auto& states = model_->GetStates();
+			return Collection<std::shared_ptr<IState>>(states.begin(), states.end());
+		}
+		virtual IInstanceData& GetInstanceData(size_t slot) override
+		{
+			return *data_[slot];
+		}
+		virtual size_t* GetMolecularNumbers() override
+		{
+			return molecularNumbers_.data();
+		}
+		virtual void Stop(const std::string& reason) override
+		{
+			if (!running_ || stopped_)
+				return;
+			stopReason_ = reason;
+			stopped_ = true;
+			stopTime_ = time_;
+		}
+
+		std::shared_ptr<const CompiledModel> GetModel() const
+		{
+			return model_;
+		}
+		LogManager& GetLogger()
+		{
+			return logger_;
+		}
+		void SetAlgorithm(Simulation::Algorithm algorithm)
+		{
+			algorithm_ = algorithm;
+		}
+		Simulation::Algorithm GetAlgorithm() const
+		{
+			return algorithm_;
+		}
+		void SetSeed(unsigned long long seed)
+		{
+			seed_ = seed;
+			hasSeed_ = true;
+		}
+		unsigned long long GetSeed() const
+		{
+			return seed_;
+		}
+		void SetCheckpointFile(std::string checkpointFile)
+		{
+			checkpointFile_ = std::move(checkpointFile);
+		}
+		std::string GetCheckpointFile() const
+		{
+			return checkpointFile_;
+		}
+		void SetCheckpointPeriod(double checkpointPeriod)
+		{
+			checkpointPeriod_ = checkpointPeriod;
+		}
+		double GetCheckpointPeriod() const
+		{
+			return checkpointPeriod_;
+		}
+
+	private:
+		const std::shared_ptr<const CompiledModel> model_;
+		std::vector<std::unique_ptr<IInstanceData>> data_;
+		std::vector<size_t> molecularNumbers_;
+		double time_;
+		double runtime_;
+		LogManager logger_;
+		RandomEngine randomEngine_;
+		Simulation::Algorithm algorithm_;
+		unsigned long long seed_;
+		bool hasSeed_;
+		// Runtime state, which only exists between start() and Finish().
+		bool running_;
+		std::unique_ptr<ISimulationAlgorithm> simulationAlgorithm_;
+		EventScheduler eventScheduler_;
+		TimeDependentScheduler timeDependentScheduler_;
+		// Time of the next propensity reaction returned by the algorithm, if the last call to advance() stopped before it.
+		double pendingReactionT_;
+		bool hasPendingReaction_;
+		// Periodic checkpoints, and the checkpoint currently written in the background.
+		std::string checkpointFile_;
+		double checkpointPeriod_;
+		double nextCheckpointT_;
+		std::future<void> checkpointWriter_;
+		// Reason why the simulation ended early, if any, i.e. the name of the stop condition which was met, or the reason passed to Stop().
+		std::string stopReason_;
+		bool stopped_;
+		double stopTime_;
+
+		/// <summary>
+		/// Number of steps if the simulation should not stop after a given number of steps.
+		/// </summary>
+		static constexpr size_t maxSteps = static_cast<size_t>(-1);
+
+		/// <summary>
+		/// Initializes all states, reactions and loggers, and starts the simulation at simulation time zero. The runtime is only used by the loggers, e.g. to display the progress.
+		/// </summary>
+		void start(double runtime)
+		{
+			runtime_ = runtime;
+			time_ = 0;
+			seedRandomEngine();
+			RandomSourceGuard randomSourceGuard(*this);
+
+			// Initialize
+			initializeModel();
+			logger_.Initialize(*this);
+
+			restartAlgorithm();
+			nextCheckpointT_ = checkpointPeriod_;
+			running_ = true;
+			resetStopConditions();
+		}
+		/// <summary>
+		/// Seeds the random number generator with the seed of the simulation, or with a random seed if no seed was set.
+		/// </summary>
+		void seedRandomEngine()
+		{
+			if (!hasSeed_)
+				seed_ = (static_cast<unsigned long long>(std::random_device{}()) << 32) | std::random_device{}();
+			randomEngine_.Seed(seed_);
+		}
+		/// <summary>
+		/// Initializes all states and reactions of the model.
+		/// </summary>
+		void initializeModel()
+		{
+			for (auto& state : model_->GetStates())
+			{
+				state->Initialize(*this);
+			}
+			for (auto& reaction : model_->GetPropensityReactions())
+			{
+				reaction->Initialize(*this);
+			}
+			for (auto& reaction : model_->GetEventReactions())
+			{
+				reaction->Initialize(*this);
+			}
+		}
+		/// <summary>
+		/// Initializes the algorithm and the schedulers for the current state of the simulation, discarding the times of the next reactions they determined before.
+		/// Since propensity reactions are memoryless, this does not change the distribution of the trajectories.
+		/// </summary>
+		void restartAlgorithm()
+		{
+			const auto& propensityReactions = model_->GetPropensityReactions();
+			const DependencyGraph& dependencyGraph = model_->GetDependencyGraph();
+			simulationAlgorithm_ = createAlgorithm();
+			simulationAlgorithm_->Initialize(*this, propensityReactions, dependencyGraph, model_->GetMassActionKernel());
+			eventScheduler_.Initialize(*this, model_->GetEventReactions(), dependencyGraph);
+			timeDependentScheduler_.Initialize(*this, propensityReactions, dependencyGraph, model_->GetMassActionKernel());
+			hasPendingReaction_ = false;
+		}
+		/// <summary>
+		/// Advances the simulation until the given simulation time, and saves a checkpoint in the background every checkpoint period, if periodic checkpoints are enabled.
+		/// </summary>
+		void advanceCheckpointed(double until)
+		{
+			if (!checkpointFile_.empty() && checkpointPeriod_ > 0)
+			{
+				while (nextCheckpointT_ <= until && !stopped_)
+				{
+					// The algorithm is not interrupted at the checkpoint, such that saving checkpoints does not change the trajectory, e.g. by ending a leap early.
+					advance(nextCheckpointT_, maxSteps, false);
+					nextCheckpointT_ += checkpointPeriod_;
+					std::vector<char> data = saveCheckpoint();
+					// Only the file is written in the background, such that the simulation does not wait for the disk. At most one checkpoint is written at a time.
+					waitForCheckpoint();
+					checkpointWriter_ = std::async(std::launch::async, [fileName = checkpointFile_, data = std::move(data)]()
+					{
+						WriteCheckpointFile(fileName, data);
+					});
+				}
+			}
+			advance(until, maxSteps, true);
+		}
+		/// <summary>
+		/// Serializes the runtime state of the simulation into a binary checkpoint, including the state of the algorithm and the schedulers (e.g. the pending step), such that the restored simulation continues exactly as this simulation.
+		/// Does not change the state of this simulation.
+		/// </summary>
+		std::vector<char> saveCheckpoint()
+		{
+			RandomSourceGuard randomSourceGuard(*this);
+			CheckpointWriter checkpoint;
+			checkpoint.WriteArray(checkpointMagic, sizeof(checkpointMagic));
+			checkpoint.Write(checkpointVersion);
+			checkpoint.WriteString(modelFingerprint());
+			checkpoint.Write(static_cast<std::int32_t>(algorithm_));
+			checkpoint.Write(seed_);
+			checkpoint.Write(time_);
+			checkpoint.Write(runtime_);
+			checkpoint.Write(nextCheckpointT_);
+			randomEngine_.Save(checkpoint);
+			writeModelData(checkpoint);
+			logger_.SaveCheckpoint(*this, checkpoint);
+			writeAlgorithmData(checkpoint);
+			return checkpoint.Release();
+		}
+		/// <summary>
+		/// Forgets which stop condition ended the last simulation, and evaluates all stop conditions for the initial state of the simulation.
+		/// </summary>
+		void resetStopConditions()
+		{
+			stopReason_ = "";
+			stopped_ = false;
+			stopTime_ = stochsim::inf;
+			RandomSourceGuard randomSourceGuard(*this);
+			checkAllStopConditions();
+		}
+		/// <summary>
+		/// Evaluates the stop conditions with the given indices, and stops the simulation at the current simulation time if any of them is met. Returns true if the simulation stopped.
+		/// </summary>
+		bool checkStopConditions(const std::vector<size_t>& conditions)
+		{
+			const auto& stopConditions = model_->GetStopConditions();
+			for (size_t condition : conditions)
+			{
+				if (stopConditions[condition]->IsMet(*this))
+				{
+					Stop(stopConditions[condition]->GetName());
+					return true;
+				}
+			}
+			return false;
+		}
+		/// <summary>
+		/// Evaluates all stop conditions, e.g. after several reactions fired at once. Returns true if the simulation stopped.
+		/// </summary>
+		bool checkAllStopConditions()
+		{
+			const auto& stopConditions = model_->GetStopConditions();
+			for (const auto& condition : stopConditions)
+			{
+				if (condition->IsMet(*this))
+				{
+					Stop(condition->GetName());
+					return true;
+				}
+			}
+			return false;
+		}
+		/// <summary>
+		/// Writes the molecular numbers and the instance data of all states and reactions to a checkpoint.
+		/// </summary>
+		void writeModelData(CheckpointWriter& checkpoint) const
+		{
+			checkpoint.WriteArray(molecularNumbers_.data(), molecularNumbers_.size());
+			for (auto& data : data_)
+			{
+				data->Save(checkpoint);
+			}
+		}
+		/// <summary>
+		/// Restores the molecular numbers and the instance data written by writeModelData(). States and reactions must already be initialized.
+		/// </summary>
+		void readModelData(CheckpointReader& checkpoint)
+		{
+			checkpoint.ReadArray(molecularNumbers_.data(), molecularNumbers_.size());
+			for (auto& data : data_)
+			{
+				data->Load(checkpoint);
+			}
+		}
+		/// <summary>
+		/// Writes the time of the pending propensity reaction, and the state of the algorithm and the schedulers to a checkpoint.
+		/// </summary>
+		void writeAlgorithmData(CheckpointWriter& checkpoint) const
+		{
+			checkpoint.Write(pendingReactionT_);
+			checkpoint.Write(hasPendingReaction_);
+			simulationAlgorithm_->SaveCheckpoint(checkpoint);
+			eventScheduler_.SaveCheckpoint(checkpoint);
+			timeDependentScheduler_.SaveCheckpoint(checkpoint);
+		}
+		/// <summary>
+		/// Reads the data written by writeAlgorithmData(). The algorithm and the schedulers must have been initialized for the restored state of the model before (see restartAlgorithm()).
+		/// </summary>
+		void readAlgorithmData(CheckpointReader& checkpoint)
+		{
+			pendingReactionT_ = checkpoint.Read<double>();
+			hasPendingReaction_ = checkpoint.Read<bool>();
+			simulationAlgorithm_->RestoreCheckpoint(*this, checkpoint);
+			eventScheduler_.RestoreCheckpoint(checkpoint);
+			timeDependentScheduler_.RestoreCheckpoint(checkpoint);
+		}
+		/// <summary>
+		/// Reads the header of a checkpoint, and throws an exception if it is not a checkpoint of the current format, or if it was saved by a simulation of a different model. The source (e.g. the file name)
+		/// only describes the checkpoint in error messages.
+		/// </summary>
+		void readCheckpointHeader(CheckpointReader& checkpoint, const std::string& source) const
+		{
+			char magic[sizeof(checkpointMagic)];
+			checkpoint.ReadArray(magic, sizeof(magic));
+			if (std::memcmp(magic, checkpointMagic, sizeof(magic)) != 0 || checkpoint.Read<std::uint32_t>() != checkpointVersion)
+			{
+				std::stringstream errorMessage;
+				errorMessage << source << " is not a checkpoint, or was saved by an incompatible version.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+			if (checkpoint.ReadString() != modelFingerprint())
+			{
+				std::stringstream errorMessage;
+				errorMessage << source << " was saved by a simulation of a different model.";
+				throw std::exception(errorMessage.str().c_str());
+			}
+		}
+		/// <summary>
+		/// Waits until the checkpoint written in the background, if any, is written, and re-throws the exception thrown while writing it, if any.
+		/// </summary>
+		void waitForCheckpoint()
+		{
+			if (checkpointWriter_.valid())
+				checkpointWriter_.get();
+		}
+		/// <summary>
+		/// Returns a description of the structure of the model, which a checkpoint must match to be restored.
+		/// </summary>
+		std::string modelFingerprint() const
+		{
+			std::stringstream fingerprint;
+			for (auto& state : model_->GetStates())
+			{
+				fingerprint << state->GetName() << ';';
+			}
+			fingerprint << model_->GetPropensityReactions().size() << ';' << model_->GetEventReactions().size() << ';' << data_.size() << ';' << molecularNumbers_.size();
+			return fingerprint.str();
+		}
+		/// <summary>
+		/// Advances the simulation until the given simulation time, until the given number of propensity or event reactions fired (a leap counting as one step), or until a stop condition is met, whichever comes first.
+		/// If the simulation time is reached, the simulation time is set to it, and, if interruptAtEnd is true, the algorithm fires all propensity reactions happening until then (see ISimulationAlgorithm::Interrupt()).
+		/// Otherwise, the pending step of the algorithm is kept, such that advancing the simulation in several calls produces the same trajectory as advancing it in one call, also for approximate algorithms. Returns the number of steps.
+		/// </summary>
+		size_t advance(double until, size_t numSteps, bool interruptAtEnd)
+		{
+			/**
+			** Run a modified version of Gillespies algorithm. The base algorithm is implemented as outlined in
+			** Gillespie, Daniel T. "Exact stochastic simulation of coupled chemical reactions." The journal of physical chemistry 81.25 (1977): 2340-2361.
+			** What we added is the support of fixed time delays and other events happening at given times instead with continuous propensities.
+			** When and which propensity reaction fires next is determined by the selected algorithm (see Simulation::Algorithm).
+			** Propensity reactions whose rates explicitly depend on time are simulated exactly, independent of the algorithm (see TimeDependentScheduler).
+			**/
+			const auto& propensityReactions = model_->GetPropensityReactions();
+			const auto& eventReactions = model_->GetEventReactions();
+			const DependencyGraph& dependencyGraph = model_->GetDependencyGraph();
+			ISimulationAlgorithm& algorithm = *simulationAlgorithm_;
+			RandomSourceGuard randomSourceGuard(*this);
+
+			// iterate until the simulation is stopped
+			size_t steps = 0;
+			while (steps < numSteps && !stopped_)
+			{
+				// Calculate time of next propensity reaction event. If the last call to advance() stopped before this time, and the algorithm did not change the state when being interrupted,
+				// the time is still valid. Re-using it makes advancing the simulation in several calls produce the same trajectory as advancing it in one call.
+				double nextReactionT = hasPendingReaction_ ? pendingReactionT_ : algorithm.NextReactionTime(*this);
+				hasPendingReaction_ = false;
+
+				// Calculate time to next event reaction
+				double nextEventT = eventScheduler_.NextEventTime();
+
+				// Calculate time to next time dependent propensity reaction, if earlier than all other reactions
+				double nextTimeDependentT = timeDependentScheduler_.NextReactionTime(*this, std::min(std::min(nextReactionT, nextEventT), until));
+
+				// Stop if no reaction fires until the given time, or if no reaction can fire anymore at all.
+				const double nextT = std::min(std::min(nextReactionT, nextEventT), nextTimeDependentT);
+				if (nextT > until || nextT >= stochsim::inf)
+				{
+					bool changed = false;
+					if (until < stochsim::inf)
+					{
+						time_ = until;
+						if (interruptAtEnd)
+						{
+							logger_.NotifyBeforeChange(*this);
+							changed = interrupt();
+							if (changed)
+								checkAllStopConditions();
+						}
+					}
+					pendingReactionT_ = nextReactionT;
+					hasPendingReaction_ = !changed;
+					break;
+				}
+
+				// Fire either next event, next time dependent reaction or next propensity reaction, whichever is earlier
+				if (nextEventT > nextReactionT && nextTimeDependentT > nextReactionT)
+				{
+					// Fire a propensity reaction
+					time_ = nextReactionT;
+
+					// notify logger about the time of the next reaction event
+					logger_.NotifyBeforeChange(*this);
+
+					// decide on identity of next reaction event and fire this event
+					size_t reactionIndex = algorithm.FireNextReaction(*this);
+					if (reactionIndex < propensityReactions.size())
+					{
+						eventScheduler_.NotifyPropensityFired(*this, reactionIndex);
+						timeDependentScheduler_.NotifyPropensityFired(*this, reactionIndex);
+						checkStopConditions(dependencyGraph.GetPropensityConditionDependents(reactionIndex));
+					}
+					else if (reactionIndex == ISimulationAlgorithm::severalReactions)
+					{
+						eventScheduler_.NotifyAllChanged(*this);
+						timeDependentScheduler_.NotifyAllChanged(*this);
+						checkAllStopConditions();
+					}
+				}
+				else if (nextEventT > nextTimeDependentT)
+				{
+					time_ = nextTimeDependentT;
+					// notify logger about the time of the next reaction event
+					logger_.NotifyBeforeChange(*this);
+					size_t reactionIndex = timeDependentScheduler_.NextReaction();
+					// propensity reactions happening until the time dependent reaction fires
+					bool interrupted = interrupt();
+					propensityReactions[reactionIndex]->Fire(*this);
+					algorithm.NotifyPropensityFired(*this, reactionIndex);
+					eventScheduler_.NotifyPropensityFired(*this, reactionIndex);
+					timeDependentScheduler_.NotifyPropensityFired(*this, reactionIndex);
+					if (interrupted)
+						checkAllStopConditions();
+					else
+						checkStopConditions(dependencyGraph.GetPropensityConditionDependents(reactionIndex));
+				}
+				else
+				{
+					time_ = nextEventT;
+					// notify logger about the time of the next reaction event
+					logger_.NotifyBeforeChange(*this);
+					// propensity reactions happening until the event fires
+					bool interrupted = interrupt();
+					size_t nextEventIndex = eventScheduler_.NextEvent();
+					eventReactions[nextEventIndex]->Fire(*this);
+					algorithm.NotifyEventFired(*this, nextEventIndex);
+					eventScheduler_.NotifyEventFired(*this, nextEventIndex);
+					timeDependentScheduler_.NotifyEventFired(*this, nextEventIndex);
+					if (interrupted)
+						checkAllStopConditions();
+					else
+						checkStopConditions(dependencyGraph.GetEventConditionDependents(nextEventIndex));
+				}
+				steps++;
+			}
+			return steps;
+		}
+		/// <summary>
+		/// Lets the algorithm fire all propensity reactions happening until the current simulation time, and updates the schedulers if any reaction fired. Returns true if any reaction fired.
+		/// </summary>
+		bool interrupt()
+		{
+			if (!simulationAlgorithm_->Interrupt(*this))
+				return false;
+			eventScheduler_.NotifyAllChanged(*this);
+			timeDependentScheduler_.NotifyAllChanged(*this);
+			return true;
+		}
+
+		std::unique_ptr<ISimulationAlgorithm> createAlgorithm() const
+		{
+			switch (algorithm_)
+			{
+			case Simulation::Algorithm::NextReactionMethod:
+				return std::make_unique<NextReactionMethod>();
+			case Simulation::Algorithm::CompositionRejection:
+				return std::make_unique<CompositionRejection>();
+			case Simulation::Algorithm::TauLeaping:
+				return std::make_unique<TauLeaping>();
+			case Simulation::Algorithm::Hybrid:
+				return std::make_unique<HybridMethod>();
+			case Simulation::Algorithm::SortingDirectMethod:
+				return std::make_unique<SortingDirectMethod>();
+			case Simulation::Algorithm::PartialPropensityMethod:
+				return std::make_unique<PartialPropensityMethod>();
+			case Simulation::Algorithm::SlowScale:
+				return std::make_unique<SlowScaleMethod>();
+			case Simulation::Algorithm::DirectMethod:
+			default:
+				return std::make_unique<DirectMethod>();
+			}
+		}
+	};
+
+	SimulationInstance::SimulationInstance(std::shared_ptr<const CompiledModel> model) : impl_(new SimulationInstance::Impl(std::move(model)))
+	{
+	}
+	SimulationInstance::~SimulationInstance()
+	{
+		delete impl_;
+	}
+	void SimulationInstance::Run(double maxTime)
+	{
+		impl_->Run(maxTime);
+	}
+	void SimulationInstance::RunUntil(double time)
+	{
+		impl_->RunUntil(time);
+	}
+	void SimulationInstance::Continue(double duration)
+	{
+		impl_->RunUntil(impl_->GetSimTime() + duration);
+	}
+	size_t SimulationInstance::Step(size_t numSteps)
+	{
+		return impl_->Step(numSteps);
+	}
+	void SimulationInstance::Finish()
+	{
+		impl_->Finish();
+	}
+	bool SimulationInstance::IsRunning() const
+	{
+		return impl_->IsRunning();
+	}
+	double SimulationInstance::GetSimTime() const
+	{
+		return impl_->GetSimTime();
+	}
+	size_t SimulationInstance::Num(const IState& state)
+	{
+		return impl_->Num(state);
+	}
+	std::string SimulationInstance::GetStopReason() const
+	{
+		return impl_->GetStopReason();
+	}
+	double SimulationInstance::GetStopTime() const
+	{
+		return impl_->GetStopTime();
+	}
+	void SimulationInstance::SaveCheckpoint(const std::string& fileName)
+	{
+		impl_->SaveCheckpoint(fileName);
+	}
+	void SimulationInstance::LoadCheckpoint(const std::string& fileName)
+	{
+		impl_->LoadCheckpoint(fileName);
+	}
+	std::vector<char> SimulationInstance::CreateCheckpoint()
+	{
+		return impl_->CreateCheckpoint();
+	}
+	void SimulationInstance::StartFromCheckpoint(const std::vector<char>& checkpoint, double runtime)
+	{
+		impl_->StartFromCheckpoint(checkpoint, runtime);
+	}
+	void SimulationInstance::SetCheckpointFile(std::string checkpointFile)
+	{
+		impl_->SetCheckpointFile(std::move(checkpointFile));
+	}
+	std::string SimulationInstance::GetCheckpointFile() const
+	{
+		return impl_->GetCheckpointFile();
+	}
+	void SimulationInstance::SetCheckpointPeriod(double checkpointPeriod)
+	{
+		impl_->SetCheckpointPeriod(checkpointPeriod);
+	}
+	double SimulationInstance::GetCheckpointPeriod() const
+	{
+		return impl_->GetCheckpointPeriod();
+	}
+	std::shared_ptr<const CompiledModel> SimulationInstance::GetModel() const
+	{
+		return impl_->GetModel();
+	}
+	void SimulationInstance::AddLogger(std::shared_ptr<ILogger> logger)
+	{
+		impl_->GetLogger().AddTask(std::move(logger));
+	}
+	void SimulationInstance::SetLogPeriod(double logPeriod)
+	{
+		impl_->GetLogger().SetLogPeriod(logPeriod);
+	}
+	double SimulationInstance::GetLogPeriod() const
+	{
+		return impl_->GetLogger().GetLogPeriod();
+	}
+	void SimulationInstance::SetBaseFolder(std::string baseFolder)
+	{
+		impl_->GetLogger().SetBaseFolder(std::move(baseFolder));
+	}
+	std::string SimulationInstance::GetBaseFolder() const
+	{
+		return impl_->GetLogger().GetBaseFolder();
+	}
+	void SimulationInstance::SetUniqueSubfolder(bool uniqueSubFolder)
+	{
+		impl_->GetLogger().SetUniqueSubfolder(uniqueSubFolder);
+	}
+	bool SimulationInstance::IsUniqueSubfolder() const
+	{
+		return impl_->GetLogger().IsUniqueSubfolder();
+	}
+	void SimulationInstance::SetAlgorithm(Simulation::Algorithm algorithm)
+	{
+		impl_->SetAlgorithm(algorithm);
+	}
+	Simulation::Algorithm SimulationInstance::GetAlgorithm() const
+	{
+		return impl_->GetAlgorithm();
+	}
+	void SimulationInstance::SetSeed(unsigned long long seed)
+	{
+		impl_->SetSeed(seed);
+	}
+	unsigned long long SimulationInstance::GetSeed() const
+	{
+		return impl_->GetSeed();
+	}
+}
@@ -0,0 +1,562 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "ReactionNetwork.h"
+#include "MassActionKernel.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Slow-scale stochastic simulation algorithm, as outlined in
+	/// Cao, Yang, Daniel T. Gillespie, and Linda R. Petzold. "The slow-scale stochastic simulation algorithm." The Journal of chemical physics 122.1 (2005): 014116.
+	/// Fast reversible reaction pairs (e.g. E + S -&gt; ES and ES -&gt; E + S) are assumed to be in partial equilibrium, and only the remaining, slow reactions are simulated. A pair of mass action reactions is a candidate
+	/// if the changes of one reaction are exactly the opposite of the changes of the other, no other candidate pair involves any of their states, and the propensities of all other reactions depending on their states follow mass action kinetics.
+	/// Before every step, a candidate pair is considered fast if its expected propensity in partial equilibrium is at least fastRatio times larger than the aggregated propensity of all reactions not belonging to any candidate pair.
+	/// For every fast pair, the stationary distribution of its virtual fast process (the pair firing alone, all other molecular numbers being constant) is a birth-death process in the extent of the pair, which is computed
+	/// exactly by detailed balance. The slow reactions then fire with their propensities averaged over these distributions. Before a slow reaction fires, the states of every fast pair are resampled from the stationary
+	/// distribution (weighted by the propensity of the firing reaction), by firing the reactions of the pair. When the fast pairs fire orders of magnitude more often than the slow reactions, this is orders of magnitude
+	/// faster than simulating every single firing.
+	/// The algorithm is approximate. If no pair is fast, it reduces to the direct method. Event reactions still fire exactly at their scheduled times.
+	/// </summary>
+	class SlowScaleMethod : public ISimulationAlgorithm
+	{
+	public:
+		SlowScaleMethod() : reactions_(nullptr), kernel_(nullptr), aSlow_(0)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			network_.Initialize(reactions);
+			propensities_.assign(reactions.size(), 0);
+			numbers_.assign(network_.NumStates(), 0);
+			findPairs();
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			for (size_t i = 0; i < network_.NumStates(); i++)
+			{
+				numbers_[i] = network_.GetState(i)->Num(simInfo);
+			}
+			kernel_->ComputeRates(simInfo, propensities_.data());
+			double aOther = 0;
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (propensities_[j] < 0)
+					propensities_[j] = 0;
+				if (reactionPairs_[j] == noPair)
+					aOther += propensities_[j];
+			}
+			// Partition the candidate pairs into fast and slow pairs. Close to partial equilibrium, both reactions of a pair have about the same propensity, and the stationary distribution only has
+			// to be computed if their sum is large enough.
+			for (auto& pair : pairs_)
+			{
+				pair.fast_ = propensities_[pair.forward_] + propensities_[pair.backward_] >= fastRatio * aOther
+					&& computeDistribution(pair) && pair.meanPropensity_ >= fastRatio * aOther;
+			}
+			// Propensities of the slow reactions, averaged over the stationary distributions of the fast pairs.
+			aSlow_ = 0;
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (reactionPairs_[j] != noPair && pairs_[reactionPairs_[j]].fast_)
+				{
+					propensities_[j] = 0;
+					continue;
+				}
+				if (readsFast(j))
+					propensities_[j] = averagePropensity(j);
+				aSlow_ += propensities_[j];
+			}
+			if (aSlow_ <= 0)
+				return stochsim::inf;
+			return simInfo.GetSimTime() + simInfo.RandExponential() / aSlow_;
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			// decide on identity of next slow reaction.
+			double afraction = simInfo.Rand() * aSlow_;
+			double asum = 0;
+			size_t reactionIndex = reactions_->size();
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (propensities_[j] <= 0)
+					continue;
+				reactionIndex = j;
+				asum += propensities_[j];
+				if (asum >= afraction)
+					break;
+			}
+			if (reactionIndex >= reactions_->size())
+				return reactions_->size();
+			// Resample the states of the fast pairs, conditioned on the slow reaction firing.
+			bool anyFast = false;
+			for (size_t pairIndex = 0; pairIndex < pairs_.size(); pairIndex++)
+			{
+				if (!pairs_[pairIndex].fast_)
+					continue;
+				anyFast = true;
+				resample(simInfo, pairIndex, reactionIndex);
+			}
+			(*reactions_)[reactionIndex]->Fire(simInfo);
+			return anyFast ? severalReactions : reactionIndex;
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			// do nothing. Slow reactions are memoryless, and the fast pairs are only resampled when a slow reaction fires.
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			// do nothing. All propensities are recomputed anyways.
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			// do nothing. All propensities are recomputed anyways.
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// Everything a pending step needs to select and fire the slow reaction, i.e. the averaged propensities and the stationary distributions of the fast pairs.
+			checkpoint.WriteArray(propensities_.data(), propensities_.size());
+			for (auto number : numbers_)
+			{
+				checkpoint.Write<std::uint64_t>(number);
+			}
+			checkpoint.Write(aSlow_);
+			checkpoint.Write<std::uint64_t>(pairs_.size());
+			for (const auto& pair : pairs_)
+			{
+				checkpoint.Write(pair.fast_);
+				checkpoint.Write<std::int64_t>(pair.lowest_);
+				checkpoint.Write(pair.meanPropensity_);
+				checkpoint.Write<std::uint64_t>(pair.probabilities_.size());
+				checkpoint.WriteArray(pair.probabilities_.data(), pair.probabilities_.size());
+			}
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			checkpoint.ReadArray(propensities_.data(), propensities_.size());
+			for (auto& number : numbers_)
+			{
+				number = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			}
+			aSlow_ = checkpoint.Read<double>();
+			if (checkpoint.Read<std::uint64_t>() != pairs_.size())
+				throw std::exception("Checkpoint is truncated or corrupt.");
+			for (auto& pair : pairs_)
+			{
+				pair.fast_ = checkpoint.Read<bool>();
+				pair.lowest_ = static_cast<long long>(checkpoint.Read<std::int64_t>());
+				pair.meanPropensity_ = checkpoint.Read<double>();
+				pair.probabilities_.resize(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+				checkpoint.ReadArray(pair.probabilities_.data(), pair.probabilities_.size());
+			}
+		}
+	private:
+		/// <summary>
+		/// Minimal ratio between the expected propensity of a fast pair in partial equilibrium and the aggregated propensity of all reactions not belonging to any candidate pair.
+		/// </summary>
+		static constexpr double fastRatio = 100;
+		/// <summary>
+		/// Relative probability below which the tails of the stationary distribution of a fast pair are truncated.
+		/// </summary>
+		static constexpr double truncation = 1e-18;
+		/// <summary>
+		/// Maximal number of states of the stationary distribution of a fast pair. Pairs with wider distributions are simulated exactly.
+		/// </summary>
+		static constexpr size_t maxWidth = 1 << 17;
+		/// <summary>
+		/// Maximal change of any molecular number by the extent of a fast pair which is considered when computing its stationary distribution. Larger molecular numbers cannot be represented exactly as doubles anyways.
+		/// </summary>
+		static constexpr long long maxExtent = 1LL << 52;
+		static constexpr size_t noPair = static_cast<size_t>(-1);
+
+		/// <summary>
+		/// Candidate pair of reversible reactions, and the stationary distribution of its extent relative to the current molecular numbers.
+		/// </summary>
+		struct Pair
+		{
+			size_t forward_;
+			size_t backward_;
+			// Changes of the molecular numbers when the forward reaction fires.
+			std::vector<std::pair<size_t, long long>> changes_;
+			bool fast_;
+			// Relative extent of the first state of the distribution, and probabilities of all states.
+			long long lowest_;
+			std::vector<double> probabilities_;
+			// Expected propensity of the forward reaction.
+			double meanPropensity_;
+		};
+
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		ReactionNetwork network_;
+		std::vector<Pair> pairs_;
+		// Candidate pair of every reaction, or noPair.
+		std::vector<size_t> reactionPairs_;
+		// Candidate pair changing every state, or noPair.
+		std::vector<size_t> statePairs_;
+		std::vector<size_t> numbers_;
+		std::vector<double> propensities_;
+		std::vector<double> weights_;
+		double aSlow_;
+
+		/// <summary>
+		/// Finds all pairs of mass action reactions which might be in partial equilibrium.
+		/// </summary>
+		void findPairs()
+		{
+			const size_t numReactions = network_.NumReactions();
+			pairs_.clear();
+			reactionPairs_.assign(numReactions, noPair);
+			statePairs_.assign(network_.NumStates(), noPair);
+			// States whose molecular numbers are read by reactions with custom rates. Reactions with unknown structure might read any state.
+			std::vector<bool> customRead(network_.NumStates(), false);
+			for (size_t j = 0; j < numReactions; j++)
+			{
+				const ReactionNetwork::Reaction& reaction = network_.GetReaction(j);
+				if (!reaction.known_)
+					return;
+				if (!reaction.massAction_ || !kernel_->IsMassAction(j))
+				{
+					for (const auto& rateState : reaction.rateStates_)
+					{
+						customRead[rateState.first] = true;
+					}
+				}
+			}
+			// States involved in any candidate pair, either by being changed or by being read.
+			std::vector<bool> used(network_.NumStates(), false);
+			for (size_t j1 = 0; j1 < numReactions; j1++)
+			{
+				if (reactionPairs_[j1] != noPair || !isPairable(j1))
+					continue;
+				for (size_t j2 = j1 + 1; j2 < numReactions; j2++)
+				{
+					if (reactionPairs_[j2] != noPair || !isPairable(j2) || !isReverse(j1, j2))
+						continue;
+					const ReactionNetwork::Reaction& forward = network_.GetReaction(j1);
+					const ReactionNetwork::Reaction& backward = network_.GetReaction(j2);
+					Pair pair;
+					pair.forward_ = j1;
+					pair.backward_ = j2;
+					pair.fast_ = false;
+					pair.lowest_ = 0;
+					pair.meanPropensity_ = 0;
+					for (const auto& change : forward.changes_)
+					{
+						pair.changes_.emplace_back(change.first, static_cast<long long>(change.second));
+					}
+					// The propensity of the forward reaction must decrease, and the one of the backward reaction increase with the extent, such that the distribution is unimodal.
+					bool valid = true;
+					for (const auto& rateState : forward.rateStates_)
+					{
+						valid = valid && changeOf(pair, rateState.first) <= 0;
+					}
+					for (const auto& rateState : backward.rateStates_)
+					{
+						valid = valid && changeOf(pair, rateState.first) >= 0;
+					}
+					for (const auto& change : pair.changes_)
+					{
+						valid = valid && !used[change.first] && !customRead[change.first];
+					}
+					for (const auto& rateState : forward.rateStates_)
+					{
+						valid = valid && !used[rateState.first];
+					}
+					for (const auto& rateState : backward.rateStates_)
+					{
+						valid = valid && !used[rateState.first];
+					}
+					if (!valid)
+						continue;
+					for (const auto& change : pair.changes_)
+					{
+						used[change.first] = true;
+						statePairs_[change.first] = pairs_.size();
+					}
+					for (const auto& rateState : forward.rateStates_)
+					{
+						used[rateState.first] = true;
+					}
+					for (const auto& rateState : backward.rateStates_)
+					{
+						used[rateState.first] = true;
+					}
+					reactionPairs_[j1] = pairs_.size();
+					reactionPairs_[j2] = pairs_.size();
+					pairs_.push_back(std::move(pair));
+					break;
+				}
+			}
+		}
+		bool isPairable(size_t reactionIndex) const
+		{
+			const ReactionNetwork::Reaction& reaction = network_.GetReaction(reactionIndex);
+			return reaction.known_ && reaction.massAction_ && reaction.exactChanges_ && kernel_->IsMassAction(reactionIndex) && !reaction.changes_.empty();
+		}
+		/// <summary>
+		/// Returns true if the changes of the second reaction are exactly the opposite of the changes of the first.
+		/// </summary>
+		bool isReverse(size_t first, size_t second) const
+		{
+			const auto& changes1 = network_.GetReaction(first).changes_;
+			const auto& changes2 = network_.GetReaction(second).changes_;
+			size_t nonZero1 = 0;
+			for (const auto& change1 : changes1)
+			{
+				if (change1.second == 0)
+					continue;
+				nonZero1++;
+				bool found = false;
+				for (const auto& change2 : changes2)
+				{
+					if (change2.first == change1.first && change2.second == -change1.second)
+						found = true;
+				}
+				if (!found)
+					return false;
+			}
+			size_t nonZero2 = 0;
+			for (const auto& change2 : changes2)
+			{
+				if (change2.second != 0)
+					nonZero2++;
+			}
+			return nonZero1 > 0 && nonZero1 == nonZero2;
+		}
+		static long long changeOf(const Pair& pair, size_t stateIndex)
+		{
+			for (const auto& change : pair.changes_)
+			{
+				if (change.first == stateIndex)
+					return change.second;
+			}
+			return 0;
+		}
+		/// <summary>
+		/// Molecular number of a state after the pair fired forward extent times, starting from the current molecular numbers.
+		/// </summary>
+		inline double number(const Pair& pair, size_t stateIndex, long long extent) const
+		{
+			return static_cast<double>(static_cast<long long>(numbers_[stateIndex]) + extent * changeOf(pair, stateIndex));
+		}
+		/// <summary>
+		/// Product of the mass action factors of the given reaction on the states changed by the pair, after the pair fired forward extent times.
+		/// </summary>
+		double factors(size_t pairIndex, size_t reactionIndex, long long extent) const
+		{
+			const Pair& pair = pairs_[pairIndex];
+			double result = 1;
+			for (const auto& rateState : network_.GetReaction(reactionIndex).rateStates_)
+			{
+				if (statePairs_[rateState.first] != pairIndex)
+					continue;
+				const double num = number(pair, rateState.first, extent);
+				for (Stochiometry s = 0; s < rateState.second; s++)
+				{
+					if (num - s <= 0)
+						return 0;
+					result *= num - s;
+				}
+			}
+			return result;
+		}
+		/// <summary>
+		/// Propensity of a reaction of the pair after the pair fired forward extent times. All states the reactions of the pair depend on, but which they do not change, are constant.
+		/// </summary>
+		double pairPropensity(const Pair& pair, size_t reactionIndex, long long extent) const
+		{
+			const ReactionNetwork::Reaction& reaction = network_.GetReaction(reactionIndex);
+			double rate = reaction.rateConstant_;
+			for (const auto& rateState : reaction.rateStates_)
+			{
+				const double num = number(pair, rateState.first, extent);
+				for (Stochiometry s = 0; s < rateState.second; s++)
+				{
+					if (num - s <= 0)
+						return 0;
+					rate *= num - s;
+				}
+			}
+			return rate;
+		}
+		/// <summary>
+		/// Computes the stationary distribution of the extent of a pair by detailed balance, i.e. p(k+1)/p(k) = a_forward(k) / a_backward(k+1). Returns false if the distribution is degenerate or too wide.
+		/// </summary>
+		bool computeDistribution(Pair& pair)
+		{
+			// Range of extents keeping all molecular numbers non-negative. If the extent is unbounded on one side, e.g. for a birth-death pair (-> A and A ->), only extents up to maxExtent
+			// molecules away from the current molecular numbers are considered, such that neither the extents nor the molecular numbers overflow.
+			long long maxChange = 1;
+			for (const auto& change : pair.changes_)
+			{
+				maxChange = std::max(maxChange, change.second > 0 ? change.second : -change.second);
+			}
+			long long lower = -(maxExtent / maxChange);
+			long long upper = maxExtent / maxChange;
+			for (const auto& change : pair.changes_)
+			{
+				const long long num = static_cast<long long>(numbers_[change.first]);
+				if (change.second > 0)
+					lower = std::max(lower, -(num / change.second));
+				else if (change.second < 0)
+					upper = std::min(upper, num / -change.second);
+			}
+			if (lower >= upper)
+				return false;
+			auto ratio = [&](long long extent) -> double
+			{
+				const double backward = pairPropensity(pair, pair.backward_, extent + 1);
+				const double forward = pairPropensity(pair, pair.forward_, extent);
+				return backward > 0 ? forward / backward : (forward > 0 ? stochsim::inf : 0);
+			};
+			// Mode, i.e. the smallest extent for which the ratio falls below one. The ratio is monotonically decreasing.
+			long long low = lower;
+			long long high = upper;
+			while (low < high)
+			{
+				const long long middle = low + (high - low) / 2;
+				if (ratio(middle) < 1)
+					high = middle;
+				else
+					low = middle + 1;
+			}
+			const long long mode = low;
+			// Relative probabilities around the mode, until they become negligible.
+			weights_.clear();
+			weights_.push_back(1);
+			long long first = mode;
+			for (double weight = 1; first > lower && weights_.size() < maxWidth; )
+			{
+				const double r = ratio(first - 1);
+				if (!(r > 0) || r == stochsim::inf)
+					break;
+				weight /= r;
+				if (weight < truncation)
+					break;
+				weights_.push_back(weight);
+				first--;
+			}
+			std::reverse(weights_.begin(), weights_.end());
+			long long last = mode;
+			for (double weight = 1; last < upper && weights_.size() < maxWidth; )
+			{
+				const double r = ratio(last);
+				if (!(r > 0))
+					break;
+				weight *= r;
+				if (weight < truncation)
+					break;
+				weights_.push_back(weight);
+				last++;
+			}
+			if (weights_.size() <= 1 || weights_.size() >= maxWidth)
+				return false;
+			pair.lowest_ = first;
+			double total = 0;
+			for (double weight : weights_)
+			{
+				total += weight;
+			}
+			pair.probabilities_.resize(weights_.size());
+			pair.meanPropensity_ = 0;
+			for (size_t i = 0; i < weights_.size(); i++)
+			{
+				pair.probabilities_[i] = weights_[i] / total;
+				pair.meanPropensity_ += pair.probabilities_[i] * pairPropensity(pair, pair.forward_, first + static_cast<long long>(i));
+			}
+			return pair.meanPropensity_ > 0;
+		}
+		/// <summary>
+		/// Returns true if the propensity of the reaction depends on a state changed by a fast pair.
+		/// </summary>
+		bool readsFast(size_t reactionIndex) const
+		{
+			for (const auto& rateState : network_.GetReaction(reactionIndex).rateStates_)
+			{
+				const size_t pair = statePairs_[rateState.first];
+				if (pair != noPair && pairs_[pair].fast_)
+					return true;
+			}
+			return false;
+		}
+		/// <summary>
+		/// Computes the propensity of a mass action reaction averaged over the stationary distributions of all fast pairs. Since the fast pairs do not share any states, their extents are independent.
+		/// </summary>
+		double averagePropensity(size_t reactionIndex) const
+		{
+			const ReactionNetwork::Reaction& reaction = network_.GetReaction(reactionIndex);
+			double rate = reaction.rateConstant_;
+			std::vector<size_t> averagedPairs;
+			for (const auto& rateState : reaction.rateStates_)
+			{
+				const size_t pairIndex = statePairs_[rateState.first];
+				if (pairIndex != noPair && pairs_[pairIndex].fast_)
+				{
+					if (std::find(averagedPairs.begin(), averagedPairs.end(), pairIndex) == averagedPairs.end())
+						averagedPairs.push_back(pairIndex);
+					continue;
+				}
+				for (Stochiometry s = 0; s < rateState.second; s++)
+				{
+					const double factor = static_cast<double>(numbers_[rateState.first]) - s;
+					if (factor <= 0)
+						return 0;
+					rate *= factor;
+				}
+			}
+			for (size_t pairIndex : averagedPairs)
+			{
+				const Pair& pair = pairs_[pairIndex];
+				double mean = 0;
+				for (size_t i = 0; i < pair.probabilities_.size(); i++)
+				{
+					mean += pair.probabilities_[i] * factors(pairIndex, reactionIndex, pair.lowest_ + static_cast<long long>(i));
+				}
+				rate *= mean;
+			}
+			return rate;
+		}
+		/// <summary>
+		/// Draws the extent of a fast pair from its stationary distribution, weighted by the propensity of the slow reaction about to fire, and fires the reactions of the pair accordingly.
+		/// </summary>
+		void resample(ISimInfo& simInfo, size_t pairIndex, size_t slowReaction)
+		{
+			const Pair& pair = pairs_[pairIndex];
+			weights_.resize(pair.probabilities_.size());
+			double total = 0;
+			for (size_t i = 0; i < pair.probabilities_.size(); i++)
+			{
+				weights_[i] = pair.probabilities_[i] * factors(pairIndex, slowReaction, pair.lowest_ + static_cast<long long>(i));
+				total += weights_[i];
+			}
+			if (total <= 0)
+				return;
+			const double target = simInfo.Rand() * total;
+			double sum = 0;
+			size_t selected = 0;
+			for (size_t i = 0; i < weights_.size(); i++)
+			{
+				if (weights_[i] <= 0)
+					continue;
+				selected = i;
+				sum += weights_[i];
+				if (sum >= target)
+					break;
+			}
+			long long extent = pair.lowest_ + static_cast<long long>(selected);
+			for (; extent > 0; extent--)
+			{
+				(*reactions_)[pair.forward_]->Fire(simInfo);
+			}
+			for (; extent < 0; extent++)
+			{
+				(*reactions_)[pair.backward_]->Fire(simInfo);
+			}
+		}
+	};
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "DependencyGraph.h"
+#include "MassActionKernel.h"
+namespace stochsim
+{
+	/// <summary>
+	/// McCollum et al.'s sorting direct method, as outlined in
+	/// McCollum, James M., et al. "The sorting direct method for stochastic simulation of biochemical systems with varying reaction execution behavior." Computational biology and chemistry 30.1 (2006): 39-49.
+	/// Variant of the direct method which selects the reaction firing next by a linear search over all reactions. The reactions are kept in an order adapting to how often they fire: every time a reaction fires,
+	/// it swaps places with its predecessor. Frequently firing reactions thus bubble to the front of the search order, and the linear search typically terminates after very few reactions.
+	/// Only the propensities of the reactions depending on the reaction which fired are recomputed, and the aggregated propensity is updated incrementally. Compared to the direct method with its sum tree and the next
+	/// reaction method with its priority queue, no logarithmic data structure has to be maintained, which is usually faster for medium-sized models with few dominating reactions.
+	/// </summary>
+	class SortingDirectMethod : public ISimulationAlgorithm
+	{
+	public:
+		SortingDirectMethod() : reactions_(nullptr), kernel_(nullptr), dependencyGraph_(nullptr), dirty_(nullptr), a0_(0), numPositive_(0), stepsSinceSum_(0)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			dependencyGraph_ = &dependencyGraph;
+			dirty_ = nullptr;
+			propensities_.resize(reactions.size());
+			kernel.ComputeRates(simInfo, propensities_.data());
+			// Start with the order of definition. The pre-simulation suggested by McCollum et al. is not necessary, since the order adapts quickly.
+			order_.resize(reactions.size());
+			for (size_t i = 0; i < reactions.size(); i++)
+			{
+				order_[i] = i;
+			}
+			sum();
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			// Update propensities which might have changed since the last call.
+			if (dirty_)
+			{
+				for (auto reactionIndex : *dirty_)
+				{
+					update(reactionIndex, kernel_->ComputeRate(simInfo, reactionIndex));
+				}
+				dirty_ = nullptr;
+			}
+			if (numPositive_ == 0)
+			{
+				a0_ = 0;
+				return stochsim::inf;
+			}
+			// The incremental updates accumulate rounding errors. Re-sum from time to time, which costs as much as a single worst case search.
+			if (++stepsSinceSum_ >= resumPeriod || a0_ <= 0)
+				sum();
+
+			// Calculate time span to next propensity reaction event
+			if (a0_ > 0)
+			{
+				return simInfo.GetSimTime() + simInfo.RandExponential() / a0_;
+			}
+			else
+			{
+				return stochsim::inf;
+			}
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			// decide on identity of next reaction event by a linear search in the current order.
+			double target = simInfo.Rand() * a0_;
+			size_t position = order_.size();
+			double asum = 0;
+			for (size_t i = 0; i < order_.size(); i++)
+			{
+				const double propensity = propensities_[order_[i]];
+				if (propensity <= 0)
+					continue;
+				// Due to rounding errors in a0, the target might not be reached. Then, the last reaction with positive propensity fires.
+				position = i;
+				asum += propensity;
+				if (asum > target)
+					break;
+			}
+			const size_t reactionIndex = order_[position];
+			(*reactions_)[reactionIndex]->Fire(simInfo);
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+
+			// Move the reaction one step to the front of the search order.
+			if (position > 0)
+			{
+				order_[position] = order_[position - 1];
+				order_[position - 1] = reactionIndex;
+			}
+			return reactionIndex;
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			// do nothing. Propensity reactions are memoryless.
+			return false;
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetEventDependents(eventIndex);
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// The search order and the incrementally updated aggregated propensity are saved, such that the same reactions are selected after the checkpoint is restored.
+			checkpoint.WriteArray(propensities_.data(), propensities_.size());
+			saveReactions(checkpoint, &order_);
+			checkpoint.Write(a0_);
+			checkpoint.Write<std::uint64_t>(numPositive_);
+			checkpoint.Write<std::uint64_t>(stepsSinceSum_);
+			saveReactions(checkpoint, dirty_);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			checkpoint.ReadArray(propensities_.data(), propensities_.size());
+			restoreReactions(checkpoint, order_, reactions_->size());
+			if (order_.size() != reactions_->size())
+				throw std::exception("Checkpoint was saved for a different number of propensity reactions.");
+			a0_ = checkpoint.Read<double>();
+			numPositive_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			stepsSinceSum_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			restoreReactions(checkpoint, restoredDirty_, reactions_->size());
+			dirty_ = restoredDirty_.empty() ? nullptr : &restoredDirty_;
+		}
+	private:
+		/// <summary>
+		/// Number of steps after which the aggregated propensity is recomputed from scratch.
+		/// </summary>
+		static constexpr size_t resumPeriod = 1024;
+
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		const DependencyGraph* dependencyGraph_;
+		// Reactions whose propensities have to be recomputed before the next step. Since every reaction or event firing is followed by a call to NextReactionTime, at most one set of reactions is dirty at any time.
+		const std::vector<size_t>* dirty_;
+		// Owns the dirty reactions restored from a checkpoint.
+		std::vector<size_t> restoredDirty_;
+		// Propensities, indexed by reaction.
+		std::vector<double> propensities_;
+		// Reaction indices in the order of the linear search.
+		std::vector<size_t> order_;
+		double a0_;
+		// Number of reactions with positive propensity. Allows to detect that no reaction can fire anymore independent of the rounding errors in a0_.
+		size_t numPositive_;
+		size_t stepsSinceSum_;
+
+		/// <summary>
+		/// Sets the propensity of the given reaction, and updates the aggregated propensity.
+		/// </summary>
+		void update(size_t reactionIndex, double propensity)
+		{
+			const double oldPropensity = propensities_[reactionIndex];
+			if (propensity == oldPropensity)
+				return;
+			if (oldPropensity > 0)
+			{
+				a0_ -= oldPropensity;
+				numPositive_--;
+			}
+			if (propensity > 0)
+			{
+				a0_ += propensity;
+				numPositive_++;
+			}
+			propensities_[reactionIndex] = propensity;
+		}
+		/// <summary>
+		/// Recomputes the aggregated propensity from scratch.
+		/// </summary>
+		void sum()
+		{
+			a0_ = 0;
+			numPositive_ = 0;
+			for (double propensity : propensities_)
+			{
+				if (propensity > 0)
+				{
+					a0_ += propensity;
+					numPositive_++;
+				}
+			}
+			stepsSinceSum_ = 0;
+		}
+	};
+}
@@ -0,0 +1,455 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <math.h>
+#include "stochsim_common.h"
+#include "SimulationAlgorithm.h"
+#include "ReactionNetwork.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Explicit tau-leaping with the step size selection and the treatment of critical reactions as outlined in
+	/// Cao, Yang, Daniel T. Gillespie, and Linda R. Petzold. "Efficient step size selection for the tau-leaping simulation method." The Journal of chemical physics 124.4 (2006): 044109.
+	/// Instead of firing one reaction at a time, every non-critical reaction fires a Poisson distributed number of times during a leap of length tau, with tau chosen such that no propensity changes by more
+	/// than a fraction epsilon. Reactions which are close to exhausting one of their reactants (critical reactions), as well as reactions whose structure is unknown (i.e. which are not PropensityReactions) or which
+	/// depend on or transform weighted states (see PropensityReaction::SetWeight()), fire at most once per leap. Leaps which would result in negative molecular numbers are rejected and repeated with half the step size. If the selected step is not much larger than the expected
+	/// time until the next reaction, a series of exact steps of the direct method is performed instead, before a leap is tried again. During these steps, only the propensities depending on the last reaction are recomputed.
+	/// The algorithm is approximate, but can be orders of magnitude faster than exact algorithms for models with high molecular numbers. Event reactions still fire exactly at their scheduled times.
+	/// </summary>
+	class TauLeaping : public ISimulationAlgorithm
+	{
+	public:
+		TauLeaping() : reactions_(nullptr), kernel_(nullptr), dependencyGraph_(nullptr), mode_(Mode::None), stepStart_(0), a0_(0), exactStepsLeft_(0), dirty_(nullptr), allDirty_(true)
+		{
+		}
+		virtual void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel) override
+		{
+			reactions_ = &reactions;
+			kernel_ = &kernel;
+			dependencyGraph_ = &dependencyGraph;
+			mode_ = Mode::None;
+			exactStepsLeft_ = 0;
+			dirty_ = nullptr;
+			allDirty_ = true;
+			network_.Initialize(reactions);
+			propensities_.assign(reactions.size(), 0);
+			critical_.assign(reactions.size(), false);
+			counts_.assign(reactions.size(), 0);
+			numbers_.assign(network_.NumStates(), 0);
+			mu_.assign(network_.NumStates(), 0);
+			sigma2_.assign(network_.NumStates(), 0);
+			g_.assign(network_.NumStates(), 0);
+		}
+		virtual double NextReactionTime(ISimInfo& simInfo) override
+		{
+			stepStart_ = simInfo.GetSimTime();
+			mode_ = Mode::None;
+			// Still in a series of exact steps, during which no leap is tried. As in the direct method, only the propensities which might have changed since the last step are recomputed.
+			if (exactStepsLeft_ > 0 && !allDirty_)
+			{
+				if (dirty_)
+				{
+					for (auto reactionIndex : *dirty_)
+					{
+						const double propensity = kernel_->ComputeRate(simInfo, reactionIndex);
+						propensities_[reactionIndex] = propensity > 0 ? propensity : 0;
+					}
+					dirty_ = nullptr;
+				}
+				a0_ = 0;
+				for (size_t j = 0; j < reactions_->size(); j++)
+				{
+					a0_ += propensities_[j];
+				}
+				if (a0_ <= 0)
+					return stochsim::inf;
+				return exactStep(simInfo);
+			}
+			dirty_ = nullptr;
+			allDirty_ = false;
+			for (size_t i = 0; i < network_.NumStates(); i++)
+			{
+				numbers_[i] = static_cast<double>(network_.GetState(i)->Num(simInfo));
+			}
+			// Compute propensities.
+			a0_ = 0;
+			kernel_->ComputeRates(simInfo, propensities_.data());
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				propensities_[j] = propensities_[j] > 0 ? propensities_[j] : 0;
+				a0_ += propensities_[j];
+			}
+			if (a0_ <= 0)
+				return stochsim::inf;
+			if (exactStepsLeft_ > 0)
+				return exactStep(simInfo);
+
+			// Determine critical reactions.
+			double a0Critical = 0;
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				critical_[j] = isCritical(j);
+				if (critical_[j])
+					a0Critical += propensities_[j];
+			}
+			double tau1 = computeTau1();
+			if (tau1 < exactStepFactor / a0_)
+				return startExactSteps(simInfo);
+			while (true)
+			{
+				// As outlined by Cao et al., the time until the next critical reaction is redrawn for every attempt, also after a rejected leap.
+				double tau2 = a0Critical > 0 ? simInfo.RandExponential() / a0Critical : stochsim::inf;
+				double tau;
+				if (tau1 < tau2)
+				{
+					// No critical reaction fires during the leap.
+					tau = tau1;
+					drawCounts(simInfo, tau);
+				}
+				else
+				{
+					// Exactly one critical reaction fires at the end of the leap.
+					tau = tau2;
+					drawCounts(simInfo, tau);
+					double afraction = simInfo.Rand() * a0Critical;
+					double asum = 0;
+					size_t criticalReaction = reactions_->size();
+					for (size_t j = 0; j < reactions_->size(); j++)
+					{
+						if (!critical_[j] || propensities_[j] <= 0)
+							continue;
+						criticalReaction = j;
+						asum += propensities_[j];
+						if (asum >= afraction)
+							break;
+					}
+					if (criticalReaction < reactions_->size())
+						counts_[criticalReaction] = 1;
+				}
+				if (isNonNegative())
+				{
+					mode_ = Mode::Leap;
+					return stepStart_ + tau;
+				}
+				// Leap would result in negative molecular numbers. Retry with smaller step.
+				tau1 /= 2;
+				if (tau1 < exactStepFactor / a0_)
+					return startExactSteps(simInfo);
+			}
+		}
+		virtual size_t FireNextReaction(ISimInfo& simInfo) override
+		{
+			if (mode_ == Mode::Exact)
+			{
+				mode_ = Mode::None;
+				double afraction = simInfo.Rand() * a0_;
+				double asum = 0;
+				size_t reactionIndex = reactions_->size();
+				for (size_t j = 0; j < reactions_->size(); j++)
+				{
+					if (propensities_[j] <= 0)
+						continue;
+					reactionIndex = j;
+					asum += propensities_[j];
+					if (asum >= afraction)
+						break;
+				}
+				if (reactionIndex >= reactions_->size() || !network_.CanFire(simInfo, reactionIndex))
+					return reactions_->size();
+				(*reactions_)[reactionIndex]->Fire(simInfo);
+				dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+				return reactionIndex;
+			}
+			else if (mode_ == Mode::Leap)
+			{
+				mode_ = Mode::None;
+				allDirty_ = true;
+				return fireCounts(simInfo) ? severalReactions : reactions_->size();
+			}
+			return reactions_->size();
+		}
+		virtual bool Interrupt(ISimInfo& simInfo) override
+		{
+			if (mode_ != Mode::Leap)
+			{
+				// Exact steps are memoryless. The pending exact step is kept, such that it still fires if the simulation continues without any other reaction firing first.
+				return false;
+			}
+			mode_ = Mode::None;
+			// Perform a shorter leap until the current time. Since the leap ends before the next critical reaction would fire, only non-critical reactions fire.
+			double tau = simInfo.GetSimTime() - stepStart_;
+			if (tau <= 0)
+				return false;
+			drawCounts(simInfo, tau);
+			allDirty_ = true;
+			return fireCounts(simInfo);
+		}
+		virtual void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetEventDependents(eventIndex);
+		}
+		virtual void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex) override
+		{
+			dirty_ = &dependencyGraph_->GetPropensityDependents(reactionIndex);
+		}
+		virtual void SaveCheckpoint(CheckpointWriter& checkpoint) const override
+		{
+			// The number of exact steps left, the step determined by the last call to NextReactionTime, which might not have been fired yet, and the propensities which have to be recomputed.
+			checkpoint.Write(static_cast<std::int32_t>(mode_));
+			checkpoint.Write(stepStart_);
+			checkpoint.Write(a0_);
+			checkpoint.Write<std::uint64_t>(exactStepsLeft_);
+			checkpoint.WriteArray(propensities_.data(), propensities_.size());
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				checkpoint.Write<bool>(critical_[j]);
+				checkpoint.Write<std::uint64_t>(counts_[j]);
+			}
+			checkpoint.Write(allDirty_);
+			saveReactions(checkpoint, dirty_);
+		}
+		virtual void RestoreCheckpoint(ISimInfo& simInfo, CheckpointReader& checkpoint) override
+		{
+			mode_ = static_cast<Mode>(checkpoint.Read<std::int32_t>());
+			stepStart_ = checkpoint.Read<double>();
+			a0_ = checkpoint.Read<double>();
+			exactStepsLeft_ = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			checkpoint.ReadArray(propensities_.data(), propensities_.size());
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				critical_[j] = checkpoint.Read<bool>();
+				counts_[j] = static_cast<size_t>(checkpoint.Read<std::uint64_t>());
+			}
+			allDirty_ = checkpoint.Read<bool>();
+			restoreReactions(checkpoint, restoredDirty_, reactions_->size());
+			dirty_ = restoredDirty_.empty() ? nullptr : &restoredDirty_;
+		}
+	private:
+		/// <summary>
+		/// Error control parameter epsilon. Tau is chosen such that no propensity is expected to change by more than this fraction.
+		/// </summary>
+		static constexpr double epsilon = 0.03;
+		/// <summary>
+		/// Reactions which would exhaust one of their reactants when firing less than this number of times are considered critical.
+		/// </summary>
+		static constexpr double criticalFirings = 10;
+		/// <summary>
+		/// If tau is smaller than this factor times the expected time until the next reaction, an exact step is performed instead of a leap.
+		/// </summary>
+		static constexpr double exactStepFactor = 10;
+		/// <summary>
+		/// Number of exact steps performed before a leap is tried again. Trying to leap before every step would cost a tau selection per reaction, i.e. more than the direct method.
+		/// </summary>
+		static constexpr size_t numExactSteps = 100;
+
+		enum class Mode
+		{
+			None,
+			Exact,
+			Leap
+		};
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const MassActionKernel* kernel_;
+		const DependencyGraph* dependencyGraph_;
+		ReactionNetwork network_;
+		Mode mode_;
+		double stepStart_;
+		double a0_;
+		std::vector<double> propensities_;
+		// Number of exact steps still to be performed before a leap is tried again.
+		size_t exactStepsLeft_;
+		// Reactions whose propensities have to be recomputed before the next exact step, and if all propensities have to be recomputed, e.g. after a leap.
+		const std::vector<size_t>* dirty_;
+		// Owns the dirty reactions restored from a checkpoint.
+		std::vector<size_t> restoredDirty_;
+		bool allDirty_;
+		std::vector<bool> critical_;
+		std::vector<size_t> counts_;
+		// Molecular numbers, expected changes, variances of changes and highest orders of all states at the beginning of the step.
+		std::vector<double> numbers_;
+		std::vector<double> mu_;
+		std::vector<double> sigma2_;
+		std::vector<double> g_;
+
+		/// <summary>
+		/// Starts a series of numExactSteps exact steps, and performs its first step.
+		/// </summary>
+		double startExactSteps(ISimInfo& simInfo)
+		{
+			exactStepsLeft_ = numExactSteps;
+			return exactStep(simInfo);
+		}
+		/// <summary>
+		/// Performs an exact step of the direct method, with the propensities computed at the beginning of the step. Returns the time when the selected reaction fires.
+		/// </summary>
+		double exactStep(ISimInfo& simInfo)
+		{
+			exactStepsLeft_--;
+			mode_ = Mode::Exact;
+			return stepStart_ + simInfo.RandExponential() / a0_;
+		}
+		bool isCritical(size_t reactionIndex) const
+		{
+			const ReactionNetwork::Reaction& reaction = network_.GetReaction(reactionIndex);
+			// The change of propensities depending on the properties of molecules cannot be predicted, such that these reactions are treated as critical, too.
+			if (!reaction.known_ || reaction.weighted_)
+				return true;
+			for (const auto& consumed : reaction.consumed_)
+			{
+				if (numbers_[consumed.first] < criticalFirings * consumed.second)
+					return true;
+			}
+			return false;
+		}
+		/// <summary>
+		/// Returns the highest order of reaction g_i for a state with the given molecular number and stochiometry in a reaction of the given order.
+		/// </summary>
+		static double highestOrder(double order, Stochiometry stochiometry, double number)
+		{
+			if (stochiometry <= 1 || number <= stochiometry - 1)
+				return order;
+			double g = 0;
+			for (Stochiometry s = 0; s < stochiometry; s++)
+			{
+				g += s / (number - s);
+			}
+			return order / stochiometry * (stochiometry + g);
+		}
+		/// <summary>
+		/// Computes the largest leap for the non-critical reactions such that the relative change of all propensities is expected to stay below epsilon.
+		/// </summary>
+		double computeTau1()
+		{
+			std::fill(mu_.begin(), mu_.end(), 0);
+			std::fill(sigma2_.begin(), sigma2_.end(), 0);
+			std::fill(g_.begin(), g_.end(), 0);
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				const ReactionNetwork::Reaction& reaction = network_.GetReaction(j);
+				// Only the non-critical reactions change the molecular numbers during the leap, but the propensities of all reactions, including the critical ones, must not change too much.
+				if (!critical_[j])
+				{
+					for (const auto& change : reaction.changes_)
+					{
+						mu_[change.first] += change.second * propensities_[j];
+						sigma2_[change.first] += change.second * change.second * propensities_[j];
+					}
+				}
+				for (const auto& rateState : reaction.rateStates_)
+				{
+					g_[rateState.first] = std::max(g_[rateState.first], highestOrder(reaction.order_, rateState.second, numbers_[rateState.first]));
+				}
+			}
+			double tau1 = stochsim::inf;
+			for (size_t i = 0; i < network_.NumStates(); i++)
+			{
+				// Only states any propensity depends on.
+				if (g_[i] <= 0)
+					continue;
+				double bound = std::max(epsilon * numbers_[i] / g_[i], 1.0);
+				if (mu_[i] != 0)
+					tau1 = std::min(tau1, bound / fabs(mu_[i]));
+				if (sigma2_[i] > 0)
+					tau1 = std::min(tau1, bound * bound / sigma2_[i]);
+			}
+			return tau1;
+		}
+		/// <summary>
+		/// Draws the number of times each non-critical reaction fires during a leap of length tau. Critical reactions are set to fire zero times.
+		/// </summary>
+		void drawCounts(ISimInfo& simInfo, double tau)
+		{
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				counts_[j] = critical_[j] ? 0 : drawPoisson(simInfo, propensities_[j] * tau);
+			}
+		}
+		/// <summary>
+		/// Returns true if firing all reactions according to counts_ results in non-negative molecular numbers.
+		/// </summary>
+		bool isNonNegative()
+		{
+			std::fill(mu_.begin(), mu_.end(), 0);
+			for (size_t j = 0; j < reactions_->size(); j++)
+			{
+				if (counts_[j] == 0)
+					continue;
+				for (const auto& change : network_.GetReaction(j).changes_)
+				{
+					mu_[change.first] += change.second * counts_[j];
+				}
+			}
+			for (size_t i = 0; i < network_.NumStates(); i++)
+			{
+				if (numbers_[i] + mu_[i] < 0)
+					return false;
+			}
+			return true;
+		}
+		/// <summary>
+		/// Fires all reactions according to counts_. To prevent negative molecular numbers, reactions only fire if enough molecules of their reactants are available. Since a reaction might only
+		/// become able to fire after other reactions fired, all reactions are fired in rounds until no reaction can fire anymore. Returns true if any reaction fired.
+		/// </summary>
+		bool fireCounts(ISimInfo& simInfo)
+		{
+			bool anyFired = false;
+			bool progress = true;
+			while (progress)
+			{
+				progress = false;
+				for (size_t j = 0; j < reactions_->size(); j++)
+				{
+					while (counts_[j] > 0 && network_.CanFire(simInfo, j))
+					{
+						(*reactions_)[j]->Fire(simInfo);
+						counts_[j]--;
+						progress = true;
+						anyFired = true;
+					}
+				}
+			}
+			return anyFired;
+		}
+		/// <summary>
+		/// Draws a Poisson distributed random number. For small means by inversion, and for large means by the transformed rejection method of
+		/// Hörmann, Wolfgang. "The transformed rejection method for generating Poisson random variables." Insurance: Mathematics and Economics 12.1 (1993): 39-45.
+		/// </summary>
+		static size_t drawPoisson(ISimInfo& simInfo, double mean)
+		{
+			if (mean <= 0)
+				return 0;
+			if (mean < 10)
+			{
+				double limit = exp(-mean);
+				double product = simInfo.Rand();
+				size_t k = 0;
+				while (product > limit)
+				{
+					k++;
+					product *= simInfo.Rand();
+				}
+				return k;
+			}
+			const double slam = sqrt(mean);
+			const double loglam = log(mean);
+			const double b = 0.931 + 2.53 * slam;
+			const double a = -0.059 + 0.02483 * b;
+			const double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+			const double vr = 0.9277 - 3.6224 / (b - 2);
+			while (true)
+			{
+				double u = simInfo.Rand() - 0.5;
+				double v = simInfo.Rand();
+				double us = 0.5 - fabs(u);
+				double k = floor((2 * a / us + b) * u + mean + 0.43);
+				if (us >= 0.07 && v <= vr)
+					return static_cast<size_t>(k);
+				if (k < 0 || (us < 0.013 && v > us))
+					continue;
+				if (log(v) + log(invalpha) - log(a / (us * us) + b) <= -mean + k * loglam - lgamma(k + 1))
+					return static_cast<size_t>(k);
+			}
+		}
+	};
+}
@@ -0,0 +1,433 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include "stochsim_common.h"
+#include "DependencyGraph.h"
+#include "MassActionKernel.h"
+#include "IndexedPriorityQueue.h"
+#include "Checkpoint.h"
+namespace stochsim
+{
+	/// <summary>
+	/// Simulates the propensity reactions whose custom rate equation references the simulation time (see MassActionKernel::IsTimeDependent()) exactly, i.e. as inhomogeneous Poisson processes, instead of
+	/// assuming that their propensities stay constant until the next reaction fires. For every such reaction, an exponentially distributed hazard with mean one is drawn, and the reaction fires when the integral
+	/// of its propensity over time reaches this hazard. The integral is computed numerically by adaptive Simpson quadrature, as outlined in
+	/// Anderson, David F. "A modified next reaction method for simulating chemical systems with time dependent propensities and delays." The Journal of chemical physics 127.21 (2007): 214107.
+	/// The integral is only computed as far as necessary to decide if the reaction fires before the next reaction or event of the rest of the model. The quadrature panels are kept, such that when one of the states
+	/// the propensity depends on changes, the hazard consumed so far is known without re-evaluating the propensity, and only the remaining hazard has to be integrated with the new molecular numbers.
+	/// The propensities are thus only evaluated when a state they depend on changes (see DependencyGraph) or when the simulation time passes the end of the integrated interval, and not in every step.
+	/// Like event reactions, the reactions fire independent of the selected algorithm, which is notified about them by ISimulationAlgorithm::NotifyPropensityFired().
+	/// </summary>
+	class TimeDependentScheduler
+	{
+	public:
+		TimeDependentScheduler() : reactions_(nullptr), dependencyGraph_(nullptr)
+		{
+		}
+		/// <summary>
+		/// Called by the simulation before the simulation starts, after all states and reactions were initialized.
+		/// The reaction collection and the dependency graph must stay valid until the simulation finished.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactions">Propensity reactions of the simulation.</param>
+		/// <param name="dependencyGraph">Dependency graph of the reactions of the simulation.</param>
+		/// <param name="kernel">Kernel determining which reactions are time dependent.</param>
+		void Initialize(ISimInfo& simInfo, const std::vector<std::shared_ptr<IPropensityReaction>>& reactions, const DependencyGraph& dependencyGraph, const MassActionKernel& kernel)
+		{
+			reactions_ = &reactions;
+			dependencyGraph_ = &dependencyGraph;
+			const auto& timeDependentReactions = kernel.GetTimeDependentReactions();
+			channels_.clear();
+			channels_.resize(timeDependentReactions.size());
+			channelOf_.assign(timeDependentReactions.empty() ? 0 : reactions.size(), noChannel);
+			std::vector<double> keys(timeDependentReactions.size());
+			for (size_t c = 0; c < timeDependentReactions.size(); c++)
+			{
+				channels_[c].reaction_ = timeDependentReactions[c];
+				channelOf_[timeDependentReactions[c]] = c;
+				channels_[c].remaining_ = simInfo.RandExponential();
+				channels_[c].length_ = simInfo.GetLogPeriod();
+				keys[c] = restart(simInfo, channels_[c]);
+			}
+			queue_.Reset(std::move(keys));
+		}
+		/// <summary>
+		/// Returns the simulation time when the next time dependent reaction fires, or stochsim::inf if no time dependent reaction fires before the given time limit.
+		/// The propensities are only integrated until the time limit.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="limit">Time of the next propensity or event reaction of the rest of the model, or when the simulation stops.</param>
+		/// <returns>Simulation time of next time dependent reaction.</returns>
+		double NextReactionTime(ISimInfo& simInfo, double limit)
+		{
+			while (!queue_.Empty() && !channels_[queue_.Top()].resolved_ && queue_.TopKey() < limit)
+			{
+				const size_t c = queue_.Top();
+				queue_.Update(c, extend(simInfo, channels_[c]));
+			}
+			return queue_.Empty() || !channels_[queue_.Top()].resolved_ ? stochsim::inf : queue_.TopKey();
+		}
+		/// <summary>
+		/// Returns the index of the time dependent propensity reaction firing next. Behavior undefined if there are no time dependent reactions.
+		/// </summary>
+		/// <returns>Index of next time dependent reaction.</returns>
+		inline size_t NextReaction() const
+		{
+			return channels_[queue_.Top()].reaction_;
+		}
+		/// <summary>
+		/// Updates the firing times of all time dependent reactions depending on the propensity reaction which fired. If the reaction itself is time dependent, a new hazard is drawn for it.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="reactionIndex">Index of the propensity reaction which fired.</param>
+		inline void NotifyPropensityFired(ISimInfo& simInfo, size_t reactionIndex)
+		{
+			if (!channels_.empty())
+				update(simInfo, dependencyGraph_->GetPropensityDependents(reactionIndex), reactionIndex);
+		}
+		/// <summary>
+		/// Updates the firing times of all time dependent reactions depending on the event reaction which fired.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		/// <param name="eventIndex">Index of the event reaction which fired.</param>
+		inline void NotifyEventFired(ISimInfo& simInfo, size_t eventIndex)
+		{
+			if (!channels_.empty())
+				update(simInfo, dependencyGraph_->GetEventDependents(eventIndex), noReaction);
+		}
+		/// <summary>
+		/// Updates the firing times of all time dependent reactions, e.g. after several propensity reactions fired at once.
+		/// </summary>
+		/// <param name="simInfo">Simulation context.</param>
+		void NotifyAllChanged(ISimInfo& simInfo)
+		{
+			for (size_t c = 0; c < channels_.size(); c++)
+			{
+				updateChannel(simInfo, c, false);
+			}
+		}
+		/// <summary>
+		/// Writes the remaining hazards and the quadrature panels of all time dependent reactions to a checkpoint, such that the restored simulation neither redraws the hazards nor re-integrates the propensities.
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to write to.</param>
+		void SaveCheckpoint(CheckpointWriter& checkpoint) const
+		{
+			checkpoint.Write<std::uint64_t>(channels_.size());
+			for (const auto& channel : channels_)
+			{
+				checkpoint.Write(channel.remaining_);
+				checkpoint.Write(channel.hazard_);
+				checkpoint.Write(channel.rateEnd_);
+				checkpoint.Write(channel.length_);
+				checkpoint.Write(channel.resolved_);
+				checkpoint.Write<std::uint64_t>(channel.panels_.size());
+				checkpoint.WriteArray(channel.panels_.data(), channel.panels_.size());
+			}
+			queue_.Save(checkpoint);
+		}
+		/// <summary>
+		/// Restores the state written by SaveCheckpoint(). Called after Initialize().
+		/// </summary>
+		/// <param name="checkpoint">Checkpoint to read from.</param>
+		void RestoreCheckpoint(CheckpointReader& checkpoint)
+		{
+			if (checkpoint.Read<std::uint64_t>() != channels_.size())
+				throw std::exception("Checkpoint was saved for a different number of time dependent reactions.");
+			for (auto& channel : channels_)
+			{
+				channel.remaining_ = checkpoint.Read<double>();
+				channel.hazard_ = checkpoint.Read<double>();
+				channel.rateEnd_ = checkpoint.Read<double>();
+				channel.length_ = checkpoint.Read<double>();
+				channel.resolved_ = checkpoint.Read<bool>();
+				channel.panels_.resize(static_cast<size_t>(checkpoint.Read<std::uint64_t>()));
+				checkpoint.ReadArray(channel.panels_.data(), channel.panels_.size());
+			}
+			queue_.Load(checkpoint);
+			if (queue_.Size() != channels_.size())
+				throw std::exception("Checkpoint is truncated or corrupt.");
+		}
+	private:
+		/// <summary>
+		/// Relative tolerance of the hazard integrated over a quadrature panel.
+		/// </summary>
+		static constexpr double tolerance = 1e-7;
+		/// <summary>
+		/// Hazard below which the tolerance is absolute instead of relative, i.e. tolerance*minimalHazard.
+		/// </summary>
+		static constexpr double minimalHazard = 1e-3;
+		/// <summary>
+		/// Length of quadrature panels, relative to the simulation time, below which panels are accepted independent of their error, e.g. at discontinuities of the propensity.
+		/// </summary>
+		static constexpr double minimalLength = 1e-12;
+		static constexpr size_t noChannel = static_cast<size_t>(-1);
+		static constexpr size_t noReaction = static_cast<size_t>(-1);
+
+		/// <summary>
+		/// Simpson panel of the quadrature of the propensity over time. The propensity is interpolated by the quadratic polynomial through the propensities at the beginning, the middle and the end of the panel.
+		/// </summary>
+		struct Panel
+		{
+			double start_;
+			double length_;
+			double rates_[3];
+			// Hazard integrated from the time the channel was last solved until the start of the panel.
+			double hazard_;
+
+			/// <summary>
+			/// Integral of the interpolated propensity from the start of the panel to the given fraction x of the panel.
+			/// </summary>
+			inline double Integral(double x) const noexcept
+			{
+				const double b = -3 * rates_[0] + 4 * rates_[1] - rates_[2];
+				const double c = 2 * rates_[0] - 4 * rates_[1] + 2 * rates_[2];
+				return length_ * x * (rates_[0] + x * (b / 2 + x * c / 3));
+			}
+			/// <summary>
+			/// Interpolated propensity at the given fraction x of the panel.
+			/// </summary>
+			inline double Rate(double x) const noexcept
+			{
+				const double b = -3 * rates_[0] + 4 * rates_[1] - rates_[2];
+				const double c = 2 * rates_[0] - 4 * rates_[1] + 2 * rates_[2];
+				return rates_[0] + x * (b + x * c);
+			}
+		};
+		/// <summary>
+		/// Time dependent reaction, together with the quadrature of its propensity since the states it depends on last changed.
+		/// </summary>
+		struct Channel
+		{
+			size_t reaction_;
+			// Hazard remaining until the reaction fires, counted from the start of the first panel.
+			double remaining_;
+			// Hazard integrated until the end of the last panel, and the propensity at this time.
+			double hazard_;
+			double rateEnd_;
+			// Length of the next panel.
+			double length_;
+			// True if the firing time is known, false if the propensity was only integrated until the end of the last panel without consuming the remaining hazard.
+			bool resolved_;
+			std::vector<Panel> panels_;
+		};
+		/// <summary>
+		/// Forwards to the simulation context, except for the simulation time, such that rate equations can be evaluated at future times.
+		/// </summary>
+		class ShiftedSimInfo : public ISimInfo
+		{
+		public:
+			ShiftedSimInfo(ISimInfo& simInfo) : simInfo_(simInfo), time_(simInfo.GetSimTime())
+			{
+			}
+			void SetSimTime(double time) noexcept
+			{
+				time_ = time;
+			}
+			virtual double GetSimTime() const override
+			{
+				return time_;
+			}
+			virtual double GetRunTime() const override
+			{
+				return simInfo_.GetRunTime();
+			}
+			virtual size_t Rand(size_t lower, size_t upper) override
+			{
+				return simInfo_.Rand(lower, upper);
+			}
+			virtual double Rand() override
+			{
+				return simInfo_.Rand();
+			}
+			virtual double RandExponential() override
+			{
+				return simInfo_.RandExponential();
+			}
+			virtual std::string GetSaveFolder() const override
+			{
+				return simInfo_.GetSaveFolder();
+			}
+			virtual double GetLogPeriod() const override
+			{
+				return simInfo_.GetLogPeriod();
+			}
+			virtual const Collection<std::shared_ptr<IState>> GetStates() const override
+			{
+				return simInfo_.GetStates();
+			}
+			virtual IInstanceData& GetInstanceData(size_t slot) override
+			{
+				return simInfo_.GetInstanceData(slot);
+			}
+			virtual size_t* GetMolecularNumbers() override
+			{
+				return simInfo_.GetMolecularNumbers();
+			}
+			virtual void Stop(const std::string& reason) override
+			{
+				simInfo_.Stop(reason);
+			}
+		private:
+			ISimInfo& simInfo_;
+			double time_;
+		};
+
+		const std::vector<std::shared_ptr<IPropensityReaction>>* reactions_;
+		const DependencyGraph* dependencyGraph_;
+		std::vector<Channel> channels_;
+		// Channel of every propensity reaction, or noChannel if the reaction is not time dependent. Empty if there are no time dependent reactions.
+		std::vector<size_t> channelOf_;
+		IndexedPriorityQueue queue_;
+
+		void update(ISimInfo& simInfo, const std::vector<size_t>& dependents, size_t firedReaction)
+		{
+			for (auto reactionIndex : dependents)
+			{
+				const size_t c = channelOf_[reactionIndex];
+				if (c != noChannel)
+					updateChannel(simInfo, c, reactionIndex == firedReaction);
+			}
+		}
+		/// <summary>
+		/// Restarts the integration of a channel at the current simulation time after the states its propensity depends on changed. If the reaction fired, a new hazard is drawn. Otherwise, the hazard consumed since the integration was last restarted is subtracted.
+		/// </summary>
+		void updateChannel(ISimInfo& simInfo, size_t c, bool fired)
+		{
+			Channel& channel = channels_[c];
+			if (fired)
+				channel.remaining_ = simInfo.RandExponential();
+			else
+				channel.remaining_ = std::max(channel.remaining_ - consumed(channel, simInfo.GetSimTime()), 0.0);
+			const double key = restart(simInfo, channel);
+			if (key != queue_.GetKey(c))
+				queue_.Update(c, key);
+		}
+		/// <summary>
+		/// Returns the hazard integrated from the start of the first panel of the channel until the given time, which must not be later than the end of the last panel.
+		/// </summary>
+		static double consumed(const Channel& channel, double time)
+		{
+			if (channel.panels_.empty() || time <= channel.panels_.front().start_)
+				return 0;
+			auto panel = std::upper_bound(channel.panels_.begin(), channel.panels_.end(), time, [](double time, const Panel& panel) {return time < panel.start_; }) - 1;
+			const double x = std::min((time - panel->start_) / panel->length_, 1.0);
+			return panel->hazard_ + panel->Integral(x);
+		}
+		/// <summary>
+		/// Returns the propensity of the reaction at the given time, assuming that the molecular numbers stay constant.
+		/// </summary>
+		inline double rate(ShiftedSimInfo& shiftedSimInfo, const Channel& channel, double time) const
+		{
+			shiftedSimInfo.SetSimTime(time);
+			const double propensity = (*reactions_)[channel.reaction_]->ComputeRate(shiftedSimInfo);
+			return propensity > 0 ? propensity : 0;
+		}
+		/// <summary>
+		/// Discards all panels of the channel, such that the integration continues at the current simulation time. Returns the key of the channel in the queue, i.e. the current simulation time.
+		/// </summary>
+		double restart(ISimInfo& simInfo, Channel& channel) const
+		{
+			channel.panels_.clear();
+			channel.hazard_ = 0;
+			const double time = simInfo.GetSimTime();
+			// The remaining hazard might have been consumed up to rounding errors.
+			if (channel.remaining_ <= 0)
+			{
+				channel.resolved_ = true;
+				return time;
+			}
+			ShiftedSimInfo shiftedSimInfo(simInfo);
+			channel.rateEnd_ = rate(shiftedSimInfo, channel, time);
+			channel.resolved_ = false;
+			return time;
+		}
+		/// <summary>
+		/// Integrates the propensity of the channel over the next panel. Returns the key of the channel in the queue, i.e. the firing time if the remaining hazard is consumed in this panel,
+		/// the end of the panel otherwise, or stochsim::inf if the panel would have to be infinitely long since the propensity vanishes.
+		/// </summary>
+		double extend(ISimInfo& simInfo, Channel& channel) const
+		{
+			ShiftedSimInfo shiftedSimInfo(simInfo);
+			const double time = channel.panels_.empty() ? simInfo.GetSimTime() : channel.panels_.back().start_ + channel.panels_.back().length_;
+			const double target = channel.remaining_;
+			const double hazard = channel.hazard_;
+			const double rateStart = channel.rateEnd_;
+
+			// Initially, guess the length from the expected time until the remaining hazard is consumed. Never go below the minimal length, such that the integration always progresses.
+			const double minimal = minimalLength * (1 + std::abs(time));
+			double length = channel.length_;
+			if (channel.panels_.empty() && rateStart > 0 && target / rateStart < length)
+				length = target / rateStart;
+			length = std::max(length, minimal);
+			if (!(time + length < stochsim::inf))
+			{
+				channel.resolved_ = true;
+				return stochsim::inf;
+			}
+			double rateMiddle = rate(shiftedSimInfo, channel, time + length / 2);
+			double rateEnd = rate(shiftedSimInfo, channel, time + length);
+			while (true)
+			{
+				// Compare Simpson's rule on the whole panel with Simpson's rule on both halves.
+				const double rateQuarter = rate(shiftedSimInfo, channel, time + length / 4);
+				const double rateThreeQuarters = rate(shiftedSimInfo, channel, time + 3 * length / 4);
+				const double coarse = length * (rateStart + 4 * rateMiddle + rateEnd) / 6;
+				const double left = length / 2 * (rateStart + 4 * rateQuarter + rateMiddle) / 6;
+				const double right = length / 2 * (rateMiddle + 4 * rateThreeQuarters + rateEnd) / 6;
+				const double error = std::abs(left + right - coarse);
+				const double allowedError = tolerance * std::max(left + right, minimalHazard);
+				if (error > allowedError && length / 2 >= minimal)
+				{
+					// Refine by continuing with the left half.
+					length /= 2;
+					rateEnd = rateMiddle;
+					rateMiddle = rateQuarter;
+					continue;
+				}
+				channel.panels_.push_back(Panel{ time, length / 2, {rateStart, rateQuarter, rateMiddle}, hazard });
+				channel.panels_.push_back(Panel{ time + length / 2, length / 2, {rateMiddle, rateThreeQuarters, rateEnd}, hazard + left });
+				channel.hazard_ = hazard + left + right;
+				channel.rateEnd_ = rateEnd;
+				// Adapt the length of the next panel to the error of this panel, which is proportional to the fifth power of its length.
+				channel.length_ = length * (error > 0 ? std::min(std::max(0.9 * std::pow(allowedError / error, 0.2), 0.5), 4.0) : 4.0);
+				if (channel.hazard_ >= target)
+				{
+					channel.resolved_ = true;
+					const Panel& panel = hazard + left >= target ? channel.panels_[channel.panels_.size() - 2] : channel.panels_.back();
+					return panel.start_ + root(panel, target - panel.hazard_) * panel.length_;
+				}
+				return time + length;
+			}
+		}
+		/// <summary>
+		/// Returns the fraction x of the panel at which the integral of the interpolated propensity reaches the given hazard, by Newton's method safeguarded by bisection.
+		/// </summary>
+		static double root(const Panel& panel, double hazard)
+		{
+			double lower = 0;
+			double upper = 1;
+			const double total = panel.Integral(1);
+			double x = total > 0 ? std::min(std::max(hazard / total, 0.0), 1.0) : 0.5;
+			for (int iteration = 0; iteration < 100; iteration++)
+			{
+				const double difference = panel.Integral(x) - hazard;
+				if (difference == 0)
+					break;
+				if (difference < 0)
+					lower = x;
+				else
+					upper = x;
+				const double derivative = panel.length_ * panel.Rate(x);
+				double next = derivative > 0 ? x - difference / derivative : lower;
+				if (!(next > lower && next < upper))
+					next = (lower + upper) / 2;
+				if (next == x || upper - lower <= 1e-15)
+					break;
+				x = next;
+			}
+			return x;
+		}
+	};
+}
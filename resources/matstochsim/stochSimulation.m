@@ -91,6 +91,28 @@ classdef stochSimulation < handle & matlab.mixin.CustomDisplay
         % Matlab console while the simulation is running. Specifically, the
         % percentage of the simulation already accomplished is displayed.
         logConsole;
+        
+        % Algorithm used to determine when and which propensity reaction
+        % fires next. Either 'direct' (Gillespie's direct method, default),
+        % 'nrm' (Gibson and Bruck's next reaction method), 'sdm' (McCollum
+        % et al.'s sorting direct method), 'pdm' (Ramaswamy et al.'s
+        % partial-propensity direct method), 'cr' (Slepoy et al.'s
+        % composition-rejection method), 'tau' (Cao et al.'s tau-leaping
+        % method), 'hybrid' (hybrid stochastic/deterministic method) or
+        % 'sssa' (Cao et al.'s slow-scale SSA). All algorithms except
+        % tau-leaping, the hybrid method and the slow-scale SSA are
+        % exact, but the next reaction method is typically faster for
+        % models with many, sparsely coupled reactions, the sorting direct
+        % method for medium-sized models dominated by a few reactions, the
+        % partial-propensity method for networks dominated by bimolecular
+        % reactions, and the composition-rejection method for very large
+        % reaction networks.
+        % Tau-leaping and the hybrid method are approximate, but much
+        % faster for models with high molecular numbers, respectively
+        % mixing low and high molecular numbers. The slow-scale SSA is
+        % approximate, but orders of magnitude faster for models
+        % dominated by fast reversible reactions.
+        algorithm;
     end
     properties(SetAccess = private, GetAccess=public,Dependent)
         % Cell array holding references to all states defined in the
@@ -486,5 +508,13 @@ classdef stochSimulation < handle & matlab.mixin.CustomDisplay
             logConsole = this.call('IsLogConsole');
         end
         
+        function set.algorithm(this, algorithm)
+            this.call('SetAlgorithm', algorithm);
+        end
+        
+        function algorithm = get.algorithm(this)
+            algorithm = this.call('GetAlgorithm');
+        end
+        
     end
 end
\ No newline at end of file
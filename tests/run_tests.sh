@@ -0,0 +1,50 @@
+#!/bin/sh
+# Runs the self test of cmdstochsim, and simulates the bundled example models and the test models
+# in this folder with every algorithm, comparing the mean molecular numbers with the ones obtained
+# by the direct method (-compare).
+#
+# Usage: run_tests.sh path/to/cmdstochsim
+# Returns a non-zero exit code if any test failed or timed out.
+
+if [ $# -ne 1 ]; then
+	echo "Usage: $0 path/to/cmdstochsim" >&2
+	exit 2
+fi
+cmdstochsim=$1
+testDir=$(cd "$(dirname "$0")" && pwd)
+exampleDir=$testDir/../examples
+outputDir=$(mktemp -d) || exit 2
+trap 'rm -rf "$outputDir"' EXIT
+
+# Maximal time in seconds a single test may take, such that e.g. infinite loops are reported as failures.
+maxTime=600
+if command -v timeout > /dev/null 2>&1; then
+	run() { timeout "$maxTime" "$cmdstochsim" "$@"; }
+else
+	run() { "$cmdstochsim" "$@"; }
+fi
+
+numTests=0
+numFailed=0
+check() {
+	numTests=$((numTests + 1))
+	echo "*** $*"
+	if ! run "$@"; then
+		numFailed=$((numFailed + 1))
+		echo "*** FAILED: $*"
+	fi
+}
+
+check -selftest
+
+algorithms="nrm cr tau hybrid sdm pdm sssa"
+for algorithm in $algorithms; do
+	check -a "$algorithm" -t 40 -n 400 -seed 1 -compare -o "$outputDir" "$exampleDir/Michaelis.cmdl"
+	check -a "$algorithm" -t 40 -n 400 -seed 1 -compare -o "$outputDir" "$exampleDir/GAL.cmdl"
+	check -a "$algorithm" -t 0.5 -n 50 -seed 1 -compare -o "$outputDir" "$exampleDir/PhageInfect.cmdl"
+	check -a "$algorithm" -t 100 -n 400 -seed 1 -compare -o "$outputDir" "$testDir/BirthDeath.cmdl"
+	check -a "$algorithm" -t 20 -n 400 -seed 1 -compare -o "$outputDir" "$testDir/TimeDependent.cmdl"
+done
+
+echo "$((numTests - numFailed)) of $numTests tests passed."
+[ "$numFailed" -eq 0 ]